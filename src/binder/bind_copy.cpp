@@ -0,0 +1,84 @@
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "binder/binder.h"
+#include "binder/statement/copy_statement.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+#include "nodes/parsenodes.hpp"
+
+namespace bustub {
+
+namespace {
+
+/** @return the value of a copy option, std::nullopt if the option has none, like a bare `HEADER` */
+auto CopyOptionValue(duckdb_libpgquery::PGDefElem *def) -> std::optional<std::string> {
+  if (def->arg == nullptr) {
+    return std::nullopt;
+  }
+  switch (def->arg->type) {
+    case duckdb_libpgquery::T_PGString:
+      return std::string(reinterpret_cast<duckdb_libpgquery::PGValue *>(def->arg)->val.str);
+    case duckdb_libpgquery::T_PGInteger:
+      return std::to_string(reinterpret_cast<duckdb_libpgquery::PGValue *>(def->arg)->val.ival);
+    default:
+      throw NotImplementedException(fmt::format("unsupported value of copy option {}", def->defname));
+  }
+}
+
+}  // namespace
+
+auto Binder::BindCopy(duckdb_libpgquery::PGCopyStmt *stmt) -> std::unique_ptr<CopyStatement> {
+  if (!stmt->is_from) {
+    throw NotImplementedException("copy only supports loading a table, COPY ... TO is not supported");
+  }
+  if (stmt->relation == nullptr || stmt->query != nullptr) {
+    throw NotImplementedException("copy from a query is not supported");
+  }
+  if (stmt->attlist != nullptr) {
+    throw NotImplementedException("copy only supports all columns, don't specify columns");
+  }
+  if (stmt->is_program || stmt->filename == nullptr) {
+    throw NotImplementedException("copy only supports loading from a file");
+  }
+
+  auto table = BindBaseTableRef(stmt->relation->relname, std::nullopt);
+  if (StringUtil::StartsWith(table->table_, "__")) {
+    throw bustub::Exception(fmt::format("invalid table for copy: {}", table->table_));
+  }
+
+  std::string format = "csv";
+  char delimiter = ',';
+  bool header = false;
+  if (stmt->options != nullptr) {
+    for (auto c = stmt->options->head; c != nullptr; c = lnext(c)) {
+      auto def = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(c->data.ptr_value);
+      auto name = StringUtil::Lower(def->defname);
+      auto value = CopyOptionValue(def);
+      if (name == "format") {
+        if (!value.has_value()) {
+          throw bustub::Exception("copy option format needs a value");
+        }
+        format = StringUtil::Lower(*value);
+      } else if (name == "delimiter") {
+        if (!value.has_value() || value->size() != 1) {
+          throw bustub::Exception("copy delimiter must be a single character");
+        }
+        delimiter = (*value)[0];
+      } else if (name == "header") {
+        auto flag = StringUtil::Lower(value.value_or("true"));
+        header = flag == "true" || flag == "1" || flag == "on";
+      } else {
+        throw NotImplementedException(fmt::format("unsupported copy option: {}", name));
+      }
+    }
+  }
+  if (delimiter == '"' || delimiter == '\n' || delimiter == '\r') {
+    throw bustub::Exception("copy delimiter cannot be a quote or a newline");
+  }
+
+  return std::make_unique<CopyStatement>(std::move(table), stmt->filename, std::move(format), delimiter, header);
+}
+
+}  // namespace bustub
@@ -20,6 +20,8 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cctype>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -112,7 +114,27 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
     throw bustub::Exception("should have at least 1 column");
   }
 
-  return std::make_unique<CreateStatement>(std::move(table), std::move(columns));
+  std::string format;
+  if (pg_stmt->options != nullptr) {
+    for (auto c = pg_stmt->options->head; c != nullptr; c = lnext(c)) {
+      auto def = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(c->data.ptr_value);
+      if (std::string(def->defname) != "format" || def->arg == nullptr) {
+        throw NotImplementedException(fmt::format("unsupported table option: {}", def->defname));
+      }
+      // `format = pax` is parsed as a type name, `format = 'pax'` as a string
+      if (def->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(def->arg);
+        format = reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str;
+      } else if (def->arg->type == duckdb_libpgquery::T_PGString) {
+        format = reinterpret_cast<duckdb_libpgquery::PGValue *>(def->arg)->val.str;
+      } else {
+        throw NotImplementedException("table format must be a name");
+      }
+      std::transform(format.begin(), format.end(), format.begin(), [](unsigned char c) { return std::tolower(c); });
+    }
+  }
+
+  return std::make_unique<CreateStatement>(std::move(table), std::move(columns), std::move(format));
 }
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
@@ -129,7 +151,11 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  std::string index_type = stmt->accessMethod == nullptr ? "" : stmt->accessMethod;
+  std::transform(index_type.begin(), index_type.end(), index_type.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), std::move(index_type));
 }
 
 }  // namespace bustub
@@ -0,0 +1,78 @@
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/binder.h"
+#include "binder/bound_expression.h"
+#include "binder/expressions/bound_constant.h"
+#include "binder/expressions/bound_parameter.h"
+#include "binder/statement/prepare_statement.h"
+#include "common/exception.h"
+#include "nodes/parsenodes.hpp"
+#include "nodes/pg_list.hpp"
+#include "type/type_id.h"
+
+namespace bustub {
+
+auto Binder::BindPrepare(duckdb_libpgquery::PGPrepareStmt *stmt) -> std::unique_ptr<PrepareStatement> {
+  std::vector<TypeId> parameter_types;
+  if (stmt->argtypes != nullptr) {
+    for (auto c = stmt->argtypes->head; c != nullptr; c = lnext(c)) {
+      auto *type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(c->data.ptr_value);
+      auto name = std::string(
+          reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str);
+      // 参数只支持和表的列相同的类型，varchar 的长度没有意义
+      if (name == "int4") {
+        parameter_types.push_back(TypeId::INTEGER);
+      } else if (name == "varchar") {
+        parameter_types.push_back(TypeId::VARCHAR);
+      } else {
+        throw NotImplementedException(fmt::format("unsupported type: {}", name));
+      }
+    }
+  }
+
+  // 只有在绑定 PREPARE 的语句时才允许出现 $n
+  parameter_types_ = parameter_types;
+  auto statement = BindStatement(stmt->query);
+  parameter_types_ = std::nullopt;
+
+  return std::make_unique<PrepareStatement>(stmt->name, std::move(parameter_types), std::move(statement));
+}
+
+auto Binder::BindExecute(duckdb_libpgquery::PGExecuteStmt *stmt) -> std::unique_ptr<ExecuteStatement> {
+  std::vector<Value> parameters;
+  if (stmt->params != nullptr) {
+    for (auto &expr : BindExpressionList(stmt->params)) {
+      if (expr->type_ != ExpressionType::CONSTANT) {
+        throw NotImplementedException("only constants can be bound to the parameters of a prepared statement");
+      }
+      parameters.push_back(dynamic_cast<const BoundConstant &>(*expr).val_);
+    }
+  }
+  return std::make_unique<ExecuteStatement>(stmt->name, std::move(parameters));
+}
+
+auto Binder::BindDeallocate(duckdb_libpgquery::PGDeallocateStmt *stmt) -> std::unique_ptr<DeallocateStatement> {
+  if (stmt->name == nullptr) {
+    return std::make_unique<DeallocateStatement>(std::nullopt);
+  }
+  return std::make_unique<DeallocateStatement>(stmt->name);
+}
+
+auto Binder::BindParameter(duckdb_libpgquery::PGParamRef *node) -> std::unique_ptr<BoundExpression> {
+  if (!parameter_types_.has_value()) {
+    throw bustub::Exception("parameters are only allowed in a prepared statement");
+  }
+  if (node->number <= 0) {
+    throw NotImplementedException("only numbered parameters like $1 are supported");
+  }
+  auto index = static_cast<uint32_t>(node->number - 1);
+  // 没有声明类型的参数留给 planner 根据它所比较的表达式推断
+  auto type = index < parameter_types_->size() ? (*parameter_types_)[index] : TypeId::INVALID;
+  return std::make_unique<BoundParameter>(index, type);
+}
+
+}  // namespace bustub
@@ -722,6 +722,19 @@ auto Binder::BindAExpr(duckdb_libpgquery::PGAExpr *root) -> std::unique_ptr<Boun
   BUSTUB_ASSERT(root, "nullptr");
   auto name = std::string((reinterpret_cast<duckdb_libpgquery::PGValue *>(root->name->head->data.ptr_value))->val.str);
 
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN || root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN) {
+    // `x BETWEEN a AND b` is bound as `x >= a AND x <= b`, `x NOT BETWEEN a AND b` as `x < a OR x > b`
+    auto bounds = BindExpressionList(reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr));
+    if (bounds.size() != 2) {
+      throw bustub::Exception("BETWEEN should have 2 bounds");
+    }
+    bool negated = root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN;
+    auto low = std::make_unique<BoundBinaryOp>(negated ? "<" : ">=", BindExpression(root->lexpr), std::move(bounds[0]));
+    auto high =
+        std::make_unique<BoundBinaryOp>(negated ? ">" : "<=", BindExpression(root->lexpr), std::move(bounds[1]));
+    return std::make_unique<BoundBinaryOp>(negated ? "or" : "and", std::move(low), std::move(high));
+  }
+
   if (root->kind != duckdb_libpgquery::PG_AEXPR_OP) {
     throw bustub::Exception("unsupported op in AExpr");
   }
@@ -800,6 +813,8 @@ auto Binder::BindExpression(duckdb_libpgquery::PGNode *node) -> std::unique_ptr<
       return BindAExpr(reinterpret_cast<duckdb_libpgquery::PGAExpr *>(node));
     case duckdb_libpgquery::T_PGBoolExpr:
       return BindBoolExpr(reinterpret_cast<duckdb_libpgquery::PGBoolExpr *>(node));
+    case duckdb_libpgquery::T_PGParamRef:
+      return BindParameter(reinterpret_cast<duckdb_libpgquery::PGParamRef *>(node));
     default:
       break;
   }
@@ -0,0 +1,35 @@
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "binder/binder.h"
+#include "binder/statement/vacuum_statement.h"
+#include "binder/table_ref/bound_base_table_ref.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+#include "nodes/parsenodes.hpp"
+
+namespace bustub {
+
+auto Binder::BindVacuum(duckdb_libpgquery::PGVacuumStmt *stmt) -> std::unique_ptr<VacuumStatement> {
+  if ((stmt->options & duckdb_libpgquery::PG_VACOPT_FULL) != 0) {
+    throw NotImplementedException("VACUUM FULL is not supported");
+  }
+  if (stmt->va_cols != nullptr) {
+    throw NotImplementedException("vacuum or analyze of columns is not supported");
+  }
+  bool vacuum = (stmt->options & duckdb_libpgquery::PG_VACOPT_VACUUM) != 0;
+  bool analyze = (stmt->options & duckdb_libpgquery::PG_VACOPT_ANALYZE) != 0;
+  if (stmt->relation == nullptr) {
+    return std::make_unique<VacuumStatement>(std::nullopt, vacuum, analyze);
+  }
+
+  // 确认表存在
+  auto table = BindBaseTableRef(stmt->relation->relname, std::nullopt);
+  if (StringUtil::StartsWith(table->table_, "__")) {
+    throw bustub::Exception(fmt::format("invalid table for vacuum: {}", table->table_));
+  }
+  return std::make_unique<VacuumStatement>(table->table_, vacuum, analyze);
+}
+
+}  // namespace bustub
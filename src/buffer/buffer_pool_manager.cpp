@@ -101,7 +101,6 @@ auto BufferPoolManager::GetPageByPageId(bustub::page_id_t pageId) -> Page * {
 }
 auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "create New page..." << std::endl;
   Page* page = nullptr;
   frame_id_t  frame_id = -1;
   //先查找空闲列表
@@ -129,7 +128,6 @@ auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
 
   if(frame_id == -1){
     throw  Exception("frame....");
-    std::cout << "Fail to create new page" << std::endl;
     throw Exception("fail to create new page");
     return nullptr;
   }
@@ -139,16 +137,15 @@ auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
   page->page_id_ = *page_id;
   page->pin_count_ = 1;
   page->is_dirty_ = false;
- // page->data_ = nullptr;
+  // 复用的帧中还留着上一个页面的数据，新页面必须从全0开始
+  page->ResetMemory();
 
   replacer_->RecordAccess(frame_id);
-  std::cout << "Success to create a new page " << *page_id << std::endl;
   return page;
 }
 
 auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "Fetch page " << page_id << std::endl;
 
   //todo 先查询buffer pool
   Page* page = nullptr;
@@ -194,7 +191,6 @@ auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType
   }
 
   if(frame_id == -1){
-    std::cout << "Fail to fetch page " << page_id << std::endl;
     throw Exception("Fail to fetch page");
     return nullptr;
   }
@@ -205,22 +201,18 @@ auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType
   page->pin_count_++;
 
   replacer_->RecordAccess(frame_id);
-  std::cout << "success to fetch page " << page_id << std::endl;
   return page;
 }
 
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
 
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "Unpin page " << page_id << std::endl;
   if(page_table_.find(page_id) == page_table_.end()){
-    std::cout << "Page " << page_id << " is not in buffer pool" << std::endl;
     return false;
   }
 
   Page* page = GetPageByPageId(page_id);
   if(page->pin_count_ == 0){
-    std::cout << "pin count of page" << page_id << " is 0" << std::endl;
     return false;
   }
 
@@ -239,15 +231,12 @@ auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unus
     replacer_->SetEvictable(page_table_[page_id], true);
   }
 
-  std::cout << "Success to unpin page "<< page_id << std::endl;
   return true;
 }
 
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "Flush page "<< page_id << std::endl;
   if(page_table_.find(page_id) == page_table_.end()){
-    std::cout << "page " << page_id << "is not in buffer pool" << std::endl;
     return false;
   }
 
@@ -255,14 +244,12 @@ auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
   disk_manager_->WritePage(page->page_id_, page->data_);
   page->is_dirty_ = false;
 
-  std::cout << "Success to flush page " << page_id << std::endl;
   return true;
 
 }
 
 void BufferPoolManager::FlushAllPages() {
     std::unique_lock<std::mutex> lock(latch_);
-    std::cout << "Flush all page" << std::endl;
     for(size_t i=0; i<pool_size_; i++){
       if(pages_[i].page_id_ == INVALID_PAGE_ID){
         continue ;
@@ -270,27 +257,26 @@ void BufferPoolManager::FlushAllPages() {
       disk_manager_->WritePage(pages_[i].page_id_, pages_[i].data_);
       pages_[i].is_dirty_ = false;
     }
-    std::cout << "Success to flush all page" << std::endl;
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "Delete page " << page_id << std::endl;
   if(page_table_.find(page_id) == page_table_.end()){
-      std::cout << "page " << page_id << "is not in buffer pool" << std::endl;
       return false;
   }
 
   Page* page = GetPageByPageId(page_id);
   if(page->pin_count_ > 0){
-      std::cout << "pin count of page " << page_id << " is lager than 0" << std::endl;
       return false;
   }
 
-  replacer_->Remove(page_table_[page_id]);
+  frame_id_t frame_id = page_table_[page_id];
+  replacer_->Remove(frame_id);
+  page_table_.erase(page_id);
   page->page_id_ = INVALID_PAGE_ID;
-  page_table_.erase(page->page_id_);
-  std::cout << "Success to delete page " << page_id << std::endl;
+  page->is_dirty_ = false;
+  page->ResetMemory();
+  free_list_.emplace_back(frame_id);
   return true;
 }
 
@@ -303,7 +289,6 @@ auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard {
 auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
 
    Page* page = FetchPage(page_id);
-   std::cout << "RLatch page " << page_id << std::endl;
    page->RLatch();
    return { this, page};
   //return {this, FetchPage(page_id)};
@@ -312,7 +297,6 @@ auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
 auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
     Page* page = FetchPage(page_id);
     page->WLatch();
-    std::cout << "WLatch page " << page_id << std::endl;
     return {this, page};
    //return {this, FetchPage(page_id)};
 }
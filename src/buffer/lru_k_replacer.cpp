@@ -21,7 +21,6 @@ LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_fra
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
 
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "evict..." <<  std::endl;
 
   bool is_inf = false;
   size_t max_k_distance = UINT64_MAX;
@@ -50,20 +49,17 @@ auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   }
 
   if(*frame_id == -1){
-      std::cout << "failed to evict a frame..." << std::endl;
       return false;
   }
 
   //移除frame_id;
   node_store_.erase(*frame_id);
   curr_size_--;
-  std::cout << "success to  evict frame " << *frame_id << std::endl;
   return true;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "access frame " << frame_id <<" at timestamp " << current_timestamp_ << std::endl;
   if(frame_id > frame_id_t (replacer_size_)){
     throw Exception(fmt::format("frame_id[{}] is invalid", frame_id));
   }
@@ -84,7 +80,6 @@ void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "set frame " << frame_id << " to " << set_evictable << std::endl;
   if(frame_id > (frame_id_t)replacer_size_){
     throw Exception(fmt::format("frame_id[{}] is invalid", frame_id));
   }
@@ -104,7 +99,6 @@ void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::unique_lock<std::mutex> lock(latch_);
-  std::cout << "remove frame " << frame_id << std::endl;
   if(frame_id > (frame_id_t)replacer_size_){
     throw Exception(fmt::format("frame_id[{}] is invalid", frame_id));
   }
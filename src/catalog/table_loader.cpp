@@ -0,0 +1,352 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_loader.cpp
+//
+// Identification: src/catalog/table_loader.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_loader.h"
+
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+#include "common/exception.h"
+#include "common/util/parallel_util.h"
+#include "fmt/format.h"
+#include "type/limits.h"
+#include "type/type.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TableLoader::TableLoader(Catalog *catalog, TableInfo *table, Transaction *txn, LoadOptions options)
+    : table_(table),
+      txn_(txn),
+      options_(options),
+      indexes_(catalog->GetTableIndexes(table->name_)),
+      index_entries_(indexes_.size()),
+      skip_header_(options.format_ == LoadFormat::Csv && options.header_) {}
+
+auto TableLoader::LoadFile(const std::string &path) -> size_t {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) {
+    throw Exception(fmt::format("cannot open file {}", path));
+  }
+  return Load(in);
+}
+
+auto TableLoader::Load(std::istream &in) -> size_t {
+  if (options_.format_ == LoadFormat::Binary) {
+    ReadBinaryHeader(in);
+  }
+
+  try {
+    LoadRows(in);
+  } catch (...) {
+    // 解析出错时前面的分块已经写入了表，但索引还没有建。把这些行标记为删除，表和索引都回到加载之前
+    for (const auto &rid : inserted_rids_) {
+      table_->table_->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rid);
+    }
+    inserted_rids_.clear();
+    for (auto &entries : index_entries_) {
+      entries.clear();
+    }
+    num_rows_ = 0;
+    throw;
+  }
+  inserted_rids_.clear();
+
+  // 表加载完后再建索引，每个索引的键排序后一次插入
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    indexes_[i]->index_->InsertEntries(index_entries_[i], txn_);
+    index_entries_[i].clear();
+  }
+  return num_rows_;
+}
+
+void TableLoader::LoadRows(std::istream &in) {
+  const auto num_workers = ParallelUtil::WorkerCount();
+  std::string carry;
+  bool more = true;
+  while (more) {
+    // 读入一轮分块，由工作线程并行解析，再按文件顺序批量插入
+    std::vector<std::string> chunks;
+    while (chunks.size() < num_workers * 2) {
+      std::string chunk;
+      if (!ReadChunk(in, &carry, &chunk)) {
+        more = false;
+        break;
+      }
+      chunks.push_back(std::move(chunk));
+    }
+    std::vector<std::vector<Tuple>> parsed(chunks.size());
+    ParallelUtil::For(num_workers, chunks.size(), [&](size_t i) {
+      if (options_.format_ == LoadFormat::Csv) {
+        ParseCsv(chunks[i], &parsed[i]);
+      } else {
+        ParseBinary(chunks[i], &parsed[i]);
+      }
+    });
+    for (const auto &tuples : parsed) {
+      InsertTuples(tuples);
+    }
+  }
+}
+
+auto TableLoader::ReadChunk(std::istream &in, std::string *carry, std::string *chunk) -> bool {
+  std::string buf = std::move(*carry);
+  carry->clear();
+  while (true) {
+    auto old_size = buf.size();
+    buf.resize(old_size + CHUNK_SIZE);
+    in.read(buf.data() + old_size, CHUNK_SIZE);
+    buf.resize(old_size + in.gcount());
+    if (static_cast<size_t>(in.gcount()) < CHUNK_SIZE) {
+      // 读到文件末尾，剩下的就是最后一块
+      if (buf.empty()) {
+        return false;
+      }
+      if (options_.format_ == LoadFormat::Binary && CompleteRowsLength(buf) != buf.size()) {
+        throw Exception("truncated binary row file");
+      }
+      *chunk = std::move(buf);
+      break;
+    }
+    auto length = CompleteRowsLength(buf);
+    if (length > 0) {
+      carry->assign(buf, length);
+      buf.resize(length);
+      *chunk = std::move(buf);
+      break;
+    }
+    // 一行比一块还长，继续读
+  }
+
+  if (skip_header_) {
+    skip_header_ = false;
+    bool quoted = false;
+    size_t header_end = chunk->size();
+    for (size_t i = 0; i < chunk->size(); i++) {
+      if ((*chunk)[i] == '"') {
+        quoted = !quoted;
+      } else if ((*chunk)[i] == '\n' && !quoted) {
+        header_end = i + 1;
+        break;
+      }
+    }
+    chunk->erase(0, header_end);
+  }
+  return true;
+}
+
+auto TableLoader::CompleteRowsLength(const std::string &buf) const -> size_t {
+  if (options_.format_ == LoadFormat::Binary) {
+    size_t pos = 0;
+    while (pos + sizeof(uint32_t) <= buf.size()) {
+      uint32_t length;
+      memcpy(&length, buf.data() + pos, sizeof(uint32_t));
+      if (pos + sizeof(uint32_t) + length > buf.size()) {
+        break;
+      }
+      pos += sizeof(uint32_t) + length;
+    }
+    return pos;
+  }
+  // 引号里的换行不是行尾
+  bool quoted = false;
+  size_t end = 0;
+  for (size_t i = 0; i < buf.size(); i++) {
+    if (buf[i] == '"') {
+      quoted = !quoted;
+    } else if (buf[i] == '\n' && !quoted) {
+      end = i + 1;
+    }
+  }
+  return end;
+}
+
+void TableLoader::ReadBinaryHeader(std::istream &in) const {
+  char magic[sizeof(BINARY_MAGIC)];
+  uint32_t column_count = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&column_count), sizeof(column_count));
+  if (!in || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+    throw Exception("not a binary row file");
+  }
+  const auto &schema = table_->schema_;
+  if (column_count != schema.GetColumnCount()) {
+    throw Exception(fmt::format("binary row file has {} columns, table {} has {}", column_count, table_->name_,
+                                schema.GetColumnCount()));
+  }
+  for (uint32_t i = 0; i < column_count; i++) {
+    char type = 0;
+    in.read(&type, 1);
+    if (!in || static_cast<TypeId>(type) != schema.GetColumn(i).GetType()) {
+      throw Exception(fmt::format("type of column {} of the binary row file does not match the table", i));
+    }
+  }
+}
+
+void TableLoader::ParseCsv(const std::string &chunk, std::vector<Tuple> *tuples) const {
+  const auto &schema = table_->schema_;
+  const auto num_columns = schema.GetColumnCount();
+  const auto delimiter = options_.delimiter_;
+  const auto size = chunk.size();
+  std::vector<Value> values;
+  std::string field;
+  size_t pos = 0;
+  while (pos < size) {
+    // 跳过空行
+    if (chunk[pos] == '\n' || (chunk[pos] == '\r' && pos + 1 < size && chunk[pos + 1] == '\n')) {
+      pos += chunk[pos] == '\n' ? 1 : 2;
+      continue;
+    }
+    values.clear();
+    bool end_of_row = false;
+    while (!end_of_row) {
+      field.clear();
+      bool quoted = pos < size && chunk[pos] == '"';
+      if (quoted) {
+        pos++;
+        while (true) {
+          if (pos >= size) {
+            throw Exception("unterminated quoted field in CSV file");
+          }
+          char c = chunk[pos++];
+          if (c != '"') {
+            field.push_back(c);
+          } else if (pos < size && chunk[pos] == '"') {
+            field.push_back('"');
+            pos++;
+          } else {
+            break;
+          }
+        }
+        if (pos < size && chunk[pos] == '\r' && (pos + 1 == size || chunk[pos + 1] == '\n')) {
+          pos++;
+        }
+        if (pos < size && chunk[pos] != delimiter && chunk[pos] != '\n') {
+          throw Exception("unexpected character after a quoted field in CSV file");
+        }
+      } else {
+        auto start = pos;
+        while (pos < size && chunk[pos] != delimiter && chunk[pos] != '\n') {
+          pos++;
+        }
+        field.assign(chunk, start, pos - start);
+        if (!field.empty() && field.back() == '\r' && (pos == size || chunk[pos] == '\n')) {
+          field.pop_back();
+        }
+      }
+      end_of_row = pos >= size || chunk[pos] == '\n';
+      if (values.size() == num_columns) {
+        throw Exception(fmt::format("CSV row has more than {} fields", num_columns));
+      }
+      values.push_back(ParseField(field, quoted, values.size()));
+      pos++;
+    }
+    if (values.size() != num_columns) {
+      throw Exception(fmt::format("CSV row has {} fields, table {} has {} columns", values.size(), table_->name_,
+                                  num_columns));
+    }
+    tuples->emplace_back(values, &schema);
+    CheckTupleSize(tuples->back());
+  }
+}
+
+auto TableLoader::ParseField(const std::string &field, bool quoted, uint32_t column_idx) const -> Value {
+  const auto &column = table_->schema_.GetColumn(column_idx);
+  if (field.empty() && !quoted) {
+    return ValueFactory::GetNullValueByType(column.GetType());
+  }
+  if (column.GetType() == TypeId::VARCHAR) {
+    return ValueFactory::GetVarcharValue(field);
+  }
+  try {
+    return ValueFactory::GetVarcharValue(field).CastAs(column.GetType());
+  } catch (Exception &) {
+    throw;
+  } catch (std::exception &) {
+    throw Exception(fmt::format("invalid {} value '{}' for column {}", Type::TypeIdToString(column.GetType()), field,
+                                column.GetName()));
+  }
+}
+
+void TableLoader::ParseBinary(const std::string &chunk, std::vector<Tuple> *tuples) const {
+  const auto &schema = table_->schema_;
+  size_t pos = 0;
+  while (pos < chunk.size()) {
+    uint32_t length;
+    memcpy(&length, chunk.data() + pos, sizeof(uint32_t));
+    const char *data = chunk.data() + pos + sizeof(uint32_t);
+    // 文件来自外部，变长列的偏移和长度都要落在行内
+    bool valid = length >= schema.GetLength();
+    for (uint32_t i = 0; valid && i < schema.GetColumnCount(); i++) {
+      const auto &column = schema.GetColumn(i);
+      if (column.IsInlined()) {
+        continue;
+      }
+      uint32_t offset;
+      uint32_t var_length;
+      memcpy(&offset, data + column.GetOffset(), sizeof(uint32_t));
+      valid = offset <= length - sizeof(uint32_t);
+      if (valid) {
+        memcpy(&var_length, data + offset, sizeof(uint32_t));
+        valid = var_length == BUSTUB_VALUE_NULL || var_length <= length - offset - sizeof(uint32_t);
+      }
+    }
+    if (!valid) {
+      throw Exception("corrupted row in binary row file");
+    }
+    Tuple tuple;
+    tuple.DeserializeFrom(chunk.data() + pos);
+    CheckTupleSize(tuple);
+    tuples->push_back(std::move(tuple));
+    pos += sizeof(uint32_t) + length;
+  }
+}
+
+void TableLoader::CheckTupleSize(const Tuple &tuple) const {
+  // 放不进空页面的行在这里报错，回滚已经插入的行，而不是在插入时使进程崩溃
+  if (!table_->table_->FitsInPage(tuple)) {
+    throw Exception(fmt::format("row of {} bytes does not fit in a page of table {}", tuple.GetLength(),
+                                table_->name_));
+  }
+}
+
+void TableLoader::InsertTuples(const std::vector<Tuple> &tuples) {
+  auto rids = table_->table_->InsertTuples(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuples);
+  inserted_rids_.insert(inserted_rids_.end(), rids.begin(), rids.end());
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    const auto *index_info = indexes_[i];
+    for (size_t j = 0; j < tuples.size(); j++) {
+      index_entries_[i].emplace_back(
+          tuples[j].KeyFromTuple(table_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs()),
+          rids[j]);
+    }
+  }
+  num_rows_ += tuples.size();
+}
+
+BinaryRowWriter::BinaryRowWriter(std::ostream &out, const Schema &schema) : out_(out), schema_(schema) {
+  uint32_t column_count = schema_.GetColumnCount();
+  out_.write(TableLoader::BINARY_MAGIC, sizeof(TableLoader::BINARY_MAGIC));
+  out_.write(reinterpret_cast<const char *>(&column_count), sizeof(column_count));
+  for (const auto &column : schema_.GetColumns()) {
+    auto type = static_cast<char>(column.GetType());
+    out_.write(&type, 1);
+  }
+}
+
+void BinaryRowWriter::WriteRow(const std::vector<Value> &values) {
+  Tuple tuple{values, &schema_};
+  std::vector<char> buf(sizeof(uint32_t) + tuple.GetLength());
+  tuple.SerializeTo(buf.data());
+  out_.write(buf.data(), buf.size());
+}
+
+}  // namespace bustub
@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_statistics.cpp
+//
+// Identification: src/catalog/table_statistics.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <string_view>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+namespace {
+
+/** MurmurHash3 的 fmix64，HashOf 对整数是恒等映射，需要先打散 */
+auto Mix(hash_t hash) -> uint64_t {
+  uint64_t h = hash;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+auto ToDouble(const Value &value) -> std::optional<double> {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return static_cast<double>(value.GetAs<int64_t>());
+    case TypeId::DECIMAL:
+      return value.GetAs<double>();
+    default:
+      return std::nullopt;
+  }
+}
+
+auto Less(const Value &l, const Value &r) -> bool { return l.CompareLessThan(r) == CmpBool::CmpTrue; }
+
+}  // namespace
+
+auto HyperLogLog::HashOf(const Value &value) -> hash_t {
+  // 整数直接用原值，不同的整数不会冲突，AddHash 会再打散；字符串用标准库的哈希
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+      return static_cast<hash_t>(static_cast<int64_t>(*ToDouble(value)));
+    case TypeId::BIGINT:
+      return static_cast<hash_t>(value.GetAs<int64_t>());
+    case TypeId::DECIMAL:
+      return std::hash<double>{}(value.GetAs<double>());
+    case TypeId::VARCHAR:
+      return std::hash<std::string_view>{}(std::string_view(value.GetData(), value.GetLength()));
+    default:
+      return HashUtil::HashValue(&value);
+  }
+}
+
+HyperLogLog::HyperLogLog(uint8_t precision) : precision_(precision), registers_(1ULL << precision, 0) {}
+
+void HyperLogLog::AddHash(hash_t hash) {
+  auto h = Mix(hash);
+  auto index = h >> (64 - precision_);
+  // 剩余的位中第一个 1 的位置，末尾补一个 1 保证不会全零
+  auto rest = (h << precision_) | (1ULL << (precision_ - 1));
+  auto rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+auto HyperLogLog::Estimate() const -> size_t {
+  auto m = static_cast<double>(registers_.size());
+  double sum = 0;
+  size_t zeros = 0;
+  for (auto rank : registers_) {
+    sum += std::ldexp(1.0, -rank);
+    zeros += rank == 0 ? 1 : 0;
+  }
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate = alpha * m * m / sum;
+  // 基数较小时用 linear counting 修正
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / static_cast<double>(zeros));
+  }
+  return static_cast<size_t>(std::llround(estimate));
+}
+
+auto ColumnStatistics::EqualFraction(const Value &value) const -> double {
+  if (distinct_count_ == 0 || bounds_.empty() || Less(value, bounds_.front()) || Less(bounds_.back(), value)) {
+    return 0;
+  }
+  return 1.0 / static_cast<double>(distinct_count_);
+}
+
+auto ColumnStatistics::LessFraction(const Value &value, bool inclusive) const -> double {
+  if (bounds_.empty()) {
+    return 0;
+  }
+  if (Less(value, bounds_.front())) {
+    return 0;
+  }
+  if (!Less(value, bounds_.back())) {
+    return inclusive || Less(bounds_.back(), value) ? 1.0 : 1.0 - EqualFraction(value);
+  }
+  auto buckets = bounds_.size() - 1;
+  // 第一个上界不小于 value 的桶，前面的桶都完整计入
+  size_t bucket = 1;
+  while (bucket < bounds_.size() && Less(bounds_[bucket], value)) {
+    bucket++;
+  }
+  double fraction = 0.5;
+  auto low = ToDouble(bounds_[bucket - 1]);
+  auto high = ToDouble(bounds_[bucket]);
+  auto v = ToDouble(value);
+  if (low.has_value() && high.has_value() && v.has_value() && *high > *low) {
+    fraction = (*v - *low) / (*high - *low);
+  }
+  double result = (static_cast<double>(bucket - 1) + fraction) / static_cast<double>(buckets);
+  if (inclusive) {
+    result += EqualFraction(value);
+  }
+  return std::clamp(result, 0.0, 1.0);
+}
+
+auto TableStatistics::Collect(TableHeap *table, const Schema &schema) -> TableStatistics {
+  TableStatistics stats;
+  const auto column_count = schema.GetColumnCount();
+  stats.columns_.resize(column_count);
+  std::vector<HyperLogLog> sketches(column_count);
+  // 蓄水池抽样，固定种子使同样的数据得到同样的直方图
+  std::vector<std::vector<Value>> sample;
+  std::mt19937_64 rng(0x5eed);
+
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    if (meta.is_deleted_) {
+      continue;
+    }
+    stats.row_count_++;
+    std::vector<Value> row;
+    row.reserve(column_count);
+    for (uint32_t i = 0; i < column_count; i++) {
+      auto value = tuple.GetValue(&schema, i);
+      if (value.IsNull()) {
+        stats.columns_[i].null_count_++;
+      } else {
+        sketches[i].AddHash(HyperLogLog::HashOf(value));
+      }
+      row.push_back(std::move(value));
+    }
+    if (sample.size() < SAMPLE_SIZE) {
+      sample.push_back(std::move(row));
+    } else {
+      auto slot = std::uniform_int_distribution<size_t>(0, stats.row_count_ - 1)(rng);
+      if (slot < SAMPLE_SIZE) {
+        sample[slot] = std::move(row);
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto &column = stats.columns_[i];
+    std::vector<Value> values;
+    for (const auto &row : sample) {
+      if (!row[i].IsNull()) {
+        values.push_back(row[i]);
+      }
+    }
+    if (values.empty()) {
+      continue;
+    }
+    // HLL 的误差可能让估计值超过非空行数
+    column.distinct_count_ = std::clamp<size_t>(sketches[i].Estimate(), 1, stats.row_count_ - column.null_count_);
+    std::sort(values.begin(), values.end(), Less);
+    auto buckets = std::min(NUM_BUCKETS, values.size());
+    column.bounds_.push_back(values.front());
+    for (size_t b = 1; b <= buckets; b++) {
+      column.bounds_.push_back(values[b * values.size() / buckets - 1]);
+    }
+  }
+  return stats;
+}
+
+}  // namespace bustub
@@ -1,5 +1,5 @@
 // DDL (Data Definition Language) statement handling in BusTub, including create table, create index, and set/show
-// variable.
+// variable. COPY and VACUUM are handled here as well, they work on a table without going through the planner.
 
 #include <optional>
 #include <shared_mutex>
@@ -9,20 +9,25 @@
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
 #include "binder/bound_statement.h"
+#include "binder/statement/copy_statement.h"
 #include "binder/statement/create_statement.h"
 #include "binder/statement/explain_statement.h"
 #include "binder/statement/index_statement.h"
+#include "binder/statement/prepare_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
+#include "binder/statement/vacuum_statement.h"
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
+#include "catalog/table_loader.h"
 #include "common/bustub_instance.h"
 #include "common/enums/statement_type.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/mock_scan_executor.h"
@@ -31,6 +36,7 @@
 #include "fmt/core.h"
 #include "fmt/format.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/plan_cache.h"
 #include "planner/planner.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
@@ -41,8 +47,17 @@
 namespace bustub {
 
 void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer) {
+  TableFormat format;
+  if (stmt.format_.empty() || stmt.format_ == "row") {
+    format = TableFormat::Row;
+  } else if (stmt.format_ == "pax") {
+    format = TableFormat::Pax;
+  } else {
+    throw NotImplementedException(fmt::format("unsupported table format: {}", stmt.format_));
+  }
+
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_));
+  auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_), true, format);
   l.unlock();
 
   if (info == nullptr) {
@@ -71,10 +86,23 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
     throw NotImplementedException("only support creating index with exactly one or two columns");
   }
 
+  // `art` is what the parser reports when no access method is given
+  IndexType index_type;
+  if (stmt.index_type_.empty() || stmt.index_type_ == "art" || stmt.index_type_ == "btree" ||
+      stmt.index_type_ == "bplustree") {
+    index_type = IndexType::BPlusTreeIndex;
+  } else if (stmt.index_type_ == "hash") {
+    index_type = IndexType::HashTableIndex;
+  } else if (stmt.index_type_ == "linear_probe") {
+    index_type = IndexType::LinearProbeHashTableIndex;
+  } else {
+    throw NotImplementedException(fmt::format("unsupported index type: {}", stmt.index_type_));
+  }
+
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
   auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
       txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+      IntegerHashFunctionType{}, index_type);
   l.unlock();
 
   if (info == nullptr) {
@@ -83,6 +111,63 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
   WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
 }
 
+void BustubInstance::HandleCopyStatement(Transaction *txn, const CopyStatement &stmt, ResultWriter &writer) {
+  LoadOptions options;
+  if (stmt.format_ == "csv") {
+    options.format_ = LoadFormat::Csv;
+  } else if (stmt.format_ == "binary") {
+    options.format_ = LoadFormat::Binary;
+  } else {
+    throw NotImplementedException(fmt::format("unsupported copy format: {}", stmt.format_));
+  }
+  options.delimiter_ = stmt.delimiter_;
+  options.header_ = stmt.header_;
+
+  // Hold the catalog lock for the whole load, so no index is created on the table while it is loaded.
+  std::shared_lock<std::shared_mutex> l(catalog_lock_);
+  auto *table_info = catalog_->GetTable(stmt.table_->table_);
+  TableLoader loader(catalog_, table_info, txn, options);
+  auto num_rows = loader.LoadFile(stmt.file_path_);
+  l.unlock();
+
+  WriteOneCell(fmt::format("{}", num_rows), writer);
+}
+
+void BustubInstance::HandleVacuumStatement(Transaction *txn, const VacuumStatement &stmt, ResultWriter &writer) {
+  // A deleted tuple can be reclaimed once the transaction that deleted it has finished, i.e. it is older than
+  // every running transaction. The transaction running VACUUM is one of them.
+  auto horizon = txn_manager_->GetOldestRunningTxnId();
+  auto can_reclaim = [horizon](const TupleMeta &meta) {
+    return meta.delete_txn_id_ == INVALID_TXN_ID || meta.delete_txn_id_ < horizon;
+  };
+
+  std::shared_lock<std::shared_mutex> l(catalog_lock_);
+  std::vector<std::string> tables;
+  if (stmt.table_.has_value()) {
+    tables.push_back(*stmt.table_);
+  } else {
+    tables = catalog_->GetTableNames();
+  }
+  // VACUUM reports the number of reclaimed tuples, ANALYZE the number of rows it found.
+  size_t count = 0;
+  for (const auto &table : tables) {
+    auto *table_info = catalog_->GetTable(table);
+    if (stmt.vacuum_) {
+      count += table_info->table_->Vacuum(can_reclaim);
+    }
+    if (stmt.analyze_) {
+      auto stats = TableStatistics::Collect(table_info->table_.get(), table_info->schema_);
+      if (!stmt.vacuum_) {
+        count += stats.row_count_;
+      }
+      catalog_->SetTableStatistics(table_info->oid_, std::move(stats));
+    }
+  }
+  l.unlock();
+
+  WriteOneCell(fmt::format("{}", count), writer);
+}
+
 void BustubInstance::HandleExplainStatement(Transaction *txn, const ExplainStatement &stmt, ResultWriter &writer) {
   std::string output;
 
@@ -136,4 +221,55 @@ void BustubInstance::HandleVariableSetStatement(Transaction *txn, const Variable
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
+void BustubInstance::HandlePrepareStatement(Transaction *txn, const PrepareStatement &stmt, ResultWriter &writer) {
+  if (prepared_statements_.count(stmt.name_) != 0) {
+    throw bustub::Exception(fmt::format("prepared statement {} already exists", stmt.name_));
+  }
+  prepared_statements_[stmt.name_] = PlanPreparedStatement(stmt.statement_, stmt.parameter_types_);
+}
+
+auto BustubInstance::HandleExecuteStatement(Transaction *txn, const ExecuteStatement &stmt, ResultWriter &writer,
+                                            std::shared_ptr<CheckOptions> check_options) -> bool {
+  auto it = prepared_statements_.find(stmt.name_);
+  if (it == prepared_statements_.end()) {
+    throw bustub::Exception(fmt::format("prepared statement {} does not exist", stmt.name_));
+  }
+
+  // The plan was built before a table, an index or the statistics changed, plan the bound statement again.
+  if (it->second->catalog_version_ != catalog_->GetVersion()) {
+    it->second = PlanPreparedStatement(it->second->statement_, it->second->parameter_types_);
+  }
+  auto cached_plan = it->second;
+
+  const auto &types = cached_plan->parameter_types_;
+  if (stmt.parameters_.size() != types.size()) {
+    throw bustub::Exception(fmt::format("prepared statement {} takes {} parameters, {} given", stmt.name_,
+                                        types.size(), stmt.parameters_.size()));
+  }
+  std::vector<Value> parameters;
+  parameters.reserve(types.size());
+  for (size_t i = 0; i < types.size(); i++) {
+    const auto &value = stmt.parameters_[i];
+    if (value.IsNull()) {
+      parameters.push_back(ValueFactory::GetNullValueByType(types[i]));
+    } else if (value.GetTypeId() != types[i]) {
+      parameters.push_back(value.CastAs(types[i]));
+    } else {
+      parameters.push_back(value);
+    }
+  }
+  return ExecutePlan(*cached_plan, parameters, txn, writer, std::move(check_options));
+}
+
+void BustubInstance::HandleDeallocateStatement(Transaction *txn, const DeallocateStatement &stmt,
+                                               ResultWriter &writer) {
+  if (!stmt.name_.has_value()) {
+    prepared_statements_.clear();
+    return;
+  }
+  if (prepared_statements_.erase(*stmt.name_) == 0) {
+    throw bustub::Exception(fmt::format("prepared statement {} does not exist", *stmt.name_));
+  }
+}
+
 }  // namespace bustub
@@ -6,11 +6,14 @@
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
 #include "binder/bound_statement.h"
+#include "binder/statement/copy_statement.h"
 #include "binder/statement/create_statement.h"
 #include "binder/statement/explain_statement.h"
 #include "binder/statement/index_statement.h"
+#include "binder/statement/prepare_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
+#include "binder/statement/vacuum_statement.h"
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
@@ -29,6 +32,7 @@
 #include "fmt/core.h"
 #include "fmt/format.h"
 #include "optimizer/optimizer.h"
+#include "optimizer/plan_cache.h"
 #include "planner/planner.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
@@ -80,6 +84,8 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
+
+  plan_cache_ = std::make_unique<PlanCache>(PLAN_CACHE_SIZE);
 }
 
 BustubInstance::BustubInstance() {
@@ -120,6 +126,8 @@ BustubInstance::BustubInstance() {
 
   // Execution engine.
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
+
+  plan_cache_ = std::make_unique<PlanCache>(PLAN_CACHE_SIZE);
 }
 
 void BustubInstance::CmdDisplayTables(ResultWriter &writer) {
@@ -201,6 +209,11 @@ auto BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer,
     txn_manager_->Abort(txn);
     delete txn;
     throw ex;
+  } catch (...) {
+    // Rows are written while the query runs, so an exception from the writer also aborts the transaction.
+    txn_manager_->Abort(txn);
+    delete txn;
+    throw;
   }
 }
 
@@ -223,6 +236,19 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
     throw Exception(fmt::format("unsupported internal command: {}", sql));
   }
 
+  // A single SELECT, INSERT, UPDATE or DELETE run before is run again with its cached plan, skipping parsing,
+  // binding, planning and optimization.
+  auto cache_key = PlanCacheKey(sql);
+  if (cache_key.has_value()) {
+    // The catalog version is read under the catalog lock like in the planning path below.
+    std::shared_lock<std::shared_mutex> l(catalog_lock_);
+    auto cached_plan = plan_cache_->Get(*cache_key, catalog_->GetVersion());
+    l.unlock();
+    if (cached_plan != nullptr) {
+      return ExecutePlan(*cached_plan, {}, txn, writer, std::move(check_options));
+    }
+  }
+
   bool is_successful = true;
 
   std::shared_lock<std::shared_mutex> l(catalog_lock_);
@@ -230,8 +256,6 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
   binder.ParseAndSave(sql);
   l.unlock();
 
-  bool is_delete = false;
-
   for (auto *stmt : binder.statement_nodes_) {
     auto statement = binder.BindStatement(stmt);
     switch (statement->type_) {
@@ -260,57 +284,141 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         HandleExplainStatement(txn, explain_stmt, writer);
         continue;
       }
-      case StatementType::DELETE_STATEMENT:
-        is_delete = true;
+      case StatementType::COPY_STATEMENT: {
+        const auto &copy_stmt = dynamic_cast<const CopyStatement &>(*statement);
+        HandleCopyStatement(txn, copy_stmt, writer);
+        continue;
+      }
+      case StatementType::VACUUM_STATEMENT: {
+        const auto &vacuum_stmt = dynamic_cast<const VacuumStatement &>(*statement);
+        HandleVacuumStatement(txn, vacuum_stmt, writer);
+        continue;
+      }
+      case StatementType::PREPARE_STATEMENT: {
+        const auto &prepare_stmt = dynamic_cast<const PrepareStatement &>(*statement);
+        HandlePrepareStatement(txn, prepare_stmt, writer);
+        continue;
+      }
+      case StatementType::EXECUTE_STATEMENT: {
+        const auto &execute_stmt = dynamic_cast<const ExecuteStatement &>(*statement);
+        is_successful &= HandleExecuteStatement(txn, execute_stmt, writer, check_options);
+        continue;
+      }
+      case StatementType::DEALLOCATE_STATEMENT: {
+        const auto &deallocate_stmt = dynamic_cast<const DeallocateStatement &>(*statement);
+        HandleDeallocateStatement(txn, deallocate_stmt, writer);
+        continue;
+      }
       default:
         break;
     }
 
     std::shared_lock<std::shared_mutex> l(catalog_lock_);
 
+    auto cached_plan = std::make_shared<CachedPlan>();
+    cached_plan->type_ = statement->type_;
+    cached_plan->catalog_version_ = catalog_->GetVersion();
+
     // Plan the query.
     bustub::Planner planner(*catalog_);
     planner.PlanQuery(*statement);
 
     // Optimize the query.
     bustub::Optimizer optimizer(*catalog_, IsForceStarterRule());
-    auto optimized_plan = optimizer.Optimize(planner.plan_);
+    cached_plan->plan_ = optimizer.Optimize(planner.plan_);
+    cached_plan->schema_ = planner.plan_->output_schema_;
 
     l.unlock();
 
-    // Execute the query.
-    auto exec_ctx = MakeExecutorContext(txn, is_delete);
-    if (check_options != nullptr) {
-      exec_ctx->InitCheckOptions(std::move(check_options));
+    if (cache_key.has_value() && binder.statement_nodes_.size() == 1) {
+      cached_plan->sql_ = *cache_key;
+      plan_cache_->Put(*cache_key, cached_plan);
     }
-    std::vector<Tuple> result_set{};
-    is_successful &= execution_engine_->Execute(optimized_plan, &result_set, txn, exec_ctx.get());
 
-    // Return the result set as a vector of string.
-    auto schema = planner.plan_->OutputSchema();
+    // Execute the query.
+    is_successful &= ExecutePlan(*cached_plan, {}, txn, writer, check_options);
+  }
+
+  return is_successful;
+}
+
+auto BustubInstance::ExecutePlan(const CachedPlan &cached_plan, const std::vector<Value> &parameters,
+                                 Transaction *txn, ResultWriter &writer, std::shared_ptr<CheckOptions> check_options)
+    -> bool {
+  // A prepared plan is shared by every EXECUTE, the values are bound into a copy of it.
+  auto plan = cached_plan.parameter_types_.empty() ? cached_plan.plan_ : BindParameters(cached_plan.plan_, parameters);
 
-    // Generate header for the result set.
-    writer.BeginTable(false);
-    writer.BeginHeader();
-    for (const auto &column : schema.GetColumns()) {
-      writer.WriteHeaderCell(column.GetName());
-    }
-    writer.EndHeader();
+  auto exec_ctx = MakeExecutorContext(txn, cached_plan.type_ == StatementType::DELETE_STATEMENT);
+  if (check_options != nullptr) {
+    exec_ctx->InitCheckOptions(std::move(check_options));
+  }
+  // The schema of the result rows.
+  const auto &schema = *cached_plan.schema_;
 
-    // Transforming result set into strings.
-    for (const auto &tuple : result_set) {
+  // Generate header for the result set.
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  for (const auto &column : schema.GetColumns()) {
+    writer.WriteHeaderCell(column.GetName());
+  }
+  writer.EndHeader();
+
+  // Stream the rows to the writer a batch at a time as the executors produce them, so the result is
+  // never materialized and the first rows show up before the query finishes. The price is that a query
+  // failing later, e.g. on a division by zero in a later row, leaves the rows already written with the
+  // client; buffering until no error can happen any more would mean buffering the whole result.
+  auto write_batch = [&writer, &schema](const TupleBatch &batch) {
+    for (auto row : batch.GetSelection()) {
       writer.BeginRow();
       for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
-        writer.WriteCell(tuple.GetValue(&schema, i).ToString());
+        writer.WriteCell(batch.GetValue(i, row).ToString());
       }
       writer.EndRow();
     }
+    return true;
+  };
+  bool is_successful;
+  try {
+    is_successful = execution_engine_->Execute(plan, write_batch, txn, exec_ctx.get());
+  } catch (...) {
     writer.EndTable();
+    throw;
   }
-
+  writer.EndTable();
   return is_successful;
 }
 
+auto BustubInstance::PlanPreparedStatement(std::shared_ptr<const BoundStatement> statement,
+                                           const std::vector<TypeId> &parameter_types)
+    -> std::shared_ptr<const CachedPlan> {
+  std::shared_lock<std::shared_mutex> l(catalog_lock_);
+
+  auto cached_plan = std::make_shared<CachedPlan>();
+  cached_plan->statement_ = std::move(statement);
+  cached_plan->type_ = cached_plan->statement_->type_;
+  cached_plan->catalog_version_ = catalog_->GetVersion();
+
+  bustub::Planner planner(*catalog_);
+  planner.PlanQuery(*cached_plan->statement_);
+  // The optimizer may drop expressions, the parameters are collected from the plan before it runs.
+  cached_plan->parameter_types_ = InferParameterTypes(planner.plan_, parameter_types);
+
+  bustub::Optimizer optimizer(*catalog_, IsForceStarterRule());
+  cached_plan->plan_ = optimizer.Optimize(planner.plan_);
+  cached_plan->schema_ = planner.plan_->output_schema_;
+
+  return cached_plan;
+}
+
+auto BustubInstance::PlanCacheKey(const std::string &sql) -> std::optional<std::string> {
+  auto key = PlanCache::Normalize(sql);
+  if (!key.has_value()) {
+    return std::nullopt;
+  }
+  // The session variable changes the optimizer rules, plans built with and without it are kept apart.
+  return IsForceStarterRule() ? fmt::format("starter:{}", *key) : *key;
+}
+
 /**
  * FOR TEST ONLY. Generate test tables in this BusTub instance.
  * It's used in the shell to predefine some tables, as we don't support
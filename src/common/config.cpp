@@ -20,4 +20,10 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+size_t hash_join_memory_budget = 64 << 20;
+
+size_t sort_memory_budget = 64 << 20;
+
+size_t aggregation_memory_budget = 64 << 20;
+
 }  // namespace bustub
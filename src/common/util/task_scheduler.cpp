@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler.cpp
+//
+// Identification: src/common/util/task_scheduler.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/task_scheduler.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+namespace {
+
+/** The scheduler the current thread is a worker of, and its worker id */
+thread_local const TaskScheduler *current_scheduler = nullptr;
+thread_local size_t current_worker_id = 0;
+
+}  // namespace
+
+auto TaskScheduler::Instance() -> TaskScheduler & {
+  static TaskScheduler scheduler(std::max<size_t>(1, std::thread::hardware_concurrency()));
+  return scheduler;
+}
+
+TaskScheduler::TaskScheduler(size_t num_workers) {
+  num_workers = std::max<size_t>(1, num_workers);
+  for (size_t i = 0; i < num_workers; i++) {
+    worker_queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  threads_.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; i++) {
+    threads_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void TaskScheduler::Submit(Task task) {
+  // 工作线程提交的任务放到自己的队列尾部，其他线程提交的任务按先来先服务放到共享队列
+  auto &queue = current_scheduler == this ? *worker_queues_[current_worker_id] : shared_queue_;
+  {
+    std::scoped_lock lock(queue.latch_);
+    queue.tasks_.push_back(std::move(task));
+  }
+  {
+    std::scoped_lock lock(latch_);
+    num_pending_++;
+  }
+  cv_.notify_one();
+}
+
+auto TaskScheduler::TakeTask(size_t worker_id, Task *task) -> bool {
+  {
+    auto &own = *worker_queues_[worker_id];
+    std::scoped_lock lock(own.latch_);
+    if (!own.tasks_.empty()) {
+      *task = std::move(own.tasks_.back());
+      own.tasks_.pop_back();
+      return true;
+    }
+  }
+  {
+    std::scoped_lock lock(shared_queue_.latch_);
+    if (!shared_queue_.tasks_.empty()) {
+      *task = std::move(shared_queue_.tasks_.front());
+      shared_queue_.tasks_.pop_front();
+      return true;
+    }
+  }
+  // 从其他工作线程队列的头部窃取，头部是最早提交的任务，和所有者从尾部取任务的冲突最少
+  for (size_t i = 1; i < worker_queues_.size(); i++) {
+    auto &victim = *worker_queues_[(worker_id + i) % worker_queues_.size()];
+    std::scoped_lock lock(victim.latch_);
+    if (!victim.tasks_.empty()) {
+      *task = std::move(victim.tasks_.front());
+      victim.tasks_.pop_front();
+      num_steals_++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::WorkerLoop(size_t worker_id) {
+  current_scheduler = this;
+  current_worker_id = worker_id;
+  Task task;
+  while (true) {
+    {
+      std::unique_lock lock(latch_);
+      cv_.wait(lock, [this] { return num_pending_ > 0 || stop_; });
+      if (num_pending_ == 0) {
+        return;
+      }
+      num_pending_--;
+    }
+    // 计数保证了至少有一个任务在某个队列中，但可能暂时被其他线程先拿走，直到拿到为止
+    while (!TakeTask(worker_id, &task)) {
+      std::this_thread::yield();
+    }
+    task();
+    task = nullptr;
+  }
+}
+
+}  // namespace bustub
@@ -39,6 +39,11 @@ auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level)
     txn->SetPrevLSN(lsn);
   }
 
+  {
+    std::scoped_lock running_lock(running_txns_latch_);
+    running_txns_.insert(txn->GetTransactionId());
+  }
+
   std::unique_lock<std::shared_mutex> l(txn_map_mutex);
   txn_map[txn->GetTransactionId()] = txn;
   return txn;
@@ -62,6 +67,7 @@ void TransactionManager::Commit(Transaction *txn) {
 
   // Release all the locks.
   ReleaseLocks(txn);
+  FinishRunning(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
@@ -112,10 +118,21 @@ void TransactionManager::Abort(Transaction *txn) {
 
   // Release all the locks.
   ReleaseLocks(txn);
+  FinishRunning(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+auto TransactionManager::GetOldestRunningTxnId() -> txn_id_t {
+  std::scoped_lock running_lock(running_txns_latch_);
+  return running_txns_.empty() ? next_txn_id_.load() : *running_txns_.begin();
+}
+
+void TransactionManager::FinishRunning(Transaction *txn) {
+  std::scoped_lock running_lock(running_txns_latch_);
+  running_txns_.erase(txn->GetTransactionId());
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
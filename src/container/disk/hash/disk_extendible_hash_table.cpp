@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,7 +27,15 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  BasicPageGuard dir_guard = buffer_pool_manager_->NewPageGuarded(&directory_page_id_);
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  BasicPageGuard bucket_guard = buffer_pool_manager_->NewPageGuarded(&bucket_page_id);
+
+  // 新页面由缓冲池清零，空桶不需要额外初始化；目录初始只有一个局部深度为0的桶
+  auto *dir_page = dir_guard.AsMut<HashTableDirectoryPage>();
+  dir_page->SetPageId(directory_page_id_);
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
 }
 
 /*****************************************************************************
@@ -45,23 +54,13 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
-}
-
-template <typename KeyType, typename ValueType, typename KeyComparator>
-inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
-}
-
-template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, const HashTableDirectoryPage *dir_page) -> uint32_t {
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, const HashTableDirectoryPage *dir_page) -> page_id_t {
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 /*****************************************************************************
@@ -69,7 +68,13 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  ReadPageGuard bucket_guard =
+      buffer_pool_manager_->FetchPageRead(KeyToPageId(key, dir_guard.As<HashTableDirectoryPage>()));
+  // 拿到桶的锁之后目录就可以释放了，分裂和合并都需要先拿到桶的写锁
+  dir_guard.Drop();
+
+  return bucket_guard.As<HASH_TABLE_BUCKET_TYPE>()->GetValue(key, comparator_, result);
 }
 
 /*****************************************************************************
@@ -77,12 +82,81 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  WritePageGuard bucket_guard =
+      buffer_pool_manager_->FetchPageWrite(KeyToPageId(key, dir_guard.As<HashTableDirectoryPage>()));
+  dir_guard.Drop();
+
+  auto *bucket = bucket_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+  if (!bucket->IsFull()) {
+    return bucket->Insert(key, value, comparator_);
+  }
+  bucket_guard.Drop();
+
+  return SplitInsert(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  WritePageGuard dir_guard = buffer_pool_manager_->FetchPageWrite(directory_page_id_);
+  auto *dir_page = dir_guard.AsMut<HashTableDirectoryPage>();
+
+  // 释放读锁到拿到写锁之间目录可能已经被其他线程修改，每一轮都重新定位目标桶
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    WritePageGuard bucket_guard = buffer_pool_manager_->FetchPageWrite(dir_page->GetBucketPageId(bucket_idx));
+    auto *bucket = bucket_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+    if (!bucket->IsFull()) {
+      return bucket->Insert(key, value, comparator_);
+    }
+
+    std::vector<ValueType> values;
+    bucket->GetValue(key, comparator_, &values);
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      return false;
+    }
+
+    if (!SplitBucket(dir_page, bucket_idx, bucket)) {
+      return false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, HASH_TABLE_BUCKET_TYPE *bucket)
+    -> bool {
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+  if (local_depth == dir_page->GetGlobalDepth()) {
+    if (dir_page->Size() * 2 > DIRECTORY_ARRAY_SIZE) {
+      return false;
+    }
+    dir_page->IncrGlobalDepth();
+  }
+
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+  page_id_t image_page_id = INVALID_PAGE_ID;
+  BasicPageGuard image_guard = buffer_pool_manager_->NewPageGuarded(&image_page_id);
+  auto *image = image_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+
+  // 新的最高位为1的目录项指向分裂出的桶，两个桶的局部深度都加一
+  uint32_t high_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < dir_page->Size(); i++) {
+    if (dir_page->GetBucketPageId(i) != bucket_page_id) {
+      continue;
+    }
+    dir_page->IncrLocalDepth(i);
+    if ((i & high_bit) != 0) {
+      dir_page->SetBucketPageId(i, image_page_id);
+    }
+  }
+
+  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && bucket->IsOccupied(i); i++) {
+    if (bucket->IsReadable(i) && (Hash(bucket->KeyAt(i)) & high_bit) != 0) {
+      image->Insert(bucket->KeyAt(i), bucket->ValueAt(i), comparator_);
+      bucket->RemoveAt(i);
+    }
+  }
+  return true;
 }
 
 /*****************************************************************************
@@ -90,26 +164,75 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  WritePageGuard bucket_guard =
+      buffer_pool_manager_->FetchPageWrite(KeyToPageId(key, dir_guard.As<HashTableDirectoryPage>()));
+  dir_guard.Drop();
+
+  auto *bucket = bucket_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+  bool removed = bucket->Remove(key, value, comparator_);
+  bool empty = bucket->IsEmpty();
+  bucket_guard.Drop();
+
+  if (removed && empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  WritePageGuard dir_guard = buffer_pool_manager_->FetchPageWrite(directory_page_id_);
+  auto *dir_page = dir_guard.AsMut<HashTableDirectoryPage>();
+
+  // 合并后的桶如果仍然是空的，继续和它的分裂镜像合并
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      return;
+    }
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      return;
+    }
+
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    {
+      // 释放桶锁之后可能有其他线程又插入了数据
+      ReadPageGuard bucket_guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+      if (!bucket_guard.As<HASH_TABLE_BUCKET_TYPE>()->IsEmpty()) {
+        return;
+      }
+    }
+
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      page_id_t page_id = dir_page->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        dir_page->SetBucketPageId(i, image_page_id);
+        dir_page->DecrLocalDepth(i);
+      }
+    }
+    // 持有目录写锁时没有其他线程能再访问到这个桶
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+
+    while (dir_page->CanShrink()) {
+      dir_page->DecrGlobalDepth();
+    }
+  }
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetGlobalDepth() -> uint32_t {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false));
-  table_latch_.RUnlock();
-  return global_depth;
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  return dir_guard.As<HashTableDirectoryPage>()->GetGlobalDepth();
 }
 
 /*****************************************************************************
@@ -117,11 +240,8 @@ auto HASH_TABLE_TYPE::GetGlobalDepth() -> uint32_t {
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false));
-  table_latch_.RUnlock();
+  ReadPageGuard dir_guard = buffer_pool_manager_->FetchPageRead(directory_page_id_);
+  dir_guard.As<HashTableDirectoryPage>()->VerifyIntegrity();
 }
 
 /*****************************************************************************
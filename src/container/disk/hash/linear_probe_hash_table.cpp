@@ -10,8 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -23,46 +25,311 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                      const KeyComparator &comparator, size_t num_buckets,
-                                      HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+LINEAR_PROBE_HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                   const KeyComparator &comparator, size_t num_buckets,
+                                                   HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  // 槽位数向上取整到块大小的整数倍，至少一个块
+  size_t num_blocks = std::clamp<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1,
+                                         HashTableHeaderPage::MaxNumBlocks());
+  BasicPageGuard header_guard = buffer_pool_manager_->NewPageGuarded(&header_page_id_);
+  auto *header_page = header_guard.AsMut<HashTableHeaderPage>();
+  header_page->SetPageId(header_page_id_);
+  header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  CreateNewBlockPages(header_page, num_blocks);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+LINEAR_PROBE_HASH_TABLE_TYPE::~LinearProbeHashTable() {
+  std::scoped_lock lock(rebuild_thread_mutex_);
+  if (rebuild_thread_.joinable()) {
+    rebuild_thread_.join();
+  }
+}
 
 /*****************************************************************************
- * SEARCH
+ * HELPERS
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
+template <typename BlockPage, typename Visitor>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Probe(const HashTableHeaderPage *header_page, const KeyType &key, Visitor &&visit)
+    -> bool {
+  size_t size = header_page->GetSize();
+  size_t start = hash_fn_.GetHash(key) % size;
+  size_t current_block = header_page->NumBlocks();
+  BasicPageGuard block_guard;
+  BlockPage *block = nullptr;
+
+  for (size_t i = 0; i < size; i++) {
+    size_t slot = (start + i) % size;
+    size_t block_index = slot / BLOCK_ARRAY_SIZE;
+    if (block_index != current_block) {
+      // 块页只需要pin住，槽位上的并发由occupied/readable两个原子位图协调
+      block_guard = buffer_pool_manager_->FetchPageBasic(header_page->GetBlockPageId(block_index));
+      // 只读的查找用 As，不会把途经的块页标记为脏页
+      if constexpr (std::is_const_v<BlockPage>) {
+        block = block_guard.As<HASH_TABLE_BLOCK_TYPE>();
+      } else {
+        block = block_guard.AsMut<HASH_TABLE_BLOCK_TYPE>();
+      }
+      current_block = block_index;
+    }
+    if (visit(block, static_cast<slot_offset_t>(slot % BLOCK_ARRAY_SIZE))) {
+      return true;
+    }
+  }
   return false;
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::RebuildTarget(size_t size) const -> size_t {
+  size_t readable = num_readable_.load();
+  size_t tombstones = num_tombstones_.load();
+  if ((readable + tombstones) * 4 < size * 3 && tombstones * 4 < size) {
+    return 0;
+  }
+  // 存活的元素超过一半时扩容一倍，否则原样重建，只是清理墓碑
+  size_t max_size = HashTableHeaderPage::MaxNumBlocks() * BLOCK_ARRAY_SIZE;
+  size_t target = std::min(readable * 2 >= size ? size * 2 : size, max_size);
+  if (target == size && tombstones == 0) {
+    return 0;
+  }
+  return target;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::ScheduleRebuild() {
+  if (rebuild_scheduled_.exchange(true)) {
+    return;
+  }
+  std::scoped_lock lock(rebuild_thread_mutex_);
+  if (rebuild_thread_.joinable()) {
+    rebuild_thread_.join();
+  }
+  rebuild_thread_ = std::thread([this] {
+    table_latch_.WLock();
+    // 排队期间表可能已经被同步重建过，需要重新判断
+    ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+    size_t target = RebuildTarget(header_guard.As<HashTableHeaderPage>()->GetSize());
+    header_guard.Drop();
+    if (target != 0) {
+      Rebuild(target);
+    }
+    table_latch_.WUnlock();
+    rebuild_scheduled_ = false;
+  });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks) {
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id = INVALID_PAGE_ID;
+    // 新页面由缓冲池清零，所有槽位都是空的
+    BasicPageGuard block_guard = buffer_pool_manager_->NewPageGuarded(&block_page_id);
+    header_page->AddBlockPageId(block_page_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::DeleteBlockPages(const HashTableHeaderPage *old_header_page) {
+  for (size_t i = 0; i < old_header_page->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(old_header_page->GetBlockPageId(i));
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key,
+                                                const ValueType &value) {
+  // 重建时持有表的写锁，新表中没有墓碑和重复元素，直接放进第一个空槽
+  auto insert_into_empty = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    return !block->IsOccupied(offset) && block->Insert(offset, key, value);
+  };
+  bool inserted = Probe<HASH_TABLE_BLOCK_TYPE>(header_page, key, insert_into_empty);
+  BUSTUB_ASSERT(inserted, "rebuilt table must have room for every live pair");
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void LINEAR_PROBE_HASH_TABLE_TYPE::Rebuild(size_t num_slots) {
+  size_t num_blocks = std::clamp<size_t>((num_slots + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1,
+                                         HashTableHeaderPage::MaxNumBlocks());
+  page_id_t new_header_page_id = INVALID_PAGE_ID;
+  BasicPageGuard new_header_guard = buffer_pool_manager_->NewPageGuarded(&new_header_page_id);
+  auto *new_header_page = new_header_guard.AsMut<HashTableHeaderPage>();
+  new_header_page->SetPageId(new_header_page_id);
+  new_header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  CreateNewBlockPages(new_header_page, num_blocks);
+
+  BasicPageGuard old_header_guard = buffer_pool_manager_->FetchPageBasic(header_page_id_);
+  const auto *old_header_page = old_header_guard.As<HashTableHeaderPage>();
+  for (size_t i = 0; i < old_header_page->NumBlocks(); i++) {
+    BasicPageGuard block_guard = buffer_pool_manager_->FetchPageBasic(old_header_page->GetBlockPageId(i));
+    const auto *block = block_guard.As<HASH_TABLE_BLOCK_TYPE>();
+    for (size_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+      // 只搬运存活的元素，墓碑在这里被丢弃
+      if (block->IsReadable(offset)) {
+        ResizeInsert(new_header_page, block->KeyAt(offset), block->ValueAt(offset));
+      }
+    }
+  }
+
+  DeleteBlockPages(old_header_page);
+  page_id_t old_header_page_id = header_page_id_;
+  old_header_guard.Drop();
+  buffer_pool_manager_->DeletePage(old_header_page_id);
+
+  header_page_id_ = new_header_page_id;
+  num_tombstones_ = 0;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                            std::vector<ValueType> *result) -> bool {
+  table_latch_.RLock();
+  BasicPageGuard header_guard = buffer_pool_manager_->FetchPageBasic(header_page_id_);
+  bool found = false;
+  // 碰到从未被占用过的槽位说明探测序列结束，墓碑不会结束探测
+  auto collect = [&](const HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (!block->IsOccupied(offset)) {
+      return true;
+    }
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0) {
+      result->push_back(block->ValueAt(offset));
+      found = true;
+    }
+    return false;
+  };
+  Probe<const HASH_TABLE_BLOCK_TYPE>(header_guard.As<HashTableHeaderPage>(), key, collect);
+  header_guard.Drop();
+  table_latch_.RUnlock();
+  return found;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value)
+    -> bool {
+  std::scoped_lock stripe_lock(insert_stripes_[hash_fn_.GetHash(key) % NUM_INSERT_STRIPES]);
+  while (true) {
+    table_latch_.RLock();
+    page_id_t probed_header_page_id = header_page_id_;
+    BasicPageGuard header_guard = buffer_pool_manager_->FetchPageBasic(probed_header_page_id);
+    size_t size = header_guard.As<HashTableHeaderPage>()->GetSize();
+    bool inserted = false;
+    bool duplicate = false;
+    auto try_insert = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+      if (!block->IsOccupied(offset)) {
+        if (block->Insert(offset, key, value)) {
+          inserted = true;
+          return true;
+        }
+        // 槽位被其他键的插入抢先占用，继续向后探测
+      }
+      if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 &&
+          block->ValueAt(offset) == value) {
+        duplicate = true;
+        return true;
+      }
+      return false;
+    };
+    bool stopped = Probe<HASH_TABLE_BLOCK_TYPE>(header_guard.As<HashTableHeaderPage>(), key, try_insert);
+    header_guard.Drop();
+    // 计数在持有表锁时更新，重建清零墓碑计数时不会漏掉或多算
+    if (inserted) {
+      num_readable_++;
+    }
+    table_latch_.RUnlock();
+
+    if (inserted) {
+      if (RebuildTarget(size) != 0) {
+        ScheduleRebuild();
+      }
+      return true;
+    }
+    if (duplicate) {
+      return false;
+    }
+
+    // 探测了一整圈都没有空槽，同步重建之后再插入
+    BUSTUB_ENSURE(!stopped, "probe stopped without inserting");
+    table_latch_.WLock();
+    // 放开读锁的间隙里表可能已经被后台线程重建过(原样重建时大小不变，只能比较头页面)
+    if (header_page_id_ == probed_header_page_id) {
+      size_t target = RebuildTarget(size);
+      if (target == 0) {
+        // 表已经达到头页面能容纳的上限
+        table_latch_.WUnlock();
+        return false;
+      }
+      Rebuild(target);
+    }
+    table_latch_.WUnlock();
+  }
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value)
+    -> bool {
+  table_latch_.RLock();
+  BasicPageGuard header_guard = buffer_pool_manager_->FetchPageBasic(header_page_id_);
+  size_t size = header_guard.As<HashTableHeaderPage>()->GetSize();
+  bool removed = false;
+  auto try_remove = [&](HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (!block->IsOccupied(offset)) {
+      return true;
+    }
+    // 只清除readable位，occupied位保留下来作为墓碑，保证后面的探测序列不会断开
+    if (block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 &&
+        block->ValueAt(offset) == value && block->Remove(offset)) {
+      removed = true;
+      return true;
+    }
+    return false;
+  };
+  Probe<HASH_TABLE_BLOCK_TYPE>(header_guard.As<HashTableHeaderPage>(), key, try_remove);
+  header_guard.Drop();
+  if (removed) {
+    num_readable_--;
+    num_tombstones_++;
+  }
+  table_latch_.RUnlock();
+
+  if (removed) {
+    if (RebuildTarget(size) != 0) {
+      ScheduleRebuild();
+    }
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void LINEAR_PROBE_HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  Rebuild(2 * initial_size);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+auto LINEAR_PROBE_HASH_TABLE_TYPE::GetSize() -> size_t {
+  table_latch_.RLock();
+  ReadPageGuard header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  size_t size = header_guard.As<HashTableHeaderPage>()->GetSize();
+  header_guard.Drop();
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -1,29 +1,306 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// aggregation_executor.cpp
-//
-// Identification: src/execution/aggregation_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-#include <vector>
-
-#include "execution/executors/aggregation_executor.h"
-
-namespace bustub {
-
-AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
-                                         std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
-
-void AggregationExecutor::Init() {}
-
-auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
-
-auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_executor.cpp
+//
+// Identification: src/execution/aggregation_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/parallel_util.h"
+#include "execution/executors/aggregation_executor.h"
+
+namespace bustub {
+
+AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                         std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {
+  // 溢出的部分聚合结果按分组键和各个聚合状态的类型序列化
+  std::vector<Column> columns;
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  const auto &agg_types = plan_->GetAggregateTypes();
+  for (size_t i = 0; i < group_bys.size(); i++) {
+    auto type = group_bys[i]->GetReturnType();
+    auto name = "key" + std::to_string(i);
+    columns.push_back(type == TypeId::VARCHAR ? Column{name, type, VARCHAR_DEFAULT_LENGTH} : Column{name, type});
+  }
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    bool is_count =
+        agg_types[i] == AggregationType::CountStarAggregate || agg_types[i] == AggregationType::CountAggregate;
+    auto type = is_count ? TypeId::INTEGER : aggregates[i]->GetReturnType();
+    auto name = "agg" + std::to_string(i);
+    columns.push_back(type == TypeId::VARCHAR ? Column{name, type, VARCHAR_DEFAULT_LENGTH} : Column{name, type});
+  }
+  spill_schema_ = std::make_unique<Schema>(columns);
+}
+
+void AggregationExecutor::Init() {
+  child_->Init();
+  const size_t num_workers = ParallelUtil::WorkerCount();
+  const size_t num_keys = plan_->GetGroupBys().size();
+  const auto &agg_types = plan_->GetAggregateTypes();
+  memory_budget_ = aggregation_memory_budget;
+  local_tables_.assign(num_workers,
+                       std::vector<AggregationHashTable>(NUM_PARTITIONS, AggregationHashTable(agg_types, num_keys)));
+  results_.assign(NUM_PARTITIONS, AggregationHashTable(agg_types, num_keys));
+  spill_files_.clear();
+  spill_files_.resize(NUM_PARTITIONS);
+  pending_.clear();
+  batches_.resize(num_workers);
+
+  // 每一轮从子节点取出最多num_workers个批次，每个线程把一个批次预聚合到自己的哈希表中。
+  // 子节点不是线程安全的，所以取批次仍然是串行的
+  bool exhausted = false;
+  while (!exhausted) {
+    size_t num_batches = 0;
+    while (num_batches < num_workers && child_->NextBatch(&batches_[num_batches])) {
+      num_batches++;
+    }
+    exhausted = num_batches < num_workers;
+    ParallelUtil::For(num_workers, num_batches, [&](size_t i) { ConsumeBatch(batches_[i], &local_tables_[i]); });
+
+    // 超出内存预算时把所有线程中最大的分区写到临时页面，直到回到预算以内
+    while (MemoryUsage() > memory_budget_) {
+      size_t largest = 0;
+      size_t largest_bytes = 0;
+      for (size_t p = 0; p < NUM_PARTITIONS; p++) {
+        size_t bytes = 0;
+        for (const auto &tables : local_tables_) {
+          bytes += tables[p].MemoryUsage();
+        }
+        if (bytes > largest_bytes) {
+          largest = p;
+          largest_bytes = bytes;
+        }
+      }
+      if (largest_bytes == 0) {
+        break;
+      }
+      SpillPartition(largest);
+    }
+  }
+  batches_.clear();
+
+  // 没有溢出的分区现在就并行合并。溢出的分区等输出到它的时候再合并，这样同一时刻只有一个溢出分区在内存中
+  ParallelUtil::For(num_workers, NUM_PARTITIONS, [&](size_t p) {
+    if (spill_files_[p] == nullptr) {
+      MergePartition(p);
+    }
+  });
+
+  // 没有group by时，即使输入为空也要输出一行初始值(例如count(*)为0)
+  emit_initial_ = num_keys == 0;
+  for (size_t p = 0; p < NUM_PARTITIONS && emit_initial_; p++) {
+    emit_initial_ = results_[p].Size() == 0 && spill_files_[p] == nullptr;
+  }
+  out_partition_ = 0;
+  out_group_ = 0;
+}
+
+void AggregationExecutor::ConsumeBatch(const TupleBatch &batch, std::vector<AggregationHashTable> *tables) {
+  // 先按列计算出整个批次的分组键和聚合参数，再逐行合并到分组所在分区的哈希表中
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  std::vector<std::vector<Value>> key_columns(group_bys.size());
+  std::vector<std::vector<Value>> val_columns(aggregates.size());
+  for (size_t i = 0; i < group_bys.size(); i++) {
+    group_bys[i]->EvaluateBatch(batch, &key_columns[i]);
+  }
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    aggregates[i]->EvaluateBatch(batch, &val_columns[i]);
+  }
+
+  std::vector<Value> keys(group_bys.size());
+  std::vector<Value> inputs(aggregates.size());
+  for (uint32_t row = 0; row < batch.Size(); row++) {
+    for (size_t i = 0; i < key_columns.size(); i++) {
+      keys[i] = std::move(key_columns[i][row]);
+    }
+    for (size_t i = 0; i < val_columns.size(); i++) {
+      inputs[i] = std::move(val_columns[i][row]);
+    }
+    auto hash = AggregationHashTable::HashKeys(keys.data(), keys.size());
+    (*tables)[hash >> PARTITION_SHIFT].Combine(hash, keys.data(), inputs.data());
+  }
+}
+
+auto AggregationExecutor::MemoryUsage() const -> size_t {
+  size_t bytes = 0;
+  for (const auto &tables : local_tables_) {
+    for (const auto &table : tables) {
+      bytes += table.MemoryUsage();
+    }
+  }
+  return bytes;
+}
+
+void AggregationExecutor::SpillPartition(size_t partition) {
+  auto &file = spill_files_[partition];
+  if (file == nullptr) {
+    file = std::make_unique<SpillFile>(exec_ctx_->GetBufferPoolManager());
+  }
+  for (auto &tables : local_tables_) {
+    auto &table = tables[partition];
+    for (size_t group = 0; group < table.Size(); group++) {
+      AppendGroup(table.GetRow(group), file.get());
+    }
+    table.Clear();
+  }
+  file->Finish();
+}
+
+auto AggregationExecutor::RepartitionOf(uint64_t hash, size_t level) -> size_t {
+  // 每一层用不同的种子重新打散哈希值，这样在上一层落在同一分区的分组这一层会分开
+  hash ^= level * 0x9e3779b97f4a7c15ULL;
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash >> PARTITION_SHIFT;
+}
+
+void AggregationExecutor::AppendGroup(const Value *row, SpillFile *file) {
+  // 聚合状态的类型可能和列类型不同(例如初始的NULL是INTEGER)，写入前统一转换成列类型
+  const auto &columns = spill_schema_->GetColumns();
+  std::vector<Value> values(columns.size());
+  for (size_t i = 0; i < columns.size(); i++) {
+    auto type = columns[i].GetType();
+    if (row[i].IsNull()) {
+      values[i] = ValueFactory::GetNullValueByType(type);
+    } else {
+      values[i] = row[i].GetTypeId() == type ? row[i] : row[i].CastAs(type);
+    }
+  }
+  file->Append(Tuple{values, spill_schema_.get()});
+}
+
+void AggregationExecutor::MergePartition(size_t partition) {
+  auto &result = results_[partition];
+  for (auto &tables : local_tables_) {
+    auto &table = tables[partition];
+    for (size_t group = 0; group < table.Size(); group++) {
+      const Value *row = table.GetRow(group);
+      result.Merge(table.GetHash(group), row, row + plan_->GetGroupBys().size());
+    }
+    table.Clear();
+  }
+
+  if (spill_files_[partition] != nullptr) {
+    LoadSpillFile(std::move(spill_files_[partition]), 0, &result);
+  }
+}
+
+void AggregationExecutor::LoadSpillFile(std::unique_ptr<SpillFile> file, size_t level, AggregationHashTable *result) {
+  const size_t num_keys = plan_->GetGroupBys().size();
+  const size_t num_columns = spill_schema_->GetColumnCount();
+  std::vector<Tuple> tuples;
+  std::vector<Value> values(num_columns);
+  size_t page = 0;
+  while (page < file->NumPages()) {
+    file->ReadPage(page++, &tuples);
+    for (const auto &tuple : tuples) {
+      for (uint32_t i = 0; i < num_columns; i++) {
+        values[i] = tuple.GetValue(spill_schema_.get(), i);
+      }
+      auto hash = AggregationHashTable::HashKeys(values.data(), num_keys);
+      result->Merge(hash, values.data(), values.data() + num_keys);
+    }
+    // 读完最后一页时分组已经都在内存里了，直接输出
+    if (result->MemoryUsage() > memory_budget_ && page < file->NumPages() && level < MAX_SPILL_LEVEL) {
+      break;
+    }
+  }
+  if (page == file->NumPages()) {
+    return;
+  }
+
+  // 分区倾斜或者仍然太大：把已经合并的分组和文件剩下的部分按新的种子再分成NUM_PARTITIONS份，
+  // 之后逐份装载，每一份都可能再被切分
+  std::vector<std::unique_ptr<SpillFile>> parts(NUM_PARTITIONS);
+  auto part_of = [&](uint64_t hash) -> SpillFile * {
+    auto &part = parts[RepartitionOf(hash, level + 1)];
+    if (part == nullptr) {
+      part = std::make_unique<SpillFile>(exec_ctx_->GetBufferPoolManager());
+    }
+    return part.get();
+  };
+  for (size_t group = 0; group < result->Size(); group++) {
+    AppendGroup(result->GetRow(group), part_of(result->GetHash(group)));
+  }
+  result->Clear();
+  while (page < file->NumPages()) {
+    file->ReadPage(page++, &tuples);
+    for (const auto &tuple : tuples) {
+      for (uint32_t i = 0; i < num_keys; i++) {
+        values[i] = tuple.GetValue(spill_schema_.get(), i);
+      }
+      part_of(AggregationHashTable::HashKeys(values.data(), num_keys))->Append(tuple);
+    }
+  }
+  file.reset();
+  for (auto &part : parts) {
+    if (part != nullptr) {
+      part->Finish();
+      pending_.emplace_back(std::move(part), level + 1);
+    }
+  }
+}
+
+auto AggregationExecutor::AdvanceToGroup() -> bool {
+  while (out_partition_ < NUM_PARTITIONS) {
+    if (spill_files_[out_partition_] != nullptr) {
+      MergePartition(out_partition_);
+    }
+    if (out_group_ < results_[out_partition_].Size()) {
+      return true;
+    }
+    // 输出完的分区立即释放内存，再装载这个分区被重新切分出来的下一份
+    results_[out_partition_].Clear();
+    out_group_ = 0;
+    if (!pending_.empty()) {
+      auto [file, level] = std::move(pending_.back());
+      pending_.pop_back();
+      LoadSpillFile(std::move(file), level, &results_[out_partition_]);
+      continue;
+    }
+    out_partition_++;
+  }
+  return false;
+}
+
+auto AggregationExecutor::MakeOutputValues() -> std::vector<Value> {
+  if (emit_initial_) {
+    emit_initial_ = false;
+    return AggregationHashTable::InitialStates(plan_->GetAggregateTypes());
+  }
+  const auto &table = results_[out_partition_];
+  const Value *row = table.GetRow(out_group_++);
+  return {row, row + table.RowWidth()};
+}
+
+auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (!emit_initial_ && !AdvanceToGroup()) {
+    return false;
+  }
+  *tuple = Tuple{MakeOutputValues(), &GetOutputSchema()};
+  return true;
+}
+
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull() && (emit_initial_ || AdvanceToGroup())) {
+    batch->Append(MakeOutputValues());
+  }
+  return !batch->IsEmpty();
+}
+
+auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
+
+}  // namespace bustub
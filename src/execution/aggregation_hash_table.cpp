@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_hash_table.cpp
+//
+// Identification: src/execution/aggregation_hash_table.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/aggregation_hash_table.h"
+
+#include <algorithm>
+
+#include "common/util/hash_util.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return `true` if two group-by values belong to the same group, NULLs are equal to each other */
+auto SameGroupValue(const Value &a, const Value &b) -> bool {
+  if (a.IsNull() || b.IsNull()) {
+    return a.IsNull() && b.IsNull();
+  }
+  return a.CompareEquals(b) == CmpBool::CmpTrue;
+}
+
+auto VarBytes(const Value &val) -> size_t {
+  return val.GetTypeId() == TypeId::VARCHAR && !val.IsNull() ? val.GetLength() : 0;
+}
+
+}  // namespace
+
+auto AggregationHashTable::HashKeys(const Value *keys, size_t num_keys) -> uint64_t {
+  uint64_t hash = 0;
+  for (size_t i = 0; i < num_keys; i++) {
+    hash = HashUtil::CombineHashes(hash, keys[i].IsNull() ? 0 : HashUtil::HashValue(&keys[i]));
+  }
+  // 打散之后高位用来分区，低位用来在表内寻址
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+auto AggregationHashTable::InitialStates(const std::vector<AggregationType> &agg_types) -> std::vector<Value> {
+  std::vector<Value> values;
+  for (const auto &agg_type : agg_types) {
+    switch (agg_type) {
+      case AggregationType::CountStarAggregate:
+        // Count start starts at zero.
+        values.emplace_back(ValueFactory::GetIntegerValue(0));
+        break;
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+      case AggregationType::MinAggregate:
+      case AggregationType::MaxAggregate:
+        // Others starts at null.
+        values.emplace_back(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+        break;
+    }
+  }
+  return values;
+}
+
+auto AggregationHashTable::FindOrInsert(uint64_t hash, const Value *keys) -> Value * {
+  if ((hashes_.size() + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+  const size_t mask = slots_.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    auto group = slots_[i];
+    if (group == EMPTY_SLOT) {
+      slots_[i] = static_cast<uint32_t>(hashes_.size());
+      break;
+    }
+    if (hashes_[group] != hash) {
+      continue;
+    }
+    Value *row = &rows_[group * width_];
+    bool same = true;
+    for (size_t k = 0; k < num_keys_ && same; k++) {
+      same = SameGroupValue(row[k], keys[k]);
+    }
+    if (same) {
+      return row + num_keys_;
+    }
+  }
+
+  // 新的分组追加到行数组末尾，先写分组键再写各个聚合的初始状态
+  hashes_.push_back(hash);
+  for (size_t k = 0; k < num_keys_; k++) {
+    rows_.push_back(keys[k]);
+    var_bytes_ += VarBytes(keys[k]);
+  }
+  for (auto &state : InitialStates(agg_types_)) {
+    rows_.push_back(std::move(state));
+  }
+  return &rows_[rows_.size() - agg_types_.size()];
+}
+
+void AggregationHashTable::Grow() {
+  size_t capacity = std::max<size_t>(16, slots_.size() * 2);
+  slots_.assign(capacity, EMPTY_SLOT);
+  const size_t mask = capacity - 1;
+  for (size_t group = 0; group < hashes_.size(); group++) {
+    size_t i = hashes_[group] & mask;
+    while (slots_[i] != EMPTY_SLOT) {
+      i = (i + 1) & mask;
+    }
+    slots_[i] = static_cast<uint32_t>(group);
+  }
+}
+
+void AggregationHashTable::Combine(uint64_t hash, const Value *keys, const Value *inputs) {
+  Value *states = FindOrInsert(hash, keys);
+  for (size_t i = 0; i < agg_types_.size(); i++) {
+    auto &agg = states[i];
+    const auto &val = inputs[i];
+    switch (agg_types_[i]) {
+      case AggregationType::CountStarAggregate:
+        agg = agg.Add(ValueFactory::GetIntegerValue(1));
+        break;
+      case AggregationType::CountAggregate:
+        if (!val.IsNull()) {
+          agg = agg.IsNull() ? ValueFactory::GetIntegerValue(1) : agg.Add(ValueFactory::GetIntegerValue(1));
+        }
+        break;
+      case AggregationType::SumAggregate:
+        if (!val.IsNull()) {
+          agg = agg.IsNull() ? val : agg.Add(val);
+        }
+        break;
+      case AggregationType::MinAggregate:
+        if (!val.IsNull() && (agg.IsNull() || val.CompareLessThan(agg) == CmpBool::CmpTrue)) {
+          var_bytes_ += VarBytes(val);
+          agg = val;
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (!val.IsNull() && (agg.IsNull() || val.CompareGreaterThan(agg) == CmpBool::CmpTrue)) {
+          var_bytes_ += VarBytes(val);
+          agg = val;
+        }
+        break;
+    }
+  }
+}
+
+void AggregationHashTable::Merge(uint64_t hash, const Value *keys, const Value *states) {
+  Value *merged = FindOrInsert(hash, keys);
+  for (size_t i = 0; i < agg_types_.size(); i++) {
+    auto &agg = merged[i];
+    const auto &partial = states[i];
+    if (partial.IsNull()) {
+      continue;
+    }
+    // 计数和求和的部分结果相加，最小值和最大值的部分结果再取一次最小或最大
+    switch (agg_types_[i]) {
+      case AggregationType::CountStarAggregate:
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+        agg = agg.IsNull() ? partial : agg.Add(partial);
+        break;
+      case AggregationType::MinAggregate:
+        if (agg.IsNull() || partial.CompareLessThan(agg) == CmpBool::CmpTrue) {
+          var_bytes_ += VarBytes(partial);
+          agg = partial;
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (agg.IsNull() || partial.CompareGreaterThan(agg) == CmpBool::CmpTrue) {
+          var_bytes_ += VarBytes(partial);
+          agg = partial;
+        }
+        break;
+    }
+  }
+}
+
+auto AggregationHashTable::MemoryUsage() const -> size_t {
+  return rows_.capacity() * sizeof(Value) + hashes_.capacity() * sizeof(uint64_t) +
+         slots_.capacity() * sizeof(uint32_t) + var_bytes_;
+}
+
+void AggregationHashTable::Clear() {
+  // 赋值空的vector而不是clear()，这样容量也一起释放
+  rows_ = std::vector<Value>();
+  hashes_ = std::vector<uint64_t>();
+  slots_ = std::vector<uint32_t>();
+  var_bytes_ = 0;
+}
+
+}  // namespace bustub
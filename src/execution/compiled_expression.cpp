@@ -0,0 +1,349 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.cpp
+//
+// Identification: src/execution/compiled_expression.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/expressions/compiled_expression.h"
+
+#include <array>
+#include <cstring>
+
+#include "common/macros.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto IsIntegral(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+auto IsSupported(TypeId type) -> bool { return type == TypeId::BOOLEAN || IsIntegral(type); }
+
+template <class T>
+void ReadRaw(const char *storage, T null_value, int64_t *val, bool *is_null) {
+  T raw;
+  memcpy(&raw, storage, sizeof(T));
+  *val = raw;
+  *is_null = raw == null_value;
+}
+
+/** 直接从元组的字节中读出定长列，NULL用各类型的哨兵值表示 */
+void ReadStorage(TypeId type, const char *storage, int64_t *val, bool *is_null) {
+  switch (type) {
+    case TypeId::BOOLEAN:
+      ReadRaw<int8_t>(storage, BUSTUB_BOOLEAN_NULL, val, is_null);
+      break;
+    case TypeId::TINYINT:
+      ReadRaw<int8_t>(storage, BUSTUB_INT8_NULL, val, is_null);
+      break;
+    case TypeId::SMALLINT:
+      ReadRaw<int16_t>(storage, BUSTUB_INT16_NULL, val, is_null);
+      break;
+    case TypeId::INTEGER:
+      ReadRaw<int32_t>(storage, BUSTUB_INT32_NULL, val, is_null);
+      break;
+    case TypeId::BIGINT:
+      ReadRaw<int64_t>(storage, BUSTUB_INT64_NULL, val, is_null);
+      break;
+    default:
+      UNREACHABLE("type is not supported by compiled expressions");
+  }
+}
+
+void ReadValue(TypeId type, const Value &value, int64_t *val, bool *is_null) {
+  *is_null = value.IsNull();
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      *val = value.GetAs<int8_t>();
+      break;
+    case TypeId::SMALLINT:
+      *val = value.GetAs<int16_t>();
+      break;
+    case TypeId::INTEGER:
+      *val = value.GetAs<int32_t>();
+      break;
+    case TypeId::BIGINT:
+      *val = value.GetAs<int64_t>();
+      break;
+    default:
+      UNREACHABLE("type is not supported by compiled expressions");
+  }
+}
+
+}  // namespace
+
+auto CompiledExpression::Compile(const AbstractExpression &expr, const Schema &schema)
+    -> std::unique_ptr<CompiledExpression> {
+  std::unique_ptr<CompiledExpression> compiled(new CompiledExpression());
+  if (!compiled->Emit(expr, schema, 0)) {
+    return nullptr;
+  }
+  return compiled;
+}
+
+/*
+ * 后序遍历表达式树生成指令，寄存器按照求值栈的深度分配：
+ * 结果写入dst，左右子表达式分别使用dst和dst+1
+ */
+auto CompiledExpression::Emit(const AbstractExpression &expr, const Schema &schema, uint32_t dst) -> bool {
+  if (dst >= MAX_REGISTERS) {
+    return false;
+  }
+  Instruction ins{};
+  ins.dst_ = static_cast<uint8_t>(dst);
+
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(&expr); column_expr != nullptr) {
+    // 程序只读一个元组，引用连接另一侧的列说明调用方传错了表达式
+    BUSTUB_ASSERT(column_expr->GetTupleIdx() == 0, "compiled expressions read columns of a single tuple");
+    if (column_expr->GetColIdx() >= schema.GetColumnCount()) {
+      return false;
+    }
+    const auto &column = schema.GetColumn(column_expr->GetColIdx());
+    if (!IsSupported(column.GetType())) {
+      return false;
+    }
+    ins.op_ = OpCode::LoadColumn;
+    ins.type_ = column.GetType();
+    ins.col_idx_ = column_expr->GetColIdx();
+    ins.offset_ = column.GetOffset();
+    program_.push_back(ins);
+    ret_type_ = column.GetType();
+    return true;
+  }
+
+  if (const auto *const_expr = dynamic_cast<const ConstantValueExpression *>(&expr); const_expr != nullptr) {
+    const auto &val = const_expr->val_;
+    if (!IsSupported(val.GetTypeId())) {
+      return false;
+    }
+    ins.op_ = OpCode::LoadConstant;
+    ReadValue(val.GetTypeId(), val, &ins.imm_, &ins.imm_null_);
+    program_.push_back(ins);
+    ret_type_ = val.GetTypeId();
+    return true;
+  }
+
+  if (expr.GetChildren().size() != 2) {
+    return false;
+  }
+  if (!Emit(*expr.GetChildAt(0), schema, dst)) {
+    return false;
+  }
+  auto lhs_type = ret_type_;
+  if (!Emit(*expr.GetChildAt(1), schema, dst + 1)) {
+    return false;
+  }
+  auto rhs_type = ret_type_;
+  ins.lhs_ = static_cast<uint8_t>(dst);
+  ins.rhs_ = static_cast<uint8_t>(dst + 1);
+
+  if (const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(&expr); cmp_expr != nullptr) {
+    // 布尔值只能和布尔值比较，其余情况交给解释执行去报错
+    if ((lhs_type == TypeId::BOOLEAN) != (rhs_type == TypeId::BOOLEAN)) {
+      return false;
+    }
+    switch (cmp_expr->comp_type_) {
+      case ComparisonType::Equal:
+        ins.op_ = OpCode::Equal;
+        break;
+      case ComparisonType::NotEqual:
+        ins.op_ = OpCode::NotEqual;
+        break;
+      case ComparisonType::LessThan:
+        ins.op_ = OpCode::LessThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        ins.op_ = OpCode::LessThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        ins.op_ = OpCode::GreaterThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        ins.op_ = OpCode::GreaterThanOrEqual;
+        break;
+      default:
+        return false;
+    }
+    program_.push_back(ins);
+    ret_type_ = TypeId::BOOLEAN;
+    return true;
+  }
+
+  if (const auto *arith_expr = dynamic_cast<const ArithmeticExpression *>(&expr); arith_expr != nullptr) {
+    if (lhs_type != TypeId::INTEGER || rhs_type != TypeId::INTEGER) {
+      return false;
+    }
+    switch (arith_expr->compute_type_) {
+      case ArithmeticType::Plus:
+        ins.op_ = OpCode::Plus;
+        break;
+      case ArithmeticType::Minus:
+        ins.op_ = OpCode::Minus;
+        break;
+      default:
+        return false;
+    }
+    program_.push_back(ins);
+    ret_type_ = TypeId::INTEGER;
+    return true;
+  }
+
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    if (lhs_type != TypeId::BOOLEAN || rhs_type != TypeId::BOOLEAN) {
+      return false;
+    }
+    switch (logic_expr->logic_type_) {
+      case LogicType::And:
+        ins.op_ = OpCode::And;
+        break;
+      case LogicType::Or:
+        ins.op_ = OpCode::Or;
+        break;
+      default:
+        return false;
+    }
+    program_.push_back(ins);
+    ret_type_ = TypeId::BOOLEAN;
+    return true;
+  }
+
+  return false;
+}
+
+template <class ColumnReader>
+void CompiledExpression::Run(const ColumnReader &read, int64_t *regs, bool *nulls) const {
+  for (const auto &ins : program_) {
+    const int64_t lhs = regs[ins.lhs_];
+    const int64_t rhs = regs[ins.rhs_];
+    const bool any_null = nulls[ins.lhs_] || nulls[ins.rhs_];
+    switch (ins.op_) {
+      case OpCode::LoadColumn:
+        read(ins, &regs[ins.dst_], &nulls[ins.dst_]);
+        break;
+      case OpCode::LoadConstant:
+        regs[ins.dst_] = ins.imm_;
+        nulls[ins.dst_] = ins.imm_null_;
+        break;
+      case OpCode::Equal:
+        regs[ins.dst_] = static_cast<int64_t>(lhs == rhs);
+        nulls[ins.dst_] = any_null;
+        break;
+      case OpCode::NotEqual:
+        regs[ins.dst_] = static_cast<int64_t>(lhs != rhs);
+        nulls[ins.dst_] = any_null;
+        break;
+      case OpCode::LessThan:
+        regs[ins.dst_] = static_cast<int64_t>(lhs < rhs);
+        nulls[ins.dst_] = any_null;
+        break;
+      case OpCode::LessThanOrEqual:
+        regs[ins.dst_] = static_cast<int64_t>(lhs <= rhs);
+        nulls[ins.dst_] = any_null;
+        break;
+      case OpCode::GreaterThan:
+        regs[ins.dst_] = static_cast<int64_t>(lhs > rhs);
+        nulls[ins.dst_] = any_null;
+        break;
+      case OpCode::GreaterThanOrEqual:
+        regs[ins.dst_] = static_cast<int64_t>(lhs >= rhs);
+        nulls[ins.dst_] = any_null;
+        break;
+      case OpCode::Plus:
+      case OpCode::Minus: {
+        // 和解释执行一样按32位整数计算，结果恰好等于NULL哨兵值时也视为NULL
+        auto res = static_cast<int32_t>(ins.op_ == OpCode::Plus ? lhs + rhs : lhs - rhs);
+        regs[ins.dst_] = res;
+        nulls[ins.dst_] = any_null || res == BUSTUB_INT32_NULL;
+        break;
+      }
+      case OpCode::And:
+      case OpCode::Or: {
+        // 三值逻辑：一侧为false时AND的结果为false，一侧为true时OR的结果为true，与另一侧是否为NULL无关
+        const bool l_true = !nulls[ins.lhs_] && lhs != 0;
+        const bool r_true = !nulls[ins.rhs_] && rhs != 0;
+        const bool l_false = !nulls[ins.lhs_] && lhs == 0;
+        const bool r_false = !nulls[ins.rhs_] && rhs == 0;
+        if (ins.op_ == OpCode::And) {
+          regs[ins.dst_] = static_cast<int64_t>(l_true && r_true);
+          nulls[ins.dst_] = !(l_false || r_false) && !(l_true && r_true);
+        } else {
+          regs[ins.dst_] = static_cast<int64_t>(l_true || r_true);
+          nulls[ins.dst_] = !(l_true || r_true) && !(l_false && r_false);
+        }
+        break;
+      }
+    }
+  }
+}
+
+auto CompiledExpression::Evaluate(const TupleView &tuple) const -> Value {
+  std::array<int64_t, MAX_REGISTERS> regs{};
+  std::array<bool, MAX_REGISTERS> nulls{};
+  const char *data = tuple.GetData();
+  auto read = [data](const Instruction &ins, int64_t *val, bool *is_null) {
+    ReadStorage(ins.type_, data + ins.offset_, val, is_null);
+  };
+  Run(read, regs.data(), nulls.data());
+
+  if (nulls[0]) {
+    return ValueFactory::GetNullValueByType(ret_type_);
+  }
+  switch (ret_type_) {
+    case TypeId::BOOLEAN:
+      return ValueFactory::GetBooleanValue(regs[0] != 0);
+    case TypeId::TINYINT:
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(regs[0]));
+    case TypeId::SMALLINT:
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(regs[0]));
+    case TypeId::INTEGER:
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(regs[0]));
+    case TypeId::BIGINT:
+      return ValueFactory::GetBigIntValue(regs[0]);
+    default:
+      UNREACHABLE("type is not supported by compiled expressions");
+  }
+}
+
+auto CompiledExpression::EvaluatePredicate(const TupleView &tuple) const -> bool {
+  std::array<int64_t, MAX_REGISTERS> regs{};
+  std::array<bool, MAX_REGISTERS> nulls{};
+  const char *data = tuple.GetData();
+  auto read = [data](const Instruction &ins, int64_t *val, bool *is_null) {
+    ReadStorage(ins.type_, data + ins.offset_, val, is_null);
+  };
+  Run(read, regs.data(), nulls.data());
+  return !nulls[0] && regs[0] != 0;
+}
+
+void CompiledExpression::Select(TupleBatch *batch) const {
+  std::array<int64_t, MAX_REGISTERS> regs{};
+  std::array<bool, MAX_REGISTERS> nulls{};
+  std::vector<uint32_t> sel;
+  sel.reserve(batch->Size());
+  for (auto row : batch->GetSelection()) {
+    auto read = [batch, row](const Instruction &ins, int64_t *val, bool *is_null) {
+      ReadValue(ins.type_, batch->GetValue(ins.col_idx_, row), val, is_null);
+    };
+    Run(read, regs.data(), nulls.data());
+    if (!nulls[0] && regs[0] != 0) {
+      sel.push_back(row);
+    }
+  }
+  batch->SetSelection(std::move(sel));
+}
+
+}  // namespace bustub
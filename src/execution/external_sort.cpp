@@ -0,0 +1,305 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.cpp
+//
+// Identification: src/execution/external_sort.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/external_sort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "common/util/parallel_util.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return negative, zero or positive as a sorts before, with or after b in ascending order, both are not NULL */
+auto CompareValues(const Value &a, const Value &b) -> int {
+  if (a.CompareLessThan(b) == CmpBool::CmpTrue) {
+    return -1;
+  }
+  if (a.CompareGreaterThan(b) == CmpBool::CmpTrue) {
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+ExternalSorter::ExternalSorter(BufferPoolManager *bpm, const Schema *schema,
+                               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys,
+                               size_t memory_budget, size_t num_workers)
+    : bpm_(bpm),
+      schema_(schema),
+      order_bys_(std::move(order_bys)),
+      memory_budget_(memory_budget),
+      num_workers_(std::max<size_t>(1, num_workers)) {}
+
+auto ExternalSorter::MakePrefix(const std::vector<Value> &keys) const -> uint64_t {
+  if (keys.empty()) {
+    return 0;
+  }
+  // 把第一个排序键编码成按无符号整数比较就能得到正确顺序的8字节前缀。
+  // 编码只保证单调不减，前缀相等时仍然要比较完整的Value
+  const auto &val = keys[0];
+  bool desc = order_bys_[0].first == OrderByType::DESC;
+  if (val.IsNull()) {
+    // NULL 比所有值都小：升序时编码为 0 排在最前面，降序时取反后排在最后面
+    return desc ? ~uint64_t{0} : 0;
+  }
+  uint64_t prefix = 0;
+  {
+    constexpr uint64_t sign_bit = uint64_t{1} << 63;
+    switch (val.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        prefix = static_cast<uint64_t>(static_cast<int64_t>(val.GetAs<int8_t>())) ^ sign_bit;
+        break;
+      case TypeId::SMALLINT:
+        prefix = static_cast<uint64_t>(static_cast<int64_t>(val.GetAs<int16_t>())) ^ sign_bit;
+        break;
+      case TypeId::INTEGER:
+        prefix = static_cast<uint64_t>(static_cast<int64_t>(val.GetAs<int32_t>())) ^ sign_bit;
+        break;
+      case TypeId::BIGINT:
+        prefix = static_cast<uint64_t>(val.GetAs<int64_t>()) ^ sign_bit;
+        break;
+      case TypeId::TIMESTAMP:
+        prefix = val.GetAs<uint64_t>();
+        break;
+      case TypeId::DECIMAL: {
+        auto d = val.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        prefix = (bits & sign_bit) != 0 ? ~bits : bits | sign_bit;
+        break;
+      }
+      case TypeId::VARCHAR: {
+        const char *data = val.GetData();
+        uint32_t len = val.GetLength();
+        for (uint32_t i = 0; i < sizeof(uint64_t); i++) {
+          prefix = (prefix << 8) | (i < len ? static_cast<uint8_t>(data[i]) : 0);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  // 非 NULL 的值最小编码为 1，把 0 留给 NULL，和编码为 1 的值相等时再比较完整的 Value
+  prefix = std::max<uint64_t>(prefix, 1);
+  return desc ? ~prefix : prefix;
+}
+
+auto ExternalSorter::Less(const Record &a, const Record &b) const -> bool {
+  if (a.prefix_ != b.prefix_) {
+    return a.prefix_ < b.prefix_;
+  }
+  for (size_t i = 0; i < order_bys_.size(); i++) {
+    const auto &lhs = a.keys_[i];
+    const auto &rhs = b.keys_[i];
+    int cmp;
+    if (lhs.IsNull() || rhs.IsNull()) {
+      // NULL 比所有值都小，和其他值一样按方向翻转
+      cmp = static_cast<int>(rhs.IsNull()) - static_cast<int>(lhs.IsNull());
+    } else {
+      cmp = CompareValues(lhs, rhs);
+    }
+    if (cmp != 0) {
+      return order_bys_[i].first == OrderByType::DESC ? cmp > 0 : cmp < 0;
+    }
+  }
+  return false;
+}
+
+void ExternalSorter::Add(std::vector<Value> keys, std::vector<Value> row) {
+  buffer_bytes_ += EstimateRowBytes(keys) + EstimateRowBytes(row) + sizeof(Record);
+  uint64_t prefix = MakePrefix(keys);
+  buffer_.push_back(Record{prefix, std::move(keys), std::move(row)});
+  if (buffer_bytes_ > memory_budget_) {
+    SpillBuffer();
+  }
+}
+
+auto ExternalSorter::SortBuffer() -> std::vector<std::vector<Record>> {
+  // 每个线程排序一段，数据量小的时候不值得切分
+  const size_t num_slices = std::max<size_t>(1, std::min(num_workers_, buffer_.size() / 1024));
+  const size_t slice_size = (buffer_.size() + num_slices - 1) / num_slices;
+  std::vector<std::vector<Record>> slices(num_slices);
+  for (size_t i = 0; i < num_slices; i++) {
+    auto begin = std::min(buffer_.size(), i * slice_size);
+    auto end = std::min(buffer_.size(), begin + slice_size);
+    slices[i].assign(std::make_move_iterator(buffer_.begin() + begin), std::make_move_iterator(buffer_.begin() + end));
+  }
+  buffer_.clear();
+  buffer_bytes_ = 0;
+
+  auto less = [this](const Record &a, const Record &b) { return Less(a, b); };
+  ParallelUtil::For(num_workers_, num_slices,
+                    [&](size_t i) { std::stable_sort(slices[i].begin(), slices[i].end(), less); });
+  return slices;
+}
+
+void ExternalSorter::SpillBuffer() {
+  auto slices = SortBuffer();
+  std::vector<std::unique_ptr<SpillFile>> runs(slices.size());
+  ParallelUtil::For(num_workers_, slices.size(), [&](size_t i) {
+    runs[i] = std::make_unique<SpillFile>(bpm_);
+    for (const auto &record : slices[i]) {
+      runs[i]->Append(Tuple{record.row_, schema_});
+    }
+    runs[i]->Finish();
+  });
+  num_spilled_runs_ += runs.size();
+  std::move(runs.begin(), runs.end(), std::back_inserter(runs_));
+}
+
+auto ExternalSorter::DecodeRecord(const Tuple &tuple) const -> Record {
+  Record record;
+  record.row_.reserve(schema_->GetColumnCount());
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    record.row_.push_back(tuple.GetValue(schema_, i));
+  }
+  record.keys_.reserve(order_bys_.size());
+  for (const auto &[type, expr] : order_bys_) {
+    record.keys_.push_back(expr->Evaluate(&tuple, *schema_));
+  }
+  record.prefix_ = MakePrefix(record.keys_);
+  return record;
+}
+
+auto ExternalSorter::Refill(Source *source) const -> bool {
+  if (source->pos_ < source->records_.size()) {
+    return true;
+  }
+  source->records_.clear();
+  source->pos_ = 0;
+  if (source->run_ == nullptr || source->next_page_ >= source->run_->NumPages()) {
+    return false;
+  }
+  std::vector<Tuple> tuples;
+  source->run_->ReadPage(source->next_page_++, &tuples);
+  for (const auto &tuple : tuples) {
+    source->records_.push_back(DecodeRecord(tuple));
+  }
+  return true;
+}
+
+void ExternalSorter::Finish() {
+  merge_sources_.clear();
+  if (runs_.empty()) {
+    // 全部数据都在内存中，直接归并排好序的各段
+    for (auto &slice : SortBuffer()) {
+      merge_sources_.push_back(Source{std::move(slice), 0, nullptr, 0});
+    }
+    BuildLoserTree();
+    return;
+  }
+
+  if (!buffer_.empty()) {
+    SpillBuffer();
+  }
+  // 归并路数受内存预算限制，每一路需要缓存一个页面的记录。路数不够时先分组归并成更长的顺串
+  const size_t max_fanin = std::max<size_t>(2, std::min(MAX_MERGE_FANIN, bpm_->GetPoolSize() / 2));
+  const size_t fanin = std::clamp<size_t>(memory_budget_ / (4 * BUSTUB_PAGE_SIZE), 2, max_fanin);
+  while (runs_.size() > fanin) {
+    std::vector<std::unique_ptr<SpillFile>> merged;
+    for (size_t begin = 0; begin < runs_.size(); begin += fanin) {
+      merge_sources_.clear();
+      for (size_t i = begin; i < std::min(runs_.size(), begin + fanin); i++) {
+        merge_sources_.push_back(Source{{}, 0, std::move(runs_[i]), 0});
+      }
+      BuildLoserTree();
+      auto run = std::make_unique<SpillFile>(bpm_);
+      std::vector<Value> row;
+      while (PopWinner(&row)) {
+        run->Append(Tuple{row, schema_});
+      }
+      run->Finish();
+      merged.push_back(std::move(run));
+      num_spilled_runs_++;
+    }
+    merge_sources_.clear();
+    runs_ = std::move(merged);
+  }
+
+  for (auto &run : runs_) {
+    merge_sources_.push_back(Source{{}, 0, std::move(run), 0});
+  }
+  runs_.clear();
+  BuildLoserTree();
+}
+
+auto ExternalSorter::SourceLess(size_t i, size_t j) const -> bool {
+  const auto &a = merge_sources_[i];
+  const auto &b = merge_sources_[j];
+  bool a_done = a.pos_ >= a.records_.size();
+  bool b_done = b.pos_ >= b.records_.size();
+  if (a_done || b_done) {
+    return !a_done;
+  }
+  if (Less(a.records_[a.pos_], b.records_[b.pos_])) {
+    return true;
+  }
+  // 键相等时编号小的来源先输出，来源按输入顺序编号，所以归并结果是稳定的
+  return !Less(b.records_[b.pos_], a.records_[a.pos_]) && i < j;
+}
+
+void ExternalSorter::BuildLoserTree() {
+  for (auto &source : merge_sources_) {
+    Refill(&source);
+  }
+  const size_t k = merge_sources_.size();
+  tree_.assign(std::max<size_t>(k, 1), 0);
+  if (k <= 1) {
+    return;
+  }
+  // 叶子是k..2k-1，自底向上比赛，内部节点记录败者，胜者继续向上
+  std::vector<size_t> winners(2 * k);
+  for (size_t i = 0; i < k; i++) {
+    winners[k + i] = i;
+  }
+  for (size_t node = k - 1; node >= 1; node--) {
+    size_t left = winners[2 * node];
+    size_t right = winners[2 * node + 1];
+    bool left_wins = SourceLess(left, right);
+    winners[node] = left_wins ? left : right;
+    tree_[node] = left_wins ? right : left;
+  }
+  tree_[0] = winners[1];
+}
+
+auto ExternalSorter::PopWinner(std::vector<Value> *out) -> bool {
+  if (merge_sources_.empty()) {
+    return false;
+  }
+  size_t winner = tree_[0];
+  auto &source = merge_sources_[winner];
+  if (source.pos_ >= source.records_.size()) {
+    return false;
+  }
+  *out = std::move(source.records_[source.pos_++].row_);
+  Refill(&source);
+
+  // 只需要沿着胜者所在叶子到根的路径重新比赛一次
+  const size_t k = merge_sources_.size();
+  size_t current = winner;
+  for (size_t node = (winner + k) / 2; node >= 1; node /= 2) {
+    if (SourceLess(tree_[node], current)) {
+      std::swap(tree_[node], current);
+    }
+  }
+  tree_[0] = current;
+  return true;
+}
+
+auto ExternalSorter::Next(std::vector<Value> *row) -> bool { return PopWinner(row); }
+
+}  // namespace bustub
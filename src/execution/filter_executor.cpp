@@ -11,6 +11,7 @@ FilterExecutor::FilterExecutor(ExecutorContext *exec_ctx, const FilterPlanNode *
 void FilterExecutor::Init() {
   // Initialize the child executor
   child_executor_->Init();
+  compiled_predicate_ = CompiledExpression::Compile(*plan_->GetPredicate(), child_executor_->GetOutputSchema());
 }
 
 auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
@@ -24,6 +25,13 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
       return false;
     }
 
+    if (compiled_predicate_ != nullptr) {
+      if (compiled_predicate_->EvaluatePredicate(*tuple)) {
+        return true;
+      }
+      continue;
+    }
+
     auto value = filter_expr->Evaluate(tuple, child_executor_->GetOutputSchema());
     if (!value.IsNull() && value.GetAs<bool>()) {
       return true;
@@ -31,4 +39,23 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 }
 
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  auto filter_expr = plan_->GetPredicate();
+  std::vector<Value> predicate;
+
+  // 子算子的一个批次可能被全部过滤掉，此时继续拉取下一个批次
+  while (child_executor_->NextBatch(batch)) {
+    if (compiled_predicate_ != nullptr) {
+      compiled_predicate_->Select(batch);
+    } else {
+      filter_expr->EvaluateBatch(*batch, &predicate);
+      batch->Select(predicate);
+    }
+    if (!batch->IsEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace bustub
@@ -10,22 +10,429 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <iterator>
+
 #include "execution/executors/hash_join_executor.h"
+#include "common/config.h"
+#include "common/util/parallel_util.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_child_(std::move(left_child)),
+      right_child_(std::move(right_child)),
+      jht_(ParallelUtil::WorkerCount()) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2023 Spring: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void HashJoinExecutor::Init() { throw NotImplementedException("HashJoinExecutor is not implemented"); }
+void HashJoinExecutor::Init() {
+  left_child_->Init();
+  right_child_->Init();
+
+  partitions_.clear();
+  pending_.clear();
+  probe_input_.reset();
+  probe_page_ = 0;
+  chunk_build_.reset();
+  chunk_table_.reset();
+  spilled_ = false;
+  memory_budget_ = hash_join_memory_budget;
+  // 每个溢出的分区在写入时都要固定一个页面，分区数不能超过缓冲池能同时固定的页面数
+  num_partitions_ =
+      std::max<size_t>(2, std::min(SPILL_FANOUT, exec_ctx_->GetBufferPoolManager()->GetPoolSize() / 4));
+
+  // 先把右表全部取出，再交给JoinHashTable分区并行建表，键中含有NULL的元组会在建表时被丢弃。
+  // 右表超出内存预算时改为按哈希值分区，放不下的分区写到临时页面上
+  std::vector<HashJoinKey> keys;
+  std::vector<std::vector<Value>> rows;
+  size_t bytes = 0;
+  TupleBatch batch;
+  while (right_child_->NextBatch(&batch)) {
+    auto batch_keys = MakeJoinKeys(plan_->RightJoinKeyExpressions(), batch);
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.GetRowValues(batch.GetSelection()[i]);
+      if (spilled_) {
+        AddBuildRow(std::move(batch_keys[i]), std::move(row));
+        continue;
+      }
+      bytes += EstimateRowBytes(batch_keys[i].keys_) + EstimateRowBytes(row);
+      keys.push_back(std::move(batch_keys[i]));
+      rows.push_back(std::move(row));
+      if (bytes > memory_budget_) {
+        spilled_ = true;
+        StartPartitioning(0);
+        for (size_t j = 0; j < keys.size(); j++) {
+          AddBuildRow(std::move(keys[j]), std::move(rows[j]));
+        }
+        keys.clear();
+        rows.clear();
+      }
+    }
+  }
+  if (spilled_) {
+    FinishPartitioning();
+  } else {
+    jht_.Build(std::move(keys), std::move(rows));
+  }
+
+  right_nulls_.clear();
+  for (const auto &column : right_child_->GetOutputSchema().GetColumns()) {
+    right_nulls_.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+
+  left_batches_.clear();
+  round_rows_.clear();
+  round_pos_ = 0;
+  left_done_ = false;
+  out_batch_.Reset(&GetOutputSchema());
+  out_pos_ = 0;
+}
+
+auto HashJoinExecutor::MakeJoinKeys(const std::vector<AbstractExpressionRef> &exprs, const TupleBatch &batch)
+    -> std::vector<HashJoinKey> {
+  std::vector<std::vector<Value>> columns(exprs.size());
+  for (size_t i = 0; i < exprs.size(); i++) {
+    exprs[i]->EvaluateBatch(batch, &columns[i]);
+  }
+  std::vector<HashJoinKey> keys(batch.Size());
+  for (uint32_t row = 0; row < batch.Size(); row++) {
+    keys[row].keys_.reserve(exprs.size());
+    for (auto &column : columns) {
+      keys[row].keys_.push_back(std::move(column[row]));
+    }
+  }
+  return keys;
+}
+
+auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  // 逐个元组输出时也按批次探测，Next只是依次取出输出批次中的元组
+  while (out_pos_ >= out_batch_.Size()) {
+    if (!NextBatch(&out_batch_)) {
+      return false;
+    }
+    out_pos_ = 0;
+  }
+  *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[out_pos_++]);
+  *rid = tuple->GetRid();
+  return true;
+}
+
+auto HashJoinExecutor::ProbeRow(const JoinHashTable &table, const HashJoinKey &key, const std::vector<Value> &left,
+                                std::vector<std::vector<Value>> *out) const -> bool {
+  bool matched = false;
+  table.Probe(key, [&](const std::vector<Value> &right) {
+    matched = true;
+    auto joined = left;
+    joined.insert(joined.end(), right.begin(), right.end());
+    out->push_back(std::move(joined));
+  });
+  return matched;
+}
+
+void HashJoinExecutor::EmitUnmatched(std::vector<Value> left, std::vector<std::vector<Value>> *out) const {
+  if (plan_->GetJoinType() == JoinType::LEFT) {
+    left.insert(left.end(), right_nulls_.begin(), right_nulls_.end());
+    out->push_back(std::move(left));
+  }
+}
+
+void HashJoinExecutor::ProbeBatch(const TupleBatch &left, std::vector<std::vector<Value>> *out) const {
+  auto keys = MakeJoinKeys(plan_->LeftJoinKeyExpressions(), left);
+  const auto &sel = left.GetSelection();
+  for (size_t i = 0; i < sel.size(); i++) {
+    auto values = left.GetRowValues(sel[i]);
+    if (keys[i].HasNull() || !ProbeRow(jht_, keys[i], values, out)) {
+      EmitUnmatched(std::move(values), out);
+    }
+  }
+}
+
+void HashJoinExecutor::ProbeRound() {
+  // 子执行器不是线程安全的，所以由当前线程依次取出一轮的左表批次，只有探测部分并行执行
+  const size_t num_workers = ParallelUtil::WorkerCount();
+  left_batches_.resize(num_workers);
+  size_t num_batches = 0;
+  while (num_batches < num_workers && left_child_->NextBatch(&left_batches_[num_batches])) {
+    num_batches++;
+  }
+  if (num_batches < num_workers) {
+    left_done_ = true;
+  }
+
+  std::vector<std::vector<std::vector<Value>>> results(num_batches);
+  ParallelUtil::For(num_workers, num_batches, [&](size_t i) { ProbeBatch(left_batches_[i], &results[i]); });
+
+  // 按批次顺序拼接结果，输出顺序与单线程探测时相同
+  round_rows_.clear();
+  round_pos_ = 0;
+  for (auto &result : results) {
+    std::move(result.begin(), result.end(), std::back_inserter(round_rows_));
+  }
+}
+
+auto HashJoinExecutor::PartitionOf(uint64_t hash, uint32_t level) const -> size_t {
+  // 每一层用不同的种子重新打散哈希值，上一层落在同一分区的键在下一层才能继续分开
+  hash ^= (level + 1) * 0x9e3779b97f4a7c15ULL;
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash % num_partitions_;
+}
+
+void HashJoinExecutor::StartPartitioning(uint32_t level) {
+  level_ = level;
+  partitions_.clear();
+  partitions_.resize(num_partitions_);
+  resident_bytes_ = 0;
+}
+
+void HashJoinExecutor::AddBuildRow(HashJoinKey key, std::vector<Value> row) {
+  if (key.HasNull()) {
+    return;
+  }
+  auto &partition = partitions_[PartitionOf(JoinHashTable::HashKey(key), level_)];
+  if (partition.build_file_ != nullptr) {
+    partition.build_file_->Append(Tuple{row, &right_child_->GetOutputSchema()});
+    return;
+  }
+  size_t bytes = EstimateRowBytes(key.keys_) + EstimateRowBytes(row);
+  partition.keys_.push_back(std::move(key));
+  partition.rows_.push_back(std::move(row));
+  partition.bytes_ += bytes;
+  resident_bytes_ += bytes;
 
-auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  // 超出预算时优先溢出最大的分区，这样能以最少的溢出次数腾出最多的内存
+  while (resident_bytes_ > memory_budget_) {
+    JoinPartition *largest = nullptr;
+    for (auto &candidate : partitions_) {
+      if (candidate.build_file_ == nullptr && (largest == nullptr || candidate.bytes_ > largest->bytes_)) {
+        largest = &candidate;
+      }
+    }
+    if (largest == nullptr || largest->bytes_ == 0) {
+      break;
+    }
+    SpillPartition(largest);
+  }
+}
+
+void HashJoinExecutor::SpillPartition(JoinPartition *partition) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  partition->build_file_ = std::make_unique<SpillFile>(bpm);
+  partition->probe_file_ = std::make_unique<SpillFile>(bpm);
+  for (const auto &row : partition->rows_) {
+    partition->build_file_->Append(Tuple{row, &right_child_->GetOutputSchema()});
+  }
+  resident_bytes_ -= partition->bytes_;
+  partition->keys_ = {};
+  partition->rows_ = {};
+  partition->bytes_ = 0;
+}
+
+void HashJoinExecutor::FinishPartitioning() {
+  for (auto &partition : partitions_) {
+    if (partition.build_file_ != nullptr) {
+      partition.build_file_->Finish();
+      continue;
+    }
+    partition.table_ = std::make_unique<JoinHashTable>(ParallelUtil::WorkerCount());
+    partition.table_->Build(std::move(partition.keys_), std::move(partition.rows_));
+    partition.keys_ = {};
+    partition.rows_ = {};
+  }
+}
+
+void HashJoinExecutor::RouteProbeRow(HashJoinKey key, std::vector<Value> row) {
+  if (!key.HasNull()) {
+    auto &partition = partitions_[PartitionOf(JoinHashTable::HashKey(key), level_)];
+    if (partition.probe_file_ != nullptr) {
+      partition.probe_file_->Append(Tuple{row, &left_child_->GetOutputSchema()});
+      return;
+    }
+    if (ProbeRow(*partition.table_, key, row, &round_rows_)) {
+      return;
+    }
+  }
+  EmitUnmatched(std::move(row), &round_rows_);
+}
+
+auto HashJoinExecutor::DecodeSpilled(const Tuple &tuple, const Schema &schema,
+                                     const std::vector<AbstractExpressionRef> &exprs, HashJoinKey *key)
+    -> std::vector<Value> {
+  std::vector<Value> values;
+  values.reserve(schema.GetColumnCount());
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    values.push_back(tuple.GetValue(&schema, i));
+  }
+  key->keys_.clear();
+  for (const auto &expr : exprs) {
+    key->keys_.push_back(expr->Evaluate(&tuple, schema));
+  }
+  return values;
+}
+
+auto HashJoinExecutor::SpillStep() -> bool {
+  round_rows_.clear();
+  round_pos_ = 0;
+  if (chunk_build_ != nullptr) {
+    return ChunkStep() || NextSpilledJoin();
+  }
+
+  // 当前这一层的探测输入是左孩子或者上一层溢出的探测文件，每次处理一个批次或者一个页面
+  if (probe_input_ == nullptr) {
+    TupleBatch batch;
+    if (!left_done_ && left_child_->NextBatch(&batch)) {
+      auto keys = MakeJoinKeys(plan_->LeftJoinKeyExpressions(), batch);
+      for (uint32_t i = 0; i < batch.Size(); i++) {
+        RouteProbeRow(std::move(keys[i]), batch.GetRowValues(batch.GetSelection()[i]));
+      }
+      return true;
+    }
+    left_done_ = true;
+  } else if (probe_page_ < probe_input_->NumPages()) {
+    std::vector<Tuple> tuples;
+    probe_input_->ReadPage(probe_page_++, &tuples);
+    HashJoinKey key;
+    for (const auto &tuple : tuples) {
+      auto row = DecodeSpilled(tuple, left_child_->GetOutputSchema(), plan_->LeftJoinKeyExpressions(), &key);
+      RouteProbeRow(std::move(key), std::move(row));
+    }
+    return true;
+  }
+
+  // 这一层探测完毕，溢出的分区留到之后按下一层重新分区处理
+  for (auto &partition : partitions_) {
+    if (partition.build_file_ != nullptr) {
+      partition.probe_file_->Finish();
+      pending_.push_back(SpilledJoin{std::move(partition.build_file_), std::move(partition.probe_file_), level_ + 1});
+    }
+  }
+  partitions_.clear();
+  return NextSpilledJoin();
+}
+
+auto HashJoinExecutor::NextSpilledJoin() -> bool {
+  // 探测侧为空的分区不会产生任何输出，直接丢弃
+  while (!pending_.empty() && pending_.back().probe_file_->NumTuples() == 0) {
+    pending_.pop_back();
+  }
+  if (pending_.empty()) {
+    probe_input_.reset();
+    return false;
+  }
+  auto job = std::move(pending_.back());
+  pending_.pop_back();
+  probe_input_ = std::move(job.probe_file_);
+  probe_page_ = 0;
+
+  // 重新分区几次之后仍然放不下，说明分区里大部分是同一个键，只能按预算分块建表，每块都扫描一遍探测侧
+  if (job.level_ > MAX_SPILL_LEVEL) {
+    chunk_build_ = std::move(job.build_file_);
+    chunk_page_ = 0;
+    probe_matched_.assign(probe_input_->NumTuples(), false);
+    unmatched_pass_ = false;
+    LoadChunk();
+    return true;
+  }
+
+  StartPartitioning(job.level_);
+  std::vector<Tuple> tuples;
+  for (size_t page = 0; page < job.build_file_->NumPages(); page++) {
+    job.build_file_->ReadPage(page, &tuples);
+    for (const auto &tuple : tuples) {
+      HashJoinKey key;
+      auto row = DecodeSpilled(tuple, right_child_->GetOutputSchema(), plan_->RightJoinKeyExpressions(), &key);
+      AddBuildRow(std::move(key), std::move(row));
+    }
+  }
+  FinishPartitioning();
+  return true;
+}
+
+void HashJoinExecutor::LoadChunk() {
+  std::vector<HashJoinKey> keys;
+  std::vector<std::vector<Value>> rows;
+  size_t bytes = 0;
+  std::vector<Tuple> tuples;
+  while (chunk_page_ < chunk_build_->NumPages() && (rows.empty() || bytes < memory_budget_)) {
+    chunk_build_->ReadPage(chunk_page_++, &tuples);
+    for (const auto &tuple : tuples) {
+      HashJoinKey key;
+      auto row = DecodeSpilled(tuple, right_child_->GetOutputSchema(), plan_->RightJoinKeyExpressions(), &key);
+      bytes += EstimateRowBytes(key.keys_) + EstimateRowBytes(row);
+      keys.push_back(std::move(key));
+      rows.push_back(std::move(row));
+    }
+  }
+  chunk_table_ = std::make_unique<JoinHashTable>(ParallelUtil::WorkerCount());
+  chunk_table_->Build(std::move(keys), std::move(rows));
+  probe_page_ = 0;
+  probe_row_ = 0;
+}
+
+auto HashJoinExecutor::ChunkStep() -> bool {
+  if (probe_page_ < probe_input_->NumPages()) {
+    std::vector<Tuple> tuples;
+    probe_input_->ReadPage(probe_page_++, &tuples);
+    HashJoinKey key;
+    for (const auto &tuple : tuples) {
+      auto row = DecodeSpilled(tuple, left_child_->GetOutputSchema(), plan_->LeftJoinKeyExpressions(), &key);
+      if (unmatched_pass_) {
+        if (!probe_matched_[probe_row_]) {
+          EmitUnmatched(std::move(row), &round_rows_);
+        }
+      } else if (ProbeRow(*chunk_table_, key, row, &round_rows_)) {
+        probe_matched_[probe_row_] = true;
+      }
+      probe_row_++;
+    }
+    return true;
+  }
+  if (!unmatched_pass_ && chunk_page_ < chunk_build_->NumPages()) {
+    LoadChunk();
+    return true;
+  }
+  // 所有分块都探测过之后，左连接还要再扫描一遍探测侧，输出没有任何匹配的元组
+  if (!unmatched_pass_ && plan_->GetJoinType() == JoinType::LEFT) {
+    unmatched_pass_ = true;
+    chunk_table_.reset();
+    probe_page_ = 0;
+    probe_row_ = 0;
+    return true;
+  }
+  chunk_build_.reset();
+  chunk_table_.reset();
+  return false;
+}
+
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (round_pos_ >= round_rows_.size()) {
+      if (spilled_) {
+        if (!SpillStep()) {
+          break;
+        }
+      } else {
+        if (left_done_) {
+          break;
+        }
+        ProbeRound();
+      }
+      continue;
+    }
+    batch->Append(std::move(round_rows_[round_pos_++]));
+  }
+  return !batch->IsEmpty();
+}
 
 }  // namespace bustub
@@ -13,10 +13,85 @@
 
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+auto IndexScanExecutor::MakeKeyTuple(const AbstractExpressionRef &bound) const -> Tuple {
+  std::vector<Value> values{bound->Evaluate(nullptr, index_info_->key_schema_)};
+  return {values, &index_info_->key_schema_};
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::MakeKey(const AbstractExpressionRef &bound) const -> IntegerKeyType {
+  IntegerKeyType key;
+  key.SetFromKey(MakeKeyTuple(bound));
+  return key;
+}
+
+void IndexScanExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info_->table_name_);
+
+  // A hash index has no key order, it can only be probed with the single key of a point lookup
+  if (index_info_->index_type_ != IndexType::BPlusTreeIndex) {
+    if (plan_->low_key_ == nullptr || plan_->high_key_ == nullptr || !plan_->low_inclusive_ ||
+        !plan_->high_inclusive_ ||
+        MakeKeyTuple(plan_->low_key_).GetValue(&index_info_->key_schema_, 0).CompareEquals(
+            MakeKeyTuple(plan_->high_key_).GetValue(&index_info_->key_schema_, 0)) != CmpBool::CmpTrue) {
+      throw ExecutionException("a hash index only supports point lookups");
+    }
+    rids_.clear();
+    index_info_->index_->ScanKey(MakeKeyTuple(plan_->low_key_), &rids_, GetExecutorContext()->GetTransaction());
+    rid_cursor_ = 0;
+    return;
+  }
+
+  auto *tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(index_info_->index_.get());
+  if (tree == nullptr) {
+    throw ExecutionException("index scan requires a b+ tree index");
+  }
+
+  IndexKeyRange<IntegerKeyType> range;
+  if (plan_->low_key_ != nullptr) {
+    range.low_ = MakeKey(plan_->low_key_);
+    range.low_inclusive_ = plan_->low_inclusive_;
+  }
+  if (plan_->high_key_ != nullptr) {
+    range.high_ = MakeKey(plan_->high_key_);
+    range.high_inclusive_ = plan_->high_inclusive_;
+  }
+
+  iter_ = plan_->IsReverse() ? tree->GetReverseIterator(range) : tree->GetRangeIterator(range);
+}
+
+auto IndexScanExecutor::NextRid(RID *rid) -> bool {
+  if (index_info_->index_type_ != IndexType::BPlusTreeIndex) {
+    if (rid_cursor_ >= rids_.size()) {
+      return false;
+    }
+    *rid = rids_[rid_cursor_++];
+    return true;
+  }
+
+  if (iter_.IsEnd()) {
+    return false;
+  }
+  *rid = (*iter_).second;
+  ++iter_;
+  return true;
+}
+
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  RID curr_rid;
+  while (NextRid(&curr_rid)) {
+    auto [meta, curr_tuple] = table_info_->table_->GetTuple(curr_rid);
+    if (meta.is_deleted_) {
+      continue;
+    }
+    *tuple = std::move(curr_tuple);
+    *rid = curr_rid;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
@@ -1,27 +1,73 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// insert_executor.cpp
-//
-// Identification: src/execution/insert_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include <memory>
-
-#include "execution/executors/insert_executor.h"
-
-namespace bustub {
-
-InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
-                               std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
-
-void InsertExecutor::Init() { throw NotImplementedException("InsertExecutor is not implemented"); }
-
-auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// insert_executor.cpp
+//
+// Identification: src/execution/insert_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/insert_executor.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
+                               std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void InsertExecutor::Init() {
+  child_executor_->Init();
+  done_ = false;
+}
+
+auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  done_ = true;
+
+  auto catalog = exec_ctx_->GetCatalog();
+  auto table_info = catalog->GetTable(plan_->TableOid());
+  auto indexes = catalog->GetTableIndexes(table_info->name_);
+
+  int32_t count = 0;
+  // 每个索引的键攒到最后排序后一次性插入
+  std::vector<std::vector<std::pair<Tuple, RID>>> index_entries(indexes.size());
+  TupleBatch batch;
+  std::vector<Tuple> child_tuples;
+  while (child_executor_->NextBatch(&batch)) {
+    child_tuples.clear();
+    for (auto row : batch.GetSelection()) {
+      child_tuples.push_back(batch.GetTuple(row));
+    }
+    auto new_rids = table_info->table_->InsertTuples(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, child_tuples,
+                                                     exec_ctx_->GetLockManager(), exec_ctx_->GetTransaction(),
+                                                     table_info->oid_);
+    for (size_t i = 0; i < indexes.size(); i++) {
+      auto index_info = indexes[i];
+      for (size_t j = 0; j < child_tuples.size(); j++) {
+        index_entries[i].emplace_back(child_tuples[j].KeyFromTuple(table_info->schema_, index_info->key_schema_,
+                                                                   index_info->index_->GetKeyAttrs()),
+                                      new_rids[j]);
+      }
+    }
+    count += static_cast<int32_t>(new_rids.size());
+  }
+  // 同步更新表上的所有索引
+  for (size_t i = 0; i < indexes.size(); i++) {
+    indexes[i]->index_->InsertEntries(index_entries[i], exec_ctx_->GetTransaction());
+  }
+
+  *tuple = Tuple{{ValueFactory::GetIntegerValue(count)}, &GetOutputSchema()};
+  return true;
+}
+
+}  // namespace bustub
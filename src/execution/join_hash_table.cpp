@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.cpp
+//
+// Identification: src/execution/join_hash_table.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/join_hash_table.h"
+
+#include <algorithm>
+
+#include "common/util/parallel_util.h"
+
+namespace bustub {
+
+auto JoinHashTable::HashKey(const HashJoinKey &key) -> uint64_t {
+  uint64_t hash = 0;
+  for (const auto &val : key.keys_) {
+    if (!val.IsNull()) {
+      hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&val));
+    }
+  }
+  // HashValue的高位分布很差，用murmur3的finalizer打散后，高位用来分区，低位用来在分区内寻址
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+void JoinHashTable::Build(std::vector<HashJoinKey> keys, std::vector<std::vector<Value>> rows) {
+  keys_ = std::move(keys);
+  rows_ = std::move(rows);
+  partitions_.clear();
+  num_rows_ = 0;
+
+  const size_t n = keys_.size();
+  radix_bits_ = 0;
+  while ((n >> radix_bits_) > PARTITION_TARGET_ROWS && radix_bits_ < MAX_RADIX_BITS) {
+    radix_bits_++;
+  }
+  const size_t num_partitions = size_t{1} << radix_bits_;
+
+  // 把输入切成若干块，每个线程负责一块：先计算哈希值并统计每个分区的行数
+  const size_t num_chunks = std::max<size_t>(1, std::min(num_workers_, (n + 1023) / 1024));
+  const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  std::vector<uint64_t> hashes(n);
+  std::vector<std::vector<size_t>> histograms(num_chunks, std::vector<size_t>(num_partitions, 0));
+  ParallelUtil::For(num_workers_, num_chunks, [&](size_t chunk) {
+    auto &histogram = histograms[chunk];
+    for (size_t i = chunk * chunk_size; i < std::min(n, (chunk + 1) * chunk_size); i++) {
+      if (keys_[i].HasNull()) {
+        continue;
+      }
+      hashes[i] = HashKey(keys_[i]);
+      histogram[PartitionOf(hashes[i])]++;
+    }
+  });
+
+  // 前缀和决定每一块在每个分区中的写入位置，分散写入时各线程之间没有冲突
+  std::vector<size_t> partition_begin(num_partitions + 1, 0);
+  std::vector<std::vector<size_t>> offsets(num_chunks, std::vector<size_t>(num_partitions, 0));
+  size_t total = 0;
+  for (size_t p = 0; p < num_partitions; p++) {
+    partition_begin[p] = total;
+    for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+      offsets[chunk][p] = total;
+      total += histograms[chunk][p];
+    }
+  }
+  partition_begin[num_partitions] = total;
+  num_rows_ = total;
+
+  std::vector<uint32_t> order(total);
+  ParallelUtil::For(num_workers_, num_chunks, [&](size_t chunk) {
+    auto &offset = offsets[chunk];
+    for (size_t i = chunk * chunk_size; i < std::min(n, (chunk + 1) * chunk_size); i++) {
+      if (!keys_[i].HasNull()) {
+        order[offset[PartitionOf(hashes[i])]++] = static_cast<uint32_t>(i);
+      }
+    }
+  });
+
+  // 每个分区独立建表，装载因子不超过1/2
+  partitions_.resize(num_partitions);
+  ParallelUtil::For(num_workers_, num_partitions, [&](size_t p) {
+    const size_t count = partition_begin[p + 1] - partition_begin[p];
+    if (count == 0) {
+      return;
+    }
+    size_t capacity = 2;
+    while (capacity < count * 2) {
+      capacity <<= 1;
+    }
+    auto &slots = partitions_[p];
+    slots.assign(capacity, Slot{});
+    const size_t mask = capacity - 1;
+    for (size_t k = partition_begin[p]; k < partition_begin[p + 1]; k++) {
+      auto row = order[k];
+      size_t i = hashes[row] & mask;
+      while (slots[i].row_ != EMPTY_SLOT) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = Slot{hashes[row], row};
+    }
+  });
+}
+
+}  // namespace bustub
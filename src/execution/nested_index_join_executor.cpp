@@ -11,20 +11,81 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/nested_index_join_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2023 Spring: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestIndexJoinExecutor::Init() { throw NotImplementedException("NestIndexJoinExecutor is not implemented"); }
+void NestIndexJoinExecutor::Init() {
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  child_executor_->Init();
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  inner_tuples_.clear();
+  inner_cursor_ = 0;
+  pending_null_row_ = false;
+}
+
+void NestIndexJoinExecutor::ProbeInner(const Tuple &outer_tuple) {
+  inner_tuples_.clear();
+  inner_cursor_ = 0;
+
+  Value key_value = plan_->KeyPredicate()->Evaluate(&outer_tuple, child_executor_->GetOutputSchema());
+  // NULL never compares equal, there is nothing to probe for
+  if (!key_value.IsNull()) {
+    std::vector<RID> rids;
+    Tuple key_tuple({key_value}, &index_info_->key_schema_);
+    index_info_->index_->ScanKey(key_tuple, &rids, GetExecutorContext()->GetTransaction());
+    for (const auto &rid : rids) {
+      auto [meta, inner_tuple] = inner_table_info_->table_->GetTuple(rid);
+      if (!meta.is_deleted_) {
+        inner_tuples_.push_back(std::move(inner_tuple));
+      }
+    }
+  }
+  pending_null_row_ = inner_tuples_.empty() && plan_->GetJoinType() == JoinType::LEFT;
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto &outer_schema = child_executor_->GetOutputSchema();
+  const auto &inner_schema = plan_->InnerTableSchema();
+
+  while (inner_cursor_ >= inner_tuples_.size() && !pending_null_row_) {
+    RID outer_rid;
+    if (!child_executor_->Next(&outer_tuple_, &outer_rid)) {
+      return false;
+    }
+    ProbeInner(outer_tuple_);
+  }
+
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema().GetColumnCount());
+  for (uint32_t i = 0; i < outer_schema.GetColumnCount(); i++) {
+    values.push_back(outer_tuple_.GetValue(&outer_schema, i));
+  }
+  if (pending_null_row_) {
+    pending_null_row_ = false;
+    for (uint32_t i = 0; i < inner_schema.GetColumnCount(); i++) {
+      values.push_back(ValueFactory::GetNullValueByType(inner_schema.GetColumn(i).GetType()));
+    }
+  } else {
+    const auto &inner_tuple = inner_tuples_[inner_cursor_++];
+    for (uint32_t i = 0; i < inner_schema.GetColumnCount(); i++) {
+      values.push_back(inner_tuple.GetValue(&inner_schema, i));
+    }
+  }
+
+  *tuple = Tuple(values, &GetOutputSchema());
+  return true;
+}
 
 }  // namespace bustub
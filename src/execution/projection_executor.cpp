@@ -33,4 +33,23 @@ auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
 
   return true;
 }
+
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    batch->Reset(&GetOutputSchema());
+    return false;
+  }
+
+  // 每个表达式一次计算出整列的结果，输出批次中只包含被选中的行
+  const auto &exprs = plan_->GetExpressions();
+  std::vector<std::vector<Value>> columns(exprs.size());
+  for (size_t i = 0; i < exprs.size(); i++) {
+    exprs[i]->EvaluateBatch(child_batch_, &columns[i]);
+  }
+
+  batch->Reset(&GetOutputSchema());
+  batch->AssignColumns(std::move(columns), child_batch_.Size());
+  return true;
+}
+
 }  // namespace bustub
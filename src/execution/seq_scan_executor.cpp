@@ -1,23 +1,324 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include "execution/executors/seq_scan_executor.h"
-
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
-
-void SeqScanExecutor::Init() { throw NotImplementedException("SeqScanExecutor is not implemented"); }
-
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/seq_scan_executor.h"
+
+#include <iterator>
+
+#include "common/util/parallel_util.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "storage/page/pax_page.h"
+
+namespace bustub {
+
+namespace {
+
+/** Marks the columns an expression reads */
+void CollectColumns(const AbstractExpression &expr, std::vector<bool> *columns) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(&expr); column != nullptr) {
+    (*columns)[column->GetColIdx()] = true;
+  }
+  for (const auto &child : expr.GetChildren()) {
+    CollectColumns(*child, columns);
+  }
+}
+
+/** @return `true` if the zone map can compare values of the column with the constant */
+auto ZoneComparable(TypeId column_type, TypeId constant_type) -> bool {
+  auto is_numeric = [](TypeId type) {
+    return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT ||
+           type == TypeId::DECIMAL;
+  };
+  return column_type == constant_type || (is_numeric(column_type) && is_numeric(constant_type));
+}
+
+/** Collects the `column <op> constant` conjuncts of a scan predicate as zone map ranges */
+void CollectZoneMapRanges(const AbstractExpression &expr, const Schema &schema, std::vector<ZoneMapRange> *ranges) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    if (logic_expr->logic_type_ == LogicType::And) {
+      CollectZoneMapRanges(*logic_expr->GetChildAt(0), schema, ranges);
+      CollectZoneMapRanges(*logic_expr->GetChildAt(1), schema, ranges);
+    }
+    return;
+  }
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (cmp_expr == nullptr) {
+    return;
+  }
+  auto comp_type = cmp_expr->comp_type_;
+  const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(0).get());
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(cmp_expr->GetChildAt(1).get());
+  if (column_expr == nullptr) {
+    // `constant <op> column`，把比较翻转过来
+    column_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(1).get());
+    constant_expr = dynamic_cast<const ConstantValueExpression *>(cmp_expr->GetChildAt(0).get());
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column_expr == nullptr || constant_expr == nullptr || column_expr->GetTupleIdx() != 0 ||
+      constant_expr->val_.IsNull() || comp_type == ComparisonType::NotEqual ||
+      !ZoneComparable(schema.GetColumn(column_expr->GetColIdx()).GetType(), constant_expr->val_.GetTypeId())) {
+    return;
+  }
+
+  ZoneMapRange range;
+  range.column_idx_ = column_expr->GetColIdx();
+  const auto &bound = constant_expr->val_;
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      range.lower_ = bound;
+      range.upper_ = bound;
+      break;
+    case ComparisonType::GreaterThan:
+      range.lower_inclusive_ = false;
+      range.lower_ = bound;
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      range.lower_ = bound;
+      break;
+    case ComparisonType::LessThan:
+      range.upper_inclusive_ = false;
+      range.upper_ = bound;
+      break;
+    case ComparisonType::LessThanOrEqual:
+      range.upper_ = bound;
+      break;
+    default:
+      return;
+  }
+  ranges->push_back(std::move(range));
+}
+
+}  // namespace
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void SeqScanExecutor::Init() {
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  // 迭代器只扫描到创建时表中的最后一个元组，同一语句中新插入的元组不会被扫描到
+  iter_.emplace(table_info_->table_->MakeIterator());
+  ready_batches_.clear();
+  ready_pos_ = 0;
+  num_pages_scanned_ = 0;
+  compiled_predicate_ = nullptr;
+  // 谓词按表的列读取，输出的只是计划要求的那些列
+  const auto &table_schema = table_info_->schema_;
+  column_ids_ = plan_->GetColumnIds();
+  if (column_ids_.empty()) {
+    for (uint32_t col = 0; col < table_schema.GetColumnCount(); col++) {
+      column_ids_.push_back(col);
+    }
+  }
+  predicate_columns_.assign(table_schema.GetColumnCount(), false);
+  std::vector<ZoneMapRange> ranges;
+  if (plan_->filter_predicate_ != nullptr) {
+    compiled_predicate_ = CompiledExpression::Compile(*plan_->filter_predicate_, table_schema);
+    CollectColumns(*plan_->filter_predicate_, &predicate_columns_);
+    CollectZoneMapRanges(*plan_->filter_predicate_, table_schema, &ranges);
+  }
+  // 谓词中的范围条件交给MorselQueue，根据zone map跳过不可能匹配的页面
+  morsels_.emplace(table_info_->table_.get(), MorselQueue::DEFAULT_PAGES_PER_MORSEL, ranges);
+}
+
+auto SeqScanExecutor::Accept(const Tuple &tuple) const -> bool {
+  if (plan_->filter_predicate_ == nullptr) {
+    return true;
+  }
+  if (compiled_predicate_ != nullptr) {
+    return compiled_predicate_->EvaluatePredicate(tuple);
+  }
+  auto value = plan_->filter_predicate_->Evaluate(&tuple, table_info_->schema_);
+  return !value.IsNull() && value.GetAs<bool>();
+}
+
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (!iter_->IsEnd()) {
+    auto [meta, cur] = iter_->GetTuple();
+    ++(*iter_);
+    if (meta.is_deleted_ || !Accept(cur)) {
+      continue;
+    }
+    *rid = cur.GetRid();
+    if (plan_->GetColumnIds().empty()) {
+      *tuple = std::move(cur);
+      return true;
+    }
+    std::vector<Value> values;
+    values.reserve(column_ids_.size());
+    for (auto col : column_ids_) {
+      values.push_back(cur.GetValue(&table_info_->schema_, col));
+    }
+    *tuple = Tuple{std::move(values), &GetOutputSchema()};
+    tuple->SetRid(*rid);
+    return true;
+  }
+  return false;
+}
+
+void SeqScanExecutor::ScanMorsel(const Morsel &morsel, std::vector<TupleBatch> *batches) const {
+  if (table_info_->table_->GetFormat() == TableFormat::Pax) {
+    ScanPaxMorsel(morsel, batches);
+    return;
+  }
+  const bool all_columns = plan_->GetColumnIds().empty();
+  // 只输出部分列时批次里没有谓词读的其他列，没有编译的谓词只能逐行在整个元组上求值
+  const bool interpret_batch = plan_->filter_predicate_ != nullptr && compiled_predicate_ == nullptr && all_columns;
+  const bool interpret_rows = plan_->filter_predicate_ != nullptr && compiled_predicate_ == nullptr && !all_columns;
+  TupleBatch batch(&GetOutputSchema());
+  std::vector<Value> predicate;
+  auto flush = [&] {
+    if (interpret_batch) {
+      plan_->filter_predicate_->EvaluateBatch(batch, &predicate);
+      batch.Select(predicate);
+    }
+    if (!batch.IsEmpty()) {
+      batches->push_back(std::move(batch));
+    }
+    batch = TupleBatch(&GetOutputSchema());
+  };
+  // 元组以视图的形式直接从固定住的页面中读取，不再复制到堆上。编译后的谓词直接在页面的字节上求值，
+  // 被过滤掉的元组不会被拆成列，没有输出的列也不会
+  morsels_->Scan(morsel, [&](const TupleMeta &meta, const TupleView &tuple) {
+    if (meta.is_deleted_ || (compiled_predicate_ != nullptr && !compiled_predicate_->EvaluatePredicate(tuple)) ||
+        (interpret_rows && !Accept(tuple.Materialize()))) {
+      return;
+    }
+    if (all_columns) {
+      batch.AppendTupleView(tuple);
+    } else {
+      batch.AppendTupleView(tuple, table_info_->schema_, column_ids_);
+    }
+    if (batch.IsFull()) {
+      flush();
+    }
+  });
+  flush();
+}
+
+void SeqScanExecutor::ScanPaxMorsel(const Morsel &morsel, std::vector<TupleBatch> *batches) const {
+  const auto &schema = GetOutputSchema();
+  const auto &table_schema = table_info_->schema_;
+  const uint32_t num_columns = schema.GetColumnCount();
+  const uint32_t num_table_columns = table_schema.GetColumnCount();
+  std::vector<std::vector<Value>> columns(num_columns);
+  std::vector<RID> rids;
+  auto flush = [&] {
+    if (rids.empty()) {
+      return;
+    }
+    TupleBatch batch(&schema);
+    auto num_rows = static_cast<uint32_t>(rids.size());
+    batch.AssignColumns(std::move(columns), num_rows, std::move(rids));
+    batches->push_back(std::move(batch));
+    columns.assign(num_columns, {});
+    rids.clear();
+  };
+
+  std::vector<uint32_t> slots;
+  std::vector<Value> predicate;
+  TupleBatch filter;
+  morsels_->ScanPages<PaxPage>(morsel, [&](page_id_t page_id, const PaxPage *page, uint32_t num_slots) {
+    slots.clear();
+    for (uint32_t slot = 0; slot < num_slots; slot++) {
+      if (!page->GetTupleMeta(RID{page_id, slot}).is_deleted_) {
+        slots.push_back(slot);
+      }
+    }
+    bool filtered = plan_->filter_predicate_ != nullptr && !slots.empty();
+    if (filtered) {
+      // 先只读出谓词用到的列求值，其他列的位置放空值占位，谓词不会读到它们
+      std::vector<std::vector<Value>> filter_columns(num_table_columns);
+      for (uint32_t col = 0; col < num_table_columns; col++) {
+        if (predicate_columns_[col]) {
+          page->ReadColumn(table_schema, col, slots, &filter_columns[col]);
+        } else {
+          filter_columns[col].resize(slots.size());
+        }
+      }
+      filter.Reset(&table_schema);
+      filter.AssignColumns(std::move(filter_columns), static_cast<uint32_t>(slots.size()));
+      plan_->filter_predicate_->EvaluateBatch(filter, &predicate);
+      filter.Select(predicate);
+      size_t kept = 0;
+      for (auto row : filter.GetSelection()) {
+        slots[kept++] = slots[row];
+      }
+      slots.resize(kept);
+    }
+    // 一页的元组数远小于批大小，放不下时先把已有的行输出
+    if (rids.size() + slots.size() > static_cast<size_t>(BUSTUB_BATCH_SIZE)) {
+      flush();
+    }
+    // 只有通过过滤的元组才从输出列的minipage中读出来，谓词已经读过的列直接取过滤后留下的值
+    for (uint32_t col = 0; col < num_columns; col++) {
+      auto table_col = column_ids_[col];
+      if (filtered && predicate_columns_[table_col]) {
+        const auto &values = filter.GetColumn(table_col);
+        for (auto row : filter.GetSelection()) {
+          columns[col].push_back(values[row]);
+        }
+      } else {
+        page->ReadColumn(table_schema, table_col, slots, &columns[col]);
+      }
+    }
+    for (auto slot : slots) {
+      rids.emplace_back(page_id, slot);
+    }
+  });
+  flush();
+}
+
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  while (ready_pos_ >= ready_batches_.size()) {
+    // 每一轮给每个线程分一个morsel，结果按morsel的顺序拼起来，输出顺序和串行扫描一致
+    const size_t num_workers = ParallelUtil::WorkerCount();
+    std::vector<Morsel> round;
+    Morsel morsel;
+    while (round.size() < num_workers && morsels_->Next(&morsel)) {
+      num_pages_scanned_ += morsel.pages_.size();
+      round.push_back(std::move(morsel));
+    }
+    if (round.empty()) {
+      batch->Reset(&GetOutputSchema());
+      return false;
+    }
+    std::vector<std::vector<TupleBatch>> results(round.size());
+    ParallelUtil::For(num_workers, round.size(), [&](size_t i) { ScanMorsel(round[i], &results[i]); });
+    ready_batches_.clear();
+    ready_pos_ = 0;
+    for (auto &batches : results) {
+      std::move(batches.begin(), batches.end(), std::back_inserter(ready_batches_));
+    }
+  }
+  *batch = std::move(ready_batches_[ready_pos_++]);
+  return true;
+}
+
+}  // namespace bustub
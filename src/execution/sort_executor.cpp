@@ -1,13 +1,56 @@
 #include "execution/executors/sort_executor.h"
+#include "common/config.h"
+#include "common/util/parallel_util.h"
 
 namespace bustub {
 
 SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void SortExecutor::Init() { throw NotImplementedException("SortExecutor is not implemented"); }
+void SortExecutor::Init() {
+  child_executor_->Init();
+  sorter_ = std::make_unique<ExternalSorter>(exec_ctx_->GetBufferPoolManager(), &child_executor_->GetOutputSchema(),
+                                             plan_->GetOrderBy(), sort_memory_budget, ParallelUtil::WorkerCount());
 
-auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  // 排序键按列整批求值，再和整行一起交给排序器
+  const auto &order_bys = plan_->GetOrderBy();
+  std::vector<std::vector<Value>> key_columns(order_bys.size());
+  TupleBatch batch;
+  while (child_executor_->NextBatch(&batch)) {
+    for (size_t i = 0; i < order_bys.size(); i++) {
+      order_bys[i].second->EvaluateBatch(batch, &key_columns[i]);
+    }
+    const auto &sel = batch.GetSelection();
+    for (size_t row = 0; row < sel.size(); row++) {
+      std::vector<Value> keys;
+      keys.reserve(order_bys.size());
+      for (auto &column : key_columns) {
+        keys.push_back(std::move(column[row]));
+      }
+      sorter_->Add(std::move(keys), batch.GetRowValues(sel[row]));
+    }
+  }
+  sorter_->Finish();
+}
+
+auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  std::vector<Value> values;
+  if (!sorter_->Next(&values)) {
+    return false;
+  }
+  *tuple = Tuple{std::move(values), &GetOutputSchema()};
+  *rid = RID{};
+  return true;
+}
+
+auto SortExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  std::vector<Value> values;
+  while (!batch->IsFull() && sorter_->Next(&values)) {
+    batch->Append(std::move(values));
+  }
+  return !batch->IsEmpty();
+}
 
 }  // namespace bustub
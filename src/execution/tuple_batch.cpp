@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  // 保留各列vector已经分配的空间，批次在算子之间反复使用时不需要重新分配
+  columns_.resize(schema == nullptr ? 0 : schema->GetColumnCount());
+  for (auto &column : columns_) {
+    column.clear();
+    column.reserve(BUSTUB_BATCH_SIZE);
+  }
+  rids_.clear();
+  sel_.clear();
+}
+
+void TupleBatch::Append(std::vector<Value> values, RID rid) {
+  BUSTUB_ASSERT(values.size() == columns_.size(), "row does not match the batch schema");
+  auto row = static_cast<uint32_t>(rids_.size());
+  for (uint32_t i = 0; i < values.size(); i++) {
+    columns_[i].push_back(std::move(values[i]));
+  }
+  rids_.push_back(rid);
+  sel_.push_back(row);
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, RID rid) {
+  auto row = static_cast<uint32_t>(rids_.size());
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(rid);
+  sel_.push_back(row);
+}
+
+void TupleBatch::AppendTupleView(const TupleView &tuple) {
+  auto row = static_cast<uint32_t>(rids_.size());
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(tuple.GetRid());
+  sel_.push_back(row);
+}
+
+void TupleBatch::AppendTupleView(const TupleView &tuple, const Schema &tuple_schema,
+                                 const std::vector<uint32_t> &column_ids) {
+  BUSTUB_ASSERT(column_ids.size() == columns_.size(), "columns do not match the batch schema");
+  auto row = static_cast<uint32_t>(rids_.size());
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(tuple.GetValue(&tuple_schema, column_ids[i]));
+  }
+  rids_.push_back(tuple.GetRid());
+  sel_.push_back(row);
+}
+
+void TupleBatch::AssignColumns(std::vector<std::vector<Value>> columns, uint32_t num_rows, std::vector<RID> rids) {
+  BUSTUB_ASSERT(columns.size() == columns_.size(), "columns do not match the batch schema");
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    BUSTUB_ASSERT(columns[i].size() == num_rows, "column has a wrong number of rows");
+    columns_[i] = std::move(columns[i]);
+  }
+  if (rids.empty()) {
+    rids_.assign(num_rows, RID{});
+  } else {
+    BUSTUB_ASSERT(rids.size() == num_rows, "rids have a wrong number of rows");
+    rids_ = std::move(rids);
+  }
+  sel_.resize(num_rows);
+  for (uint32_t i = 0; i < num_rows; i++) {
+    sel_[i] = i;
+  }
+}
+
+void TupleBatch::Select(const std::vector<Value> &predicate) {
+  BUSTUB_ASSERT(predicate.size() == sel_.size(), "predicate does not match the selection");
+  // 原地压缩选择向量，被过滤掉的行仍然留在列中，不需要移动任何值
+  size_t kept = 0;
+  for (size_t i = 0; i < sel_.size(); i++) {
+    if (!predicate[i].IsNull() && predicate[i].GetAs<bool>()) {
+      sel_[kept++] = sel_[i];
+    }
+  }
+  sel_.resize(kept);
+}
+
+auto TupleBatch::GetRowValues(uint32_t row) const -> std::vector<Value> {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row]);
+  }
+  return values;
+}
+
+auto TupleBatch::GetTuple(uint32_t row) const -> Tuple {
+  Tuple tuple{GetRowValues(row), schema_};
+  tuple.SetRid(rids_[row]);
+  return tuple;
+}
+
+}  // namespace bustub
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include "binder/bound_expression.h"
+#include "fmt/format.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+/**
+ * A bound parameter placeholder of a prepared statement, e.g., `$1`.
+ */
+class BoundParameter : public BoundExpression {
+ public:
+  BoundParameter(uint32_t index, TypeId type)
+      : BoundExpression(ExpressionType::PARAMETER), index_(index), type_(type) {}
+
+  auto ToString() const -> std::string override { return fmt::format("${}", index_ + 1); }
+
+  auto HasAggregation() const -> bool override { return false; }
+
+  /** The position of the parameter, starting from 0 for `$1`. */
+  uint32_t index_;
+
+  /** The type declared by PREPARE, INVALID if it is left to the planner to infer. */
+  TypeId type_;
+};
+}  // namespace bustub
@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//                         BusTub
+//
+// binder/copy_statement.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "binder/bound_statement.h"
+#include "binder/table_ref/bound_base_table_ref.h"
+
+namespace bustub {
+
+/** `COPY table FROM 'file' [WITH] (FORMAT csv | binary, DELIMITER 'c', HEADER)` */
+class CopyStatement : public BoundStatement {
+ public:
+  explicit CopyStatement(std::unique_ptr<BoundBaseTableRef> table, std::string file_path, std::string format,
+                         char delimiter, bool header);
+
+  /** The table to load into */
+  std::unique_ptr<BoundBaseTableRef> table_;
+
+  /** The file to load from */
+  std::string file_path_;
+
+  /** Format of the file, `csv` or `binary`, lowercased */
+  std::string format_;
+
+  /** Field delimiter of a CSV file */
+  char delimiter_;
+
+  /** Whether the first line of a CSV file is a header to skip */
+  bool header_;
+
+  auto ToString() const -> std::string override;
+};
+
+}  // namespace bustub
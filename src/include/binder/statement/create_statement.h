@@ -21,11 +21,14 @@ namespace bustub {
 
 class CreateStatement : public BoundStatement {
  public:
-  explicit CreateStatement(std::string table, std::vector<Column> columns);
+  explicit CreateStatement(std::string table, std::vector<Column> columns, std::string format = "");
 
   std::string table_;
   std::vector<Column> columns_;
 
+  /** Page format from `WITH (format = ...)`, e.g. `pax`, lowercased; empty if not given */
+  std::string format_;
+
   auto ToString() const -> std::string override;
 };
 
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//                         BusTub
+//
+// binder/prepare_statement.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_statement.h"
+#include "common/enums/statement_type.h"
+#include "fmt/format.h"
+#include "fmt/ranges.h"
+#include "type/type.h"
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * `PREPARE name [(type, ...)] AS statement` plans a SELECT, INSERT, UPDATE or DELETE with `$n` placeholders once,
+ * so that it can be run again with different values by EXECUTE.
+ */
+class PrepareStatement : public BoundStatement {
+ public:
+  PrepareStatement(std::string name, std::vector<TypeId> parameter_types,
+                   std::shared_ptr<const BoundStatement> statement)
+      : BoundStatement(StatementType::PREPARE_STATEMENT),
+        name_(std::move(name)),
+        parameter_types_(std::move(parameter_types)),
+        statement_(std::move(statement)) {}
+
+  /** The name the statement is executed by */
+  std::string name_;
+
+  /** The declared types of the first parameters, the others are inferred by the planner */
+  std::vector<TypeId> parameter_types_;
+
+  /** The statement to prepare, it is kept by the prepared plan to plan it again when the catalog changes */
+  std::shared_ptr<const BoundStatement> statement_;
+
+  auto ToString() const -> std::string override {
+    std::vector<std::string> types;
+    for (auto type : parameter_types_) {
+      types.push_back(Type::TypeIdToString(type));
+    }
+    return fmt::format("BoundPrepare {{\n  name={},\n  parameter_types={},\n  statement={}\n}}", name_, types,
+                       statement_->ToString());
+  }
+};
+
+/**
+ * `EXECUTE name [(value, ...)]` runs a prepared statement with the values bound to its parameters.
+ */
+class ExecuteStatement : public BoundStatement {
+ public:
+  ExecuteStatement(std::string name, std::vector<Value> parameters)
+      : BoundStatement(StatementType::EXECUTE_STATEMENT), name_(std::move(name)), parameters_(std::move(parameters)) {}
+
+  /** The name of the prepared statement */
+  std::string name_;
+
+  /** The values of `$1`, `$2`, ... */
+  std::vector<Value> parameters_;
+
+  auto ToString() const -> std::string override {
+    std::vector<std::string> values;
+    for (const auto &value : parameters_) {
+      values.push_back(value.ToString());
+    }
+    return fmt::format("BoundExecute {{ name={}, parameters={} }}", name_, values);
+  }
+};
+
+/**
+ * `DEALLOCATE name` drops a prepared statement, `DEALLOCATE ALL` drops all of them.
+ */
+class DeallocateStatement : public BoundStatement {
+ public:
+  explicit DeallocateStatement(std::optional<std::string> name)
+      : BoundStatement(StatementType::DEALLOCATE_STATEMENT), name_(std::move(name)) {}
+
+  /** The prepared statement to drop, std::nullopt for all of them */
+  std::optional<std::string> name_;
+
+  auto ToString() const -> std::string override {
+    return fmt::format("BoundDeallocate {{ name={} }}", name_.value_or("<all>"));
+  }
+};
+
+}  // namespace bustub
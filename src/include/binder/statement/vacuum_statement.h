@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//                         BusTub
+//
+// binder/vacuum_statement.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "binder/bound_statement.h"
+#include "common/enums/statement_type.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+/**
+ * `VACUUM [table]` reclaims the space of deleted tuples, `ANALYZE [table]` collects the statistics used by the
+ * optimizer and `VACUUM ANALYZE [table]` does both, for one table or for every table.
+ */
+class VacuumStatement : public BoundStatement {
+ public:
+  VacuumStatement(std::optional<std::string> table, bool vacuum, bool analyze)
+      : BoundStatement(StatementType::VACUUM_STATEMENT), table_(std::move(table)), vacuum_(vacuum), analyze_(analyze) {}
+
+  /** The table to vacuum, std::nullopt for every table */
+  std::optional<std::string> table_;
+
+  /** Whether to reclaim the space of deleted tuples */
+  bool vacuum_;
+
+  /** Whether to collect statistics */
+  bool analyze_;
+
+  auto ToString() const -> std::string override {
+    return fmt::format("BoundVacuum {{ table={}, vacuum={}, analyze={} }}", table_.value_or("<all>"), vacuum_,
+                       analyze_);
+  }
+};
+
+}  // namespace bustub
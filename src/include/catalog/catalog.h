@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -20,10 +22,12 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "catalog/table_statistics.h"
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -58,6 +62,12 @@ struct TableInfo {
   const table_oid_t oid_;
 };
 
+/**
+ * The kinds of index structures a table can be indexed with. HashTableIndex is the extendible hash
+ * table, LinearProbeHashTableIndex the linear probing one; both only answer point lookups.
+ */
+enum class IndexType { BPlusTreeIndex, HashTableIndex, LinearProbeHashTableIndex };
+
 /**
  * The IndexInfo class maintains metadata about a index.
  */
@@ -70,15 +80,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param index_type The kind of index structure
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::BPlusTreeIndex)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        index_type_{index_type} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,6 +103,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The kind of index structure */
+  const IndexType index_type_;
 };
 
 /**
@@ -106,6 +120,9 @@ class Catalog {
   /** Indicates that an operation returning a `IndexInfo*` failed */
   static constexpr IndexInfo *NULL_INDEX_INFO{nullptr};
 
+  /** Number of slots a new linear probing hash index starts with */
+  static constexpr size_t LINEAR_PROBE_INITIAL_SIZE{1024};
+
   /**
    * Construct a new Catalog instance.
    * @param bpm The buffer pool manager backing tables created by this catalog
@@ -121,10 +138,11 @@ class Catalog {
    * @param table_name The name of the new table, note that all tables beginning with `__` are reserved for the system.
    * @param schema The schema of the new table
    * @param create_table_heap whether to create a table heap for the new table
+   * @param format the page format of the table heap
    * @return A (non-owning) pointer to the metadata for the table
    */
-  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true)
-      -> TableInfo * {
+  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true,
+                   TableFormat format = TableFormat::Row) -> TableInfo * {
     if (table_names_.count(table_name) != 0) {
       return NULL_TABLE_INFO;
     }
@@ -136,7 +154,7 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_);
+      table = std::make_unique<TableHeap>(bpm_, format, schema);
     }
 
     // Fetch the table OID for the new table
@@ -150,6 +168,7 @@ class Catalog {
     tables_.emplace(table_oid, std::move(meta));
     table_names_.emplace(table_name, table_oid);
     index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t>{});
+    version_.fetch_add(1);
 
     return tmp;
   }
@@ -196,12 +215,14 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The kind of index structure to build
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, IndexType index_type = IndexType::BPlusTreeIndex)
+      -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -221,31 +242,38 @@ class Catalog {
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::HashTableIndex) {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                            hash_function);
+    } else if (index_type == IndexType::LinearProbeHashTableIndex) {
+      index = std::make_unique<LinearProbeHashTableIndex<KeyType, ValueType, KeyComparator>>(
+          std::move(meta), bpm_, LINEAR_PROBE_INITIAL_SIZE, hash_function);
+    } else {
+      index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    }
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
+    std::vector<std::pair<Tuple, RID>> entries;
     for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
       auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+      entries.emplace_back(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid());
     }
+    index->InsertEntries(entries, txn);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, index_type);
     auto *tmp = index_info.get();
 
     // Update internal tracking
     indexes_.emplace(index_oid, std::move(index_info));
     table_indexes.emplace(index_name, index_oid);
+    version_.fetch_add(1);
 
     return tmp;
   }
@@ -298,7 +326,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -341,6 +369,35 @@ class Catalog {
     return result;
   }
 
+  /**
+   * Replace the statistics of a table, collected by ANALYZE.
+   * @param table_oid The OID of the table
+   * @param stats The new statistics
+   */
+  void SetTableStatistics(table_oid_t table_oid, TableStatistics stats) {
+    std::scoped_lock lock(statistics_latch_);
+    statistics_[table_oid] = std::make_shared<const TableStatistics>(std::move(stats));
+    version_.fetch_add(1);
+  }
+
+  /**
+   * Get the statistics of a table.
+   * @param table_oid The OID of the table
+   * @return The statistics collected by the last ANALYZE of the table, nullptr if it was never analyzed
+   */
+  auto GetTableStatistics(table_oid_t table_oid) const -> std::shared_ptr<const TableStatistics> {
+    std::scoped_lock lock(statistics_latch_);
+    auto stats = statistics_.find(table_oid);
+    return stats == statistics_.end() ? nullptr : stats->second;
+  }
+
+  /**
+   * Get the version of the catalog, which changes whenever a table or an index is created or the statistics of a
+   * table are replaced. A plan built at one version may be stale at another.
+   * @return The current version
+   */
+  auto GetVersion() const -> uint64_t { return version_.load(); }
+
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -371,6 +428,13 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** Map table identifier -> statistics, ANALYZE may replace them while queries are planned. */
+  std::unordered_map<table_oid_t, std::shared_ptr<const TableStatistics>> statistics_;
+  mutable std::mutex statistics_latch_;
+
+  /** Bumped by every change the optimizer depends on. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_loader.h
+//
+// Identification: src/include/catalog/table_loader.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** The file formats a TableLoader reads */
+enum class LoadFormat { Csv, Binary };
+
+/** How a TableLoader reads its input */
+struct LoadOptions {
+  LoadFormat format_{LoadFormat::Csv};
+  /** The field delimiter of a CSV file */
+  char delimiter_{','};
+  /** Whether the first line of a CSV file is a header to skip */
+  bool header_{false};
+};
+
+/**
+ * TableLoader bulk-loads a file into a table, it backs `COPY table FROM 'file'`.
+ *
+ * The input is read in chunks that end on a row boundary. A round of chunks is parsed into tuples by
+ * worker threads, then the tuples are appended to the table heap in file order with
+ * TableHeap::InsertTuples. The keys of every index are collected while loading and inserted sorted in
+ * one InsertEntries call at the end. If the input turns out to be invalid, the rows appended so far are
+ * marked deleted before the error is rethrown, so the table and its indexes are left as they were.
+ *
+ * CSV fields are separated by the delimiter and may be quoted with `"`, a quote inside a quoted field is
+ * written twice. An empty unquoted field is NULL, `""` is an empty string.
+ *
+ * The binary format is written by BinaryRowWriter: a magic number, the column count and the type of every
+ * column, then every row as a 4-byte length followed by the row serialized like a tuple of the schema.
+ */
+class TableLoader {
+ public:
+  /** The bytes read per chunk */
+  static constexpr size_t CHUNK_SIZE = 1 << 20;
+  /** The magic number a binary row file starts with */
+  static constexpr char BINARY_MAGIC[8] = {'B', 'U', 'S', 'T', 'U', 'B', 'R', '1'};
+
+  /**
+   * Create a loader for a table.
+   * @param catalog the catalog the table and its indexes are in
+   * @param table the table to load into
+   * @param txn the transaction of the load
+   * @param options how to read the input
+   */
+  TableLoader(Catalog *catalog, TableInfo *table, Transaction *txn, LoadOptions options);
+
+  /**
+   * Load a file into the table.
+   * @return the number of rows loaded
+   */
+  auto LoadFile(const std::string &path) -> size_t;
+
+  /**
+   * Load a stream into the table.
+   * @return the number of rows loaded
+   */
+  auto Load(std::istream &in) -> size_t;
+
+ private:
+  /** Parse the input and append its rows to the table, collecting their index keys */
+  void LoadRows(std::istream &in);
+
+  /**
+   * Read the next chunk, which ends on a row boundary.
+   * @param in the input
+   * @param[in,out] carry the bytes of a partial row read with the previous chunk
+   * @param[out] chunk the chunk
+   * @return `false` if there is nothing left to read
+   */
+  auto ReadChunk(std::istream &in, std::string *carry, std::string *chunk) -> bool;
+
+  /** @return the length of the complete rows at the start of buf */
+  auto CompleteRowsLength(const std::string &buf) const -> size_t;
+
+  /** Check the header of a binary row file */
+  void ReadBinaryHeader(std::istream &in) const;
+
+  void ParseCsv(const std::string &chunk, std::vector<Tuple> *tuples) const;
+
+  void ParseBinary(const std::string &chunk, std::vector<Tuple> *tuples) const;
+
+  /** Throw if a parsed row does not fit in a page of the table */
+  void CheckTupleSize(const Tuple &tuple) const;
+
+  /** @return a field of a CSV row as a value of the column */
+  auto ParseField(const std::string &field, bool quoted, uint32_t column_idx) const -> Value;
+
+  /** Append parsed tuples to the table and collect their index keys */
+  void InsertTuples(const std::vector<Tuple> &tuples);
+
+  TableInfo *table_;
+  Transaction *txn_;
+  LoadOptions options_;
+  std::vector<IndexInfo *> indexes_;
+  /** The keys to insert into each index once the table is loaded */
+  std::vector<std::vector<std::pair<Tuple, RID>>> index_entries_;
+  /** The rows appended to the table by the load so far, deleted again if the load fails */
+  std::vector<RID> inserted_rids_;
+  /** Whether the header line of a CSV file still needs to be skipped */
+  bool skip_header_;
+  size_t num_rows_{0};
+};
+
+/** BinaryRowWriter writes the binary row files a TableLoader reads. */
+class BinaryRowWriter {
+ public:
+  /**
+   * Start a binary row file for rows of a schema.
+   * @param out the stream to write the file to
+   * @param schema the schema of the rows
+   */
+  BinaryRowWriter(std::ostream &out, const Schema &schema);
+
+  /** Write a row. */
+  void WriteRow(const std::vector<Value> &values);
+
+ private:
+  std::ostream &out_;
+  Schema schema_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_statistics.h
+//
+// Identification: src/include/catalog/table_statistics.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/util/hash_util.h"
+#include "type/value.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/**
+ * HyperLogLog estimates the number of distinct hashes added to it with 2^precision one-byte registers. The
+ * standard error is about 1.04 / sqrt(2^precision), small counts are estimated with linear counting.
+ */
+class HyperLogLog {
+ public:
+  static constexpr uint8_t DEFAULT_PRECISION = 12;
+
+  explicit HyperLogLog(uint8_t precision = DEFAULT_PRECISION);
+
+  /**
+   * @return the hash of a value to add. HashUtil::HashValue maps many small integers to the same hash, which would
+   * make distinct values look like duplicates.
+   */
+  static auto HashOf(const Value &value) -> hash_t;
+
+  /** Add the hash of a value. */
+  void AddHash(hash_t hash);
+
+  /** @return the estimated number of distinct hashes added */
+  auto Estimate() const -> size_t;
+
+ private:
+  uint8_t precision_;
+  /** The largest number of leading zeros plus one seen by each register */
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * The statistics of one column. The histogram is equi-depth: bounds_ holds the minimum and then the upper
+ * bound of every bucket, and every bucket holds about the same number of the non-NULL values.
+ */
+struct ColumnStatistics {
+  size_t null_count_{0};
+  /** The estimated number of distinct non-NULL values */
+  size_t distinct_count_{0};
+  std::vector<Value> bounds_;
+
+  /** @return the estimated fraction of the non-NULL values equal to the value */
+  auto EqualFraction(const Value &value) const -> double;
+
+  /** @return the estimated fraction of the non-NULL values less than (or equal to) the value */
+  auto LessFraction(const Value &value, bool inclusive) const -> double;
+};
+
+/** The statistics of a table collected by ANALYZE. */
+struct TableStatistics {
+  /** The number of histogram buckets per column */
+  static constexpr size_t NUM_BUCKETS = 32;
+  /** The number of rows sampled for the histograms */
+  static constexpr size_t SAMPLE_SIZE = 16384;
+
+  /** The number of live rows */
+  size_t row_count_{0};
+  std::vector<ColumnStatistics> columns_;
+
+  /**
+   * Scan a table and collect its statistics. Distinct counts are estimated over every row, the histograms
+   * are built from a fixed-size uniform sample of the rows.
+   */
+  static auto Collect(TableHeap *table, const Schema &schema) -> TableStatistics;
+};
+
+}  // namespace bustub
@@ -42,11 +42,19 @@ class CheckpointManager;
 class Catalog;
 class ExecutionEngine;
 
+class BoundStatement;
 class CreateStatement;
 class IndexStatement;
 class VariableSetStatement;
 class VariableShowStatement;
 class ExplainStatement;
+class CopyStatement;
+class VacuumStatement;
+class PrepareStatement;
+class ExecuteStatement;
+class DeallocateStatement;
+class PlanCache;
+struct CachedPlan;
 
 class ResultWriter {
  public:
@@ -226,6 +234,10 @@ class BustubInstance {
 
   /**
    * Execute a SQL query in the BusTub instance.
+   *
+   * The rows of a query are written to the writer while the query runs. If the query fails after some rows
+   * were written, the writer has already received them: the table is closed, the transaction is aborted and the
+   * error is thrown (or `false` is returned), so a client has to discard the rows of a failed query.
    */
   auto ExecuteSql(const std::string &sql, ResultWriter &writer, std::shared_ptr<CheckOptions> check_options = nullptr)
       -> bool;
@@ -263,6 +275,9 @@ class BustubInstance {
   ExecutionEngine *execution_engine_;
   std::shared_mutex catalog_lock_;
 
+  /** Plans of recently run statements, looked up by their text before the statement is parsed. */
+  std::unique_ptr<PlanCache> plan_cache_;
+
   auto GetSessionVariable(const std::string &key) -> std::string {
     if (session_variables_.find(key) != session_variables_.end()) {
       return session_variables_[key];
@@ -284,10 +299,37 @@ class BustubInstance {
   void HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer);
   void HandleIndexStatement(Transaction *txn, const IndexStatement &stmt, ResultWriter &writer);
   void HandleExplainStatement(Transaction *txn, const ExplainStatement &stmt, ResultWriter &writer);
+  void HandleCopyStatement(Transaction *txn, const CopyStatement &stmt, ResultWriter &writer);
+  void HandleVacuumStatement(Transaction *txn, const VacuumStatement &stmt, ResultWriter &writer);
   void HandleVariableShowStatement(Transaction *txn, const VariableShowStatement &stmt, ResultWriter &writer);
   void HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt, ResultWriter &writer);
+  void HandlePrepareStatement(Transaction *txn, const PrepareStatement &stmt, ResultWriter &writer);
+  auto HandleExecuteStatement(Transaction *txn, const ExecuteStatement &stmt, ResultWriter &writer,
+                              std::shared_ptr<CheckOptions> check_options) -> bool;
+  void HandleDeallocateStatement(Transaction *txn, const DeallocateStatement &stmt, ResultWriter &writer);
+
+  /**
+   * Plan and optimize the statement of a PREPARE.
+   * @param statement the bound statement, kept to plan it again when the catalog changes
+   * @param parameter_types the declared types of the first parameters
+   */
+  auto PlanPreparedStatement(std::shared_ptr<const BoundStatement> statement,
+                             const std::vector<TypeId> &parameter_types) -> std::shared_ptr<const CachedPlan>;
+
+  /**
+   * Run an optimized plan and stream its result to the writer, parameters are the values of `$1`, `$2`, ...
+   * Rows written before a failure are not taken back, see ExecuteSql().
+   */
+  auto ExecutePlan(const CachedPlan &cached_plan, const std::vector<Value> &parameters, Transaction *txn,
+                   ResultWriter &writer, std::shared_ptr<CheckOptions> check_options) -> bool;
+
+  /** @return the key of the statement in the plan cache, std::nullopt if the statement is not cached */
+  auto PlanCacheKey(const std::string &sql) -> std::optional<std::string>;
 
   std::unordered_map<std::string, std::string> session_variables_;
+
+  /** Prepared statement name -> its plan. */
+  std::unordered_map<std::string, std::shared_ptr<const CachedPlan>> prepared_statements_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,6 +28,15 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The memory in bytes a hash join may use for its build side before it spills partitions to temp pages. */
+extern size_t hash_join_memory_budget;
+
+/** The memory in bytes a sort may buffer before it spills sorted runs to temp pages. */
+extern size_t sort_memory_budget;
+
+/** The memory in bytes an aggregation may use for its groups before it spills partitions to temp pages. */
+extern size_t aggregation_memory_budget;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
@@ -36,6 +46,8 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int BUSTUB_BATCH_SIZE = 1024;  // number of rows in a tuple batch
+static constexpr int PLAN_CACHE_SIZE = 128;     // number of plans kept by the plan cache
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
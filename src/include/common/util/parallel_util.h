@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_util.h
+//
+// Identification: src/include/common/util/parallel_util.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "common/util/task_scheduler.h"
+
+namespace bustub {
+
+class ParallelUtil {
+ public:
+  /** @return the number of worker threads parallel operators use, one per hardware thread */
+  static auto WorkerCount() -> size_t { return std::max<size_t>(1, std::thread::hardware_concurrency()); }
+
+  /**
+   * Runs task(i) for every i in [0, num_tasks) on up to num_workers threads, the calling thread included.
+   * The helpers run on the shared TaskScheduler pool, so concurrent queries share the same worker threads.
+   * Tasks are handed out one at a time, so tasks of uneven size still balance across the workers.
+   * The first exception thrown by a task is rethrown on the calling thread once all workers stopped.
+   */
+  template <class Task>
+  static void For(size_t num_workers, size_t num_tasks, const Task &task) {
+    num_workers = std::min(num_workers, num_tasks);
+    if (num_workers <= 1) {
+      for (size_t i = 0; i < num_tasks; i++) {
+        task(i);
+      }
+      return;
+    }
+
+    // The state outlives this call: a helper that only starts after all tasks were handed out still
+    // touches it, but never calls the task, so the caller only waits for helpers that are running.
+    struct State {
+      std::atomic<size_t> next_{0};
+      std::atomic<size_t> active_{0};
+      size_t num_tasks_;
+      const Task *task_;
+      std::exception_ptr error_;
+      std::mutex latch_;
+      std::condition_variable done_;
+    };
+    auto state = std::make_shared<State>();
+    state->num_tasks_ = num_tasks;
+    state->task_ = &task;
+    auto work = [](State *s) {
+      for (size_t i = s->next_++; i < s->num_tasks_; i = s->next_++) {
+        try {
+          (*s->task_)(i);
+        } catch (...) {
+          std::scoped_lock lock(s->latch_);
+          if (s->error_ == nullptr) {
+            s->error_ = std::current_exception();
+          }
+          s->next_ = s->num_tasks_;
+        }
+      }
+    };
+
+    auto &scheduler = TaskScheduler::Instance();
+    for (size_t i = 1; i < num_workers; i++) {
+      scheduler.Submit([state, work] {
+        state->active_++;
+        if (state->next_ < state->num_tasks_) {
+          work(state.get());
+        }
+        if (--state->active_ == 0) {
+          std::scoped_lock lock(state->latch_);
+          state->done_.notify_all();
+        }
+      });
+    }
+    work(state.get());
+    std::unique_lock lock(state->latch_);
+    state->done_.wait(lock, [&] { return state->active_ == 0; });
+    if (state->error_ != nullptr) {
+      std::rethrow_exception(state->error_);
+    }
+  }
+};
+
+}  // namespace bustub
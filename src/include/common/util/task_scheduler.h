@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler.h
+//
+// Identification: src/include/common/util/task_scheduler.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TaskScheduler is a pool of worker threads with one task deque per worker.
+ *
+ * Tasks submitted by a worker go to the back of its own deque and are taken back LIFO, so nested
+ * parallel work stays on the worker that created it. Tasks submitted from other threads go to a
+ * shared FIFO queue, so concurrent queries are served in the order they asked for help. An idle
+ * worker first drains its own deque, then the shared queue, then steals from the front of the
+ * other workers' deques.
+ */
+class TaskScheduler {
+ public:
+  using Task = std::function<void()>;
+
+  /** @return the process-wide scheduler, with one worker per hardware thread */
+  static auto Instance() -> TaskScheduler &;
+
+  /**
+   * Start a scheduler.
+   * @param num_workers the number of worker threads
+   */
+  explicit TaskScheduler(size_t num_workers);
+
+  /** Runs the tasks still queued and stops the workers */
+  ~TaskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(TaskScheduler);
+
+  /** @return the number of worker threads */
+  auto NumWorkers() const -> size_t { return threads_.size(); }
+
+  /**
+   * Queue a task to run on a worker thread. The task must not throw.
+   * @param task the task to run
+   */
+  void Submit(Task task);
+
+  /** @return the number of tasks a worker took from another worker's deque */
+  auto NumSteals() const -> size_t { return num_steals_; }
+
+ private:
+  struct TaskQueue {
+    std::mutex latch_;
+    std::deque<Task> tasks_;
+  };
+
+  /** The loop of a worker thread */
+  void WorkerLoop(size_t worker_id);
+
+  /** @return `true` if a task was taken for the worker, own deque first, then the shared queue, then stealing */
+  auto TakeTask(size_t worker_id, Task *task) -> bool;
+
+  /** One deque per worker */
+  std::vector<std::unique_ptr<TaskQueue>> worker_queues_;
+  /** The tasks submitted by threads that are not workers of this scheduler */
+  TaskQueue shared_queue_;
+  std::vector<std::thread> threads_;
+
+  /** Protects num_pending_ and stop_, workers sleep on cv_ while there is nothing pending */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  size_t num_pending_{0};
+  bool stop_{false};
+  std::atomic<size_t> num_steals_{0};
+};
+
+}  // namespace bustub
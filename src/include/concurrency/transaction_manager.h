@@ -13,6 +13,8 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
+#include <set>
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -77,6 +79,12 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * @return the id of the oldest transaction that has not committed or aborted yet, or the id the next
+   * transaction will get if none is running. A tuple deleted by an older transaction stays deleted.
+   */
+  auto GetOldestRunningTxnId() -> txn_id_t;
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -84,6 +92,9 @@ class TransactionManager {
   void ResumeTransactions();
 
  private:
+  /** Remove a committed or aborted transaction from the running transactions */
+  void FinishRunning(Transaction *txn);
+
   /**
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
@@ -140,6 +151,10 @@ class TransactionManager {
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** The ids of the transactions that have begun and not committed or aborted yet */
+  std::set<txn_id_t> running_txns_;
+  std::mutex running_txns_latch_;
 };
 
 }  // namespace bustub
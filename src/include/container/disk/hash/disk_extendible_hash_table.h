@@ -30,6 +30,11 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * Concurrency is handled with page latches only. Lookups, inserts and removes
+ * hold the directory page's read latch until the target bucket is latched, so
+ * operations on different buckets proceed in parallel. Splits (including
+ * directory doubling) and merges take the directory page's write latch.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -110,7 +115,7 @@ class DiskExtendibleHashTable {
    * @param dir_page to use for lookup of global depth
    * @return the directory index
    */
-  auto KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t;
+  auto KeyToDirectoryIndex(KeyType key, const HashTableDirectoryPage *dir_page) -> uint32_t;
 
   /**
    * Get the bucket page_id corresponding to a key.
@@ -119,22 +124,19 @@ class DiskExtendibleHashTable {
    * @param dir_page a pointer to the hash table's directory page
    * @return the bucket page_id corresponding to the input key
    */
-  auto KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t;
+  auto KeyToPageId(KeyType key, const HashTableDirectoryPage *dir_page) -> page_id_t;
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Splits the bucket at bucket_idx into itself and a new split image, doubling the
+   * directory first if the bucket's local depth equals the global depth.
+   * The caller must hold the directory page's write latch and the bucket's write latch.
    *
-   * @return a pointer to the directory page
+   * @param dir_page the directory page
+   * @param bucket_idx directory index of the bucket to split
+   * @param bucket the bucket to split
+   * @return false if the directory is already at its maximum size
    */
-  auto FetchDirectoryPage() -> HashTableDirectoryPage *;
-
-  /**
-   * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
-   *
-   * @param bucket_page_id the page_id to fetch
-   * @return a pointer to a bucket page
-   */
-  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+  auto SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, HASH_TABLE_BUCKET_TYPE *bucket) -> bool;
 
   /**
    * Performs insertion with an optional bucket splitting.
@@ -166,8 +168,6 @@ class DiskExtendibleHashTable {
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
-  ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
 
@@ -12,8 +12,12 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -24,12 +28,19 @@
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
+#define LINEAR_PROBE_HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
 
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Slot s of the table lives in block s / BLOCK_ARRAY_SIZE of the header page at offset
+ * s % BLOCK_ARRAY_SIZE. Inserts, removes and lookups share the table latch and coordinate on
+ * the block pages through the atomic occupied/readable bits only. Removes leave tombstones
+ * behind; once the load factor (tombstones included) passes 3/4 or the tombstones pass 1/4 of
+ * the slots, a background thread rebuilds the table into fresh pages, doubling it when the live
+ * entries need the room. The rebuild holds the table latch exclusively.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -45,6 +56,9 @@ class LinearProbeHashTable {
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                 const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
 
+  /** Waits for a pending background rebuild. */
+  ~LinearProbeHashTable();
+
   /**
    * Inserts a key-value pair into the hash table.
    * @param transaction the current transaction
@@ -85,12 +99,28 @@ class LinearProbeHashTable {
   auto GetSize() -> size_t;
 
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
+  /**
+   * Walks the probe sequence of key in the table described by header_page, starting at the home
+   * slot of the key and stopping after one full round. visit(block, offset) returns true to stop.
+   * BlockPage is `const HASH_TABLE_BLOCK_TYPE` for lookups, so the visited block pages stay clean, and
+   * HASH_TABLE_BLOCK_TYPE for inserts and removes, which may modify them.
+   * @return true if visit stopped the walk, false if every slot was visited
+   */
+  template <typename BlockPage, typename Visitor>
+  auto Probe(const HashTableHeaderPage *header_page, const KeyType &key, Visitor &&visit) -> bool;
+
+  /** @return the number of slots a rebuild should produce for a table of size slots, 0 if none is needed */
+  auto RebuildTarget(size_t size) const -> size_t;
+
+  /** Rebuilds the table into num_slots slots, dropping tombstones. The table latch must be held exclusively. */
+  void Rebuild(size_t num_slots);
+
+  /** Starts a background rebuild unless one is already pending. */
+  void ScheduleRebuild();
+
   void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
+  void DeleteBlockPages(const HashTableHeaderPage *old_header_page);
   void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   // member variable
   page_id_t header_page_id_;
@@ -102,6 +132,20 @@ class LinearProbeHashTable {
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  // inserts of the same key serialize on a stripe so that the duplicate check and the claim of a slot
+  // cannot interleave with another insert of the same pair
+  static constexpr size_t NUM_INSERT_STRIPES = 64;
+  std::array<std::mutex, NUM_INSERT_STRIPES> insert_stripes_;
+
+  // live pairs and tombstones in the current table, drive the rebuild policy
+  std::atomic<size_t> num_readable_{0};
+  std::atomic<size_t> num_tombstones_{0};
+
+  // at most one background rebuild is pending at a time
+  std::atomic<bool> rebuild_scheduled_{false};
+  std::mutex rebuild_thread_mutex_;
+  std::thread rebuild_thread_;
 };
 
 }  // namespace bustub
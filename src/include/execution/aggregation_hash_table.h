@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_hash_table.h
+//
+// Identification: src/include/execution/aggregation_hash_table.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "execution/plans/aggregation_plan.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * AggregationHashTable maps group keys to running aggregates.
+ *
+ * Groups are stored in flat rows of a single array, each row holding the group-by values followed
+ * by one aggregate state per aggregate, so adding a group does not allocate per key or per state.
+ * The rows are indexed by an open-addressing table of row numbers. NULL group-by values are
+ * grouped together.
+ */
+class AggregationHashTable {
+ public:
+  /**
+   * Create an empty table.
+   * @param agg_types the types of the aggregates
+   * @param num_keys the number of group-by values of every group
+   */
+  AggregationHashTable(std::vector<AggregationType> agg_types, size_t num_keys)
+      : agg_types_(std::move(agg_types)), num_keys_(num_keys), width_(num_keys + agg_types_.size()) {}
+
+  /** @return the hash of the group-by values of a group */
+  static auto HashKeys(const Value *keys, size_t num_keys) -> uint64_t;
+
+  /** @return the initial aggregate states, e.g. 0 for COUNT(*) and NULL for the others */
+  static auto InitialStates(const std::vector<AggregationType> &agg_types) -> std::vector<Value>;
+
+  /**
+   * Combine one input row into its group, creating the group if needed.
+   * @param hash the hash of the group-by values
+   * @param keys the group-by values of the row
+   * @param inputs the aggregate arguments of the row, one per aggregate
+   */
+  void Combine(uint64_t hash, const Value *keys, const Value *inputs);
+
+  /**
+   * Merge the aggregate states of a group produced by another table into its group here.
+   * @param hash the hash of the group-by values
+   * @param keys the group-by values of the group
+   * @param states the aggregate states of the group, one per aggregate
+   */
+  void Merge(uint64_t hash, const Value *keys, const Value *states);
+
+  /** @return the number of groups */
+  auto Size() const -> size_t { return hashes_.size(); }
+
+  /** @return the number of values in a group row, the group-by values followed by the aggregate states */
+  auto RowWidth() const -> size_t { return width_; }
+
+  /** @return the row of a group, RowWidth() values */
+  auto GetRow(size_t group) const -> const Value * { return &rows_[group * width_]; }
+
+  /** @return the hash of the group-by values of a group */
+  auto GetHash(size_t group) const -> uint64_t { return hashes_[group]; }
+
+  /** @return the estimated memory used by the table in bytes */
+  auto MemoryUsage() const -> size_t;
+
+  /** Remove all groups and release their memory */
+  void Clear();
+
+ private:
+  static constexpr uint32_t EMPTY_SLOT = std::numeric_limits<uint32_t>::max();
+
+  /** @return the aggregate states of the group with the given keys, inserting a new group if there is none */
+  auto FindOrInsert(uint64_t hash, const Value *keys) -> Value *;
+
+  /** Doubles the open-addressing table */
+  void Grow();
+
+  std::vector<AggregationType> agg_types_;
+  size_t num_keys_;
+  size_t width_;
+  /** The group rows, width_ values each */
+  std::vector<Value> rows_;
+  /** The hash of every group */
+  std::vector<uint64_t> hashes_;
+  /** The open-addressing table of group numbers, its capacity is a power of two */
+  std::vector<uint32_t> slots_;
+  /** The bytes of variable-length group-by values and states */
+  size_t var_bytes_{0};
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -22,6 +23,7 @@
 #include "execution/executor_factory.h"
 #include "execution/executors/init_check_executor.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -43,16 +45,17 @@ class ExecutionEngine {
   DISALLOW_COPY_AND_MOVE(ExecutionEngine);
 
   /**
-   * Execute a query plan.
+   * Execute a query plan, handing the result to a callback one batch at a time as it is produced.
+   * The next batch is only produced after the callback returned, so the result is never held in full.
    * @param plan The query plan to execute
-   * @param result_set The set of tuples produced by executing the plan
+   * @param on_batch Called with every batch of result rows, returns `false` to stop the execution early
    * @param txn The transaction context in which the query executes
    * @param exec_ctx The executor context in which the query executes
    * @return `true` if execution of the query plan succeeds, `false` otherwise
    */
   // NOLINTNEXTLINE
-  auto Execute(const AbstractPlanNodeRef &plan, std::vector<Tuple> *result_set, Transaction *txn,
-               ExecutorContext *exec_ctx) -> bool {
+  auto Execute(const AbstractPlanNodeRef &plan, const std::function<bool(const TupleBatch &)> &on_batch,
+               Transaction *txn, ExecutorContext *exec_ctx) -> bool {
     BUSTUB_ASSERT((txn == exec_ctx->GetTransaction()), "Broken Invariant");
 
     // Construct the executor for the abstract plan node
@@ -63,18 +66,43 @@ class ExecutionEngine {
 
     try {
       executor->Init();
-      PollExecutor(executor.get(), plan, result_set);
+      PollExecutor(executor.get(), plan, on_batch);
       PerformChecks(exec_ctx);
     } catch (const ExecutionException &ex) {
       executor_succeeded = false;
-      if (result_set != nullptr) {
-        result_set->clear();
-      }
     }
 
     return executor_succeeded;
   }
 
+  /**
+   * Execute a query plan.
+   * @param plan The query plan to execute
+   * @param result_set The set of tuples produced by executing the plan
+   * @param txn The transaction context in which the query executes
+   * @param exec_ctx The executor context in which the query executes
+   * @return `true` if execution of the query plan succeeds, `false` otherwise
+   */
+  // NOLINTNEXTLINE
+  auto Execute(const AbstractPlanNodeRef &plan, std::vector<Tuple> *result_set, Transaction *txn,
+               ExecutorContext *exec_ctx) -> bool {
+    auto executor_succeeded = Execute(
+        plan,
+        [result_set](const TupleBatch &batch) {
+          if (result_set != nullptr) {
+            for (auto row : batch.GetSelection()) {
+              result_set->push_back(batch.GetTuple(row));
+            }
+          }
+          return true;
+        },
+        txn, exec_ctx);
+    if (!executor_succeeded && result_set != nullptr) {
+      result_set->clear();
+    }
+    return executor_succeeded;
+  }
+
   void PerformChecks(ExecutorContext *exec_ctx) {
     for (const auto &[left_executor, right_executor] : exec_ctx->GetNLJCheckExecutorSet()) {
       auto casted_left_executor = dynamic_cast<const InitCheckExecutor *>(left_executor);
@@ -87,18 +115,17 @@ class ExecutionEngine {
 
  private:
   /**
-   * Poll the executor until exhausted, or exception escapes.
+   * Poll the executor a batch at a time until exhausted, the callback stops it, or exception escapes.
    * @param executor The root executor
    * @param plan The plan to execute
-   * @param result_set The tuple result set
+   * @param on_batch The callback the batches are handed to
    */
   static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
-                           std::vector<Tuple> *result_set) {
-    RID rid{};
-    Tuple tuple{};
-    while (executor->Next(&tuple, &rid)) {
-      if (result_set != nullptr) {
-        result_set->push_back(tuple);
+                           const std::function<bool(const TupleBatch &)> &on_batch) {
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+      if (!batch.IsEmpty() && !on_batch(batch)) {
+        return;
       }
     }
   }
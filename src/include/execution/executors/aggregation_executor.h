@@ -13,140 +13,30 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include "common/util/hash_util.h"
-#include "container/hash/hash_function.h"
+#include "execution/aggregation_hash_table.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/aggregation_plan.h"
+#include "storage/table/spill_file.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
-/**
- * A simplified hash table that has all the necessary functionality for aggregations.
- */
-class SimpleAggregationHashTable {
- public:
-  /**
-   * Construct a new SimpleAggregationHashTable instance.
-   * @param agg_exprs the aggregation expressions
-   * @param agg_types the types of aggregations
-   */
-  SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return The initial aggregate value for this aggregation executor */
-  auto GenerateInitialAggregateValue() -> AggregateValue {
-    std::vector<Value> values{};
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountStarAggregate:
-          // Count start starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::CountAggregate:
-        case AggregationType::SumAggregate:
-        case AggregationType::MinAggregate:
-        case AggregationType::MaxAggregate:
-          // Others starts at null.
-          values.emplace_back(ValueFactory::GetNullValueByType(TypeId::INTEGER));
-          break;
-      }
-    }
-    return {values};
-  }
-
-  /**
-   * TODO(Student)
-   *
-   * Combines the input into the aggregation result.
-   * @param[out] result The output aggregate value
-   * @param input The input value
-   */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountStarAggregate:
-        case AggregationType::CountAggregate:
-        case AggregationType::SumAggregate:
-        case AggregationType::MinAggregate:
-        case AggregationType::MaxAggregate:
-          break;
-      }
-    }
-  }
-
-  /**
-   * Inserts a value into the hash table and then combines it with the current aggregation.
-   * @param agg_key the key to be inserted
-   * @param agg_val the value to be inserted
-   */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
-    }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
-  }
-
-  /**
-   * Clear the hash table
-   */
-  void Clear() { ht_.clear(); }
-
-  /** An iterator over the aggregation hash table */
-  class Iterator {
-   public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_{iter} {}
-
-    /** @return The key of the iterator */
-    auto Key() -> const AggregateKey & { return iter_->first; }
-
-    /** @return The value of the iterator */
-    auto Val() -> const AggregateValue & { return iter_->second; }
-
-    /** @return The iterator before it is incremented */
-    auto operator++() -> Iterator & {
-      ++iter_;
-      return *this;
-    }
-
-    /** @return `true` if both iterators are identical */
-    auto operator==(const Iterator &other) -> bool { return this->iter_ == other.iter_; }
-
-    /** @return `true` if both iterators are different */
-    auto operator!=(const Iterator &other) -> bool { return this->iter_ != other.iter_; }
-
-   private:
-    /** Aggregates map */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
-  };
-
-  /** @return Iterator to the start of the hash table */
-  auto Begin() -> Iterator { return Iterator{ht_.cbegin()}; }
-
-  /** @return Iterator to the end of the hash table */
-  auto End() -> Iterator { return Iterator{ht_.cend()}; }
-
- private:
-  /** The hash table is just a map from aggregate keys to aggregate values */
-  std::unordered_map<AggregateKey, AggregateValue> ht_{};
-  /** The aggregate expressions that we have */
-  const std::vector<AbstractExpressionRef> &agg_exprs_;
-  /** The types of aggregations that we have */
-  const std::vector<AggregationType> &agg_types_;
-};
-
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * Every worker pre-aggregates the child batches it is given into its own set of hash tables, one
+ * per hash partition of the groups. When the groups held by all workers exceed the memory budget,
+ * the largest partition is written to temp pages as partial aggregates. At the end the workers'
+ * tables of every partition are merged in parallel, spilled partitions are merged with their
+ * temp pages one at a time while the output is produced. A spilled partition whose groups still
+ * exceed the budget while it is reloaded is split again by a hash with another seed, recursively.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -170,6 +60,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the aggregation.
+   * @param[out] batch The batch filled with the next groups produced by the aggregation
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -195,14 +92,70 @@ class AggregationExecutor : public AbstractExecutor {
     return {vals};
   }
 
+  /** Combines the selected rows of a child batch into the hash tables of one worker */
+  void ConsumeBatch(const TupleBatch &batch, std::vector<AggregationHashTable> *tables);
+
+  /** @return The memory used by the hash tables of all workers */
+  auto MemoryUsage() const -> size_t;
+
+  /** Writes the groups of one partition held by all workers to the partition's spill file */
+  void SpillPartition(size_t partition);
+
+  /** Merges the groups of one partition held by all workers and in its spill file into its result table */
+  void MergePartition(size_t partition);
+
+  /** @return the partition of a group's hash when a spilled partition is split for the level-th time */
+  static auto RepartitionOf(uint64_t hash, size_t level) -> size_t;
+
+  /** Writes a group row to a spill file, converting the aggregate states to the types of the spill schema */
+  void AppendGroup(const Value *row, SpillFile *file);
+
+  /**
+   * Merges the partial aggregates of a spill file into a result table. If the table exceeds the memory budget
+   * before the file is read to its end, the table and the rest of the file are repartitioned into pending_.
+   * @param file the spill file, deleted once it is read
+   * @param level the number of times the groups in the file were repartitioned, 0 for a partition of Init
+   * @param result the table the groups are merged into
+   */
+  void LoadSpillFile(std::unique_ptr<SpillFile> file, size_t level, AggregationHashTable *result);
+
+  /** @return `true` if the output cursor points at a group, merging spilled partitions as it reaches them */
+  auto AdvanceToGroup() -> bool;
+
+  /** @return The output row of the group the cursor points at */
+  auto MakeOutputValues() -> std::vector<Value>;
+
+  /** The number of hash partitions of the groups */
+  static constexpr size_t NUM_PARTITIONS = 16;
+  /** The partition of a group is the top bits of its hash, the hash tables address slots with the low bits */
+  static constexpr size_t PARTITION_SHIFT = 60;
+  /** The number of times a spilled partition may be split again, after that it is loaded whatever its size */
+  static constexpr size_t MAX_SPILL_LEVEL = 8;
+
  private:
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  // TODO(Student): Uncomment SimpleAggregationHashTable aht_;
-  /** Simple aggregation hash table iterator */
-  // TODO(Student): Uncomment SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The child batches consumed in the current round, one per worker */
+  std::vector<TupleBatch> batches_;
+  /** The pre-aggregation tables of every worker, one per partition */
+  std::vector<std::vector<AggregationHashTable>> local_tables_;
+  /** The merged groups of every partition */
+  std::vector<AggregationHashTable> results_;
+  /** The partial aggregates spilled for every partition, nullptr if the partition never spilled */
+  std::vector<std::unique_ptr<SpillFile>> spill_files_;
+  /** The repartitioned pieces of the spilled partition being output, with their repartitioning level */
+  std::vector<std::pair<std::unique_ptr<SpillFile>, size_t>> pending_;
+  /** The schema of the spilled partial aggregates: the group-by values followed by the aggregate states */
+  std::unique_ptr<Schema> spill_schema_;
+  /** The memory the groups may use before partitions spill */
+  size_t memory_budget_{0};
+  /** The partition the output cursor is in */
+  size_t out_partition_{0};
+  /** The group the output cursor points at within its partition */
+  size_t out_group_{0};
+  /** `true` if there are no group-bys and no input, so a single row of initial aggregates is produced */
+  bool emit_initial_{false};
 };
 }  // namespace bustub
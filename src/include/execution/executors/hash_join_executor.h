@@ -14,16 +14,27 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/join_hash_table.h"
 #include "execution/plans/hash_join_plan.h"
+#include "storage/table/spill_file.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a hash JOIN on two tables. The right child is the build side and
+ * the left child is the probe side. The build side goes into a radix partitioned JoinHashTable,
+ * and the probe side is joined in rounds of several batches that are probed in parallel.
+ *
+ * When the build side exceeds hash_join_memory_budget, the join turns into a hybrid hash join:
+ * both inputs are hash partitioned, partitions stay resident while they fit the budget and the
+ * largest ones spill to temp pages otherwise. Spilled partitions are joined afterwards the same
+ * way with a different hash, and partitions that still do not fit after MAX_SPILL_LEVEL rounds,
+ * e.g. because of a single heavily duplicated key, are joined one budget-sized chunk at a time.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -48,12 +59,157 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the join.
+   * @param[out] batch The batch filled with the next joined tuples
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** The number of partitions a spilling join splits its inputs into at every level */
+  static constexpr size_t SPILL_FANOUT = 16;
+  /** The number of times a spilled partition is repartitioned before it is joined chunk by chunk */
+  static constexpr uint32_t MAX_SPILL_LEVEL = 3;
+
+  /** A hash partition of a join that exceeded the memory budget */
+  struct JoinPartition {
+    /** The resident build rows, empty once the partition spilled */
+    std::vector<HashJoinKey> keys_;
+    std::vector<std::vector<Value>> rows_;
+    /** The estimated memory used by the resident build rows */
+    size_t bytes_{0};
+    /** The hash table over the resident build rows, built once the build side is exhausted */
+    std::unique_ptr<JoinHashTable> table_;
+    /** The spilled build and probe rows, nullptr while the partition is resident */
+    std::unique_ptr<SpillFile> build_file_;
+    std::unique_ptr<SpillFile> probe_file_;
+  };
+
+  /** A spilled partition, joined after the probe input it was split from is exhausted */
+  struct SpilledJoin {
+    std::unique_ptr<SpillFile> build_file_;
+    std::unique_ptr<SpillFile> probe_file_;
+    /** The partitioning level of the rows in the files */
+    uint32_t level_;
+  };
+
+  /** @return The key values of each selected row of a batch, evaluated column by column */
+  static auto MakeJoinKeys(const std::vector<AbstractExpressionRef> &exprs, const TupleBatch &batch)
+      -> std::vector<HashJoinKey>;
+
+  /** Pulls up to one batch per worker from the probe side and joins them in parallel into round_rows_ */
+  void ProbeRound();
+
+  /** Appends the joined rows of every selected row of a probe side batch to out */
+  void ProbeBatch(const TupleBatch &left, std::vector<std::vector<Value>> *out) const;
+
+  /**
+   * Appends the join of a left row with its matches in a table to out.
+   * @return `true` if the row has any match
+   */
+  auto ProbeRow(const JoinHashTable &table, const HashJoinKey &key, const std::vector<Value> &left,
+                std::vector<std::vector<Value>> *out) const -> bool;
+
+  /** Appends a left row padded with NULLs to out if this is a left join */
+  void EmitUnmatched(std::vector<Value> left, std::vector<std::vector<Value>> *out) const;
+
+  /** Starts hash partitioning the build rows of the given level */
+  void StartPartitioning(uint32_t level);
+
+  /** Adds a build row to its partition, spilling the largest resident partitions if over budget */
+  void AddBuildRow(HashJoinKey key, std::vector<Value> row);
+
+  /** Moves the resident rows of a partition into its build file */
+  void SpillPartition(JoinPartition *partition);
+
+  /** Builds the hash tables of the resident partitions once all build rows were added */
+  void FinishPartitioning();
+
+  /** Joins a probe row with its resident partition, or appends it to the probe file of a spilled one */
+  void RouteProbeRow(HashJoinKey key, std::vector<Value> row);
+
+  /**
+   * Makes progress on a spilled join, appending any joined rows to round_rows_.
+   * @return `false` once every partition has been joined
+   */
+  auto SpillStep() -> bool;
+
+  /** Starts joining the next deferred partition. @return `false` if there is none */
+  auto NextSpilledJoin() -> bool;
+
+  /** Makes progress on a partition joined chunk by chunk. @return `false` once it is done */
+  auto ChunkStep() -> bool;
+
+  /** Loads the next budget-sized chunk of chunk_build_ into chunk_table_ */
+  void LoadChunk();
+
+  /** Reads the key and the values of a spilled tuple */
+  static auto DecodeSpilled(const Tuple &tuple, const Schema &schema, const std::vector<AbstractExpressionRef> &exprs,
+                            HashJoinKey *key) -> std::vector<Value>;
+
+  /** @return the partition of a key hash at the given level */
+  auto PartitionOf(uint64_t hash, uint32_t level) const -> size_t;
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
+  /** The child executor on the probe side */
+  std::unique_ptr<AbstractExecutor> left_child_;
+  /** The child executor on the build side */
+  std::unique_ptr<AbstractExecutor> right_child_;
+
+  /** The build side hash table */
+  JoinHashTable jht_;
+  /** NULL values for every right column, emitted by a left join when a left tuple has no match */
+  std::vector<Value> right_nulls_;
+
+  /** The probe side batches of the current round, one per worker */
+  std::vector<TupleBatch> left_batches_;
+  /** The joined rows of the current round, in probe side order */
+  std::vector<std::vector<Value>> round_rows_;
+  /** The next row of round_rows_ to emit */
+  size_t round_pos_{0};
+  /** Whether the probe side is exhausted */
+  bool left_done_{false};
+
+  /** Whether the build side exceeded the memory budget, and the join is partitioned */
+  bool spilled_{false};
+  /** The memory budget of the build side in bytes */
+  size_t memory_budget_{0};
+  /** The number of partitions at every level */
+  size_t num_partitions_{0};
+  /** The partitioning level currently being joined, 0 for the input of the children */
+  uint32_t level_{0};
+  /** The partitions of the current level */
+  std::vector<JoinPartition> partitions_;
+  /** The estimated memory used by the resident partitions */
+  size_t resident_bytes_{0};
+  /** The spilled partitions not joined yet */
+  std::vector<SpilledJoin> pending_;
+  /** The probe rows of the current level when it is not the left child, and the next page to read */
+  std::unique_ptr<SpillFile> probe_input_;
+  size_t probe_page_{0};
+
+  /** The build rows of a partition joined chunk by chunk, nullptr if there is none */
+  std::unique_ptr<SpillFile> chunk_build_;
+  /** The next page of chunk_build_ to load */
+  size_t chunk_page_{0};
+  /** The hash table over the current chunk */
+  std::unique_ptr<JoinHashTable> chunk_table_;
+  /** Whether each row of probe_input_ matched any chunk so far */
+  std::vector<bool> probe_matched_;
+  /** The index in probe_input_ of the next probe row */
+  size_t probe_row_{0};
+  /** Whether the last pass over probe_input_ emitting its unmatched rows for a left join is running */
+  bool unmatched_pass_{false};
+
+  /** The output batch drained one tuple at a time by Next() */
+  TupleBatch out_batch_;
+  /** The position in the selection vector of out_batch_ of the next tuple returned by Next() */
+  uint32_t out_pos_{0};
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -42,7 +43,22 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Build the key tuple of a constant bound of the scan. */
+  auto MakeKeyTuple(const AbstractExpressionRef &bound) const -> Tuple;
+
+  /** Build the index key of a constant bound of the scan. */
+  auto MakeKey(const AbstractExpressionRef &bound) const -> IntegerKeyType;
+
+  /** Produce the next rid from the index, false once the scan is exhausted. */
+  auto NextRid(RID *rid) -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  const IndexInfo *index_info_{nullptr};
+  const TableInfo *table_info_{nullptr};
+  BPlusTreeIndexIteratorForTwoIntegerColumn iter_;
+  /** Matches of a point lookup on a hash index */
+  std::vector<RID> rids_;
+  size_t rid_cursor_{0};
 };
 }  // namespace bustub
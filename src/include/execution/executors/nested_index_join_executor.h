@@ -22,6 +22,7 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/nested_index_join_plan.h"
+#include "storage/index/index.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
@@ -48,7 +49,21 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Look up the inner tuples matching the outer tuple through the index. */
+  void ProbeInner(const Tuple &outer_tuple);
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The outer table */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  const IndexInfo *index_info_{nullptr};
+  const TableInfo *inner_table_info_{nullptr};
+
+  /** The current outer tuple and the inner tuples it joins with */
+  Tuple outer_tuple_;
+  std::vector<Tuple> inner_tuples_;
+  size_t inner_cursor_{0};
+  /** Set while the outer tuple of a left join had no match and still has to be emitted null padded */
+  bool pending_null_row_{false};
 };
 }  // namespace bustub
@@ -12,17 +12,28 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_expression.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/morsel_queue.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * The batch path scans morsels of the table in parallel: every round hands one morsel to each
+ * worker, the workers read and filter their morsel into batches, and the batches are returned in
+ * morsel order, so the output order is the same as that of a serial scan. A table in the PAX format
+ * is scanned column by column from the minipages of its pages. Only the columns the plan outputs and
+ * the columns its filter predicate reads are decoded.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -44,11 +55,48 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan.
+   * @param[out] batch The batch filled with the next tuples of the table
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
+  /** @return The number of pages the batch path has read so far, pages skipped through the zone map are not counted */
+  auto GetNumPagesScanned() const -> size_t { return num_pages_scanned_; }
+
  private:
+  /** @return `true` if the tuple satisfies the pushed-down filter predicate */
+  auto Accept(const Tuple &tuple) const -> bool;
+
+  /** Reads the live tuples of a morsel that satisfy the filter predicate into batches */
+  void ScanMorsel(const Morsel &morsel, std::vector<TupleBatch> *batches) const;
+
+  /** ScanMorsel for a PAX table, reads the filter columns first and the output columns only for qualifying tuples */
+  void ScanPaxMorsel(const Morsel &morsel, std::vector<TupleBatch> *batches) const;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  const TableInfo *table_info_{nullptr};
+  /** The iterator over the table heap, created by Init() */
+  std::optional<TableIterator> iter_;
+  /** The compiled filter predicate, nullptr if there is none or it cannot be compiled */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The table column of every output column */
+  std::vector<uint32_t> column_ids_;
+  /** For every table column, whether the filter predicate reads it */
+  std::vector<bool> predicate_columns_;
+  /** The morsels of the table heap for the batch path, created by Init() */
+  std::optional<MorselQueue> morsels_;
+  /** The batches scanned in the current round, in morsel order */
+  std::vector<TupleBatch> ready_batches_;
+  /** The next batch of ready_batches_ to return */
+  size_t ready_pos_{0};
+  /** The number of pages in the morsels handed out so far */
+  size_t num_pages_scanned_{0};
 };
 }  // namespace bustub
@@ -17,6 +17,7 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/external_sort.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
 #include "storage/table/tuple.h"
@@ -24,7 +25,8 @@
 namespace bustub {
 
 /**
- * The SortExecutor executor executes a sort.
+ * The SortExecutor executor executes a sort. Rows are sorted by an ExternalSorter, which spills
+ * sorted runs to temp pages once the buffered rows exceed sort_memory_budget.
  */
 class SortExecutor : public AbstractExecutor {
  public:
@@ -46,11 +48,22 @@ class SortExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sort.
+   * @param[out] batch The batch filled with the next sorted tuples
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sort */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
   /** The sort plan node to be executed */
   const SortPlanNode *plan_;
+  /** The child executor whose tuples are sorted */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The sorter holding the sorted tuples */
+  std::unique_ptr<ExternalSorter> sorter_;
 };
 }  // namespace bustub
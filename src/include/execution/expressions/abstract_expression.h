@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 
@@ -65,6 +66,21 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Evaluates the expression over every selected row of a batch. The default implementation materializes
+   * each row and calls Evaluate(); expressions override it to work on whole columns instead.
+   * @param batch The input batch, whose schema is the schema the expression is bound to
+   * @param[out] result One value per selected row, in the order of the selection vector
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const {
+    result->clear();
+    result->reserve(batch.Size());
+    for (auto row : batch.GetSelection()) {
+      Tuple tuple = batch.GetTuple(row);
+      result->push_back(Evaluate(&tuple, batch.GetSchema()));
+    }
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
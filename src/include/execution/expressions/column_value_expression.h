@@ -45,6 +45,15 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(&right_schema, col_idx_);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    const auto &column = batch.GetColumn(col_idx_);
+    result->clear();
+    result->reserve(batch.Size());
+    for (auto row : batch.GetSelection()) {
+      result->push_back(column[row]);
+    }
+  }
+
   auto GetTupleIdx() const -> uint32_t { return tuple_idx_; }
   auto GetColIdx() const -> uint32_t { return col_idx_; }
 
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.h
+//
+// Identification: src/include/execution/expressions/compiled_expression.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * CompiledExpression is an expression tree lowered into a flat register program.
+ *
+ * Column references, constants, comparisons, arithmetic and logic over the fixed-size integer and
+ * boolean types are supported. Registers hold raw int64_t values plus a NULL flag, and columns are
+ * read straight from the tuple bytes, so evaluating a program never constructs a Value. The results
+ * follow the same NULL semantics as AbstractExpression::Evaluate.
+ */
+class CompiledExpression {
+ public:
+  /** The maximum number of registers a program may use */
+  static constexpr uint32_t MAX_REGISTERS = 16;
+
+  /**
+   * Compiles an expression for tuples of the given schema.
+   * @param expr the expression to compile, its column references must all have tuple index 0
+   * @param schema the schema of the tuples the expression is evaluated on
+   * @return the compiled program, or nullptr if the expression contains a node or a type that is not supported
+   */
+  static auto Compile(const AbstractExpression &expr, const Schema &schema) -> std::unique_ptr<CompiledExpression>;
+
+  /** @return the type of the value the program produces */
+  auto GetReturnType() const -> TypeId { return ret_type_; }
+
+  /** @return the value of the expression on a tuple */
+  auto Evaluate(const TupleView &tuple) const -> Value;
+  auto Evaluate(const Tuple &tuple) const -> Value { return Evaluate(TupleView(tuple)); }
+
+  /** @return `true` if a boolean expression holds on a tuple, NULL counts as false */
+  auto EvaluatePredicate(const TupleView &tuple) const -> bool;
+  auto EvaluatePredicate(const Tuple &tuple) const -> bool { return EvaluatePredicate(TupleView(tuple)); }
+
+  /** Narrows the selection of a batch to the rows on which a boolean expression holds */
+  void Select(TupleBatch *batch) const;
+
+ private:
+  enum class OpCode : uint8_t {
+    LoadColumn,
+    LoadConstant,
+    Equal,
+    NotEqual,
+    LessThan,
+    LessThanOrEqual,
+    GreaterThan,
+    GreaterThanOrEqual,
+    Plus,
+    Minus,
+    And,
+    Or
+  };
+
+  struct Instruction {
+    OpCode op_;
+    /** The destination register and the operand registers */
+    uint8_t dst_{0};
+    uint8_t lhs_{0};
+    uint8_t rhs_{0};
+    /** LoadColumn: the type, index and byte offset of the column */
+    TypeId type_{TypeId::INVALID};
+    uint32_t col_idx_{0};
+    uint32_t offset_{0};
+    /** LoadConstant: the constant */
+    int64_t imm_{0};
+    bool imm_null_{false};
+  };
+
+  CompiledExpression() = default;
+
+  /** Emits the instructions of expr so that its result ends up in register dst, returns false if unsupported */
+  auto Emit(const AbstractExpression &expr, const Schema &schema, uint32_t dst) -> bool;
+
+  /** Runs the program, the result is left in register 0 */
+  template <class ColumnReader>
+  void Run(const ColumnReader &read, int64_t *regs, bool *nulls) const;
+
+  /** The instructions, in execution order */
+  std::vector<Instruction> program_;
+  /** The type of the value the program produces */
+  TypeId ret_type_{TypeId::INVALID};
+};
+
+}  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parameter_value_expression.h
+//
+// Identification: src/include/execution/expressions/parameter_value_expression.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/expressions/abstract_expression.h"
+#include "fmt/format.h"
+
+namespace bustub {
+/**
+ * ParameterValueExpression is the placeholder `$n` of a prepared statement. It never reaches an executor: EXECUTE
+ * replaces it with a constant before the plan is run.
+ */
+class ParameterValueExpression : public AbstractExpression {
+ public:
+  /**
+   * @param index the position of the parameter, starting from 0 for `$1`
+   * @param ret_type the type of the parameter, INVALID until the planner infers it
+   */
+  ParameterValueExpression(uint32_t index, TypeId ret_type) : AbstractExpression({}, ret_type), index_(index) {}
+
+  auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value override {
+    throw Exception(fmt::format("no value is bound to parameter ${}", index_ + 1));
+  }
+
+  auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
+                    const Schema &right_schema) const -> Value override {
+    throw Exception(fmt::format("no value is bound to parameter ${}", index_ + 1));
+  }
+
+  /** @return the position of the parameter */
+  auto GetIndex() const -> uint32_t { return index_; }
+
+  /** @return the string representation of the plan node and its children */
+  auto ToString() const -> std::string override { return fmt::format("${}", index_ + 1); }
+
+  BUSTUB_EXPR_CLONE_WITH_CHILDREN(ParameterValueExpression);
+
+ private:
+  uint32_t index_;
+};
+}  // namespace bustub
@@ -72,6 +72,13 @@ class StringExpression : public AbstractExpression {
     return ValueFactory::GetVarcharValue(Compute(str));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    GetChildAt(0)->EvaluateBatch(batch, result);
+    for (auto &val : *result) {
+      val = ValueFactory::GetVarcharValue(Compute(val.GetAs<char *>()));
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override { return fmt::format("{}({})", expr_type_, *GetChildAt(0)); }
 
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/execution/external_sort.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_order_by.h"
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/spill_file.h"
+
+namespace bustub {
+
+/**
+ * ExternalSorter sorts rows that may not fit in memory.
+ *
+ * Rows are collected into a buffer until it exceeds the memory budget. A full buffer is cut into
+ * one slice per worker, the slices are sorted in parallel and every slice is written out as a
+ * sorted run to temp pages through the buffer pool. Runs are merged with a loser tree, in
+ * several passes if there are more runs than the merge fan-in. When all rows fit the budget the
+ * sorted slices are merged straight from memory.
+ *
+ * Every row carries an 8 byte normalized prefix of its first sort key that compares as an
+ * unsigned integer in the requested order, so most comparisons never look at the Values. NULL
+ * compares smaller than every other value, so NULLs come first under ASC and last under DESC.
+ * The sort is stable.
+ */
+class ExternalSorter {
+ public:
+  /** The maximum number of runs merged at once */
+  static constexpr size_t MAX_MERGE_FANIN = 64;
+
+  /**
+   * Create an empty sorter.
+   * @param bpm the buffer pool manager runs are spilled to
+   * @param schema the schema of the sorted rows
+   * @param order_bys the sort keys, evaluated on the rows
+   * @param memory_budget the memory in bytes the buffered rows may use before they spill
+   * @param num_workers the number of threads used to sort the runs
+   */
+  ExternalSorter(BufferPoolManager *bpm, const Schema *schema,
+                 std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys, size_t memory_budget,
+                 size_t num_workers);
+
+  /**
+   * Add a row to be sorted.
+   * @param keys the values of the sort keys of the row
+   * @param row the values of the row
+   */
+  void Add(std::vector<Value> keys, std::vector<Value> row);
+
+  /** Sort everything added so far. Must be called once before Next. */
+  void Finish();
+
+  /**
+   * Yield the next row in sort order.
+   * @param[out] row the next row
+   * @return `false` if there are no more rows
+   */
+  auto Next(std::vector<Value> *row) -> bool;
+
+  /** @return the number of sorted runs spilled to temp pages, including intermediate merge passes */
+  auto NumSpilledRuns() const -> size_t { return num_spilled_runs_; }
+
+ private:
+  /** A row with its sort keys */
+  struct Record {
+    /** The normalized prefix of the first sort key */
+    uint64_t prefix_;
+    std::vector<Value> keys_;
+    std::vector<Value> row_;
+  };
+
+  /** A sorted sequence of records, kept in memory or read back page by page from a run */
+  struct Source {
+    /** The records in memory, the whole slice or the page of the run being read */
+    std::vector<Record> records_;
+    size_t pos_{0};
+    /** The spilled run, nullptr for an in-memory slice */
+    std::unique_ptr<SpillFile> run_;
+    size_t next_page_{0};
+  };
+
+  /** @return `true` if a sorts strictly before b */
+  auto Less(const Record &a, const Record &b) const -> bool;
+
+  /** @return the normalized prefix of the given sort keys */
+  auto MakePrefix(const std::vector<Value> &keys) const -> uint64_t;
+
+  /** Evaluates the sort keys of a row read back from a run */
+  auto DecodeRecord(const Tuple &tuple) const -> Record;
+
+  /** Sorts the buffer into one sorted slice per worker, leaving the buffer empty */
+  auto SortBuffer() -> std::vector<std::vector<Record>>;
+
+  /** Writes the sorted slices of the buffer out as runs */
+  void SpillBuffer();
+
+  /** Refills a drained source from its run. @return `false` if the source is exhausted */
+  auto Refill(Source *source) const -> bool;
+
+  /** Sets up the loser tree over merge_sources_ */
+  void BuildLoserTree();
+
+  /** Moves the winner of the loser tree to out and replays its path. @return `false` if all sources are drained */
+  auto PopWinner(std::vector<Value> *out) -> bool;
+
+  /** @return `true` if the head of source i sorts before the head of source j, drained sources sort last */
+  auto SourceLess(size_t i, size_t j) const -> bool;
+
+  BufferPoolManager *bpm_;
+  const Schema *schema_;
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys_;
+  size_t memory_budget_;
+  size_t num_workers_;
+
+  /** The rows added since the last spill */
+  std::vector<Record> buffer_;
+  /** The estimated memory used by buffer_ */
+  size_t buffer_bytes_{0};
+  /** The sorted runs spilled so far */
+  std::vector<std::unique_ptr<SpillFile>> runs_;
+  size_t num_spilled_runs_{0};
+
+  /** The sources of the final merge */
+  std::vector<Source> merge_sources_;
+  /** The loser tree, tree_[0] is the winner and tree_[1..k) the loser at every inner node */
+  std::vector<size_t> tree_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.h
+//
+// Identification: src/include/execution/join_hash_table.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** HashJoinKey represents the values of the join key expressions of one tuple */
+struct HashJoinKey {
+  /** The join key values */
+  std::vector<Value> keys_;
+
+  /** @return `true` if any of the key values is NULL, such a key never matches */
+  auto HasNull() const -> bool {
+    for (const auto &key : keys_) {
+      if (key.IsNull()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Compares two join keys for equality.
+   * @param other the other join key to be compared with
+   * @return `true` if both join keys have equivalent values, `false` otherwise
+   */
+  auto operator==(const HashJoinKey &other) const -> bool {
+    for (uint32_t i = 0; i < other.keys_.size(); i++) {
+      if (keys_[i].CompareEquals(other.keys_[i]) != CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+/**
+ * JoinHashTable is the build side of a hash join.
+ *
+ * The build rows are radix partitioned on the high bits of the key hash so that every partition
+ * stays small enough to be cache resident, and each partition is a flat open-addressing table
+ * indexed by the low bits of the hash. Hashing, partitioning and the per-partition builds run on
+ * several worker threads. Once built, the table is read-only and can be probed concurrently.
+ */
+class JoinHashTable {
+ public:
+  /** The number of build rows a partition aims to hold */
+  static constexpr size_t PARTITION_TARGET_ROWS = 4096;
+  /** The maximum number of radix bits, i.e. at most 1024 partitions */
+  static constexpr uint32_t MAX_RADIX_BITS = 10;
+
+  /**
+   * Creates an empty table.
+   * @param num_workers the number of threads used to build the table
+   */
+  explicit JoinHashTable(size_t num_workers) : num_workers_(num_workers) {}
+
+  /**
+   * Builds the table, replacing its previous content. Rows whose key contains NULL are dropped.
+   * @param keys the join key of each row
+   * @param rows the values of each row, rows[i] has the key keys[i]
+   */
+  void Build(std::vector<HashJoinKey> keys, std::vector<std::vector<Value>> rows);
+
+  /** @return the number of rows in the table */
+  auto Size() const -> size_t { return num_rows_; }
+
+  /** @return the number of radix partitions */
+  auto NumPartitions() const -> size_t { return partitions_.size(); }
+
+  /** @return the hash of a join key, with well mixed high and low bits */
+  static auto HashKey(const HashJoinKey &key) -> uint64_t;
+
+  /**
+   * Calls callback(row) for every row whose key equals the given key.
+   * @param key the probe key, it must not contain NULL
+   * @param callback invoked with the values of each matching row
+   */
+  template <class Callback>
+  void Probe(const HashJoinKey &key, Callback &&callback) const {
+    if (partitions_.empty()) {
+      return;
+    }
+    const uint64_t hash = HashKey(key);
+    const auto &slots = partitions_[PartitionOf(hash)];
+    if (slots.empty()) {
+      return;
+    }
+    const size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      const auto &slot = slots[i];
+      if (slot.row_ == EMPTY_SLOT) {
+        return;
+      }
+      if (slot.hash_ == hash && keys_[slot.row_] == key) {
+        callback(rows_[slot.row_]);
+      }
+    }
+  }
+
+ private:
+  static constexpr uint32_t EMPTY_SLOT = std::numeric_limits<uint32_t>::max();
+
+  struct Slot {
+    uint64_t hash_{0};
+    uint32_t row_{EMPTY_SLOT};
+  };
+
+  auto PartitionOf(uint64_t hash) const -> size_t { return radix_bits_ == 0 ? 0 : hash >> (64 - radix_bits_); }
+
+  /** The number of threads used to build the table */
+  size_t num_workers_;
+  /** The number of high hash bits that select the partition */
+  uint32_t radix_bits_{0};
+  /** The number of rows with a non-NULL key */
+  size_t num_rows_{0};
+  /** The key and the values of every build row, indexed by row number */
+  std::vector<HashJoinKey> keys_;
+  std::vector<std::vector<Value>> rows_;
+  /** One open-addressing table per partition, the capacity of each is a power of two */
+  std::vector<std::vector<Slot>> partitions_;
+};
+
+}  // namespace bustub
@@ -33,21 +33,61 @@ class IndexScanPlanNode : public AbstractPlanNode {
   IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
       : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
 
+  /**
+   * Creates a new index scan plan node over a key range.
+   * @param output the output format of this scan plan node
+   * @param index_oid the identifier of the index to be scanned
+   * @param low_key constant low bound of the first key column, nullptr if unbounded
+   * @param low_inclusive whether the low bound itself is part of the range
+   * @param high_key constant high bound of the first key column, nullptr if unbounded
+   * @param high_inclusive whether the high bound itself is part of the range
+   * @param reverse scan the index in descending key order
+   */
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef low_key, bool low_inclusive,
+                    AbstractExpressionRef high_key, bool high_inclusive, bool reverse)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        low_key_(std::move(low_key)),
+        low_inclusive_(low_inclusive),
+        high_key_(std::move(high_key)),
+        high_inclusive_(high_inclusive),
+        reverse_(reverse) {}
+
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return true if the scan emits keys in descending order */
+  auto IsReverse() const -> bool { return reverse_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /**
+   * Bounds on the first key column, a null expression leaves that side unbounded. The default flags
+   * describe the half open interval [low, high), the same as IndexKeyRange.
+   */
+  AbstractExpressionRef low_key_;
+  bool low_inclusive_{true};
+  AbstractExpressionRef high_key_;
+  bool high_inclusive_{false};
+
+  /** Walk the leaves backwards, from the high bound down to the low bound. */
+  bool reverse_{false};
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    if (low_key_ == nullptr && high_key_ == nullptr && !reverse_) {
+      return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    }
+    return fmt::format("IndexScan {{ index_oid={}, range={}{}, {}{}, reverse={} }}", index_oid_,
+                       low_key_ != nullptr && low_inclusive_ ? "[" : "(",
+                       low_key_ == nullptr ? "-inf" : low_key_->ToString(),
+                       high_key_ == nullptr ? "+inf" : high_key_->ToString(),
+                       high_key_ != nullptr && high_inclusive_ ? "]" : ")", reverse_);
   }
 };
 
@@ -15,6 +15,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "binder/table_ref/bound_base_table_ref.h"
 #include "catalog/catalog.h"
@@ -33,13 +34,15 @@ class SeqScanPlanNode : public AbstractPlanNode {
    * Construct a new SeqScanPlanNode instance.
    * @param output The output schema of this sequential scan plan node
    * @param table_oid The identifier of table to be scanned
+   * @param column_ids The table columns the scan outputs, in output order, empty to output every column
    */
   SeqScanPlanNode(SchemaRef output, table_oid_t table_oid, std::string table_name,
-                  AbstractExpressionRef filter_predicate = nullptr)
+                  AbstractExpressionRef filter_predicate = nullptr, std::vector<uint32_t> column_ids = {})
       : AbstractPlanNode(std::move(output), {}),
         table_oid_{table_oid},
         table_name_(std::move(table_name)),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        column_ids_(std::move(column_ids)) {}
 
   /** @return The type of the plan node */
   auto GetType() const -> PlanType override { return PlanType::SeqScan; }
@@ -47,6 +50,12 @@ class SeqScanPlanNode : public AbstractPlanNode {
   /** @return The identifier of the table that should be scanned */
   auto GetTableOid() const -> table_oid_t { return table_oid_; }
 
+  /** @return The table columns the scan outputs, empty if it outputs every column of the table */
+  auto GetColumnIds() const -> const std::vector<uint32_t> & { return column_ids_; }
+
+  /** @return The table column an output column of the scan is read from */
+  auto GetColumnId(uint32_t col_idx) const -> uint32_t { return column_ids_.empty() ? col_idx : column_ids_[col_idx]; }
+
   static auto InferScanSchema(const BoundBaseTableRef &table_ref) -> Schema;
 
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(SeqScanPlanNode);
@@ -59,15 +68,23 @@ class SeqScanPlanNode : public AbstractPlanNode {
 
   /** The predicate to filter in seqscan. It will ALWAYS be nullptr unless you enable the MergeFilterScan rule.
       You don't need to handle it to get a perfect score in project 3 in Spring 2023.
+      It reads the columns of the table schema, including those the scan does not output.
   */
   AbstractExpressionRef filter_predicate_;
 
+  /** The table columns the scan outputs, set by column pruning. Empty if the scan outputs every column */
+  std::vector<uint32_t> column_ids_;
+
  protected:
   auto PlanNodeToString() const -> std::string override {
+    std::string columns;
+    if (!column_ids_.empty()) {
+      columns = fmt::format(", columns=[{}]", fmt::join(column_ids_, ", "));
+    }
     if (filter_predicate_) {
-      return fmt::format("SeqScan {{ table={}, filter={} }}", table_name_, filter_predicate_);
+      return fmt::format("SeqScan {{ table={}{}, filter={} }}", table_name_, columns, filter_predicate_);
     }
-    return fmt::format("SeqScan {{ table={} }}", table_name_);
+    return fmt::format("SeqScan {{ table={}{} }}", table_name_, columns);
   }
 };
 
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleBatch is the unit of work of the batch-at-a-time execution path (AbstractExecutor::NextBatch).
+ *
+ * A batch holds up to BUSTUB_BATCH_SIZE rows stored column by column, one value vector per column of
+ * its schema. Rows are never removed from a batch; operators such as filters instead shrink the
+ * selection vector, which lists the physical row indices that are still part of the result in order.
+ *
+ * The columns hold Values, not arrays of the raw column type. Expressions, aggregates and hash keys
+ * all operate on Value, and typed arrays would need a second implementation of the operators of every
+ * type. The batch path saves the per-tuple virtual calls and tuple copies instead. Predicates on raw
+ * bytes are left to CompiledExpression, which reads the tuples on the page before they become a batch.
+ */
+class TupleBatch {
+ public:
+  /** Creates an empty batch that is not bound to any schema yet. */
+  TupleBatch() = default;
+
+  /** Creates an empty batch for rows of the given schema. */
+  explicit TupleBatch(const Schema *schema) { Reset(schema); }
+
+  /**
+   * Drops all rows and rebinds the batch to the given schema. Column storage is kept for reuse.
+   * @param schema the schema of the rows that will be appended
+   */
+  void Reset(const Schema *schema);
+
+  /** @return the schema of the rows in this batch */
+  auto GetSchema() const -> const Schema & { return *schema_; }
+
+  /** @return the number of columns of each row */
+  auto ColumnCount() const -> uint32_t { return static_cast<uint32_t>(columns_.size()); }
+
+  /** @return the number of physical rows, including the rows that are no longer selected */
+  auto NumRows() const -> uint32_t { return static_cast<uint32_t>(rids_.size()); }
+
+  /** @return the number of selected rows */
+  auto Size() const -> uint32_t { return static_cast<uint32_t>(sel_.size()); }
+
+  /** @return `true` if no row is selected */
+  auto IsEmpty() const -> bool { return sel_.empty(); }
+
+  /** @return `true` if no more rows can be appended */
+  auto IsFull() const -> bool { return rids_.size() >= static_cast<size_t>(BUSTUB_BATCH_SIZE); }
+
+  /** @return the physical row indices of the selected rows */
+  auto GetSelection() const -> const std::vector<uint32_t> & { return sel_; }
+
+  /** Replaces the selection vector, every entry must be a physical row index of this batch. */
+  void SetSelection(std::vector<uint32_t> sel) { sel_ = std::move(sel); }
+
+  /**
+   * Narrows the selection to the rows for which a predicate holds.
+   * @param predicate one boolean value per selected row, in selection order; NULL counts as false
+   */
+  void Select(const std::vector<Value> &predicate);
+
+  /** @return all values of a column, indexed by physical row */
+  auto GetColumn(uint32_t col_idx) const -> const std::vector<Value> & { return columns_[col_idx]; }
+
+  /** @return the value of a column at a physical row */
+  auto GetValue(uint32_t col_idx, uint32_t row) const -> const Value & { return columns_[col_idx][row]; }
+
+  /** @return the RID of a physical row */
+  auto GetRid(uint32_t row) const -> RID { return rids_[row]; }
+
+  /**
+   * Appends a row and selects it.
+   * @param values one value per column of the schema
+   * @param rid the RID of the row, if it comes from a table
+   */
+  void Append(std::vector<Value> values, RID rid = RID{});
+
+  /**
+   * Replaces all rows of the batch with dense columns and selects every row.
+   * @param columns one value vector per column of the schema, each holding num_rows values
+   * @param num_rows the number of rows in the columns
+   * @param rids the RID of every row, empty if the rows do not come from a table
+   */
+  void AssignColumns(std::vector<std::vector<Value>> columns, uint32_t num_rows, std::vector<RID> rids = {});
+
+  /** Unpacks a tuple of the batch's schema into the columns and selects it. */
+  void AppendTuple(const Tuple &tuple, RID rid);
+
+  /** Unpacks a tuple of the batch's schema straight from its serialized bytes into the columns and selects it. */
+  void AppendTupleView(const TupleView &tuple);
+
+  /**
+   * Unpacks some columns of a tuple of another schema into the columns and selects it.
+   * @param tuple the tuple, laid out in tuple_schema
+   * @param tuple_schema the schema of the tuple
+   * @param column_ids the column of the tuple read into each column of the batch
+   */
+  void AppendTupleView(const TupleView &tuple, const Schema &tuple_schema, const std::vector<uint32_t> &column_ids);
+
+  /** @return the values of a physical row */
+  auto GetRowValues(uint32_t row) const -> std::vector<Value>;
+
+  /** @return a physical row materialized as a tuple of the batch's schema */
+  auto GetTuple(uint32_t row) const -> Tuple;
+
+ private:
+  /** The schema of the rows */
+  const Schema *schema_{nullptr};
+  /** One value vector per column */
+  std::vector<std::vector<Value>> columns_;
+  /** The RID of each physical row */
+  std::vector<RID> rids_;
+  /** The selection vector */
+  std::vector<uint32_t> sel_;
+};
+
+}  // namespace bustub
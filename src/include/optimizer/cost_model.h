@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// cost_model.h
+//
+// Identification: src/include/optimizer/cost_model.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * CostModel estimates the output cardinality and the cost of a plan from the statistics collected by ANALYZE.
+ * The optimizer only compares costs of plans over tables that have statistics, see HasStatistics, so plans
+ * over tables that were never analyzed are optimized by the rules alone.
+ *
+ * The cost of a plan is the cost of its children plus the work of the node itself, counted in units of reading
+ * one tuple in a sequential scan. Predicates on columns traced back to a base table are estimated with the
+ * histogram and the distinct count of the column, other predicates with fixed default selectivities.
+ *
+ * Cardinalities and costs are memoized per plan node, so a CostModel must not outlive the statistics it has read. The
+ * optimizer rules create one for each rewrite they cost.
+ */
+class CostModel {
+ public:
+  /** The cost of reading a tuple by a sequential scan */
+  static constexpr double SEQ_TUPLE_COST = 1.0;
+  /** The cost of reading a tuple through an index, the heap is visited in random order */
+  static constexpr double INDEX_TUPLE_COST = 4.0;
+  /** The cost of evaluating a predicate or an expression on a tuple */
+  static constexpr double CPU_TUPLE_COST = 0.1;
+  /** The cost of inserting a tuple into a hash table */
+  static constexpr double HASH_BUILD_COST = 2.0;
+  /** The cost of probing a hash table with a tuple */
+  static constexpr double HASH_PROBE_COST = 1.0;
+
+  /** The selectivities used when a predicate cannot be estimated from statistics */
+  static constexpr double DEFAULT_EQUAL_SELECTIVITY = 0.1;
+  static constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3;
+  static constexpr double DEFAULT_SELECTIVITY = 0.5;
+  /** The number of rows assumed for a table without statistics */
+  static constexpr double DEFAULT_TABLE_ROWS = 1000;
+
+  explicit CostModel(const Catalog &catalog) : catalog_(catalog) {}
+
+  /** @return true if every table read by the plan has statistics */
+  auto HasStatistics(const AbstractPlanNodeRef &plan) const -> bool;
+
+  /** @return the estimated number of tuples the plan outputs */
+  auto EstimateCardinality(const AbstractPlanNodeRef &plan) const -> double;
+
+  /** @return the estimated cost of executing the plan */
+  auto EstimateCost(const AbstractPlanNodeRef &plan) const -> double;
+
+  /**
+   * Estimate the fraction of tuples a predicate keeps.
+   * @param expr the predicate
+   * @param inputs the plans producing the tuples the predicate reads, indexed by the tuple index of its columns
+   */
+  auto EstimateSelectivity(const AbstractExpressionRef &expr, const std::vector<AbstractPlanNodeRef> &inputs) const
+      -> double;
+
+ private:
+  /** A column of a base table */
+  using ColumnOrigin = std::pair<table_oid_t, uint32_t>;
+
+  /** @return the base table column an output column of the plan is read from, std::nullopt if it is computed */
+  auto TraceColumn(const AbstractPlanNodeRef &plan, uint32_t col_idx) const -> std::optional<ColumnOrigin>;
+
+  /** @return the selectivity of a range on a base table column, std::nullopt if the table was not analyzed */
+  auto RangeSelectivity(const ColumnOrigin &origin, const std::optional<Value> &low, bool low_inclusive,
+                        const std::optional<Value> &high, bool high_inclusive) const -> std::optional<double>;
+
+  /** @return the estimated number of distinct values of an output column of the plan */
+  auto DistinctCount(const AbstractPlanNodeRef &plan, uint32_t col_idx) const -> std::optional<double>;
+
+  /** @return the estimated selectivity of `left = right`, each side a column of the given plan */
+  auto EqualColumnsSelectivity(const AbstractPlanNodeRef &left, uint32_t left_col, const AbstractPlanNodeRef &right,
+                               uint32_t right_col) const -> double;
+
+  /** @return the number of live rows of a table, DEFAULT_TABLE_ROWS if the table was not analyzed */
+  auto TableRows(table_oid_t table_oid) const -> double;
+
+  /** @return the estimated number of tuples the plan outputs, computed without looking at the memo */
+  auto ComputeCardinality(const AbstractPlanNodeRef &plan) const -> double;
+
+  /** @return the estimated cost of executing the plan, computed without looking at the memo */
+  auto ComputeCost(const AbstractPlanNodeRef &plan) const -> double;
+
+  const Catalog &catalog_;
+  /** The cardinalities estimated so far. The keys hold the plans alive so that no other plan reuses their address */
+  mutable std::unordered_map<AbstractPlanNodeRef, double> cardinalities_;
+  /** The costs estimated so far */
+  mutable std::unordered_map<AbstractPlanNodeRef, double> costs_;
+};
+
+}  // namespace bustub
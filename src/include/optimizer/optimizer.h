@@ -41,6 +41,20 @@ class Optimizer {
    */
   auto OptimizeMergeFilterNLJ(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief push the conjuncts of filters and join predicates down through joins, projections, sorts and the group-by
+   * columns of aggregations, as close to the scans as possible. Equalities over an inner join are closed
+   * transitively so that a conjunct on one side of an equi join also filters the other side.
+   */
+  auto OptimizePredicatePushdown(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief reorder trees of inner nested loop joins. The relations and the conjuncts of the join predicates of a
+   * tree form a join graph, the cheapest bushy join order of the graph is found by dynamic programming (DPccp) for up
+   * to 12 relations and greedily for more. The tree is kept when the size of some relation cannot be estimated.
+   */
+  auto OptimizeJoinOrder(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /**
    * @brief optimize nested loop join into hash join.
    * In the starter code, we will check NLJs with exactly one equal condition. You can further support optimizing joins
@@ -48,11 +62,28 @@ class Optimizer {
    */
   auto OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief make the hash join of an equi join. The hash join builds on its right input, when the statistics of both
+   * inputs say the right one is larger an inner join is built on the left one instead, with a projection restoring
+   * the column order of the join.
+   */
+  auto MakeHashJoin(const AbstractPlanNodeRef &nlj, std::vector<AbstractExpressionRef> left_keys,
+                    std::vector<AbstractExpressionRef> right_keys) -> AbstractPlanNodeRef;
+
   /**
    * @brief optimize nested loop join into index join.
    */
   auto OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief choose between an index join and a hash join for an equi join NLJ by their estimated costs. Without
+   * statistics the index join is always chosen. The NLJ is returned when the hash join is cheaper, so that
+   * OptimizeNLJAsHashJoin rewrites it afterwards.
+   */
+  auto CheaperJoin(const AbstractPlanNodeRef &nlj, AbstractPlanNodeRef index_join,
+                   const AbstractExpressionRef &left_key, const AbstractExpressionRef &right_key)
+      -> AbstractPlanNodeRef;
+
   /**
    * @brief eliminate always true filter
    */
@@ -83,18 +114,24 @@ class Optimizer {
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
-  /** @brief check if the index can be matched */
+  /** @brief check if the index can be matched, a hash index is preferred for these point lookups */
   auto MatchIndex(const std::string &table_name, uint32_t index_key_idx)
       -> std::optional<std::tuple<index_oid_t, std::string>>;
 
+  /**
+   * @brief drop the columns nobody reads above them: projections and aggregations only compute the outputs that are
+   * used, and the inputs of joins, sorts and aggregations are narrowed to the columns they need by a projection.
+   */
+  auto OptimizeColumnPruning(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /**
    * @brief optimize sort + limit as top N
    */
   auto OptimizeSortLimitAsTopN(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
   /**
-   * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. BusTub
-   * doesn't support statistics for now, so it's the only way for you to get the table size :(
+   * @brief get the estimated cardinality for a table. Useful when join reordering. The row count collected by ANALYZE
+   * is used if there is one, otherwise the size is guessed from the table name.
    *
    * @param table_name
    * @return std::optional<size_t>
@@ -1,8 +1,44 @@
 #pragma once
 
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+
 namespace bustub {
 
 // Note: You can define your optimizer helper functions here
 void OptimizerHelperFunction();
 
+/** Append the conjuncts of the AND tree of a predicate, conjuncts that are the constant true are dropped */
+void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts);
+
+/** @return the AND of the conjuncts, the constant true if there are none */
+auto MakeConjunction(const std::vector<AbstractExpressionRef> &conjuncts) -> AbstractExpressionRef;
+
+/** @return a copy of the expression with every column reference replaced by fn(column) */
+template <class ColumnFn>
+auto RewriteColumns(const AbstractExpressionRef &expr, const ColumnFn &fn) -> AbstractExpressionRef {
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(expr.get()); column_expr != nullptr) {
+    return fn(*column_expr);
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    children.push_back(RewriteColumns(child, fn));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+/** Call fn with every column reference of the expression */
+template <class ColumnFn>
+void VisitColumns(const AbstractExpressionRef &expr, const ColumnFn &fn) {
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(expr.get()); column_expr != nullptr) {
+    fn(*column_expr);
+    return;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    VisitColumns(child, fn);
+  }
+}
+
 }  // namespace bustub
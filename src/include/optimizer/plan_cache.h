@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_statement.h"
+#include "catalog/schema.h"
+#include "common/enums/statement_type.h"
+#include "execution/plans/abstract_plan.h"
+#include "type/type_id.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * An optimized plan that can be run again without parsing, binding, planning and optimizing its statement.
+ */
+struct CachedPlan {
+  /** The normalized text the plan is cached by, empty for a prepared statement */
+  std::string sql_;
+
+  /** The bound statement of a prepared statement, nullptr for a plan in the plan cache */
+  std::shared_ptr<const BoundStatement> statement_;
+
+  /** SELECT, INSERT, UPDATE or DELETE */
+  StatementType type_;
+
+  /** The optimized plan, the parameters of a prepared statement are still placeholders in it */
+  AbstractPlanNodeRef plan_;
+
+  /** The columns of the result rows as named by the planner */
+  SchemaRef schema_;
+
+  /** The types of `$1`, `$2`, ... */
+  std::vector<TypeId> parameter_types_;
+
+  /** The catalog version the plan was built at */
+  uint64_t catalog_version_;
+};
+
+/**
+ * PlanCache keeps the plans of the most recently run statements, keyed by their normalized text. A plan built at
+ * another catalog version than the current one is stale and dropped when it is looked up. When the cache is full,
+ * the least recently used plan is evicted.
+ */
+class PlanCache {
+ public:
+  explicit PlanCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Normalize the text of a statement, so that the statement written with other letter case or spacing maps to the
+   * same key. Quoted strings and identifiers are kept as they are.
+   * @return the normalized text, std::nullopt if the text is not a single statement that can be keyed safely, e.g.
+   * it has comments, parameters or backslash escapes
+   */
+  static auto Normalize(const std::string &sql) -> std::optional<std::string>;
+
+  /** @return the plan cached for the key, nullptr if there is none or it was built at another catalog version */
+  auto Get(const std::string &key, uint64_t catalog_version) -> std::shared_ptr<const CachedPlan>;
+
+  /** Cache the plan for the key, evicting the least recently used plan if the cache is full */
+  void Put(const std::string &key, std::shared_ptr<const CachedPlan> plan);
+
+  /** @return the number of cached plans */
+  auto Size() const -> size_t;
+
+  /** @return the number of lookups that found a plan */
+  auto Hits() const -> size_t;
+
+ private:
+  size_t capacity_;
+
+  /** The cached plans, the most recently used first */
+  std::list<std::pair<std::string, std::shared_ptr<const CachedPlan>>> entries_;
+  std::unordered_map<std::string, std::list<std::pair<std::string, std::shared_ptr<const CachedPlan>>>::iterator>
+      index_;
+
+  size_t hits_{0};
+  mutable std::mutex latch_;
+};
+
+/**
+ * Find the types of the parameters a plan refers to.
+ * @param plan the optimized plan of a prepared statement
+ * @param declared the types declared by PREPARE, they take precedence over the inferred ones
+ * @return the types of `$1`, `$2`, ..., throws if the type of one of them is unknown
+ */
+auto InferParameterTypes(const AbstractPlanNodeRef &plan, const std::vector<TypeId> &declared) -> std::vector<TypeId>;
+
+/**
+ * @return a copy of the plan with every parameter replaced by a constant, values[i] is the value of `$(i+1)`
+ */
+auto BindParameters(const AbstractPlanNodeRef &plan, const std::vector<Value> &values) -> AbstractPlanNodeRef;
+
+}  // namespace bustub
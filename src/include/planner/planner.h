@@ -26,6 +26,7 @@ class BoundExpression;
 class BoundTableRef;
 class BoundBinaryOp;
 class BoundConstant;
+class BoundParameter;
 class BoundColumnRef;
 class BoundUnaryOp;
 class BoundBaseTableRef;
@@ -128,6 +129,15 @@ class Planner {
   auto PlanConstant(const BoundConstant &expr, const std::vector<AbstractPlanNodeRef> &children)
       -> AbstractExpressionRef;
 
+  auto PlanParameter(const BoundParameter &expr, const std::vector<AbstractPlanNodeRef> &children)
+      -> AbstractExpressionRef;
+
+  /**
+   * A parameter without a declared type takes the type of what it is compared with, assigned to or inserted into.
+   * @return the expression with the type given to it if it is such a parameter, otherwise the expression unchanged
+   */
+  auto InferParameterType(AbstractExpressionRef expr, TypeId type) -> AbstractExpressionRef;
+
   auto PlanSelectAgg(const SelectStatement &statement, AbstractPlanNodeRef child) -> AbstractPlanNodeRef;
 
   auto PlanAggCall(const BoundAggCall &agg_call, const std::vector<AbstractPlanNodeRef> &children)
@@ -184,6 +194,9 @@ class Planner {
 
   /** An id for all unnamed things */
   size_t universal_id_{0};
+
+  /** The column types of the table an INSERT writes, used to infer the types of parameters in its VALUES */
+  std::vector<TypeId> insert_types_;
 };
 
 static constexpr const char *const UNNAMED_COLUMN = "<unnamed>";
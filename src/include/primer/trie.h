@@ -2,16 +2,18 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <future>  // NOLINT
-#include <map>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
-#include <iostream>
+
+#include "primer/trie_arena.h"
 
 namespace bustub {
 
@@ -41,34 +43,100 @@ class MoveBlocked {
   std::future<int> wait_;
 };
 
+class TrieNode;
+
+// The children of a trie node, keyed by the next byte of the key. The children are stored in one of
+// the adaptive radix tree layouts: Node4 and Node16 keep parallel arrays of key bytes and children
+// (Node16 is searched with SIMD), Node48 maps every byte to one of 48 child slots, and Node256 indexes
+// the children by the byte directly. The layout grows as children are added and shrinks back as they
+// are removed; a node without children allocates nothing.
+class TrieNodeChildren {
+ public:
+  TrieNodeChildren() = default;
+  TrieNodeChildren(const TrieNodeChildren &other);
+  TrieNodeChildren(TrieNodeChildren &&other) noexcept;
+  auto operator=(const TrieNodeChildren &other) -> TrieNodeChildren &;
+  auto operator=(TrieNodeChildren &&other) noexcept -> TrieNodeChildren &;
+  ~TrieNodeChildren();
+
+  // Returns the child for the key byte, nullptr if there is none.
+  auto Find(char key) const -> const std::shared_ptr<const TrieNode> *;
+
+  // Inserts the child for the key byte, replacing the existing one.
+  void Set(char key, std::shared_ptr<const TrieNode> child);
+
+  // Removes the child for the key byte if there is one.
+  void Erase(char key);
+
+  // Returns the only child. Must only be called when Size() == 1.
+  auto Front() const -> std::pair<char, std::shared_ptr<const TrieNode>>;
+
+  auto Size() const -> size_t { return size_; }
+  auto Empty() const -> bool { return size_ == 0; }
+
+ private:
+  enum class Kind : uint8_t { Empty, Node4, Node16, Node48, Node256 };
+
+  static auto Capacity(Kind kind) -> size_t;
+
+  // Number of key bytes stored after the child slots: 16 for Node4/Node16 (Node16 is always searched
+  // 16 bytes at a time), 256 for Node48 and none for Node256.
+  static auto NumKeyBytes(Kind kind) -> size_t;
+
+  // Takes an empty arena block for the layout of the given kind. Must only be called without storage.
+  void AllocateStorage(Kind kind);
+
+  // Destroys the children and returns the block to the arena.
+  void ReleaseStorage();
+
+  // Returns the slot in children_ holding the key byte, -1 if there is none.
+  auto SlotOf(uint8_t key) const -> int;
+
+  // Moves all children into the layout of the given kind.
+  void Resize(Kind kind);
+
+  // Calls visit(key, child) for every child.
+  template <typename Visitor>
+  void ForEach(Visitor &&visit) const;
+
+  Kind kind_{Kind::Empty};
+  uint16_t size_{0};
+  // Both point into one arena block, the child slots first and the key bytes after them.
+  // Node4/Node16: the key byte of each slot. Node48: slot + 1 for every byte, 0 if absent. Node256: unused.
+  std::shared_ptr<const TrieNode> *children_{nullptr};
+  uint8_t *keys_{nullptr};
+};
+
 // A TrieNode is a node in a Trie.
+//
+// Chains of nodes that have a single child and no value are compressed into the prefix of the node
+// below them: a node reached through the key byte c stands for the key bytes c + prefix_.
 class TrieNode {
  public:
   // Create a TrieNode with no children.
   TrieNode() = default;
 
   // Create a TrieNode with some children.
-  explicit TrieNode(std::map<char, std::shared_ptr<const TrieNode>> children) : children_(std::move(children)) {}
+  explicit TrieNode(TrieNodeChildren children, std::string prefix = "")
+      : children_(std::move(children)), prefix_(std::move(prefix)) {}
 
   virtual ~TrieNode() = default;
 
-  // Clone returns a copy of this TrieNode. If the TrieNode has a value, the value is copied. The return
-  // type of this function is a unique_ptr to a TrieNode.
+  // Clone returns a copy of this TrieNode, allocated in the trie arena. If the TrieNode has a value,
+  // the value is shared with the copy.
   //
   // You cannot use the copy constructor to clone the node because it doesn't know whether a `TrieNode`
   // contains a value or not.
-  //
-  // Note: if you want to convert `unique_ptr` into `shared_ptr`, you can use `std::shared_ptr<T>(std::move(ptr))`.
-  virtual auto Clone() const -> std::unique_ptr<TrieNode> { return std::make_unique<TrieNode>(children_); }
+  virtual auto Clone() const -> std::shared_ptr<TrieNode> { return MakeTrieNode<TrieNode>(children_, prefix_); }
+
+  // The children of this node, keyed by the next byte of the key after prefix_.
+  TrieNodeChildren children_;
 
-  // A map of children, where the key is the next character in the key, and the value is the next TrieNode.
- mutable std::map<char, std::shared_ptr<const TrieNode>> children_;
+  // Key bytes compressed into this node, matched after the byte that leads to it.
+  std::string prefix_;
 
   // Indicates if the node is the terminal node.
   bool is_value_node_{false};
-
-  // You can add additional fields and methods here. But in general, you don't need to add extra fields to
-  // complete this project.
 };
 
 // A TrieNodeWithValue is a TrieNode that also has a value of type T associated with it.
@@ -79,16 +147,14 @@ class TrieNodeWithValue : public TrieNode {
   explicit TrieNodeWithValue(std::shared_ptr<T> value) : value_(std::move(value)) { this->is_value_node_ = true; }
 
   // Create a trie node with children and a value.
-  TrieNodeWithValue(std::map<char, std::shared_ptr<const TrieNode>> children, std::shared_ptr<T> value)
-      : TrieNode(std::move(children)), value_(std::move(value)) {
+  TrieNodeWithValue(TrieNodeChildren children, std::shared_ptr<T> value, std::string prefix = "")
+      : TrieNode(std::move(children), std::move(prefix)), value_(std::move(value)) {
     this->is_value_node_ = true;
   }
 
-  // Override the Clone method to also clone the value.
-  //
-  // Note: if you want to convert `unique_ptr` into `shared_ptr`, you can use `std::shared_ptr<T>(std::move(ptr))`.
-  auto Clone() const -> std::unique_ptr<TrieNode> override {
-    return std::make_unique<TrieNodeWithValue<T>>(children_, value_);
+  // Override the Clone method so that the copy keeps the value.
+  auto Clone() const -> std::shared_ptr<TrieNode> override {
+    return MakeTrieNode<TrieNodeWithValue<T>>(children_, value_, prefix_);
   }
 
   // The value associated with this trie node.
@@ -106,12 +172,28 @@ class Trie {
   // Create a new trie with the given root.
   explicit Trie(std::shared_ptr<const TrieNode> root) : root_(std::move(root)) {}
 
+  // Walk down the key without touching any reference count, nullptr if the path does not exist.
+  auto FindNode(std::string_view key) const -> const TrieNode *;
+
+  // Returns the subtree replacing node (nullptr for a missing one) after putting value at key[pos..],
+  // where pos is just past the byte that leads to node.
+  template <class T>
+  static auto PutAt(const std::shared_ptr<const TrieNode> &node, std::string_view key, size_t pos,
+                    const std::shared_ptr<T> &value) -> std::shared_ptr<const TrieNode>;
+
+  // Returns the subtree replacing node after removing key[pos..], nullptr if nothing is left of it.
+  // Sets *removed if the key was found; node itself is returned unchanged otherwise.
+  static auto RemoveAt(const std::shared_ptr<const TrieNode> &node, std::string_view key, size_t pos, bool *removed)
+      -> std::shared_ptr<const TrieNode>;
+
+  // Merges a valueless node with a single child into that child.
+  static auto Compact(std::shared_ptr<const TrieNode> node) -> std::shared_ptr<const TrieNode>;
+
  public:
   // Create an empty trie.
   //Trie() = default;
   Trie(){
-    std::cout << "create trieNode" << std::endl;
-    root_ = std::make_shared<const TrieNode>();
+    root_ = MakeTrieNode<const TrieNode>();
   }
   // Get the value associated with the given key.
   // 1. If the key is not in the trie, return nullptr.
@@ -120,6 +202,10 @@ class Trie {
   template <class T>
   auto Get(std::string_view key) const -> const T *;
 
+  // Same as Get, but shares ownership of the value so that it outlives this trie version.
+  template <class T>
+  auto GetShared(std::string_view key) const -> std::shared_ptr<const T>;
+
   // Put a new key-value pair into the trie. If the key already exists, overwrite the value.
   // Returns the new trie.
   template <class T>
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace bustub {
+
+// A slab allocator for trie nodes and their child arrays.
+//
+// Every write to a copy-on-write trie allocates a handful of small, same-sized blocks and every
+// replaced version frees them again. Instead of going through malloc for each of them, blocks are
+// rounded up to a size class of 16 bytes and carved from 64 KiB chunks. Freed blocks go onto a
+// free list of the freeing thread and are handed out again by its next allocations. A thread keeps
+// at most a chunk's worth of free blocks per size class and returns the excess to a shared pool
+// that threads refill from when they run dry, so blocks freed on another thread than the one that
+// allocated them flow back instead of piling up. When a thread exits its free lists go to the
+// shared pool as well. Chunks are never returned, so the arena holds on to the peak amount of trie
+// memory. Blocks larger than the biggest size class fall back to operator new.
+class TrieArena {
+ public:
+  static auto Allocate(size_t size) -> void *;
+  static void Deallocate(void *ptr, size_t size);
+
+  static constexpr size_t CLASS_SIZE = 16;
+  static constexpr size_t NUM_CLASSES = 272;
+  static constexpr size_t MAX_BLOCK_SIZE = CLASS_SIZE * NUM_CLASSES;
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+};
+
+// Standard allocator interface over TrieArena, used with std::allocate_shared so that a node and
+// its reference count share one arena block.
+template <class T>
+class TrieArenaAllocator {
+ public:
+  using value_type = T;  // NOLINT
+
+  TrieArenaAllocator() = default;
+  template <class U>
+  TrieArenaAllocator(const TrieArenaAllocator<U> & /*other*/) {}  // NOLINT
+
+  auto allocate(size_t n) -> T * { return static_cast<T *>(TrieArena::Allocate(n * sizeof(T))); }  // NOLINT
+  void deallocate(T *ptr, size_t n) { TrieArena::Deallocate(ptr, n * sizeof(T)); }                // NOLINT
+
+  template <class U>
+  auto operator==(const TrieArenaAllocator<U> & /*other*/) const -> bool {
+    return true;
+  }
+  template <class U>
+  auto operator!=(const TrieArenaAllocator<U> & /*other*/) const -> bool {
+    return false;
+  }
+};
+
+// Creates a trie node of type N in the arena.
+template <class N, class... Args>
+auto MakeTrieNode(Args &&...args) -> std::shared_ptr<N> {
+  return std::allocate_shared<N>(TrieArenaAllocator<N>(), std::forward<Args>(args)...);
+}
+
+}  // namespace bustub
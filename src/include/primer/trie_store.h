@@ -1,31 +1,47 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <shared_mutex>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "primer/trie.h"
 
 namespace bustub {
 
-// This class is used to guard the value returned by the trie. It holds a reference to the root so
-// that the reference to the value will not be invalidated.
+// This class is used to guard the value returned by the trie. It shares ownership of the value so
+// that the reference to the value will not be invalidated, even after the trie version it was read
+// from has been replaced and reclaimed.
 template <class T>
 class ValueGuard {
  public:
-  ValueGuard(Trie root, const T &value) : root_(std::move(root)), value_(value) {}
-  auto operator*() const -> const T & { return value_; }
+  explicit ValueGuard(std::shared_ptr<const T> value) : value_(std::move(value)) {}
+  auto operator*() const -> const T & { return *value_; }
 
  private:
-  Trie root_;
-  const T &value_;
+  std::shared_ptr<const T> value_;
 };
 
 // This class is a thread-safe wrapper around the Trie class. It provides a simple interface for
-// accessing the trie. It should allow concurrent reads and a single write operation at the same
-// time.
+// accessing the trie. It allows any number of concurrent reads and a single write operation at
+// the same time.
+//
+// Every write builds a new immutable trie version and publishes it with a single atomic pointer
+// store. Readers never lock: they announce the epoch they read in, load the current version and
+// walk it. A replaced version is retired with the epoch of its replacement and is only deleted
+// once every announced reader epoch is newer, so a reader never sees a version being freed.
 class TrieStore {
  public:
+  TrieStore() = default;
+  ~TrieStore();
+
+  TrieStore(const TrieStore &) = delete;
+  auto operator=(const TrieStore &) -> TrieStore & = delete;
+
   // This function returns a ValueGuard object that holds a reference to the value in the trie. If
   // the key does not exist in the trie, it will return std::nullopt.
   template <class T>
@@ -36,19 +52,48 @@ class TrieStore {
   template <class T>
   void Put(std::string_view key, T value);
 
+  // This function inserts all key-value pairs into the trie and publishes them as one new version,
+  // so readers see either none or all of them. Later pairs overwrite earlier ones with the same key.
+  template <class T>
+  void PutBatch(std::vector<std::pair<std::string, T>> entries);
+
   // This function will remove the key-value pair from the trie.
   void Remove(std::string_view key);
 
  private:
-  // This mutex protects the root. Everytime you want to access the trie root or modify it, you
-  // will need to take this lock.
-  std::mutex root_lock_;
+  // Number of reader slots. More concurrent readers than slots still work, they wait for a free one.
+  static constexpr size_t NUM_READER_SLOTS = 128;
+
+  // Epoch announced by a reader, 0 while the slot is free. Padded so readers do not share cache lines.
+  struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> epoch_{0};
+  };
+
+  // Claims a reader slot announcing the current epoch, returns the slot index.
+  auto EnterEpoch() -> size_t;
+
+  // Releases the reader slot claimed by EnterEpoch.
+  void ExitEpoch(size_t slot);
+
+  // Publishes a new version and retires the old one. Caller must hold write_lock_.
+  void Publish(const Trie *new_root);
+
+  // Deletes the retired versions no reader can still observe. Caller must hold write_lock_.
+  void Reclaim();
 
   // This mutex sequences all writes operations and allows only one write operation at a time.
   std::mutex write_lock_;
 
   // Stores the current root for the trie.
-  Trie root_;
+  std::atomic<const Trie *> root_{new Trie()};
+
+  // Global epoch, bumped every time a version is replaced. Starts at 1 as 0 marks a free slot.
+  std::atomic<uint64_t> epoch_{1};
+
+  std::array<ReaderSlot, NUM_READER_SLOTS> reader_slots_;
+
+  // Replaced versions and the epoch they were replaced in, protected by write_lock_.
+  std::vector<std::pair<const Trie *, uint64_t>> retired_;
 };
 
 }  // namespace bustub
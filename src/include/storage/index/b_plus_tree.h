@@ -75,6 +75,13 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
    auto Insert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> bool;
 
+  /**
+   * Insert key & value pairs sorted by key. The keys that fall into the same leaf are inserted under one descent
+   * and one leaf latch, a key that would split its leaf falls back to Insert.
+   * @return the number of pairs inserted, duplicate keys are skipped
+   */
+  auto InsertBatch(const std::vector<MappingType> &entries, Transaction *txn = nullptr) -> size_t;
+
    void InsertIntoParent(Context &context, const page_id_t& curr_page_id, const KeyType& key, const page_id_t& value);
 
   //void InsertIntoParent(Context& context, const page_id_t& curr_page_id, const KeyType& key, const page_id_t &value);
@@ -97,6 +104,14 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  // Iterate the keys within range in ascending order
+  auto Begin(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE;
+
+  // Iterate all keys (or the keys within range) in descending order
+  auto RBegin() -> INDEXITERATOR_TYPE;
+
+  auto RBegin(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE;
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -123,6 +138,12 @@ class BPlusTree {
   void RemoveFromFile(const std::string &file_name, Transaction *txn = nullptr);
 
  private:
+  /**
+   * Descend from the root to a leaf with read latch crabbing. The leaf is the one that holds key if key is given,
+   * otherwise the leftmost (or rightmost) leaf. Returns nullopt if the tree is empty.
+   */
+  auto FindLeafRead(const KeyType *key, bool rightmost) -> std::optional<ReadPageGuard>;
+
   /* Debug Routines for FREE!! */
   void ToGraph(page_id_t page_id, const BPlusTreePage *page, std::ofstream &out);
 
@@ -31,6 +31,9 @@ class BPlusTreeIndex : public Index {
 
   auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
 
+  /** Sort the keys and insert them with BPlusTree::InsertBatch */
+  auto InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) -> size_t override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
@@ -41,6 +44,12 @@ class BPlusTreeIndex : public Index {
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  auto GetRangeIterator(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE;
+
+  auto GetReverseIterator() -> INDEXITERATOR_TYPE;
+
+  auto GetReverseIterator(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
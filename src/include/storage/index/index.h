@@ -160,6 +160,21 @@ class Index {
    */
   virtual auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool = 0;
 
+  /**
+   * Insert a batch of entries into the index. Indexes that can do better than one InsertEntry per entry
+   * override it.
+   * @param entries The index keys with their RIDs, in any order
+   * @param transaction The transaction context
+   * @returns the number of entries inserted
+   */
+  virtual auto InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) -> size_t {
+    size_t inserted = 0;
+    for (const auto &[key, rid] : entries) {
+      inserted += InsertEntry(key, rid, transaction) ? 1 : 0;
+    }
+    return inserted;
+  }
+
   /**
    * Delete an index entry by key.
    * @param key The index key
@@ -13,62 +13,103 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <optional>
+#include <vector>
+
+#include "storage/page/b_plus_tree_header_page.h"
+#include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * Bounds of a range scan over the b+ tree. A missing bound leaves that side open,
+ * the default bounds describe the half open interval [low, high).
+ */
+template <typename KeyType>
+struct IndexKeyRange {
+  std::optional<KeyType> low_{std::nullopt};
+  bool low_inclusive_{true};
+  std::optional<KeyType> high_{std::nullopt};
+  bool high_inclusive_{false};
+};
+
+/**
+ * Iterator over the leaf level of the b+ tree.
+ *
+ * The iterator copies the matching entries of one leaf into a local batch while holding the leaf's
+ * read latch for just that copy, so no latch is held between calls to operator++. When the batch
+ * runs out, the leaf is re-read for entries inserted behind the iterator and then the scan moves on
+ * to the next (or, for a reverse scan, the previous) leaf. Emitted keys are strictly monotonic, so a
+ * concurrent split or merge never makes the iterator return the same key twice.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
   // you may define your own constructor based on your member variables
   IndexIterator(bool is_end);
-  IndexIterator(BufferPoolManager *bpm, const page_id_t page_id, const int index);
+  /**
+   * @param bpm buffer pool the tree lives in
+   * @param comparator comparator of the tree, must outlive the iterator
+   * @param header_page_id header page of the tree, used to re-position a reverse scan
+   * @param leaf_guard read guard of the leaf the scan starts from, released by the constructor
+   * @param range bounds of the scan
+   * @param reverse scan from the high bound down to the low bound
+   */
+  IndexIterator(BufferPoolManager *bpm, KeyComparator *comparator, page_id_t header_page_id,
+                ReadPageGuard leaf_guard, IndexKeyRange<KeyType> range, bool reverse);
   IndexIterator();
   ~IndexIterator();  // NOLINT
 
-  //IndexIterator(BufferPoolManager* bpm, const page_id_t page_id, const int index);
-  //IndexIterator(bool is_end);
   auto IsEnd() -> bool;
 
   auto operator*() -> const MappingType &;
 
   auto operator++() -> IndexIterator &;
 
-
   auto operator==(const IndexIterator &itr) const -> bool {
-    //throw std::runtime_error("unimplemented");
-
-    if(is_end_ && itr.is_end_){
-        return true;
-    }
-
-    if(page_id_ == itr.page_id_ && index_ == itr.index_){
-        return true;
+    if (is_end_ || itr.is_end_) {
+      return is_end_ == itr.is_end_;
     }
 
-    return false;
+    return page_id_ == itr.page_id_ && index_ == itr.index_;
   }
 
-  auto operator!=(const IndexIterator &itr) const -> bool {
-    //throw std::runtime_error("unimplemented");
-
-
-    return !(*this == itr);
-  }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
-
-  BufferPoolManager *bpm_;
-
-  ReadPageGuard guard_;
-  page_id_t page_id_;
-  int index_;
-  MappingType value_;
-  bool is_end_;
-
+  /** Copy the entries of the leaf that are within the range and after the last emitted key. */
+  void CopyLeaf(const LeafPage *leaf, page_id_t page_id);
+
+  /** Refill the batch from the current leaf or its neighbours, mark the iterator as end when nothing is left. */
+  void Advance();
+
+  /** Latch the previous leaf of the current one, re-descending from the root if the backward link is stale. */
+  auto FetchPrevLeaf(page_id_t prev_page_id) -> std::optional<ReadPageGuard>;
+
+  auto AboveLow(const KeyType &key) const -> bool;
+  auto BelowHigh(const KeyType &key) const -> bool;
+
+  BufferPoolManager *bpm_{nullptr};
+  KeyComparator *comparator_{nullptr};
+  page_id_t header_page_id_{INVALID_PAGE_ID};
+  IndexKeyRange<KeyType> range_;
+  bool reverse_{false};
+
+  // entries copied from the leaf page_id_, consumed from index_
+  std::vector<MappingType> batch_;
+  page_id_t page_id_{INVALID_PAGE_ID};
+  size_t index_{0};
+  // the last leaf reached a bound of the range, no need to look at its neighbours
+  bool hit_bound_{false};
+  std::optional<KeyType> last_key_{std::nullopt};
+  bool is_end_{true};
 };
 
 }  // namespace bustub
@@ -19,7 +19,7 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 16
+#define LEAF_PAGE_HEADER_SIZE 20
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
@@ -32,12 +32,12 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ *  Header format (size in byte, 20 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
- * |  NextPageId (4)
+ * |  NextPageId (4) | PrevPageId (4)
  *  -----------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
@@ -57,12 +57,16 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
   auto KeyAt(int index) const -> KeyType;
 
   auto ValueAt(int index) const -> ValueType;
   void SetKeyAt(int index, const KeyType& key);
   void SetValueAt(int index, const ValueType &value);
   auto GetIndex(KeyComparator& comparator, const KeyType& key) const -> int;
+  // first index whose key is not less than key, GetSize() if there is none
+  auto KeyIndex(KeyComparator& comparator, const KeyType& key) const -> int;
   void Insert(KeyComparator& comparator, const KeyType& key, const ValueType& value);
   void Delete(KeyComparator& comparator, const KeyType& key);
 
@@ -94,6 +98,7 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
  private:
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -24,15 +25,18 @@ namespace bustub {
  * Store indexed key and and value together within bucket page. Supports
  * non-unique keys.
  *
- * Bucket page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ * Bucket page format (size in byte):
+ *  ------------------------------------------------------------------------------------
+ * | Size(4) | NumReadable(4) | Tags(BUCKET_TAG_ARRAY_SIZE) | KEY(1) + VALUE(1) | ... |
+ *  ------------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
- *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
- *
+ *  Slots [0, Size) have been handed out, the others were never used. Every
+ *  used slot has a one byte tag, a fingerprint of the hash of its key, or 0
+ *  if the pair was removed (a tombstone). A probe compares the tags of 16
+ *  slots at once and only reads the keys of the slots whose tag matches, so
+ *  most probes touch the tag array and a single key. Removed slots are reused
+ *  by later inserts, and all of them are dropped once the bucket is empty.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -45,11 +49,11 @@ class HashTableBucketPage {
    *
    * @return true if at least one key matched
    */
-  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) const -> bool;
 
   /**
-   * Attempts to insert a key and value in the bucket.  Uses the occupied_
-   * and readable_ arrays to keep track of each slot's availability.
+   * Attempts to insert a key and value in the bucket. Reuses the first
+   * tombstone if there is one, otherwise takes the next unused slot.
    *
    * @param key key to insert
    * @param value value to insert
@@ -94,8 +98,7 @@ class HashTableBucketPage {
   auto IsOccupied(uint32_t bucket_idx) const -> bool;
 
   /**
-   * SetOccupied - Updates the bitmap to indicate that the entry at
-   * bucket_idx is occupied.
+   * SetOccupied - Marks the slots up to bucket_idx as handed out.
    *
    * @param bucket_idx the index to update
    */
@@ -110,8 +113,8 @@ class HashTableBucketPage {
   auto IsReadable(uint32_t bucket_idx) const -> bool;
 
   /**
-   * SetReadable - Updates the bitmap to indicate that the entry at
-   * bucket_idx is readable.
+   * SetReadable - Tags the entry at bucket_idx with the tag of its key,
+   * making it readable.
    *
    * @param bucket_idx the index to update
    */
@@ -120,30 +123,43 @@ class HashTableBucketPage {
   /**
    * @return the number of readable elements, i.e. current size
    */
-  auto NumReadable() -> uint32_t;
+  auto NumReadable() const -> uint32_t;
 
   /**
    * @return whether the bucket is full
    */
-  auto IsFull() -> bool;
+  auto IsFull() const -> bool;
 
   /**
    * @return whether the bucket is empty
    */
-  auto IsEmpty() -> bool;
+  auto IsEmpty() const -> bool;
 
   /**
    * Prints the bucket's occupancy information
    */
-  void PrintBucket();
+  void PrintBucket() const;
 
  private:
+  /** Tag of a slot that held a pair which has been removed */
+  static constexpr uint8_t TOMBSTONE_TAG = 0;
+
+  /** @return the tag of the key, never TOMBSTONE_TAG */
+  static auto Tag(const KeyType &key) -> uint8_t;
+
+  /**
+   * Calls visit(slot) on every used slot whose tag equals tag, in slot order,
+   * until visit returns true.
+   */
+  template <typename Visitor>
+  void ForEachTag(uint8_t tag, Visitor &&visit) const;
+
+  // number of slots handed out, used slots are always a prefix of the array
+  uint32_t size_;
+  uint32_t num_readable_;
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
-  char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
-  // 0 if tombstone/brand new (never occupied), 1 otherwise.
-  char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
-  // Flexible array member for page data.
-  MappingType array_[1];
+  uint8_t tags_[BUCKET_TAG_ARRAY_SIZE];
+  MappingType array_[BUCKET_ARRAY_SIZE];
 };
 
 }  // namespace bustub
@@ -26,10 +26,10 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 32 bytes in total, followed by the block page ids):
+ * -----------------------------------------------------------------------------------
+ * | LSN (4) | Padding (4) | Size (8) | PageId(4) | Padding (4) | NextBlockIndex(8) |
+ * -----------------------------------------------------------------------------------
  */
 class HashTableHeaderPage {
  public:
@@ -82,20 +82,29 @@ class HashTableHeaderPage {
    * @param index the index of the block
    * @return the page_id for the block.
    */
-  auto GetBlockPageId(size_t index) -> page_id_t;
+  auto GetBlockPageId(size_t index) const -> page_id_t;
 
   /**
    * @return the number of blocks currently stored in the header page
    */
-  auto NumBlocks() -> size_t;
+  auto NumBlocks() const -> size_t;
+
+  /**
+   * @return the maximum number of blocks a header page can hold
+   */
+  static constexpr auto MaxNumBlocks() -> size_t {
+    return (BUSTUB_PAGE_SIZE - HEADER_PAGE_METADATA_SIZE) / sizeof(page_id_t);
+  }
 
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
+  static constexpr size_t HEADER_PAGE_METADATA_SIZE = 32;
+
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
   // Flexible array member for page data.
-  __attribute__((unused)) page_id_t block_page_ids_[1];
+  page_id_t block_page_ids_[1];
 };
 
 }  // namespace bustub
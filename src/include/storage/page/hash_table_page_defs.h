@@ -35,10 +35,12 @@
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hash index bucket page.
- * The computation is the same as the above BLOCK_ARRAY_SIZE, but blocks and buckets have different implementations
- * of search, insertion, removal, and helper methods.
+ * Each pair needs one additional byte for its tag, and the page starts with an 8 byte header. The tag array is padded
+ * to a multiple of 16 bytes (BUCKET_TAG_ARRAY_SIZE) so that it can be compared 16 tags at a time, the 16 bytes
+ * subtracted from the page size leave room for that padding.
  */
-#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE ((BUSTUB_PAGE_SIZE - 8 - 16) / (sizeof(MappingType) + 1))
+#define BUCKET_TAG_ARRAY_SIZE ((BUCKET_ARRAY_SIZE + 15) / 16 * 16)
 
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.h
+//
+// Identification: src/include/storage/page/pax_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+static constexpr uint64_t PAX_PAGE_HEADER_SIZE = 16;
+
+/**
+ * PAX (Partition Attributes Across) page format. The tuples of a page are split into one minipage
+ * per column, so a scan that needs a few columns only touches their minipages:
+ *  ---------------------------------------------------------------------------------------------
+ *  | HEADER | MINIPAGE OFFSETS | TUPLE METAS | MINIPAGE 0 | ... | FREE SPACE | VARCHAR DATA |
+ *  ---------------------------------------------------------------------------------------------
+ *                                                                            ^
+ *                                                                            varchar data offset
+ *
+ *  Header format (size in bytes), the first 8 bytes are laid out like those of a TablePage, so the
+ *  page chain and tuple count of a table heap can be read without knowing the page format:
+ *  ----------------------------------------------------------------------------------------------------
+ *  | NextPageId (4) | NumTuples (2) | NumDeletedTuples (2) | Capacity (2) | VarDataOffset (2) |
+ *  | NumColumns (2) | MinipagesEnd (2) |
+ *  ----------------------------------------------------------------------------------------------------
+ *
+ *  Minipage format, capacity is the number of tuples the page was laid out for:
+ *  --------------------------------------------------------------------
+ *  | NULL BITMAP (capacity bits) | VALUES (capacity * value width) |
+ *  --------------------------------------------------------------------
+ *
+ * Fixed-width values are stored in their serialized form. A VARCHAR value is an offset (2) and a
+ * length (2) into the varchar data, which grows from the end of the page towards the minipages.
+ */
+class PaxPage {
+ public:
+  /**
+   * Initialize the page for tuples of a schema.
+   * @param schema the schema of the table
+   */
+  void Init(const Schema &schema);
+
+  /** @return the number of tuples a page is laid out for, 0 if not even one tuple fits */
+  static auto ComputeCapacity(const Schema &schema) -> uint32_t;
+
+  /** @return the varchar bytes an empty page laid out for the schema has room for */
+  static auto MaxVarcharSize(const Schema &schema) -> size_t;
+
+  /** @return the varchar bytes the tuple takes on a page, terminating '\0's included */
+  static auto VarcharSize(const Tuple &tuple, const Schema &schema) -> size_t;
+
+  /** @return number of tuples in this page */
+  auto GetNumTuples() const -> uint32_t { return num_tuples_; }
+
+  /** @return the page ID of the next table page */
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+  /** Set the page id of the next page in the table. */
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /**
+   * Insert a tuple into the page.
+   * @return the slot of the tuple, std::nullopt if the page is full or the varchar data does not fit
+   */
+  auto InsertTuple(const TupleMeta &meta, const Tuple &tuple, const Schema &schema) -> std::optional<uint16_t>;
+
+  /**
+   * Update a tuple meta.
+   */
+  void UpdateTupleMeta(const TupleMeta &meta, const RID &rid);
+
+  /**
+   * Read a tuple meta.
+   */
+  auto GetTupleMeta(const RID &rid) const -> TupleMeta;
+
+  /**
+   * Read a tuple, reassembled from the minipages of all columns.
+   */
+  auto GetTuple(const RID &rid, const Schema &schema) const -> std::pair<TupleMeta, Tuple>;
+
+  /**
+   * Update a tuple in place. A VARCHAR value may not grow beyond the value it replaces.
+   */
+  void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid, const Schema &schema);
+
+  /** @return `true` if the value of a column is NULL */
+  auto IsNull(uint32_t column_idx, uint32_t slot) const -> bool {
+    const char *bitmap = page_start_ + minipage_offsets_[column_idx];
+    return (bitmap[slot / 8] & (1 << (slot % 8))) != 0;
+  }
+
+  /**
+   * Read one column of some tuples straight from its minipage.
+   * @param schema the schema of the table
+   * @param column_idx the column to read
+   * @param slots the slots of the tuples to read
+   * @param[out] out the values are appended to it in slot order
+   */
+  void ReadColumn(const Schema &schema, uint32_t column_idx, const std::vector<uint32_t> &slots,
+                  std::vector<Value> *out) const;
+
+ private:
+  static constexpr uint32_t VARCHAR_SLOT_SIZE = 4;
+  /** The varchar bytes per tuple a page reserves room for when it is laid out */
+  static constexpr uint32_t VARCHAR_ESTIMATE = 16;
+
+  /** @return the width of a value of the column in its minipage */
+  static auto ValueWidth(const Column &col) -> uint32_t {
+    return col.IsInlined() ? col.GetFixedLength() : VARCHAR_SLOT_SIZE;
+  }
+
+  static auto Align(size_t offset) -> size_t { return (offset + 7) & ~static_cast<size_t>(7); }
+
+  /**
+   * Lay out the minipages of a page.
+   * @param[out] minipage_offsets the offset of every minipage, if not nullptr
+   * @return the end of the last minipage
+   */
+  static auto Layout(const Schema &schema, uint32_t capacity, uint16_t *minipage_offsets) -> size_t;
+
+  /** @return the offset of the tuple metas */
+  static auto MetaOffset(uint32_t num_columns) -> size_t {
+    return Align(PAX_PAGE_HEADER_SIZE + sizeof(uint16_t) * num_columns);
+  }
+
+  auto Metas() const -> const TupleMeta * {
+    return reinterpret_cast<const TupleMeta *>(page_start_ + MetaOffset(num_columns_));
+  }
+  auto Metas() -> TupleMeta * { return reinterpret_cast<TupleMeta *>(page_start_ + MetaOffset(num_columns_)); }
+
+  /** @return the start of the values of a column */
+  auto Values(uint32_t column_idx) const -> const char * {
+    return page_start_ + minipage_offsets_[column_idx] + Align((capacity_ + 7) / 8);
+  }
+  auto Values(uint32_t column_idx) -> char * {
+    return page_start_ + minipage_offsets_[column_idx] + Align((capacity_ + 7) / 8);
+  }
+
+  void SetNull(uint32_t column_idx, uint32_t slot, bool is_null) {
+    char *bitmap = page_start_ + minipage_offsets_[column_idx];
+    if (is_null) {
+      bitmap[slot / 8] = static_cast<char>(bitmap[slot / 8] | (1 << (slot % 8)));
+    } else {
+      bitmap[slot / 8] = static_cast<char>(bitmap[slot / 8] & ~(1 << (slot % 8)));
+    }
+  }
+
+  /** @return the value of a column of a tuple */
+  auto ReadValue(const Column &col, uint32_t column_idx, uint32_t slot) const -> Value;
+
+  void CheckSlot(const RID &rid) const;
+
+  char page_start_[0];
+  page_id_t next_page_id_;
+  uint16_t num_tuples_;
+  uint16_t num_deleted_tuples_;
+  uint16_t capacity_;
+  uint16_t var_data_offset_;
+  uint16_t num_columns_;
+  uint16_t minipages_end_;
+  uint16_t minipage_offsets_[0];
+};
+
+static_assert(sizeof(PaxPage) == PAX_PAGE_HEADER_SIZE);
+static_assert(PAX_PAGE_HEADER_SIZE >= TABLE_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
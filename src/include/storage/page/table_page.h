@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstring>
+#include <functional>
 #include <optional>
 #include <tuple>
 #include <utility>
@@ -24,6 +25,7 @@
 #include "storage/page/page.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
 
 namespace bustub {
 
@@ -65,6 +67,9 @@ class TablePage {
   /** Set the page id of the next page in the table. */
   void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+  /** @return the length of the largest tuple an empty page can hold */
+  static auto MaxTupleSize() -> size_t { return BUSTUB_PAGE_SIZE - TABLE_PAGE_HEADER_SIZE - TUPLE_INFO_SIZE; }
+
   /** Get the next offset to insert, return nullopt if this tuple cannot fit in this page */
   auto GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const -> std::optional<uint16_t>;
 
@@ -85,6 +90,12 @@ class TablePage {
    */
   auto GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple>;
 
+  /**
+   * Read a tuple from a table without copying it. The view points into this page and is only valid
+   * while the page guard is held.
+   */
+  auto GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView>;
+
   /**
    * Read a tuple meta from a table.
    */
@@ -95,6 +106,18 @@ class TablePage {
    */
   void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid);
 
+  /** @return the length of the largest tuple that still fits in this page */
+  auto GetFreeSpace() const -> size_t;
+
+  /**
+   * Reclaim the space of deleted tuples and move the remaining tuples together at the end of the page.
+   * Slots keep their number: a reclaimed slot keeps its deleted meta and gets an empty tuple, so the RIDs of
+   * the other tuples stay valid.
+   * @param can_reclaim whether the space of a deleted tuple can be reclaimed
+   * @return the number of tuples reclaimed
+   */
+  auto Compact(const std::function<bool(const TupleMeta &)> &can_reclaim) -> size_t;
+
   static_assert(sizeof(page_id_t) == 4);
 
  private:
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap keeps the approximate free space of every page of a table heap, so that an insert can
+ * go to a page with room instead of always appending to the last page.
+ *
+ * Free space is recorded in units of FREE_SPACE_UNIT bytes, rounded down, so a page returned by FindPage
+ * had at least the requested space when it was last recorded. The caller still has to check the page
+ * itself and record its real free space when it has no room after all.
+ *
+ * The pages are the leaves of a max tree, finding the first page with room takes O(log n). The free space
+ * map is not thread-safe, the table heap protects it with its latch.
+ */
+class FreeSpaceMap {
+ public:
+  /** The granularity of the recorded free space in bytes */
+  static constexpr size_t FREE_SPACE_UNIT = 32;
+
+  /**
+   * Record the free space of a page, adding the page if it is new.
+   * @param page_id the page
+   * @param free_bytes the largest tuple the page has room for
+   */
+  void Update(page_id_t page_id, size_t free_bytes);
+
+  /**
+   * Find a page with room for a tuple.
+   * @param needed the length of the tuple
+   * @return the first page, in the order they were added, that has room, std::nullopt if there is none
+   */
+  auto FindPage(size_t needed) const -> std::optional<page_id_t>;
+
+  /** @return the recorded free space of a page rounded down to FREE_SPACE_UNIT, 0 for an unknown page */
+  auto GetFreeSpace(page_id_t page_id) const -> size_t;
+
+  /** @return the number of pages in the map */
+  auto GetPageCount() const -> size_t { return pages_.size(); }
+
+ private:
+  /** Recompute the inner nodes above a leaf */
+  void UpdateParents(size_t node);
+
+  /** The pages in the order they were added */
+  std::vector<page_id_t> pages_;
+  /** The index of every page in pages_ */
+  std::unordered_map<page_id_t, size_t> page_index_;
+  /** The max tree over the free space of the pages in units, the leaves start at index capacity_ */
+  std::vector<uint32_t> tree_;
+  /** The number of leaves of the tree, a power of two */
+  size_t capacity_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue.h
+//
+// Identification: src/include/storage/table/morsel_queue.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/** A morsel is a range of consecutive pages of a table heap, the unit of work of a parallel scan. */
+struct Morsel {
+  /** The pages of the morsel in heap order, each with the number of slots to scan on it */
+  std::vector<std::pair<page_id_t, uint32_t>> pages_;
+};
+
+/**
+ * MorselQueue hands out the pages of a table heap as morsels to the workers of a parallel scan.
+ * Like TableIterator, it only covers the tuples that were in the table when the queue was created.
+ * Next() and Scan() may be called from several threads at once.
+ *
+ * If the heap has a zone map, the pages are listed from it when the queue is created, leaving out
+ * the pages whose zones cannot match the given ranges; such pages are never read. Otherwise the
+ * queue follows the page chain.
+ */
+class MorselQueue {
+ public:
+  static constexpr size_t DEFAULT_PAGES_PER_MORSEL = 16;
+
+  /**
+   * Create a queue over all pages of a table heap.
+   * @param table_heap the table heap to scan
+   * @param pages_per_morsel the number of pages of every morsel but the last one
+   * @param ranges the bounds of the scan predicate, pages whose zones are outside them are skipped
+   */
+  explicit MorselQueue(TableHeap *table_heap, size_t pages_per_morsel = DEFAULT_PAGES_PER_MORSEL,
+                       const std::vector<ZoneMapRange> &ranges = {});
+
+  DISALLOW_COPY_AND_MOVE(MorselQueue);
+
+  /**
+   * Take the next morsel in heap order.
+   * @param[out] morsel the morsel taken
+   * @return `false` if all pages were handed out
+   */
+  auto Next(Morsel *morsel) -> bool;
+
+  /**
+   * Read the tuples of a morsel of a row heap in RID order.
+   * @param morsel the morsel to read
+   * @param callback called with the meta and a view of the tuple of every slot, deleted tuples included.
+   * The view points into the pinned page and is only valid during the call.
+   */
+  template <class Callback>
+  void Scan(const Morsel &morsel, Callback &&callback) const {
+    ScanPages<TablePage>(morsel, [&](page_id_t page_id, const TablePage *page, uint32_t num_slots) {
+      for (uint32_t slot = 0; slot < num_slots; slot++) {
+        auto meta_tuple = page->GetTupleView(RID{page_id, slot});
+        callback(meta_tuple.first, meta_tuple.second);
+      }
+    });
+  }
+
+  /**
+   * Visit the pages of a morsel in heap order, each under a read guard.
+   * @param morsel the morsel to read
+   * @param callback called with the id of every page, the page as a PageType and the number of slots to scan on it
+   */
+  template <class PageType, class Callback>
+  void ScanPages(const Morsel &morsel, Callback &&callback) const {
+    for (const auto &page_slots : morsel.pages_) {
+      ReadPageGuard guard = bpm_->FetchPageRead(page_slots.first);
+      callback(page_slots.first, guard.As<PageType>(), page_slots.second);
+    }
+  }
+
+ private:
+  BufferPoolManager *bpm_;
+  size_t pages_per_morsel_;
+  /** Protects next_page_id_ and next_page_ */
+  std::mutex latch_;
+  /** The first page not handed out yet, INVALID_PAGE_ID once all pages were handed out */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** The last page of the heap when the queue was created and its number of tuples at that time */
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  uint32_t last_num_tuples_{0};
+  /** The pages to scan listed from the zone map with their number of slots, and the next one to hand out */
+  std::optional<std::vector<std::pair<page_id_t, uint32_t>>> pages_;
+  size_t next_page_{0};
+};
+
+}  // namespace bustub
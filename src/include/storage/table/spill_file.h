@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_file.h
+//
+// Identification: src/include/storage/table/spill_file.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * Estimate the memory used by a row of values held in memory. Operators compare the sum of the
+ * rows they hold against their memory budget to decide when to spill.
+ */
+inline auto EstimateRowBytes(const std::vector<Value> &values) -> size_t {
+  size_t bytes = sizeof(std::vector<Value>) + values.size() * sizeof(Value);
+  for (const auto &val : values) {
+    if (val.GetTypeId() == TypeId::VARCHAR && !val.IsNull()) {
+      bytes += val.GetLength();
+    }
+  }
+  return bytes;
+}
+
+/**
+ * SpillFile is an append-only sequence of tuples stored in TmpTuplePages, used by operators to
+ * move intermediate results that do not fit their memory budget out of memory. The pages go
+ * through the buffer pool, so only the page being appended to stays pinned, and all pages are
+ * deleted when the file is destroyed.
+ */
+class SpillFile {
+ public:
+  /**
+   * Create an empty spill file.
+   * @param bpm the buffer pool manager the pages are allocated from
+   */
+  explicit SpillFile(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  ~SpillFile();
+
+  DISALLOW_COPY_AND_MOVE(SpillFile);
+
+  /**
+   * Append a tuple to the end of the file. Throws if the tuple is larger than a page.
+   * @param tuple the tuple to append
+   */
+  void Append(const Tuple &tuple);
+
+  /** Unpin the page being appended to. Reading the file calls this, a later Append pins it again. */
+  void Finish();
+
+  /** @return the number of tuples in the file */
+  auto NumTuples() const -> size_t { return num_tuples_; }
+
+  /** @return the number of pages in the file */
+  auto NumPages() const -> size_t { return page_ids_.size(); }
+
+  /** @return the total size of the serialized tuples in bytes */
+  auto NumBytes() const -> size_t { return num_bytes_; }
+
+  /**
+   * Read all tuples of one page, in the order they were appended.
+   * @param page_idx the index of the page in the file
+   * @param[out] tuples the tuples read, replacing its content
+   */
+  void ReadPage(size_t page_idx, std::vector<Tuple> *tuples);
+
+ private:
+  /** Pin a page of the file, throws an ExecutionException if the buffer pool has no free frame */
+  auto FetchSpillPage(page_id_t page_id) -> TmpTuplePage *;
+
+  /** Allocate a new pinned page, throws an ExecutionException if the buffer pool has no free frame */
+  auto NewSpillPage(page_id_t *page_id) -> TmpTuplePage *;
+
+  BufferPoolManager *bpm_;
+  /** The pages of the file in append order */
+  std::vector<page_id_t> page_ids_;
+  /** The pinned last page, nullptr if it is unpinned */
+  TmpTuplePage *tail_{nullptr};
+  size_t num_tuples_{0};
+  size_t num_bytes_{0};
+};
+
+}  // namespace bustub
@@ -12,29 +12,49 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
+/**
+ * The page format of a table heap. Row pages (TablePage) store whole tuples, PAX pages (PaxPage)
+ * store every column of their tuples in a minipage of its own.
+ */
+enum class TableFormat { Row, Pax };
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * A row heap created with a schema keeps a free space map of its pages. Inserts go to the first page with
+ * room for the tuple and at least MIN_REUSE_SPACE free bytes, and only append to the last page otherwise,
+ * so the space Vacuum reclaims from deleted tuples is reused.
  */
 class TableHeap {
   friend class TableIterator;
+  friend class MorselQueue;
 
  public:
+  /** The free bytes a page before the last one needs before inserts go back to it */
+  static constexpr size_t MIN_REUSE_SPACE = BUSTUB_PAGE_SIZE / 8;
+
   ~TableHeap() = default;
 
   /**
@@ -45,7 +65,15 @@ class TableHeap {
   explicit TableHeap(BufferPoolManager *bpm);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return std::nullopt.
+   * Create a table heap with the given page format.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param format the page format of the heap
+   * @param schema the schema of the tuples, PAX pages are laid out for it and the zone map tracks its columns
+   */
+  TableHeap(BufferPoolManager *bpm, TableFormat format, const Schema &schema);
+
+  /**
+   * Insert a tuple into the table. Throws an Exception if the tuple does not fit on an empty page.
    * @param meta tuple meta
    * @param tuple tuple to insert
    * @return rid of the inserted tuple
@@ -53,6 +81,17 @@ class TableHeap {
   auto InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr = nullptr,
                    Transaction *txn = nullptr, table_oid_t oid = 0) -> std::optional<RID>;
 
+  /**
+   * Insert tuples into the table. The tuples are inserted in order, the latch of the heap is taken once and
+   * the latch of each page once for all the tuples that go on the page. If one of the tuples does not fit on an
+   * empty page, an Exception is thrown before any tuple is inserted.
+   * @param meta the meta of every tuple
+   * @param tuples tuples to insert
+   * @return the rids of the inserted tuples, in order
+   */
+  auto InsertTuples(const TupleMeta &meta, const std::vector<Tuple> &tuples, LockManager *lock_mgr = nullptr,
+                    Transaction *txn = nullptr, table_oid_t oid = 0) -> std::vector<RID>;
+
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
    * @param meta new tuple meta
@@ -81,6 +120,30 @@ class TableHeap {
   /** @return the iterator of this table, use this for project 4 except updates */
   auto MakeEagerIterator() -> TableIterator;
 
+  /**
+   * Reclaim the space of deleted tuples. Every page is compacted under its write latch, then its zones are
+   * rebuilt from the tuples left on it and its free space is recorded, so that inserts reuse it. Slot numbers
+   * do not change, so RIDs in indexes and the page lists of running scans stay valid. PAX pages are skipped.
+   * @param can_reclaim whether a deleted tuple will never be read again, e.g. its delete has committed
+   * @return the number of tuples reclaimed
+   */
+  auto Vacuum(const std::function<bool(const TupleMeta &)> &can_reclaim) -> size_t;
+
+  /** @return the free space map of the pages of this table, nullptr if the heap does not reuse free space */
+  inline auto GetFreeSpaceMap() const -> const FreeSpaceMap * { return free_space_map_.get(); }
+
+  /** @return the zone map of the pages of this table, nullptr if the heap was created without a schema */
+  inline auto GetZoneMap() const -> const ZoneMap * { return zone_map_.get(); }
+
+  /**
+   * @return whether the tuple fits on an empty page of this table. Inserting a tuple that does not throws an
+   * Exception, callers reading rows from outside check them first.
+   */
+  auto FitsInPage(const Tuple &tuple) const -> bool;
+
+  /** @return the page format of this table */
+  inline auto GetFormat() const -> TableFormat { return format_; }
+
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
@@ -93,8 +156,47 @@ class TableHeap {
   void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid);
 
  private:
+  /** Initialize a page newly added to the heap */
+  void InitPage(char *data);
+
+  /**
+   * Link a new page after the last page and move the guard to it. The latch of the heap must be held.
+   * @param[in,out] page_guard the guard of the last page, which must hold a tuple
+   */
+  void AppendPage(WritePageGuard *page_guard);
+
+  /** Throw an Exception if the tuple does not fit on an empty page */
+  void CheckFitsInPage(const Tuple &tuple) const;
+
+  /** @return the page to insert the tuple into, a page with room from the free space map or the last page */
+  auto FindPageForInsert(const Tuple &tuple) const -> page_id_t;
+
+  /**
+   * Move the guard on from a page that has no room for the tuple, to the page FindPageForInsert picks, or to a
+   * new page when that is the page held. The latch of the heap must be held.
+   * @param[in,out] page_guard the guard of the full page
+   * @param[in,out] page_id the id of the page held
+   * @param tuple the tuple to insert
+   */
+  void MoveToNextPage(WritePageGuard *page_guard, page_id_t *page_id, const Tuple &tuple);
+
+  /** Record the free space of a page in the free space map. The latch of the heap must be held. */
+  void RecordFreeSpace(page_id_t page_id, WritePageGuard *page_guard);
+
+  /** @return the slot the tuple was inserted at, std::nullopt if the page has no room for it */
+  auto InsertIntoPage(WritePageGuard *guard, const TupleMeta &meta, const Tuple &tuple) -> std::optional<uint16_t>;
+
   BufferPoolManager *bpm_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
+  TableFormat format_{TableFormat::Row};
+  /** The schema of the tuples, nullptr if the heap was created without one */
+  std::unique_ptr<Schema> schema_;
+  /** Updated by every insert and in-place update, nullptr if the heap was created without a schema */
+  std::unique_ptr<ZoneMap> zone_map_;
+  /** Protected by latch_, nullptr for PAX heaps and heaps created without a schema */
+  std::unique_ptr<FreeSpaceMap> free_space_map_;
+  /** The varchar bytes an empty PAX page has room for, computed once for the schema */
+  size_t max_varchar_size_{0};
 
   std::mutex latch_;
   page_id_t last_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
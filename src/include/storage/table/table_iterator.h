@@ -14,7 +14,9 @@
 
 #include <cassert>
 #include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include "common/macros.h"
 #include "common/rid.h"
@@ -35,6 +37,13 @@ class TableIterator {
   DISALLOW_COPY(TableIterator);
 
   TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid);
+
+  /**
+   * Create an iterator over a snapshot of the pages of a table heap.
+   * @param table_heap the table heap
+   * @param pages the pages to scan in order, each with the number of slots to scan
+   */
+  TableIterator(TableHeap *table_heap, std::vector<std::pair<page_id_t, uint32_t>> pages);
   TableIterator(TableIterator &&) = default;
 
   ~TableIterator() = default;
@@ -55,6 +64,11 @@ class TableIterator {
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  // The pages to scan with their number of slots, when the iterator was created from a snapshot. Inserts may go
+  // to any page with room, so the end of the last page is not enough to leave out tuples inserted later.
+  std::optional<std::vector<std::pair<page_id_t, uint32_t>>> pages_;
+  size_t page_idx_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view.h
+//
+// Identification: src/include/storage/table/tuple_view.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <string_view>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/limits.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleView is a non-owning view of a serialized tuple, in the same format as Tuple.
+ *
+ * A view read from a table page points into the page frame and is only valid while the page guard
+ * it was read under is held. The typed accessors read a column straight from the bytes without
+ * constructing a Value; they return the type's NULL sentinel for NULLs, so check IsNull() first.
+ */
+class TupleView {
+ public:
+  TupleView() = default;
+
+  /**
+   * Create a view of serialized tuple bytes.
+   * @param data the start of the tuple
+   * @param size the length of the tuple in bytes
+   * @param rid the RID of the tuple, if it lives in a table
+   */
+  TupleView(const char *data, uint32_t size, RID rid) : data_(data), size_(size), rid_(rid) {}
+
+  /** Create a view of a tuple, valid as long as the tuple is alive and unchanged */
+  explicit TupleView(const Tuple &tuple) : data_(tuple.GetData()), size_(tuple.GetLength()), rid_(tuple.GetRid()) {}
+
+  /** @return the RID of the tuple */
+  auto GetRid() const -> RID { return rid_; }
+
+  /** @return the start of the tuple bytes */
+  auto GetData() const -> const char * { return data_; }
+
+  /** @return the length of the tuple in bytes */
+  auto GetLength() const -> uint32_t { return size_; }
+
+  /** @return the value of a column, the only accessor that allocates */
+  auto GetValue(const Schema *schema, uint32_t column_idx) const -> Value {
+    return Value::DeserializeFrom(GetDataPtr(schema, column_idx), schema->GetColumn(column_idx).GetType());
+  }
+
+  /** @return `true` if the column is NULL */
+  auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
+    const char *ptr = GetDataPtr(schema, column_idx);
+    switch (schema->GetColumn(column_idx).GetType()) {
+      case TypeId::BOOLEAN:
+        return Read<int8_t>(ptr) == BUSTUB_BOOLEAN_NULL;
+      case TypeId::TINYINT:
+        return Read<int8_t>(ptr) == BUSTUB_INT8_NULL;
+      case TypeId::SMALLINT:
+        return Read<int16_t>(ptr) == BUSTUB_INT16_NULL;
+      case TypeId::INTEGER:
+        return Read<int32_t>(ptr) == BUSTUB_INT32_NULL;
+      case TypeId::BIGINT:
+        return Read<int64_t>(ptr) == BUSTUB_INT64_NULL;
+      case TypeId::DECIMAL:
+        return Read<double>(ptr) == BUSTUB_DECIMAL_NULL;
+      case TypeId::TIMESTAMP:
+        return Read<uint64_t>(ptr) == BUSTUB_TIMESTAMP_NULL;
+      case TypeId::VARCHAR:
+        return Read<uint32_t>(ptr) == BUSTUB_VALUE_NULL;
+      default:
+        return false;
+    }
+  }
+
+  /** @return the raw value of a BOOLEAN column */
+  auto GetBool(const Schema *schema, uint32_t column_idx) const -> int8_t {
+    return Read<int8_t>(GetDataPtr(schema, column_idx));
+  }
+
+  /** @return the value of a TINYINT column */
+  auto GetInt8(const Schema *schema, uint32_t column_idx) const -> int8_t {
+    return Read<int8_t>(GetDataPtr(schema, column_idx));
+  }
+
+  /** @return the value of a SMALLINT column */
+  auto GetInt16(const Schema *schema, uint32_t column_idx) const -> int16_t {
+    return Read<int16_t>(GetDataPtr(schema, column_idx));
+  }
+
+  /** @return the value of an INTEGER column */
+  auto GetInt32(const Schema *schema, uint32_t column_idx) const -> int32_t {
+    return Read<int32_t>(GetDataPtr(schema, column_idx));
+  }
+
+  /** @return the value of a BIGINT column */
+  auto GetInt64(const Schema *schema, uint32_t column_idx) const -> int64_t {
+    return Read<int64_t>(GetDataPtr(schema, column_idx));
+  }
+
+  /** @return the value of a DECIMAL column */
+  auto GetDecimal(const Schema *schema, uint32_t column_idx) const -> double {
+    return Read<double>(GetDataPtr(schema, column_idx));
+  }
+
+  /** @return the characters of a non-NULL VARCHAR column, pointing into the tuple bytes */
+  auto GetVarchar(const Schema *schema, uint32_t column_idx) const -> std::string_view {
+    const char *ptr = GetDataPtr(schema, column_idx);
+    auto len = Read<uint32_t>(ptr);
+    // the serialized length counts the terminating '\0'
+    return {ptr + sizeof(uint32_t), len == 0 ? 0 : len - 1};
+  }
+
+  /** @return an owning copy of the tuple */
+  auto Materialize() const -> Tuple {
+    Tuple tuple(rid_);
+    tuple.data_.assign(data_, data_ + size_);
+    return tuple;
+  }
+
+ private:
+  template <class T>
+  static auto Read(const char *ptr) -> T {
+    T val;
+    memcpy(&val, ptr, sizeof(T));
+    return val;
+  }
+
+  /** @return the start of a column, for VARCHAR the start of its length prefix */
+  auto GetDataPtr(const Schema *schema, uint32_t column_idx) const -> const char * {
+    const auto &col = schema->GetColumn(column_idx);
+    if (col.IsInlined()) {
+      return data_ + col.GetOffset();
+    }
+    return data_ + Read<uint32_t>(data_ + col.GetOffset());
+  }
+
+  const char *data_{nullptr};
+  uint32_t size_{0};
+  RID rid_{};
+};
+
+}  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.h
+//
+// Identification: src/include/storage/table/zone_map.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** The zone of one column on one page */
+struct ColumnZone {
+  /** The smallest and largest non-NULL value, INVALID while the page has none or the column is not tracked */
+  Value min_;
+  Value max_;
+  /** The number of NULLs added, a tuple updated in place counts again */
+  uint32_t null_count_{0};
+  /** Whether a non-NULL value was added */
+  bool has_value_{false};
+};
+
+/**
+ * A bound on one column taken from a `column <op> constant` conjunct of a scan predicate. A tuple can
+ * only satisfy the predicate if the column is not NULL and lies within the bound.
+ */
+struct ZoneMapRange {
+  uint32_t column_idx_{0};
+  std::optional<Value> lower_;
+  bool lower_inclusive_{true};
+  std::optional<Value> upper_;
+  bool upper_inclusive_{true};
+};
+
+/**
+ * ZoneMap keeps the min, max and NULL count of every column of every page of a table heap, so that a
+ * scan with a range predicate can skip the pages whose values cannot match.
+ *
+ * Zones only widen as tuples are added: tuples marked deleted still count, which keeps the zones a
+ * conservative summary of the page. Vacuum rebuilds the zones of a page from the tuples left on it.
+ * Min and max are tracked for fixed-width columns, VARCHAR columns only get a NULL count. The zone
+ * map also records the pages in heap order with their number of tuples, so the pages to scan can be
+ * listed without reading them.
+ */
+class ZoneMap {
+ public:
+  /**
+   * Create an empty zone map.
+   * @param schema the schema of the table
+   */
+  explicit ZoneMap(const Schema &schema);
+
+  /**
+   * Widen the zones of a page by a tuple stored on it.
+   * @param page_id the page of the tuple
+   * @param slot the slot of the tuple on the page
+   * @param tuple the tuple, inserted or updated in place
+   */
+  void AddTuple(page_id_t page_id, uint32_t slot, const Tuple &tuple);
+
+  /**
+   * Replace the zones of a page by the zones of the tuples left on it, the number of slots is kept. The
+   * caller holds the write latch of the page, so no tuple is added to it in the meantime.
+   * @param page_id the page
+   * @param tuples every tuple stored on the page
+   */
+  void RebuildPage(page_id_t page_id, const std::vector<Tuple> &tuples);
+
+  /** @return the zone of a column on a page, std::nullopt if no tuple was added to the page */
+  auto GetZone(page_id_t page_id, uint32_t column_idx) const -> std::optional<ColumnZone>;
+
+  /** @return `false` if no tuple of the page can fall within all the ranges */
+  auto MayMatch(page_id_t page_id, const std::vector<ZoneMapRange> &ranges) const -> bool;
+
+  /**
+   * List the pages that may hold tuples within all the ranges.
+   * @return the pages in heap order, each with its number of slots
+   */
+  auto GetPages(const std::vector<ZoneMapRange> &ranges) const -> std::vector<std::pair<page_id_t, uint32_t>>;
+
+ private:
+  struct PageZones {
+    page_id_t page_id_;
+    /** The number of slots on the page */
+    uint32_t num_slots_;
+    std::vector<ColumnZone> columns_;
+  };
+
+  auto MayMatch(const PageZones &page, const std::vector<ZoneMapRange> &ranges) const -> bool;
+
+  /** Widen the zones of the columns by a tuple */
+  void Widen(std::vector<ColumnZone> *columns, const Tuple &tuple) const;
+
+  /** Protects pages_ and page_index_ */
+  mutable std::shared_mutex latch_;
+  Schema schema_;
+  /** Whether min and max are tracked, per column */
+  std::vector<bool> tracked_;
+  /** The pages in the order they were first added to */
+  std::vector<PageZones> pages_;
+  /** The index of every page in pages_ */
+  std::unordered_map<page_id_t, size_t> page_index_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,363 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/optimizer_internal.h"
+
+namespace bustub {
+
+namespace {
+
+/** A plan with fewer output columns than the plan it replaces */
+struct PrunedPlan {
+  AbstractPlanNodeRef plan_;
+  /** The position of every output column of the original plan in the output of plan_, std::nullopt if pruned */
+  std::vector<std::optional<uint32_t>> columns_;
+};
+
+using OrderBys = std::vector<std::pair<OrderByType, AbstractExpressionRef>>;
+
+auto Unchanged(const AbstractPlanNodeRef &plan) -> PrunedPlan {
+  PrunedPlan pruned{plan, {}};
+  for (uint32_t i = 0; i < plan->OutputSchema().GetColumnCount(); i++) {
+    pruned.columns_.emplace_back(i);
+  }
+  return pruned;
+}
+
+/** Mark the columns of the given tuple the expression reads */
+void MarkColumns(const AbstractExpressionRef &expr, uint32_t tuple_idx, std::vector<bool> *required) {
+  VisitColumns(expr, [&](const ColumnValueExpression &column) {
+    if (column.GetTupleIdx() == tuple_idx) {
+      (*required)[column.GetColIdx()] = true;
+    }
+  });
+}
+
+/** @return the expression reading the pruned inputs, inputs[i] is the pruned plan read as tuple i */
+auto Remap(const AbstractExpressionRef &expr, const std::vector<const PrunedPlan *> &inputs) -> AbstractExpressionRef {
+  return RewriteColumns(expr, [&](const ColumnValueExpression &column) {
+    const auto &input = *inputs[column.GetTupleIdx()];
+    return std::make_shared<ColumnValueExpression>(column.GetTupleIdx(), *input.columns_[column.GetColIdx()],
+                                                   column.GetReturnType());
+  });
+}
+
+auto RemapOrderBys(const OrderBys &order_bys, const PrunedPlan &child) -> OrderBys {
+  OrderBys remapped;
+  for (const auto &[order_type, expr] : order_bys) {
+    remapped.emplace_back(order_type, Remap(expr, {&child}));
+  }
+  return remapped;
+}
+
+/** @return the schema of the columns of the original schema kept by the mapping */
+auto PrunedSchema(const Schema &schema, const std::vector<std::optional<uint32_t>> &columns, uint32_t count)
+    -> SchemaRef {
+  std::vector<Column> kept(count, schema.GetColumn(0));
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    if (columns[i].has_value()) {
+      kept[*columns[i]] = schema.GetColumn(i);
+    }
+  }
+  return std::make_shared<Schema>(kept);
+}
+
+/** Keep one column when no column is read (e.g. the input of count(*)), a tuple without columns is never produced */
+void RequireAnyColumn(std::vector<bool> *required) {
+  if (!required->empty() && std::find(required->begin(), required->end(), true) == required->end()) {
+    (*required)[0] = true;
+  }
+}
+
+auto Prune(const AbstractPlanNodeRef &plan, std::vector<bool> required) -> PrunedPlan;
+
+/**
+ * Prune the input of an operator that materializes or copies its input, a projection of the required columns is
+ * put on top of the input if the input would still produce columns nobody reads.
+ */
+auto PruneInput(const AbstractPlanNodeRef &plan, std::vector<bool> required) -> PrunedPlan {
+  RequireAnyColumn(&required);
+  auto pruned = Prune(plan, required);
+  std::vector<AbstractExpressionRef> columns;
+  std::vector<std::optional<uint32_t>> positions(required.size());
+  for (uint32_t i = 0; i < required.size(); i++) {
+    if (required[i]) {
+      positions[i] = columns.size();
+      columns.push_back(std::make_shared<ColumnValueExpression>(0, *pruned.columns_[i],
+                                                                plan->OutputSchema().GetColumn(i).GetType()));
+    }
+  }
+  if (columns.size() == pruned.plan_->OutputSchema().GetColumnCount()) {
+    return pruned;
+  }
+  auto schema = PrunedSchema(plan->OutputSchema(), positions, columns.size());
+  return {std::make_shared<ProjectionPlanNode>(std::move(schema), std::move(columns), std::move(pruned.plan_)),
+          std::move(positions)};
+}
+
+/** Prune the inputs of a join, the output is the pruned left input followed by the pruned right input */
+auto PruneJoin(const AbstractPlanNodeRef &plan, const std::vector<bool> &required,
+               const std::vector<AbstractExpressionRef> &left_exprs,
+               const std::vector<AbstractExpressionRef> &right_exprs, PrunedPlan *left, PrunedPlan *right)
+    -> PrunedPlan {
+  const auto &left_plan = plan->GetChildAt(0);
+  const auto &right_plan = plan->GetChildAt(1);
+  const auto left_count = left_plan->OutputSchema().GetColumnCount();
+  std::vector<bool> left_required(required.begin(), required.begin() + left_count);
+  std::vector<bool> right_required(required.begin() + left_count, required.end());
+  for (const auto &expr : left_exprs) {
+    MarkColumns(expr, 0, &left_required);
+  }
+  for (const auto &expr : right_exprs) {
+    MarkColumns(expr, 1, &right_required);
+  }
+  *left = PruneInput(left_plan, left_required);
+  *right = PruneInput(right_plan, right_required);
+
+  auto pruned_left_count = left->plan_->OutputSchema().GetColumnCount();
+  std::vector<std::optional<uint32_t>> columns = left->columns_;
+  for (const auto &col : right->columns_) {
+    columns.push_back(col.has_value() ? std::make_optional(pruned_left_count + *col) : std::nullopt);
+  }
+  return {nullptr, std::move(columns)};
+}
+
+/** @return the plan producing at least the required output columns of the plan */
+auto Prune(const AbstractPlanNodeRef &plan, std::vector<bool> required) -> PrunedPlan {
+  RequireAnyColumn(&required);
+
+  switch (plan->GetType()) {
+    case PlanType::Projection: {
+      const auto &projection_plan = dynamic_cast<const ProjectionPlanNode &>(*plan);
+      const auto &exprs = projection_plan.GetExpressions();
+      std::vector<bool> child_required(projection_plan.GetChildPlan()->OutputSchema().GetColumnCount());
+      for (size_t i = 0; i < exprs.size(); i++) {
+        if (required[i]) {
+          MarkColumns(exprs[i], 0, &child_required);
+        }
+      }
+      auto child = Prune(projection_plan.GetChildPlan(), child_required);
+      std::vector<AbstractExpressionRef> kept;
+      std::vector<std::optional<uint32_t>> columns(exprs.size());
+      for (size_t i = 0; i < exprs.size(); i++) {
+        if (required[i]) {
+          columns[i] = kept.size();
+          kept.push_back(Remap(exprs[i], {&child}));
+        }
+      }
+      if (kept.size() == exprs.size() && child.plan_ == projection_plan.GetChildPlan()) {
+        return Unchanged(plan);
+      }
+      auto schema = PrunedSchema(plan->OutputSchema(), columns, kept.size());
+      return {std::make_shared<ProjectionPlanNode>(std::move(schema), std::move(kept), std::move(child.plan_)),
+              std::move(columns)};
+    }
+    case PlanType::Filter: {
+      // 过滤不复制元组，直接输出子节点裁剪后的列
+      const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*plan);
+      MarkColumns(filter_plan.GetPredicate(), 0, &required);
+      auto child = Prune(filter_plan.GetChildPlan(), required);
+      if (child.plan_ == filter_plan.GetChildPlan()) {
+        return Unchanged(plan);
+      }
+      auto schema = child.plan_->output_schema_;
+      auto predicate = Remap(filter_plan.GetPredicate(), {&child});
+      return {std::make_shared<FilterPlanNode>(std::move(schema), std::move(predicate), child.plan_),
+              std::move(child.columns_)};
+    }
+    case PlanType::Limit: {
+      const auto &limit_plan = dynamic_cast<const LimitPlanNode &>(*plan);
+      auto child = Prune(limit_plan.GetChildPlan(), required);
+      if (child.plan_ == limit_plan.GetChildPlan()) {
+        return Unchanged(plan);
+      }
+      auto schema = child.plan_->output_schema_;
+      return {std::make_shared<LimitPlanNode>(std::move(schema), child.plan_, limit_plan.GetLimit()),
+              std::move(child.columns_)};
+    }
+    case PlanType::Sort: {
+      const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*plan);
+      for (const auto &[order_type, expr] : sort_plan.GetOrderBy()) {
+        MarkColumns(expr, 0, &required);
+      }
+      auto child = PruneInput(sort_plan.GetChildPlan(), required);
+      if (child.plan_ == sort_plan.GetChildPlan()) {
+        return Unchanged(plan);
+      }
+      auto schema = child.plan_->output_schema_;
+      auto order_bys = RemapOrderBys(sort_plan.GetOrderBy(), child);
+      return {std::make_shared<SortPlanNode>(std::move(schema), child.plan_, std::move(order_bys)),
+              std::move(child.columns_)};
+    }
+    case PlanType::TopN: {
+      const auto &topn_plan = dynamic_cast<const TopNPlanNode &>(*plan);
+      for (const auto &[order_type, expr] : topn_plan.GetOrderBy()) {
+        MarkColumns(expr, 0, &required);
+      }
+      auto child = PruneInput(topn_plan.GetChildPlan(), required);
+      if (child.plan_ == topn_plan.GetChildPlan()) {
+        return Unchanged(plan);
+      }
+      auto schema = child.plan_->output_schema_;
+      auto order_bys = RemapOrderBys(topn_plan.GetOrderBy(), child);
+      return {std::make_shared<TopNPlanNode>(std::move(schema), child.plan_, std::move(order_bys), topn_plan.GetN()),
+              std::move(child.columns_)};
+    }
+    case PlanType::Aggregation: {
+      // 分组列都保留，没有被用到的聚合函数不再计算
+      const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*plan);
+      const auto &group_bys = agg_plan.GetGroupBys();
+      const auto &aggregates = agg_plan.GetAggregates();
+      std::vector<bool> child_required(agg_plan.GetChildPlan()->OutputSchema().GetColumnCount());
+      std::vector<std::optional<uint32_t>> columns;
+      std::vector<AbstractExpressionRef> kept_aggregates;
+      std::vector<AggregationType> kept_types;
+      for (size_t i = 0; i < group_bys.size(); i++) {
+        MarkColumns(group_bys[i], 0, &child_required);
+        columns.emplace_back(i);
+      }
+      for (size_t i = 0; i < aggregates.size(); i++) {
+        if (!required[group_bys.size() + i]) {
+          columns.emplace_back(std::nullopt);
+          continue;
+        }
+        MarkColumns(aggregates[i], 0, &child_required);
+        columns.emplace_back(group_bys.size() + kept_aggregates.size());
+        kept_aggregates.push_back(aggregates[i]);
+        kept_types.push_back(agg_plan.GetAggregateTypes()[i]);
+      }
+      auto child = PruneInput(agg_plan.GetChildPlan(), child_required);
+      if (child.plan_ == agg_plan.GetChildPlan() && kept_aggregates.size() == aggregates.size()) {
+        return Unchanged(plan);
+      }
+      std::vector<AbstractExpressionRef> new_group_bys;
+      for (const auto &expr : group_bys) {
+        new_group_bys.push_back(Remap(expr, {&child}));
+      }
+      for (auto &expr : kept_aggregates) {
+        expr = Remap(expr, {&child});
+      }
+      auto schema = PrunedSchema(plan->OutputSchema(), columns, group_bys.size() + kept_aggregates.size());
+      return {std::make_shared<AggregationPlanNode>(std::move(schema), child.plan_, std::move(new_group_bys),
+                                                    std::move(kept_aggregates), std::move(kept_types)),
+              std::move(columns)};
+    }
+    case PlanType::HashJoin: {
+      const auto &join_plan = dynamic_cast<const HashJoinPlanNode &>(*plan);
+      PrunedPlan left;
+      PrunedPlan right;
+      auto pruned = PruneJoin(plan, required, join_plan.LeftJoinKeyExpressions(),
+                              join_plan.RightJoinKeyExpressions(), &left, &right);
+      if (left.plan_ == join_plan.GetLeftPlan() && right.plan_ == join_plan.GetRightPlan()) {
+        return Unchanged(plan);
+      }
+      // 连接键按下标 0 和 1 分别读取左右两侧
+      std::vector<AbstractExpressionRef> left_keys;
+      std::vector<AbstractExpressionRef> right_keys;
+      for (const auto &expr : join_plan.LeftJoinKeyExpressions()) {
+        left_keys.push_back(Remap(expr, {&left, &right}));
+      }
+      for (const auto &expr : join_plan.RightJoinKeyExpressions()) {
+        right_keys.push_back(Remap(expr, {&left, &right}));
+      }
+      pruned.plan_ = std::make_shared<HashJoinPlanNode>(
+          std::make_shared<Schema>(NestedLoopJoinPlanNode::InferJoinSchema(*left.plan_, *right.plan_)), left.plan_,
+          right.plan_, std::move(left_keys), std::move(right_keys), join_plan.GetJoinType());
+      return pruned;
+    }
+    case PlanType::NestedLoopJoin: {
+      const auto &join_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*plan);
+      PrunedPlan left;
+      PrunedPlan right;
+      auto pruned = PruneJoin(plan, required, {join_plan.Predicate()}, {join_plan.Predicate()}, &left, &right);
+      if (left.plan_ == join_plan.GetLeftPlan() && right.plan_ == join_plan.GetRightPlan()) {
+        return Unchanged(plan);
+      }
+      pruned.plan_ = std::make_shared<NestedLoopJoinPlanNode>(
+          std::make_shared<Schema>(NestedLoopJoinPlanNode::InferJoinSchema(*left.plan_, *right.plan_)), left.plan_,
+          right.plan_, Remap(join_plan.Predicate(), {&left, &right}), join_plan.GetJoinType());
+      return pruned;
+    }
+    case PlanType::NestedIndexJoin: {
+      // 内表的元组由索引查找得到，只能裁剪外表
+      const auto &join_plan = dynamic_cast<const NestedIndexJoinPlanNode &>(*plan);
+      const auto &child_plan = join_plan.GetChildPlan();
+      const auto child_count = child_plan->OutputSchema().GetColumnCount();
+      std::vector<bool> child_required(required.begin(), required.begin() + child_count);
+      MarkColumns(join_plan.KeyPredicate(), 0, &child_required);
+      auto child = PruneInput(child_plan, child_required);
+      if (child.plan_ == child_plan) {
+        return Unchanged(plan);
+      }
+      auto pruned_child_count = child.plan_->OutputSchema().GetColumnCount();
+      std::vector<Column> output = child.plan_->OutputSchema().GetColumns();
+      std::vector<std::optional<uint32_t>> columns = child.columns_;
+      for (uint32_t i = 0; i < join_plan.InnerTableSchema().GetColumnCount(); i++) {
+        output.push_back(plan->OutputSchema().GetColumn(child_count + i));
+        columns.emplace_back(pruned_child_count + i);
+      }
+      return {std::make_shared<NestedIndexJoinPlanNode>(
+                  std::make_shared<Schema>(output), child.plan_, Remap(join_plan.KeyPredicate(), {&child}),
+                  join_plan.GetInnerTableOid(), join_plan.GetIndexOid(), join_plan.GetIndexName(),
+                  join_plan.index_table_name_, join_plan.inner_table_schema_, join_plan.GetJoinType()),
+              std::move(columns)};
+    }
+    case PlanType::SeqScan: {
+      // 扫描只输出需要的列，谓词仍然按表的列读取，不需要改写
+      const auto &scan_plan = dynamic_cast<const SeqScanPlanNode &>(*plan);
+      std::vector<uint32_t> column_ids;
+      std::vector<Column> output;
+      std::vector<std::optional<uint32_t>> columns(required.size());
+      for (uint32_t i = 0; i < required.size(); i++) {
+        if (required[i]) {
+          columns[i] = column_ids.size();
+          column_ids.push_back(scan_plan.GetColumnId(i));
+          output.push_back(plan->OutputSchema().GetColumn(i));
+        }
+      }
+      if (column_ids.size() == required.size()) {
+        return Unchanged(plan);
+      }
+      return {std::make_shared<SeqScanPlanNode>(std::make_shared<Schema>(output), scan_plan.GetTableOid(),
+                                                scan_plan.table_name_, scan_plan.filter_predicate_,
+                                                std::move(column_ids)),
+              std::move(columns)};
+    }
+    default: {
+      // 其他节点（索引扫描、插入、更新等）读取子节点的所有列，只在子节点内部裁剪
+      std::vector<AbstractPlanNodeRef> children;
+      for (const auto &child : plan->GetChildren()) {
+        children.push_back(Prune(child, std::vector<bool>(child->OutputSchema().GetColumnCount(), true)).plan_);
+      }
+      if (children == plan->GetChildren()) {
+        return Unchanged(plan);
+      }
+      return Unchanged(plan->CloneWithChildren(std::move(children)));
+    }
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeColumnPruning(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  return Prune(plan, std::vector<bool>(plan->OutputSchema().GetColumnCount(), true)).plan_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,475 @@
+#include "optimizer/cost_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "binder/table_ref/bound_join_ref.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "execution/plans/values_plan.h"
+
+namespace bustub {
+
+namespace {
+
+/** 把 constant <op> column 翻转成 column <op> constant 时对应的比较 */
+auto FlipComparison(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+auto ConstantOf(const AbstractExpressionRef &expr) -> std::optional<Value> {
+  if (expr == nullptr) {
+    return std::nullopt;
+  }
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr.get());
+  if (constant_expr == nullptr || constant_expr->val_.IsNull()) {
+    return std::nullopt;
+  }
+  return constant_expr->val_;
+}
+
+}  // namespace
+
+auto CostModel::HasStatistics(const AbstractPlanNodeRef &plan) const -> bool {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      return catalog_.GetTableStatistics(dynamic_cast<const SeqScanPlanNode &>(*plan).GetTableOid()) != nullptr;
+    case PlanType::IndexScan: {
+      const auto *index_info = catalog_.GetIndex(dynamic_cast<const IndexScanPlanNode &>(*plan).GetIndexOid());
+      return catalog_.GetTableStatistics(catalog_.GetTable(index_info->table_name_)->oid_) != nullptr;
+    }
+    case PlanType::NestedIndexJoin:
+      if (catalog_.GetTableStatistics(dynamic_cast<const NestedIndexJoinPlanNode &>(*plan).GetInnerTableOid()) ==
+          nullptr) {
+        return false;
+      }
+      break;
+    case PlanType::MockScan:
+      return false;
+    default:
+      break;
+  }
+  return std::all_of(plan->GetChildren().begin(), plan->GetChildren().end(),
+                     [this](const AbstractPlanNodeRef &child) { return HasStatistics(child); });
+}
+
+auto CostModel::TableRows(table_oid_t table_oid) const -> double {
+  auto stats = catalog_.GetTableStatistics(table_oid);
+  return stats == nullptr ? DEFAULT_TABLE_ROWS : static_cast<double>(stats->row_count_);
+}
+
+auto CostModel::TraceColumn(const AbstractPlanNodeRef &plan, uint32_t col_idx) const -> std::optional<ColumnOrigin> {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      const auto &scan_plan = dynamic_cast<const SeqScanPlanNode &>(*plan);
+      return ColumnOrigin{scan_plan.GetTableOid(), scan_plan.GetColumnId(col_idx)};
+    }
+    case PlanType::IndexScan: {
+      const auto *index_info = catalog_.GetIndex(dynamic_cast<const IndexScanPlanNode &>(*plan).GetIndexOid());
+      return ColumnOrigin{catalog_.GetTable(index_info->table_name_)->oid_, col_idx};
+    }
+    case PlanType::Filter:
+    case PlanType::Sort:
+    case PlanType::Limit:
+    case PlanType::TopN:
+    case PlanType::InitCheck:
+      return TraceColumn(plan->GetChildAt(0), col_idx);
+    case PlanType::Projection: {
+      const auto &expr = dynamic_cast<const ProjectionPlanNode &>(*plan).GetExpressions()[col_idx];
+      if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(expr.get()); column_expr != nullptr) {
+        return TraceColumn(plan->GetChildAt(0), column_expr->GetColIdx());
+      }
+      return std::nullopt;
+    }
+    case PlanType::NestedLoopJoin:
+    case PlanType::HashJoin: {
+      // 连接的输出是左表的列接着右表的列
+      auto left_count = plan->GetChildAt(0)->OutputSchema().GetColumnCount();
+      if (col_idx < left_count) {
+        return TraceColumn(plan->GetChildAt(0), col_idx);
+      }
+      return TraceColumn(plan->GetChildAt(1), col_idx - left_count);
+    }
+    case PlanType::NestedIndexJoin: {
+      const auto &join_plan = dynamic_cast<const NestedIndexJoinPlanNode &>(*plan);
+      auto left_count = plan->GetChildAt(0)->OutputSchema().GetColumnCount();
+      if (col_idx < left_count) {
+        return TraceColumn(plan->GetChildAt(0), col_idx);
+      }
+      return ColumnOrigin{join_plan.GetInnerTableOid(), col_idx - left_count};
+    }
+    case PlanType::Aggregation: {
+      // 聚合的输出是分组列接着聚合值
+      const auto &group_bys = dynamic_cast<const AggregationPlanNode &>(*plan).GetGroupBys();
+      if (col_idx >= group_bys.size()) {
+        return std::nullopt;
+      }
+      if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(group_bys[col_idx].get());
+          column_expr != nullptr) {
+        return TraceColumn(plan->GetChildAt(0), column_expr->GetColIdx());
+      }
+      return std::nullopt;
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+auto CostModel::RangeSelectivity(const ColumnOrigin &origin, const std::optional<Value> &low, bool low_inclusive,
+                                 const std::optional<Value> &high, bool high_inclusive) const
+    -> std::optional<double> {
+  auto stats = catalog_.GetTableStatistics(origin.first);
+  if (stats == nullptr || stats->row_count_ == 0) {
+    return std::nullopt;
+  }
+  const auto &column = stats->columns_[origin.second];
+  auto non_null = static_cast<double>(stats->row_count_ - column.null_count_) / static_cast<double>(stats->row_count_);
+  if (low.has_value() && high.has_value() && low_inclusive && high_inclusive &&
+      low->CompareEquals(*high) == CmpBool::CmpTrue) {
+    return column.EqualFraction(*low) * non_null;
+  }
+  // 区间内的比例 = 不超过上界的比例 - 低于下界的比例
+  double fraction = high.has_value() ? column.LessFraction(*high, high_inclusive) : 1.0;
+  if (low.has_value()) {
+    fraction -= column.LessFraction(*low, !low_inclusive);
+  }
+  return std::max(fraction, 0.0) * non_null;
+}
+
+auto CostModel::DistinctCount(const AbstractPlanNodeRef &plan, uint32_t col_idx) const -> std::optional<double> {
+  auto origin = TraceColumn(plan, col_idx);
+  if (!origin.has_value()) {
+    return std::nullopt;
+  }
+  auto stats = catalog_.GetTableStatistics(origin->first);
+  if (stats == nullptr) {
+    return std::nullopt;
+  }
+  // 过滤之后的不同值个数不会超过输出的行数
+  auto distinct = static_cast<double>(stats->columns_[origin->second].distinct_count_);
+  return std::max(1.0, std::min(distinct, EstimateCardinality(plan)));
+}
+
+auto CostModel::EqualColumnsSelectivity(const AbstractPlanNodeRef &left, uint32_t left_col,
+                                        const AbstractPlanNodeRef &right, uint32_t right_col) const -> double {
+  auto left_distinct = DistinctCount(left, left_col);
+  auto right_distinct = DistinctCount(right, right_col);
+  if (!left_distinct.has_value() && !right_distinct.has_value()) {
+    return DEFAULT_EQUAL_SELECTIVITY;
+  }
+  // 假设值较少的一侧的每个值都能在另一侧找到
+  return 1.0 / std::max(left_distinct.value_or(1.0), right_distinct.value_or(1.0));
+}
+
+auto CostModel::EstimateSelectivity(const AbstractExpressionRef &expr,
+                                    const std::vector<AbstractPlanNodeRef> &inputs) const -> double {
+  if (expr == nullptr) {
+    return 1.0;
+  }
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get()); logic_expr != nullptr) {
+    auto left = EstimateSelectivity(logic_expr->GetChildAt(0), inputs);
+    auto right = EstimateSelectivity(logic_expr->GetChildAt(1), inputs);
+    // 假设各个条件相互独立
+    return logic_expr->logic_type_ == LogicType::And ? left * right : left + right - left * right;
+  }
+  if (const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr.get()); constant_expr != nullptr) {
+    const auto &val = constant_expr->val_;
+    if (val.IsNull()) {
+      return 0.0;
+    }
+    // 只有布尔常量知道保留多少行，其他类型的常量按默认选择率估计
+    if (val.GetTypeId() != TypeId::BOOLEAN) {
+      return DEFAULT_SELECTIVITY;
+    }
+    return val.GetAs<bool>() ? 1.0 : 0.0;
+  }
+
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (cmp_expr == nullptr) {
+    return DEFAULT_SELECTIVITY;
+  }
+  auto comp_type = cmp_expr->comp_type_;
+  const auto *lhs = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(0).get());
+  const auto *rhs = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(1).get());
+  auto input_of = [&inputs](const ColumnValueExpression *column_expr) -> AbstractPlanNodeRef {
+    return column_expr->GetTupleIdx() < inputs.size() ? inputs[column_expr->GetTupleIdx()] : nullptr;
+  };
+
+  if (lhs != nullptr && rhs != nullptr) {
+    auto left_input = input_of(lhs);
+    auto right_input = input_of(rhs);
+    if (comp_type == ComparisonType::Equal && left_input != nullptr && right_input != nullptr) {
+      return EqualColumnsSelectivity(left_input, lhs->GetColIdx(), right_input, rhs->GetColIdx());
+    }
+  }
+
+  // 其余只估计 column <op> constant
+  auto constant = ConstantOf(cmp_expr->GetChildAt(1));
+  if (lhs == nullptr) {
+    lhs = rhs;
+    constant = ConstantOf(cmp_expr->GetChildAt(0));
+    comp_type = FlipComparison(comp_type);
+  }
+  std::optional<ColumnOrigin> origin;
+  if (lhs != nullptr && constant.has_value() && input_of(lhs) != nullptr) {
+    origin = TraceColumn(input_of(lhs), lhs->GetColIdx());
+  }
+
+  std::optional<double> selectivity;
+  if (origin.has_value()) {
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        selectivity = RangeSelectivity(*origin, constant, true, constant, true);
+        break;
+      case ComparisonType::NotEqual:
+        if (auto equal = RangeSelectivity(*origin, constant, true, constant, true); equal.has_value()) {
+          selectivity = RangeSelectivity(*origin, std::nullopt, true, std::nullopt, true).value() - *equal;
+        }
+        break;
+      case ComparisonType::LessThan:
+      case ComparisonType::LessThanOrEqual:
+        selectivity =
+            RangeSelectivity(*origin, std::nullopt, true, constant, comp_type == ComparisonType::LessThanOrEqual);
+        break;
+      case ComparisonType::GreaterThan:
+      case ComparisonType::GreaterThanOrEqual:
+        selectivity =
+            RangeSelectivity(*origin, constant, comp_type == ComparisonType::GreaterThanOrEqual, std::nullopt, true);
+        break;
+    }
+  }
+  if (selectivity.has_value()) {
+    return std::clamp(*selectivity, 0.0, 1.0);
+  }
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return DEFAULT_EQUAL_SELECTIVITY;
+    case ComparisonType::NotEqual:
+      return 1.0 - DEFAULT_EQUAL_SELECTIVITY;
+    default:
+      return DEFAULT_RANGE_SELECTIVITY;
+  }
+}
+
+auto CostModel::EstimateCardinality(const AbstractPlanNodeRef &plan) const -> double {
+  // 连接的每一层都会重新估计子计划的基数，不记下来的话估计的代价随连接的层数指数增长
+  if (auto it = cardinalities_.find(plan); it != cardinalities_.end()) {
+    return it->second;
+  }
+  auto rows = ComputeCardinality(plan);
+  cardinalities_.emplace(plan, rows);
+  return rows;
+}
+
+auto CostModel::ComputeCardinality(const AbstractPlanNodeRef &plan) const -> double {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      const auto &scan_plan = dynamic_cast<const SeqScanPlanNode &>(*plan);
+      if (scan_plan.filter_predicate_ == nullptr) {
+        return TableRows(scan_plan.GetTableOid());
+      }
+      // 谓词读的是过滤之前表中完整的元组
+      auto table_schema = std::make_shared<Schema>(catalog_.GetTable(scan_plan.GetTableOid())->schema_);
+      auto unfiltered = std::make_shared<SeqScanPlanNode>(std::move(table_schema), scan_plan.GetTableOid(),
+                                                          scan_plan.table_name_);
+      return TableRows(scan_plan.GetTableOid()) * EstimateSelectivity(scan_plan.filter_predicate_, {unfiltered});
+    }
+    case PlanType::IndexScan: {
+      const auto &scan_plan = dynamic_cast<const IndexScanPlanNode &>(*plan);
+      const auto *index_info = catalog_.GetIndex(scan_plan.GetIndexOid());
+      auto table_oid = catalog_.GetTable(index_info->table_name_)->oid_;
+      auto rows = TableRows(table_oid);
+      if (scan_plan.low_key_ == nullptr && scan_plan.high_key_ == nullptr) {
+        return rows;
+      }
+      if (scan_plan.low_key_ == scan_plan.high_key_ && !ConstantOf(scan_plan.low_key_).has_value()) {
+        // 等于一个执行时才知道的参数，按每个不同的值平均有多少行估计
+        auto stats = catalog_.GetTableStatistics(table_oid);
+        auto key_col = index_info->index_->GetKeyAttrs()[0];
+        if (stats == nullptr || stats->columns_[key_col].distinct_count_ == 0) {
+          return rows * DEFAULT_EQUAL_SELECTIVITY;
+        }
+        return rows / static_cast<double>(stats->columns_[key_col].distinct_count_);
+      }
+      auto selectivity = RangeSelectivity({table_oid, index_info->index_->GetKeyAttrs()[0]},
+                                          ConstantOf(scan_plan.low_key_), scan_plan.low_inclusive_,
+                                          ConstantOf(scan_plan.high_key_), scan_plan.high_inclusive_);
+      return rows * selectivity.value_or(DEFAULT_RANGE_SELECTIVITY);
+    }
+    case PlanType::Filter: {
+      const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*plan);
+      const auto &child = plan->GetChildAt(0);
+      auto selectivity = EstimateSelectivity(filter_plan.GetPredicate(), {child});
+      if (child->GetType() == PlanType::IndexScan) {
+        // 索引扫描上的剩余谓词包含了扫描的范围，按整张表估计以免重复计算范围的选择率
+        const auto *index_info = catalog_.GetIndex(dynamic_cast<const IndexScanPlanNode &>(*child).GetIndexOid());
+        auto table_rows = TableRows(catalog_.GetTable(index_info->table_name_)->oid_);
+        return std::min(EstimateCardinality(child), table_rows * selectivity);
+      }
+      return EstimateCardinality(child) * selectivity;
+    }
+    case PlanType::NestedLoopJoin: {
+      const auto &join_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*plan);
+      auto left = EstimateCardinality(join_plan.GetLeftPlan());
+      auto rows = left * EstimateCardinality(join_plan.GetRightPlan()) *
+                  EstimateSelectivity(join_plan.Predicate(), {join_plan.GetLeftPlan(), join_plan.GetRightPlan()});
+      return join_plan.GetJoinType() == JoinType::LEFT ? std::max(rows, left) : rows;
+    }
+    case PlanType::HashJoin: {
+      const auto &join_plan = dynamic_cast<const HashJoinPlanNode &>(*plan);
+      auto left = EstimateCardinality(join_plan.GetLeftPlan());
+      auto rows = left * EstimateCardinality(join_plan.GetRightPlan());
+      const auto &left_keys = join_plan.LeftJoinKeyExpressions();
+      const auto &right_keys = join_plan.RightJoinKeyExpressions();
+      for (size_t i = 0; i < left_keys.size(); i++) {
+        const auto *left_key = dynamic_cast<const ColumnValueExpression *>(left_keys[i].get());
+        const auto *right_key = dynamic_cast<const ColumnValueExpression *>(right_keys[i].get());
+        rows *= left_key != nullptr && right_key != nullptr
+                    ? EqualColumnsSelectivity(join_plan.GetLeftPlan(), left_key->GetColIdx(),
+                                              join_plan.GetRightPlan(), right_key->GetColIdx())
+                    : DEFAULT_EQUAL_SELECTIVITY;
+      }
+      return join_plan.GetJoinType() == JoinType::LEFT ? std::max(rows, left) : rows;
+    }
+    case PlanType::NestedIndexJoin: {
+      const auto &join_plan = dynamic_cast<const NestedIndexJoinPlanNode &>(*plan);
+      auto left = EstimateCardinality(join_plan.GetChildPlan());
+      auto inner_rows = TableRows(join_plan.GetInnerTableOid());
+      const auto *index_info = catalog_.GetIndex(join_plan.GetIndexOid());
+      auto inner_stats = catalog_.GetTableStatistics(join_plan.GetInnerTableOid());
+      double inner_distinct = inner_rows;
+      if (inner_stats != nullptr) {
+        const auto &key_column = inner_stats->columns_[index_info->index_->GetKeyAttrs()[0]];
+        inner_distinct = static_cast<double>(key_column.distinct_count_);
+      }
+      std::optional<double> left_distinct;
+      if (const auto *key_expr = dynamic_cast<const ColumnValueExpression *>(join_plan.key_predicate_.get());
+          key_expr != nullptr) {
+        left_distinct = DistinctCount(join_plan.GetChildPlan(), key_expr->GetColIdx());
+      }
+      auto rows = left * inner_rows / std::max({1.0, inner_distinct, left_distinct.value_or(1.0)});
+      return join_plan.GetJoinType() == JoinType::LEFT ? std::max(rows, left) : rows;
+    }
+    case PlanType::Aggregation: {
+      const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*plan);
+      auto child = EstimateCardinality(agg_plan.GetChildPlan());
+      if (agg_plan.GetGroupBys().empty()) {
+        return 1;
+      }
+      // 分组数不超过各分组列不同值个数之积
+      double groups = 1;
+      for (const auto &group_by : agg_plan.GetGroupBys()) {
+        std::optional<double> distinct;
+        if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(group_by.get());
+            column_expr != nullptr) {
+          distinct = DistinctCount(agg_plan.GetChildPlan(), column_expr->GetColIdx());
+        }
+        groups *= distinct.value_or(std::max(1.0, child * DEFAULT_EQUAL_SELECTIVITY));
+      }
+      return std::max(1.0, std::min(groups, child));
+    }
+    case PlanType::Limit:
+      return std::min(EstimateCardinality(plan->GetChildAt(0)),
+                      static_cast<double>(dynamic_cast<const LimitPlanNode &>(*plan).GetLimit()));
+    case PlanType::TopN:
+      return std::min(EstimateCardinality(plan->GetChildAt(0)),
+                      static_cast<double>(dynamic_cast<const TopNPlanNode &>(*plan).GetN()));
+    case PlanType::Values:
+      return static_cast<double>(dynamic_cast<const ValuesPlanNode &>(*plan).GetValues().size());
+    case PlanType::MockScan:
+      return DEFAULT_TABLE_ROWS;
+    case PlanType::Insert:
+    case PlanType::Update:
+    case PlanType::Delete:
+      return 1;
+    default:
+      return plan->GetChildren().empty() ? 1 : EstimateCardinality(plan->GetChildAt(0));
+  }
+}
+
+auto CostModel::EstimateCost(const AbstractPlanNodeRef &plan) const -> double {
+  if (auto it = costs_.find(plan); it != costs_.end()) {
+    return it->second;
+  }
+  auto cost = ComputeCost(plan);
+  costs_.emplace(plan, cost);
+  return cost;
+}
+
+auto CostModel::ComputeCost(const AbstractPlanNodeRef &plan) const -> double {
+  double children_cost = 0;
+  for (const auto &child : plan->GetChildren()) {
+    children_cost += EstimateCost(child);
+  }
+  auto rows = EstimateCardinality(plan);
+
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      auto table_rows = TableRows(dynamic_cast<const SeqScanPlanNode &>(*plan).GetTableOid());
+      return table_rows * (SEQ_TUPLE_COST + CPU_TUPLE_COST);
+    }
+    case PlanType::IndexScan: {
+      // 沿树下降一次，然后逐个回表读取元组
+      const auto *index_info = catalog_.GetIndex(dynamic_cast<const IndexScanPlanNode &>(*plan).GetIndexOid());
+      auto table_rows = TableRows(catalog_.GetTable(index_info->table_name_)->oid_);
+      return std::log2(table_rows + 1) + rows * INDEX_TUPLE_COST;
+    }
+    case PlanType::NestedLoopJoin: {
+      // 左侧的每个元组都要重新执行一遍右侧
+      auto left = EstimateCardinality(plan->GetChildAt(0));
+      auto right = EstimateCardinality(plan->GetChildAt(1));
+      return EstimateCost(plan->GetChildAt(0)) + std::max(1.0, left) * EstimateCost(plan->GetChildAt(1)) +
+             left * right * CPU_TUPLE_COST;
+    }
+    case PlanType::HashJoin: {
+      // 右侧建哈希表，左侧探测
+      auto left = EstimateCardinality(plan->GetChildAt(0));
+      auto right = EstimateCardinality(plan->GetChildAt(1));
+      return children_cost + right * HASH_BUILD_COST + left * HASH_PROBE_COST + rows * CPU_TUPLE_COST;
+    }
+    case PlanType::NestedIndexJoin: {
+      const auto &join_plan = dynamic_cast<const NestedIndexJoinPlanNode &>(*plan);
+      auto left = EstimateCardinality(join_plan.GetChildPlan());
+      auto inner_rows = TableRows(join_plan.GetInnerTableOid());
+      return children_cost + left * std::log2(inner_rows + 1) + rows * INDEX_TUPLE_COST;
+    }
+    case PlanType::Sort: {
+      auto child = EstimateCardinality(plan->GetChildAt(0));
+      return children_cost + child * std::log2(child + 1) * CPU_TUPLE_COST;
+    }
+    case PlanType::TopN: {
+      auto child = EstimateCardinality(plan->GetChildAt(0));
+      return children_cost + child * std::log2(rows + 1) * CPU_TUPLE_COST;
+    }
+    case PlanType::Aggregation:
+      return children_cost + EstimateCardinality(plan->GetChildAt(0)) * HASH_PROBE_COST;
+    default:
+      return children_cost + rows * CPU_TUPLE_COST;
+  }
+}
+
+}  // namespace bustub
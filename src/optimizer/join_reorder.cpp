@@ -0,0 +1,512 @@
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "binder/table_ref/bound_join_ref.h"
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/mock_scan_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/cost_model.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/optimizer_internal.h"
+
+namespace bustub {
+
+namespace {
+
+/** A set of relations of a join region, bit i is relation i */
+using RelationSet = uint64_t;
+
+/** Regions with up to this many relations are ordered by dynamic programming, larger ones greedily */
+constexpr size_t MAX_DP_RELATIONS = 12;
+
+/** A conjunct of the join predicates, its columns are ColumnValueExpression(relation, column of the relation) */
+struct Conjunct {
+  AbstractExpressionRef expr_;
+  RelationSet relations_{0};
+  /** Whether it is `column = column` over exactly two relations, a hash join key */
+  bool equi_{false};
+};
+
+/** The best plan found for a set of relations, a leaf when left_ and right_ are empty */
+struct JoinEntry {
+  double cost_{0};
+  RelationSet left_{0};
+  RelationSet right_{0};
+};
+
+/** @return the name of the table scanned at the bottom of a chain of single-child plans, if any */
+auto ScannedTableName(const AbstractPlanNodeRef &plan) -> std::optional<std::string> {
+  if (plan->GetType() == PlanType::SeqScan) {
+    return dynamic_cast<const SeqScanPlanNode &>(*plan).table_name_;
+  }
+  if (plan->GetType() == PlanType::MockScan) {
+    return dynamic_cast<const MockScanPlanNode &>(*plan).GetTable();
+  }
+  if (plan->GetChildren().size() == 1) {
+    return ScannedTableName(plan->GetChildAt(0));
+  }
+  return std::nullopt;
+}
+
+/**
+ * The inner joins of a region of the plan, flattened into its relations and the conjuncts of all join predicates.
+ * The relations are numbered in the order their columns appear in the output of the region.
+ */
+class JoinRegion {
+ public:
+  /** Flatten the inner joins under plan, the relations are returned to be optimized by the caller */
+  explicit JoinRegion(const AbstractPlanNodeRef &plan) : root_(plan) {
+    std::vector<AbstractExpressionRef> predicates;
+    Collect(plan, 0, &predicates);
+    for (const auto &predicate : predicates) {
+      std::vector<AbstractExpressionRef> conjuncts;
+      SplitConjuncts(predicate, &conjuncts);
+      for (const auto &expr : conjuncts) {
+        AddConjunct(expr);
+      }
+    }
+  }
+
+  auto Relations() -> std::vector<AbstractPlanNodeRef> & { return relations_; }
+  auto Conjuncts() const -> const std::vector<Conjunct> & { return conjuncts_; }
+
+  /** @return the relations joined to some relation of the set by a conjunct, excluding the set itself */
+  auto Neighbors(RelationSet set) const -> RelationSet {
+    RelationSet neighbors = 0;
+    for (size_t i = 0; i < relations_.size(); i++) {
+      if ((set >> i & 1) != 0) {
+        neighbors |= adjacency_[i];
+      }
+    }
+    return neighbors & ~set;
+  }
+
+  /** @return the joins of the region in their original order, over the current relations */
+  auto Rebuild() const -> AbstractPlanNodeRef {
+    size_t next = 0;
+    return RebuildFrom(root_, &next);
+  }
+
+  /** @return the plan joining the relations in the order of the table, with the columns in the original order */
+  auto Build(const std::unordered_map<RelationSet, JoinEntry> &table) const -> AbstractPlanNodeRef {
+    auto all = (RelationSet{1} << relations_.size()) - 1;
+    std::vector<size_t> layout;
+    auto plan = BuildSet(table, all, &layout);
+
+    // 没有任何关系的谓词（例如常量条件）放在最上面
+    std::vector<AbstractExpressionRef> constant_conjuncts;
+    for (const auto &conjunct : conjuncts_) {
+      if (conjunct.relations_ == 0) {
+        constant_conjuncts.push_back(conjunct.expr_);
+      }
+    }
+    if (!constant_conjuncts.empty()) {
+      plan = std::make_shared<FilterPlanNode>(plan->output_schema_, MakeConjunction(constant_conjuncts), plan);
+    }
+
+    // 连接顺序变化后列的顺序也变了，投影回原来的顺序
+    std::vector<size_t> identity(relations_.size());
+    std::iota(identity.begin(), identity.end(), 0);
+    if (layout == identity) {
+      return plan;
+    }
+    auto positions = Positions(layout);
+    std::vector<AbstractExpressionRef> columns;
+    for (size_t r = 0; r < relations_.size(); r++) {
+      const auto &schema = relations_[r]->OutputSchema();
+      for (uint32_t c = 0; c < schema.GetColumnCount(); c++) {
+        columns.push_back(
+            std::make_shared<ColumnValueExpression>(0, positions[r] + c, schema.GetColumn(c).GetType()));
+      }
+    }
+    return std::make_shared<ProjectionPlanNode>(root_->output_schema_, std::move(columns), plan);
+  }
+
+ private:
+  void Collect(const AbstractPlanNodeRef &plan, uint32_t offset, std::vector<AbstractExpressionRef> *predicates) {
+    if (plan->GetType() == PlanType::NestedLoopJoin) {
+      const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*plan);
+      if (nlj_plan.GetJoinType() == JoinType::INNER) {
+        auto left_count = static_cast<uint32_t>(nlj_plan.GetLeftPlan()->OutputSchema().GetColumnCount());
+        Collect(nlj_plan.GetLeftPlan(), offset, predicates);
+        Collect(nlj_plan.GetRightPlan(), offset + left_count, predicates);
+        // 谓词中的列改写为整个区域输出中的列号
+        predicates->push_back(RewriteColumns(nlj_plan.Predicate(), [&](const ColumnValueExpression &column) {
+          auto col_idx = offset + (column.GetTupleIdx() == 0 ? 0 : left_count) + column.GetColIdx();
+          return std::make_shared<ColumnValueExpression>(0, col_idx, column.GetReturnType());
+        }));
+        return;
+      }
+    }
+    relations_.push_back(plan);
+    offsets_.push_back(offset);
+    adjacency_.push_back(0);
+  }
+
+  /** Turn a conjunct over region columns into one over relation columns */
+  void AddConjunct(const AbstractExpressionRef &expr) {
+    Conjunct conjunct;
+    conjunct.expr_ = RewriteColumns(expr, [&](const ColumnValueExpression &column) {
+      auto relation = static_cast<uint32_t>(
+          std::upper_bound(offsets_.begin(), offsets_.end(), column.GetColIdx()) - offsets_.begin() - 1);
+      conjunct.relations_ |= RelationSet{1} << relation;
+      return std::make_shared<ColumnValueExpression>(relation, column.GetColIdx() - offsets_[relation],
+                                                     column.GetReturnType());
+    });
+    if (const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(conjunct.expr_.get());
+        cmp_expr != nullptr && cmp_expr->comp_type_ == ComparisonType::Equal) {
+      const auto *lhs = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(0).get());
+      const auto *rhs = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(1).get());
+      conjunct.equi_ = lhs != nullptr && rhs != nullptr && lhs->GetTupleIdx() != rhs->GetTupleIdx();
+    }
+    // 涉及多个关系的谓词把这些关系两两连起来
+    for (size_t i = 0; i < relations_.size(); i++) {
+      if ((conjunct.relations_ >> i & 1) != 0) {
+        adjacency_[i] |= conjunct.relations_ & ~(RelationSet{1} << i);
+      }
+    }
+    conjuncts_.push_back(std::move(conjunct));
+  }
+
+  /** @return the first output column of every relation in a layout */
+  auto Positions(const std::vector<size_t> &layout) const -> std::vector<uint32_t> {
+    std::vector<uint32_t> positions(relations_.size());
+    uint32_t position = 0;
+    for (auto r : layout) {
+      positions[r] = position;
+      position += relations_[r]->OutputSchema().GetColumnCount();
+    }
+    return positions;
+  }
+
+  /** Walk the joins in the same order as Collect, replacing the relations */
+  auto RebuildFrom(const AbstractPlanNodeRef &plan, size_t *next) const -> AbstractPlanNodeRef {
+    if (plan->GetType() == PlanType::NestedLoopJoin &&
+        dynamic_cast<const NestedLoopJoinPlanNode &>(*plan).GetJoinType() == JoinType::INNER) {
+      auto left = RebuildFrom(plan->GetChildAt(0), next);
+      auto right = RebuildFrom(plan->GetChildAt(1), next);
+      return plan->CloneWithChildren({left, right});
+    }
+    return relations_[(*next)++];
+  }
+
+  /** Rewrite a conjunct over relation columns to read the output of a join of two layouts */
+  auto ToJoinColumns(const AbstractExpressionRef &expr, const std::vector<size_t> &left,
+                     const std::vector<size_t> &right) const -> AbstractExpressionRef {
+    auto left_positions = Positions(left);
+    auto right_positions = Positions(right);
+    return RewriteColumns(expr, [&](const ColumnValueExpression &column) {
+      auto relation = column.GetTupleIdx();
+      bool in_left = std::find(left.begin(), left.end(), relation) != left.end();
+      auto col_idx = (in_left ? left_positions[relation] : right_positions[relation]) + column.GetColIdx();
+      return std::make_shared<ColumnValueExpression>(in_left ? 0 : 1, col_idx, column.GetReturnType());
+    });
+  }
+
+  auto BuildSet(const std::unordered_map<RelationSet, JoinEntry> &table, RelationSet set,
+                std::vector<size_t> *layout) const -> AbstractPlanNodeRef {
+    const auto &entry = table.at(set);
+    if (entry.left_ == 0) {
+      // 只涉及一个关系的谓词直接过滤这个关系
+      auto relation = static_cast<size_t>(__builtin_ctzll(set));
+      layout->push_back(relation);
+      std::vector<AbstractExpressionRef> local;
+      for (const auto &conjunct : conjuncts_) {
+        if (conjunct.relations_ == set) {
+          local.push_back(ToJoinColumns(conjunct.expr_, *layout, {}));
+        }
+      }
+      const auto &plan = relations_[relation];
+      if (local.empty()) {
+        return plan;
+      }
+      return std::make_shared<FilterPlanNode>(plan->output_schema_, MakeConjunction(local), plan);
+    }
+
+    std::vector<size_t> left_layout;
+    std::vector<size_t> right_layout;
+    auto left = BuildSet(table, entry.left_, &left_layout);
+    auto right = BuildSet(table, entry.right_, &right_layout);
+    // 连接两侧的等值谓词作为连接条件，其余跨两侧的谓词在连接之后过滤
+    std::vector<AbstractExpressionRef> equi;
+    std::vector<AbstractExpressionRef> others;
+    for (const auto &conjunct : conjuncts_) {
+      if ((conjunct.relations_ & ~set) != 0 || (conjunct.relations_ & ~entry.left_) == 0 ||
+          (conjunct.relations_ & ~entry.right_) == 0) {
+        continue;
+      }
+      (conjunct.equi_ ? equi : others).push_back(ToJoinColumns(conjunct.expr_, left_layout, right_layout));
+    }
+    if (equi.empty()) {
+      std::swap(equi, others);
+    }
+    AbstractPlanNodeRef plan = std::make_shared<NestedLoopJoinPlanNode>(
+        std::make_shared<Schema>(NestedLoopJoinPlanNode::InferJoinSchema(*left, *right)), left, right,
+        MakeConjunction(equi), JoinType::INNER);
+    if (!others.empty()) {
+      // 过滤的是连接的输出，左右两侧的列都在下标 0 的元组中
+      for (auto &other : others) {
+        auto left_count = static_cast<uint32_t>(left->OutputSchema().GetColumnCount());
+        other = RewriteColumns(other, [left_count](const ColumnValueExpression &column) {
+          auto col_idx = column.GetTupleIdx() == 0 ? column.GetColIdx() : left_count + column.GetColIdx();
+          return std::make_shared<ColumnValueExpression>(0, col_idx, column.GetReturnType());
+        });
+      }
+      plan = std::make_shared<FilterPlanNode>(plan->output_schema_, MakeConjunction(others), plan);
+    }
+    layout->insert(layout->end(), left_layout.begin(), left_layout.end());
+    layout->insert(layout->end(), right_layout.begin(), right_layout.end());
+    return plan;
+  }
+
+  AbstractPlanNodeRef root_;
+  std::vector<AbstractPlanNodeRef> relations_;
+  /** The first column of every relation in the output of the region */
+  std::vector<uint32_t> offsets_;
+  std::vector<RelationSet> adjacency_;
+  std::vector<Conjunct> conjuncts_;
+};
+
+/**
+ * Find the cheapest join tree of a region. The cost of a join is that of hashing its right input and probing with
+ * its left input, so the smaller input is always built on and a large fact table is only ever probed with.
+ */
+class JoinEnumerator {
+ public:
+  JoinEnumerator(const JoinRegion &region, std::vector<double> cardinalities, std::vector<double> selectivities)
+      : region_(region), cardinalities_(std::move(cardinalities)), selectivities_(std::move(selectivities)) {}
+
+  /** @return the join trees of every connected set considered, std::nullopt if the join graph is disconnected */
+  auto Enumerate() -> std::optional<std::unordered_map<RelationSet, JoinEntry>> {
+    const auto n = cardinalities_.size();
+    for (size_t i = 0; i < n; i++) {
+      table_[RelationSet{1} << i] = JoinEntry{};
+    }
+    if (n <= MAX_DP_RELATIONS) {
+      EnumerateDPccp();
+    } else {
+      EnumerateGreedy();
+    }
+    if (table_.count((RelationSet{1} << n) - 1) == 0) {
+      return std::nullopt;
+    }
+    return std::move(table_);
+  }
+
+ private:
+  /** @return the estimated number of tuples of joining a set, independent of the join order */
+  auto Cardinality(RelationSet set) -> double {
+    if (auto it = cardinality_cache_.find(set); it != cardinality_cache_.end()) {
+      return it->second;
+    }
+    double cardinality = 1;
+    for (size_t i = 0; i < cardinalities_.size(); i++) {
+      if ((set >> i & 1) != 0) {
+        cardinality *= cardinalities_[i];
+      }
+    }
+    const auto &conjuncts = region_.Conjuncts();
+    for (size_t i = 0; i < conjuncts.size(); i++) {
+      // 单个关系的谓词已经算在关系的行数里
+      if ((conjuncts[i].relations_ & ~set) == 0 && (conjuncts[i].relations_ & (conjuncts[i].relations_ - 1)) != 0) {
+        cardinality *= selectivities_[i];
+      }
+    }
+    cardinality = std::max(cardinality, 1.0);
+    cardinality_cache_[set] = cardinality;
+    return cardinality;
+  }
+
+  /** Consider joining two disjoint connected sets, in both orders */
+  void EmitPair(RelationSet s1, RelationSet s2) {
+    auto base = table_.at(s1).cost_ + table_.at(s2).cost_;
+    auto result = Cardinality(s1 | s2);
+    for (auto [left, right] : {std::pair{s1, s2}, std::pair{s2, s1}}) {
+      auto cost = base + Cardinality(right) * CostModel::HASH_BUILD_COST +
+                  Cardinality(left) * CostModel::HASH_PROBE_COST + result * CostModel::CPU_TUPLE_COST;
+      auto it = table_.find(s1 | s2);
+      if (it == table_.end() || cost < it->second.cost_) {
+        table_[s1 | s2] = JoinEntry{cost, left, right};
+      }
+    }
+  }
+
+  /** @return the relations numbered at most i */
+  static auto Prefix(size_t i) -> RelationSet { return (RelationSet{2} << i) - 1; }
+
+  /** Call fn with every non-empty subset of set, in increasing order so that subsets come before supersets */
+  template <class Fn>
+  static void ForEachSubset(RelationSet set, const Fn &fn) {
+    for (RelationSet subset = (0 - set) & set; subset != 0; subset = (subset - set) & set) {
+      fn(subset);
+    }
+  }
+
+  /**
+   * DPccp (Moerkotte and Neumann): enumerate every connected subgraph and, for each, every connected complement
+   * joined to it, so that only pairs that a join predicate connects are considered and each pair exactly once.
+   * The subsets of a pair are always enumerated before the pair.
+   */
+  void EnumerateDPccp() {
+    const auto n = cardinalities_.size();
+    for (size_t i = n; i-- > 0;) {
+      auto start = RelationSet{1} << i;
+      EmitCsg(start);
+      EnumerateCsgRec(start, Prefix(i));
+    }
+  }
+
+  void EnumerateCsgRec(RelationSet set, RelationSet excluded) {
+    auto neighbors = region_.Neighbors(set) & ~excluded;
+    ForEachSubset(neighbors, [&](RelationSet subset) { EmitCsg(set | subset); });
+    ForEachSubset(neighbors, [&](RelationSet subset) { EnumerateCsgRec(set | subset, excluded | neighbors); });
+  }
+
+  void EmitCsg(RelationSet s1) {
+    auto min = static_cast<size_t>(__builtin_ctzll(s1));
+    auto excluded = s1 | Prefix(min);
+    auto neighbors = region_.Neighbors(s1) & ~excluded;
+    for (size_t i = cardinalities_.size(); i-- > 0;) {
+      if ((neighbors >> i & 1) == 0) {
+        continue;
+      }
+      auto s2 = RelationSet{1} << i;
+      EmitPair(s1, s2);
+      EnumerateCmpRec(s1, s2, excluded | (Prefix(i) & neighbors));
+    }
+  }
+
+  void EnumerateCmpRec(RelationSet s1, RelationSet s2, RelationSet excluded) {
+    auto neighbors = region_.Neighbors(s2) & ~excluded;
+    ForEachSubset(neighbors, [&](RelationSet subset) {
+      if (table_.count(s2 | subset) != 0) {
+        EmitPair(s1, s2 | subset);
+      }
+    });
+    ForEachSubset(neighbors, [&](RelationSet subset) { EnumerateCmpRec(s1, s2 | subset, excluded | neighbors); });
+  }
+
+  /** GOO: repeatedly join the two connected trees whose join has the fewest tuples */
+  void EnumerateGreedy() {
+    std::vector<RelationSet> trees;
+    for (size_t i = 0; i < cardinalities_.size(); i++) {
+      trees.push_back(RelationSet{1} << i);
+    }
+    while (trees.size() > 1) {
+      std::optional<std::pair<size_t, size_t>> best;
+      double best_cardinality = 0;
+      for (size_t i = 0; i < trees.size(); i++) {
+        for (size_t j = i + 1; j < trees.size(); j++) {
+          if ((region_.Neighbors(trees[i]) & trees[j]) == 0) {
+            continue;
+          }
+          auto cardinality = Cardinality(trees[i] | trees[j]);
+          if (!best.has_value() || cardinality < best_cardinality) {
+            best = {i, j};
+            best_cardinality = cardinality;
+          }
+        }
+      }
+      if (!best.has_value()) {
+        return;
+      }
+      auto [i, j] = *best;
+      EmitPair(trees[i], trees[j]);
+      trees[i] |= trees[j];
+      trees.erase(trees.begin() + static_cast<std::ptrdiff_t>(j));
+    }
+  }
+
+  const JoinRegion &region_;
+  /** The estimated tuples of every relation after its own predicates */
+  std::vector<double> cardinalities_;
+  /** The estimated selectivity of every conjunct */
+  std::vector<double> selectivities_;
+  std::unordered_map<RelationSet, double> cardinality_cache_;
+  std::unordered_map<RelationSet, JoinEntry> table_;
+};
+
+}  // namespace
+
+auto Optimizer::OptimizeJoinOrder(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  if (plan->GetType() != PlanType::NestedLoopJoin ||
+      dynamic_cast<const NestedLoopJoinPlanNode &>(*plan).GetJoinType() != JoinType::INNER) {
+    std::vector<AbstractPlanNodeRef> children;
+    for (const auto &child : plan->GetChildren()) {
+      children.emplace_back(OptimizeJoinOrder(child));
+    }
+    return plan->CloneWithChildren(std::move(children));
+  }
+
+  JoinRegion region(plan);
+  auto &relations = region.Relations();
+  for (auto &relation : relations) {
+    relation = OptimizeJoinOrder(relation);
+  }
+  // 两个关系的连接只有建表的一侧可选，由 MakeHashJoin 决定。全部关系的集合要用 RelationSet 的低位表示，
+  // 而且 RelationSet{1} << n 不能移满整个字，所以关系数必须小于 RelationSet 的位数
+  if (relations.size() < 3 || relations.size() >= sizeof(RelationSet) * 8) {
+    return region.Rebuild();
+  }
+
+  // 每个关系的行数来自统计信息，没有时按表名估计；有关系无法估计时保持原来的顺序
+  CostModel cost_model(catalog_);
+  std::vector<double> table_rows;
+  std::vector<bool> analyzed;
+  for (const auto &relation : relations) {
+    analyzed.push_back(cost_model.HasStatistics(relation));
+    if (analyzed.back()) {
+      table_rows.push_back(cost_model.EstimateCardinality(relation));
+      continue;
+    }
+    auto name = ScannedTableName(relation);
+    auto rows = name.has_value() ? EstimatedCardinality(*name) : std::nullopt;
+    if (!rows.has_value()) {
+      return region.Rebuild();
+    }
+    table_rows.push_back(static_cast<double>(*rows));
+  }
+
+  std::vector<double> cardinalities = table_rows;
+  std::vector<double> selectivities;
+  for (const auto &conjunct : region.Conjuncts()) {
+    double selectivity;
+    if (conjunct.equi_) {
+      auto first = static_cast<size_t>(__builtin_ctzll(conjunct.relations_));
+      auto second = static_cast<size_t>(__builtin_ctzll(conjunct.relations_ & (conjunct.relations_ - 1)));
+      // 没有统计信息的等值连接假设是主键和外键的连接
+      selectivity = analyzed[first] && analyzed[second]
+                        ? cost_model.EstimateSelectivity(conjunct.expr_, relations)
+                        : 1.0 / std::max({1.0, table_rows[first], table_rows[second]});
+    } else {
+      selectivity = cost_model.EstimateSelectivity(conjunct.expr_, relations);
+    }
+    selectivities.push_back(selectivity);
+    if (conjunct.relations_ != 0 && (conjunct.relations_ & (conjunct.relations_ - 1)) == 0) {
+      cardinalities[__builtin_ctzll(conjunct.relations_)] *= selectivity;
+    }
+  }
+
+  JoinEnumerator enumerator(region, std::move(cardinalities), std::move(selectivities));
+  auto table = enumerator.Enumerate();
+  if (!table.has_value()) {
+    return region.Rebuild();
+  }
+  return region.Build(*table);
+}
+
+}  // namespace bustub
@@ -24,7 +24,8 @@ auto Optimizer::OptimizeMergeFilterScan(const AbstractPlanNodeRef &plan) -> Abst
     const auto &child_plan = *optimized_plan->children_[0];
     if (child_plan.GetType() == PlanType::SeqScan) {
       const auto &seq_scan_plan = dynamic_cast<const SeqScanPlanNode &>(child_plan);
-      if (seq_scan_plan.filter_predicate_ == nullptr) {
+      // 扫描的谓词按表的列读取，只有输出整张表的扫描才能直接接过 Filter 的谓词
+      if (seq_scan_plan.filter_predicate_ == nullptr && seq_scan_plan.GetColumnIds().empty()) {
         return std::make_shared<SeqScanPlanNode>(filter_plan.output_schema_, seq_scan_plan.table_oid_,
                                                  seq_scan_plan.table_name_, filter_plan.GetPredicate());
       }
@@ -7,22 +7,112 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/hash_join_plan.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "execution/plans/projection_plan.h"
+#include "optimizer/cost_model.h"
 #include "optimizer/optimizer.h"
 #include "type/type_id.h"
 
 namespace bustub {
 
+namespace {
+
+/**
+ * 把连接谓词拆成左右两侧的连接键，只支持由AND连接的 <column expr> = <column expr>
+ * 谓词中出现其他形式的表达式时返回false
+ */
+auto ExtractEquiJoinKeys(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *left_keys,
+                         std::vector<AbstractExpressionRef> *right_keys) -> bool {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get()); logic_expr != nullptr) {
+    return logic_expr->logic_type_ == LogicType::And &&
+           ExtractEquiJoinKeys(logic_expr->GetChildAt(0), left_keys, right_keys) &&
+           ExtractEquiJoinKeys(logic_expr->GetChildAt(1), left_keys, right_keys);
+  }
+
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (cmp_expr == nullptr || cmp_expr->comp_type_ != ComparisonType::Equal) {
+    return false;
+  }
+  const auto *lhs = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(0).get());
+  const auto *rhs = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(1).get());
+  if (lhs == nullptr || rhs == nullptr || lhs->GetTupleIdx() == rhs->GetTupleIdx()) {
+    return false;
+  }
+  // 等式两边可能是 右表列 = 左表列 的顺序
+  if (lhs->GetTupleIdx() == 0) {
+    left_keys->push_back(cmp_expr->GetChildAt(0));
+    right_keys->push_back(cmp_expr->GetChildAt(1));
+  } else {
+    left_keys->push_back(cmp_expr->GetChildAt(1));
+    right_keys->push_back(cmp_expr->GetChildAt(0));
+  }
+  return true;
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
-  // TODO(student): implement NestedLoopJoin -> HashJoin optimizer rule
-  // Note for 2023 Spring: You should at least support join keys of the form:
-  // 1. <column expr> = <column expr>
-  // 2. <column expr> = <column expr> AND <column expr> = <column expr>
-  return plan;
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeNLJAsHashJoin(child));
+  }
+  AbstractPlanNodeRef optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() == PlanType::NestedLoopJoin) {
+    const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*optimized_plan);
+    BUSTUB_ENSURE(nlj_plan.children_.size() == 2, "NLJ should have exactly 2 children.");
+
+    std::vector<AbstractExpressionRef> left_keys;
+    std::vector<AbstractExpressionRef> right_keys;
+    if (ExtractEquiJoinKeys(nlj_plan.Predicate(), &left_keys, &right_keys)) {
+      return MakeHashJoin(optimized_plan, std::move(left_keys), std::move(right_keys));
+    }
+  }
+  return optimized_plan;
+}
+
+auto Optimizer::MakeHashJoin(const AbstractPlanNodeRef &nlj, std::vector<AbstractExpressionRef> left_keys,
+                             std::vector<AbstractExpressionRef> right_keys) -> AbstractPlanNodeRef {
+  const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*nlj);
+  const auto &left = nlj_plan.GetLeftPlan();
+  const auto &right = nlj_plan.GetRightPlan();
+  CostModel cost_model(catalog_);
+  // 外连接必须保留左表，只有内连接能交换两侧
+  if (force_starter_rule_ || nlj_plan.GetJoinType() != JoinType::INNER || !cost_model.HasStatistics(nlj) ||
+      cost_model.EstimateCardinality(right) <= cost_model.EstimateCardinality(left)) {
+    return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, left, right, std::move(left_keys),
+                                              std::move(right_keys), nlj_plan.GetJoinType());
+  }
+
+  // 交换两侧，在较小的左表上建哈希表，连接键的元组下标也随之交换
+  auto swap_side = [](const AbstractExpressionRef &key, uint32_t tuple_idx) -> AbstractExpressionRef {
+    const auto &column_expr = dynamic_cast<const ColumnValueExpression &>(*key);
+    return std::make_shared<ColumnValueExpression>(tuple_idx, column_expr.GetColIdx(), column_expr.GetReturnType());
+  };
+  std::vector<AbstractExpressionRef> swapped_left_keys;
+  std::vector<AbstractExpressionRef> swapped_right_keys;
+  for (size_t i = 0; i < left_keys.size(); i++) {
+    swapped_left_keys.push_back(swap_side(right_keys[i], 0));
+    swapped_right_keys.push_back(swap_side(left_keys[i], 1));
+  }
+  auto swapped = std::make_shared<HashJoinPlanNode>(
+      std::make_shared<Schema>(NestedLoopJoinPlanNode::InferJoinSchema(*right, *left)), right, left,
+      std::move(swapped_left_keys), std::move(swapped_right_keys), JoinType::INNER);
+
+  // 交换后右表的列在前，投影回原来的列顺序
+  const auto left_count = left->OutputSchema().GetColumnCount();
+  const auto right_count = right->OutputSchema().GetColumnCount();
+  std::vector<AbstractExpressionRef> columns;
+  for (uint32_t i = 0; i < left_count + right_count; i++) {
+    auto col_idx = i < left_count ? right_count + i : i - left_count;
+    columns.push_back(
+        std::make_shared<ColumnValueExpression>(0, col_idx, swapped->OutputSchema().GetColumn(col_idx).GetType()));
+  }
+  return std::make_shared<ProjectionPlanNode>(nlj_plan.output_schema_, std::move(columns), std::move(swapped));
 }
 
 }  // namespace bustub
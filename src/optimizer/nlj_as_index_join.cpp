@@ -16,6 +16,7 @@
 #include "execution/plans/nested_loop_join_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "optimizer/cost_model.h"
 #include "optimizer/optimizer.h"
 #include "type/type_id.h"
 
@@ -24,12 +25,35 @@ namespace bustub {
 auto Optimizer::MatchIndex(const std::string &table_name, uint32_t index_key_idx)
     -> std::optional<std::tuple<index_oid_t, std::string>> {
   const auto key_attrs = std::vector{index_key_idx};
+  std::optional<std::tuple<index_oid_t, std::string>> matched = std::nullopt;
   for (const auto *index_info : catalog_.GetTableIndexes(table_name)) {
-    if (key_attrs == index_info->index_->GetKeyAttrs()) {
+    if (key_attrs != index_info->index_->GetKeyAttrs()) {
+      continue;
+    }
+    // Callers probe the index with a single key, a hash index answers that without walking a tree
+    if (index_info->index_type_ != IndexType::BPlusTreeIndex) {
       return std::make_optional(std::make_tuple(index_info->index_oid_, index_info->name_));
     }
+    if (matched == std::nullopt) {
+      matched = std::make_optional(std::make_tuple(index_info->index_oid_, index_info->name_));
+    }
+  }
+  return matched;
+}
+
+auto Optimizer::CheaperJoin(const AbstractPlanNodeRef &nlj, AbstractPlanNodeRef index_join,
+                            const AbstractExpressionRef &left_key, const AbstractExpressionRef &right_key)
+    -> AbstractPlanNodeRef {
+  // 只有在自定义规则下 NLJ 之后才会被改写成哈希连接
+  CostModel cost_model(catalog_);
+  if (force_starter_rule_ || !cost_model.HasStatistics(nlj)) {
+    return index_join;
+  }
+  auto hash_join = MakeHashJoin(nlj, {left_key}, {right_key});
+  if (cost_model.EstimateCost(hash_join) < cost_model.EstimateCost(index_join)) {
+    return nlj;
   }
-  return std::nullopt;
+  return index_join;
 }
 
 auto Optimizer::OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
@@ -37,7 +61,7 @@ auto Optimizer::OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> Abstr
   for (const auto &child : plan->GetChildren()) {
     children.emplace_back(OptimizeNLJAsIndexJoin(child));
   }
-  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+  AbstractPlanNodeRef optimized_plan = plan->CloneWithChildren(std::move(children));
 
   if (optimized_plan->GetType() == PlanType::NestedLoopJoin) {
     const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*optimized_plan);
@@ -64,20 +88,26 @@ auto Optimizer::OptimizeNLJAsIndexJoin(const AbstractPlanNodeRef &plan) -> Abstr
                 if (auto index = MatchIndex(right_seq_scan.table_name_, right_expr->GetColIdx());
                     index != std::nullopt) {
                   auto [index_oid, index_name] = *index;
-                  return std::make_shared<NestedIndexJoinPlanNode>(
-                      nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), std::move(left_expr_tuple_0),
-                      right_seq_scan.GetTableOid(), index_oid, std::move(index_name), right_seq_scan.table_name_,
-                      right_seq_scan.output_schema_, nlj_plan.GetJoinType());
+                  return CheaperJoin(optimized_plan,
+                                     std::make_shared<NestedIndexJoinPlanNode>(
+                                         nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), std::move(left_expr_tuple_0),
+                                         right_seq_scan.GetTableOid(), index_oid, std::move(index_name),
+                                         right_seq_scan.table_name_, right_seq_scan.output_schema_,
+                                         nlj_plan.GetJoinType()),
+                                     expr->children_[0], expr->children_[1]);
                 }
               }
               if (left_expr->GetTupleIdx() == 1 && right_expr->GetTupleIdx() == 0) {
                 if (auto index = MatchIndex(right_seq_scan.table_name_, left_expr->GetColIdx());
                     index != std::nullopt) {
                   auto [index_oid, index_name] = *index;
-                  return std::make_shared<NestedIndexJoinPlanNode>(
-                      nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), std::move(right_expr_tuple_0),
-                      right_seq_scan.GetTableOid(), index_oid, std::move(index_name), right_seq_scan.table_name_,
-                      right_seq_scan.output_schema_, nlj_plan.GetJoinType());
+                  return CheaperJoin(optimized_plan,
+                                     std::make_shared<NestedIndexJoinPlanNode>(
+                                         nlj_plan.output_schema_, nlj_plan.GetLeftPlan(), std::move(right_expr_tuple_0),
+                                         right_seq_scan.GetTableOid(), index_oid, std::move(index_name),
+                                         right_seq_scan.table_name_, right_seq_scan.output_schema_,
+                                         nlj_plan.GetJoinType()),
+                                     expr->children_[1], expr->children_[0]);
                 }
               }
             }
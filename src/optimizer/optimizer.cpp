@@ -20,6 +20,11 @@ auto Optimizer::Optimize(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef
 }
 
 auto Optimizer::EstimatedCardinality(const std::string &table_name) -> std::optional<size_t> {
+  if (const auto *table_info = catalog_.GetTable(table_name); table_info != Catalog::NULL_TABLE_INFO) {
+    if (auto stats = catalog_.GetTableStatistics(table_info->oid_); stats != nullptr) {
+      return std::make_optional(stats->row_count_);
+    }
+  }
   if (StringUtil::EndsWith(table_name, "_1m")) {
     return std::make_optional(1000000);
   }
@@ -11,9 +11,15 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   auto p = plan;
   p = OptimizeMergeProjection(p);
   p = OptimizeMergeFilterNLJ(p);
+  p = OptimizePredicatePushdown(p);
+  p = OptimizeJoinOrder(p);
+  p = OptimizeNLJAsIndexJoin(p);
   p = OptimizeNLJAsHashJoin(p);
   p = OptimizeOrderByAsIndexScan(p);
   p = OptimizeSortLimitAsTopN(p);
+  // 前面的规则按 Filter 在 SeqScan 上方的形式匹配，留到最后再把过滤合并到扫描中，扫描才能用 zone map 跳过页面
+  p = OptimizeMergeFilterScan(p);
+  p = OptimizeColumnPruning(p);
   return p;
 }
 
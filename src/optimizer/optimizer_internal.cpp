@@ -1,5 +1,39 @@
+#include "optimizer/optimizer_internal.h"
+
+#include <memory>
+
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 
 void OptimizerHelperFunction() {}
 
+void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    SplitConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    SplitConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  if (const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr.get());
+      constant_expr != nullptr && !constant_expr->val_.IsNull() &&
+      constant_expr->val_.CastAs(TypeId::BOOLEAN).GetAs<bool>()) {
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+auto MakeConjunction(const std::vector<AbstractExpressionRef> &conjuncts) -> AbstractExpressionRef {
+  if (conjuncts.empty()) {
+    return std::make_shared<ConstantValueExpression>(ValueFactory::GetBooleanValue(true));
+  }
+  auto expr = conjuncts[0];
+  for (size_t i = 1; i < conjuncts.size(); i++) {
+    expr = std::make_shared<LogicExpression>(expr, conjuncts[i], LogicType::And);
+  }
+  return expr;
+}
+
 }  // namespace bustub
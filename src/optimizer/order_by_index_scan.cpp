@@ -1,5 +1,9 @@
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
@@ -8,7 +12,10 @@
 #include "common/exception.h"
 #include "common/macros.h"
 #include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
@@ -16,28 +23,230 @@
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
+#include "optimizer/cost_model.h"
 #include "optimizer/optimizer.h"
 #include "type/type_id.h"
 
 namespace bustub {
 
+namespace {
+
+/** Bounds on one column collected from the conjuncts of a predicate, a null expression means unbounded. */
+struct ColumnRange {
+  AbstractExpressionRef low_;
+  bool low_inclusive_{true};
+  AbstractExpressionRef high_;
+  bool high_inclusive_{true};
+};
+
+/** @return true if the expression is a parameter of a prepared statement, its value is not known until EXECUTE */
+auto IsParameter(const AbstractExpressionRef &expr) -> bool {
+  return dynamic_cast<const ParameterValueExpression *>(expr.get()) != nullptr;
+}
+
+/** @return true if bound (with inclusive) is a tighter low bound than the one in range */
+auto TighterLow(const ColumnRange &range, const Value &bound, bool inclusive) -> bool {
+  if (range.low_ == nullptr) {
+    return true;
+  }
+  if (IsParameter(range.low_)) {
+    return false;
+  }
+  const auto &curr = dynamic_cast<const ConstantValueExpression &>(*range.low_).val_;
+  if (bound.CompareGreaterThan(curr) == CmpBool::CmpTrue) {
+    return true;
+  }
+  return bound.CompareEquals(curr) == CmpBool::CmpTrue && !inclusive;
+}
+
+auto TighterHigh(const ColumnRange &range, const Value &bound, bool inclusive) -> bool {
+  if (range.high_ == nullptr) {
+    return true;
+  }
+  if (IsParameter(range.high_)) {
+    return false;
+  }
+  const auto &curr = dynamic_cast<const ConstantValueExpression &>(*range.high_).val_;
+  if (bound.CompareLessThan(curr) == CmpBool::CmpTrue) {
+    return true;
+  }
+  return bound.CompareEquals(curr) == CmpBool::CmpTrue && !inclusive;
+}
+
+/**
+ * Walk the AND tree of a scan predicate and collect the `column <op> constant` conjuncts into ranges. Only
+ * integer constants are used since the b+ tree index only stores integer keys. An equality with an integer parameter
+ * of a prepared statement pins the column as well, other bounds can not be compared with it and are left to the
+ * residual predicate.
+ */
+void CollectColumnRanges(const AbstractExpressionRef &expr, std::map<uint32_t, ColumnRange> *ranges) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get()); logic_expr != nullptr) {
+    if (logic_expr->logic_type_ == LogicType::And) {
+      CollectColumnRanges(logic_expr->GetChildAt(0), ranges);
+      CollectColumnRanges(logic_expr->GetChildAt(1), ranges);
+    }
+    return;
+  }
+
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (cmp_expr == nullptr) {
+    return;
+  }
+
+  auto comp_type = cmp_expr->comp_type_;
+  const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(0).get());
+  auto constant_ref = cmp_expr->GetChildAt(1);
+  if (column_expr == nullptr) {
+    // `constant <op> column`, flip the comparison
+    column_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->GetChildAt(1).get());
+    constant_ref = cmp_expr->GetChildAt(0);
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column_expr != nullptr && column_expr->GetTupleIdx() == 0 && IsParameter(constant_ref)) {
+    if (comp_type == ComparisonType::Equal && constant_ref->GetReturnType() == TypeId::INTEGER) {
+      (*ranges)[column_expr->GetColIdx()] = ColumnRange{constant_ref, true, constant_ref, true};
+    }
+    return;
+  }
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(constant_ref.get());
+  if (column_expr == nullptr || constant_expr == nullptr || column_expr->GetTupleIdx() != 0 ||
+      constant_expr->val_.GetTypeId() != TypeId::INTEGER || constant_expr->val_.IsNull()) {
+    return;
+  }
+
+  auto &range = (*ranges)[column_expr->GetColIdx()];
+  const auto &bound = constant_expr->val_;
+  bool set_low = false;
+  bool set_high = false;
+  bool inclusive = true;
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      set_low = set_high = true;
+      break;
+    case ComparisonType::GreaterThan:
+      inclusive = false;
+      set_low = true;
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      set_low = true;
+      break;
+    case ComparisonType::LessThan:
+      inclusive = false;
+      set_high = true;
+      break;
+    case ComparisonType::LessThanOrEqual:
+      set_high = true;
+      break;
+    default:
+      return;
+  }
+  if (set_low && TighterLow(range, bound, inclusive)) {
+    range.low_ = constant_ref;
+    range.low_inclusive_ = inclusive;
+  }
+  if (set_high && TighterHigh(range, bound, inclusive)) {
+    range.high_ = constant_ref;
+    range.high_inclusive_ = inclusive;
+  }
+}
+
+/** @return the scan predicate of a SeqScan or Filter(SeqScan), nullptr if there is none */
+auto ScanPredicate(const AbstractPlanNodeRef &plan) -> AbstractExpressionRef {
+  if (plan->GetType() == PlanType::Filter) {
+    return dynamic_cast<const FilterPlanNode &>(*plan).GetPredicate();
+  }
+  return dynamic_cast<const SeqScanPlanNode &>(*plan).filter_predicate_;
+}
+
+/** @return the SeqScan below a SeqScan or Filter(SeqScan) plan, nullptr if the plan has another shape */
+auto ScanBelow(const AbstractPlanNodeRef &plan) -> const SeqScanPlanNode * {
+  if (plan->GetType() == PlanType::SeqScan) {
+    return dynamic_cast<const SeqScanPlanNode *>(plan.get());
+  }
+  if (plan->GetType() == PlanType::Filter && plan->GetChildAt(0)->GetType() == PlanType::SeqScan) {
+    return dynamic_cast<const SeqScanPlanNode *>(plan->GetChildAt(0).get());
+  }
+  return nullptr;
+}
+
+/** @return true if the range pins the column to a single value */
+auto IsPointRange(const ColumnRange &range) -> bool {
+  if (range.low_ == nullptr || range.high_ == nullptr || !range.low_inclusive_ || !range.high_inclusive_) {
+    return false;
+  }
+  if (range.low_ == range.high_) {
+    return true;
+  }
+  const auto &low = dynamic_cast<const ConstantValueExpression &>(*range.low_).val_;
+  const auto &high = dynamic_cast<const ConstantValueExpression &>(*range.high_).val_;
+  return low.CompareEquals(high) == CmpBool::CmpTrue;
+}
+
+/** @return a b+ tree index keyed on exactly the column, nullptr if there is none */
+auto MatchTreeIndex(const Catalog &catalog, const std::string &table_name, uint32_t col_idx) -> const IndexInfo * {
+  for (const auto *index_info : catalog.GetTableIndexes(table_name)) {
+    if (index_info->index_type_ == IndexType::BPlusTreeIndex &&
+        index_info->index_->GetKeyAttrs() == std::vector<uint32_t>{col_idx}) {
+      return index_info;
+    }
+  }
+  return nullptr;
+}
+
+/** Put the predicate of the replaced scan back on top of the index scan */
+auto WithResidualFilter(const AbstractExpressionRef &predicate, AbstractPlanNodeRef index_scan) -> AbstractPlanNodeRef {
+  if (predicate == nullptr) {
+    return index_scan;
+  }
+  auto output_schema = index_scan->output_schema_;
+  return std::make_shared<FilterPlanNode>(std::move(output_schema), predicate, std::move(index_scan));
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  // Keep full scans below update / delete, an index scan could see the rows the statement itself moves in the index
+  if (plan->GetType() == PlanType::Update || plan->GetType() == PlanType::Delete) {
+    return plan;
+  }
+
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
     children.emplace_back(OptimizeOrderByAsIndexScan(child));
   }
-  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+  AbstractPlanNodeRef optimized_plan = plan->CloneWithChildren(std::move(children));
 
   if (optimized_plan->GetType() == PlanType::Sort) {
     const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*optimized_plan);
     const auto &order_bys = sort_plan.GetOrderBy();
 
+    // All keys ascending (or default) scan forward, all keys descending scan backward
+    std::optional<bool> reverse;
     std::vector<uint32_t> order_by_column_ids;
     for (const auto &[order_type, expr] : order_bys) {
-      // Order type is asc or default
-      if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+      bool desc = order_type == OrderByType::DESC;
+      if (!(desc || order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+        return optimized_plan;
+      }
+      if (reverse.has_value() && *reverse != desc) {
         return optimized_plan;
       }
+      reverse = desc;
 
       // Order expression is a column value expression
       const auto *column_value_expr = dynamic_cast<ColumnValueExpression *>(expr.get());
@@ -52,12 +261,35 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
     const auto &child_plan = optimized_plan->children_[0];
 
-    if (child_plan->GetType() == PlanType::SeqScan) {
-      const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
-      const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
+    // A range scan produced below already walks an index, reuse it if it is ordered by the sort keys
+    const AbstractPlanNodeRef *range_scan = &child_plan;
+    if (child_plan->GetType() == PlanType::Filter) {
+      range_scan = &child_plan->children_[0];
+    }
+    if ((*range_scan)->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(**range_scan);
+      const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+      // Only the b+ tree keeps its keys in order
+      if (index_info->index_type_ == IndexType::BPlusTreeIndex &&
+          index_info->index_->GetKeyAttrs() == order_by_column_ids) {
+        auto reordered = std::make_shared<IndexScanPlanNode>(
+            index_scan.output_schema_, index_scan.index_oid_, index_scan.low_key_, index_scan.low_inclusive_,
+            index_scan.high_key_, index_scan.high_inclusive_, reverse.value_or(false));
+        if (child_plan->GetType() == PlanType::Filter) {
+          return WithResidualFilter(ScanPredicate(child_plan), std::move(reordered));
+        }
+        return reordered;
+      }
+    }
+
+    if (const auto *seq_scan = ScanBelow(child_plan); seq_scan != nullptr) {
+      const auto *table_info = catalog_.GetTable(seq_scan->GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
 
       for (const auto *index : indices) {
+        if (index->index_type_ != IndexType::BPlusTreeIndex) {
+          continue;
+        }
         const auto &columns = index->key_schema_.GetColumns();
         // check index key schema == order by columns
         bool valid = true;
@@ -69,10 +301,70 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
             }
           }
           if (valid) {
-            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+            auto predicate = ScanPredicate(child_plan);
+            // Bounds on the leading key column narrow the scan, the predicate is still evaluated on top
+            ColumnRange range;
+            if (predicate != nullptr && columns.size() == 1) {
+              std::map<uint32_t, ColumnRange> ranges;
+              CollectColumnRanges(predicate, &ranges);
+              if (auto it = ranges.find(order_by_column_ids[0]); it != ranges.end()) {
+                range = it->second;
+              }
+            }
+            auto index_scan = std::make_shared<IndexScanPlanNode>(
+                seq_scan->output_schema_, index->index_oid_, range.low_, range.low_inclusive_, range.high_,
+                range.high_inclusive_, reverse.value_or(false));
+            auto candidate = WithResidualFilter(predicate, std::move(index_scan));
+            // 有统计信息时，回表读取太多元组的索引扫描不如顺序扫描后排序
+            CostModel cost_model(catalog_);
+            if (cost_model.HasStatistics(optimized_plan) &&
+                cost_model.EstimateCost(candidate) >= cost_model.EstimateCost(optimized_plan)) {
+              continue;
+            }
+            return candidate;
+          }
+        }
+      }
+    }
+  }
+
+  // A range predicate on an indexed column is answered by an index range scan instead of a full table scan,
+  // an equality predicate is answered by a single probe of a hash index if the column has one
+  if (optimized_plan->GetType() == PlanType::Filter || optimized_plan->GetType() == PlanType::SeqScan) {
+    const auto *seq_scan = ScanBelow(optimized_plan);
+    auto predicate = seq_scan == nullptr ? nullptr : ScanPredicate(optimized_plan);
+    if (predicate != nullptr) {
+      std::map<uint32_t, ColumnRange> ranges;
+      CollectColumnRanges(predicate, &ranges);
+      // 有统计信息时在顺序扫描和各个可用的索引扫描中选代价最低的，否则用第一个可用的索引
+      CostModel cost_model(catalog_);
+      bool use_cost = cost_model.HasStatistics(optimized_plan);
+      AbstractPlanNodeRef best_plan = optimized_plan;
+      double best_cost = use_cost ? cost_model.EstimateCost(optimized_plan) : 0;
+      for (const auto &[col_idx, range] : ranges) {
+        std::optional<index_oid_t> index_oid;
+        if (IsPointRange(range)) {
+          if (auto index = MatchIndex(seq_scan->table_name_, col_idx); index != std::nullopt) {
+            index_oid = std::get<0>(*index);
+          }
+        } else if (const auto *index = MatchTreeIndex(catalog_, seq_scan->table_name_, col_idx); index != nullptr) {
+          index_oid = index->index_oid_;
+        }
+        if (index_oid.has_value()) {
+          auto index_scan =
+              std::make_shared<IndexScanPlanNode>(seq_scan->output_schema_, *index_oid, range.low_,
+                                                  range.low_inclusive_, range.high_, range.high_inclusive_, false);
+          auto candidate = WithResidualFilter(predicate, std::move(index_scan));
+          if (!use_cost) {
+            return candidate;
+          }
+          if (auto cost = cost_model.EstimateCost(candidate); cost < best_cost) {
+            best_plan = std::move(candidate);
+            best_cost = cost;
           }
         }
       }
+      return best_plan;
     }
   }
 
@@ -0,0 +1,282 @@
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "execution/plans/update_plan.h"
+#include "execution/plans/values_plan.h"
+#include "fmt/format.h"
+#include "optimizer/plan_cache.h"
+
+namespace bustub {
+
+namespace {
+
+/** Call fn with a pointer to every expression held by the plan node itself, its children are not visited */
+template <class ExprFn>
+void ForEachExpression(AbstractPlanNode *plan, const ExprFn &fn) {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      fn(&dynamic_cast<SeqScanPlanNode *>(plan)->filter_predicate_);
+      break;
+    case PlanType::IndexScan: {
+      auto *index_scan = dynamic_cast<IndexScanPlanNode *>(plan);
+      fn(&index_scan->low_key_);
+      fn(&index_scan->high_key_);
+      break;
+    }
+    case PlanType::Filter:
+      fn(&dynamic_cast<FilterPlanNode *>(plan)->predicate_);
+      break;
+    case PlanType::Projection:
+      for (auto &expr : dynamic_cast<ProjectionPlanNode *>(plan)->expressions_) {
+        fn(&expr);
+      }
+      break;
+    case PlanType::Aggregation: {
+      auto *aggregation = dynamic_cast<AggregationPlanNode *>(plan);
+      for (auto &expr : aggregation->group_bys_) {
+        fn(&expr);
+      }
+      for (auto &expr : aggregation->aggregates_) {
+        fn(&expr);
+      }
+      break;
+    }
+    case PlanType::NestedLoopJoin:
+      fn(&dynamic_cast<NestedLoopJoinPlanNode *>(plan)->predicate_);
+      break;
+    case PlanType::NestedIndexJoin:
+      fn(&dynamic_cast<NestedIndexJoinPlanNode *>(plan)->key_predicate_);
+      break;
+    case PlanType::HashJoin: {
+      auto *hash_join = dynamic_cast<HashJoinPlanNode *>(plan);
+      for (auto &expr : hash_join->left_key_expressions_) {
+        fn(&expr);
+      }
+      for (auto &expr : hash_join->right_key_expressions_) {
+        fn(&expr);
+      }
+      break;
+    }
+    case PlanType::Sort:
+      for (auto &[_, expr] : dynamic_cast<SortPlanNode *>(plan)->order_bys_) {
+        fn(&expr);
+      }
+      break;
+    case PlanType::TopN:
+      for (auto &[_, expr] : dynamic_cast<TopNPlanNode *>(plan)->order_bys_) {
+        fn(&expr);
+      }
+      break;
+    case PlanType::Update:
+      for (auto &expr : dynamic_cast<UpdatePlanNode *>(plan)->target_expressions_) {
+        fn(&expr);
+      }
+      break;
+    case PlanType::Values:
+      for (auto &row : dynamic_cast<ValuesPlanNode *>(plan)->values_) {
+        for (auto &expr : row) {
+          fn(&expr);
+        }
+      }
+      break;
+    default:
+      // Insert、Delete、Limit 和 MockScan 不含表达式
+      break;
+  }
+}
+
+template <class ParameterFn>
+void VisitParameters(const AbstractExpressionRef &expr, const ParameterFn &fn) {
+  if (expr == nullptr) {
+    return;
+  }
+  if (const auto *parameter_expr = dynamic_cast<const ParameterValueExpression *>(expr.get());
+      parameter_expr != nullptr) {
+    fn(*parameter_expr);
+    return;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    VisitParameters(child, fn);
+  }
+}
+
+void CollectParameterTypes(const AbstractPlanNodeRef &plan, std::vector<TypeId> *types) {
+  // 表达式只能通过可写的节点取到，拷贝一份只用来读
+  auto copy = plan->CloneWithChildren(plan->GetChildren());
+  ForEachExpression(copy.get(), [types](AbstractExpressionRef *expr) {
+    VisitParameters(*expr, [types](const ParameterValueExpression &parameter_expr) {
+      auto index = parameter_expr.GetIndex();
+      if (index >= types->size()) {
+        types->resize(index + 1, TypeId::INVALID);
+      }
+      if ((*types)[index] == TypeId::INVALID) {
+        (*types)[index] = parameter_expr.GetReturnType();
+      }
+    });
+  });
+  for (const auto &child : plan->GetChildren()) {
+    CollectParameterTypes(child, types);
+  }
+}
+
+auto SubstituteParameters(const AbstractExpressionRef &expr, const std::vector<Value> &values)
+    -> AbstractExpressionRef {
+  if (expr == nullptr) {
+    return nullptr;
+  }
+  if (const auto *parameter_expr = dynamic_cast<const ParameterValueExpression *>(expr.get());
+      parameter_expr != nullptr) {
+    if (parameter_expr->GetIndex() >= values.size()) {
+      throw Exception(fmt::format("no value is bound to parameter ${}", parameter_expr->GetIndex() + 1));
+    }
+    return std::make_shared<ConstantValueExpression>(values[parameter_expr->GetIndex()]);
+  }
+  if (expr->GetChildren().empty()) {
+    return expr;
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    children.push_back(SubstituteParameters(child, values));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+}  // namespace
+
+auto PlanCache::Normalize(const std::string &sql) -> std::optional<std::string> {
+  std::string key;
+  char quote = 0;
+  bool pending_space = false;
+  for (size_t i = 0; i < sql.size(); i++) {
+    char c = sql[i];
+    // 转义字符会让引号的匹配出错，不缓存
+    if (c == '\\') {
+      return std::nullopt;
+    }
+    if (quote != 0) {
+      key.push_back(c);
+      if (c == quote) {
+        quote = 0;
+      }
+      continue;
+    }
+    if (std::isspace(static_cast<unsigned char>(c)) != 0) {
+      pending_space = true;
+      continue;
+    }
+    if (c == ';') {
+      // 只允许末尾的分号，多条语句不缓存
+      for (size_t j = i + 1; j < sql.size(); j++) {
+        if (sql[j] != ';' && std::isspace(static_cast<unsigned char>(sql[j])) == 0) {
+          return std::nullopt;
+        }
+      }
+      break;
+    }
+    // 注释里的换行被合并成空格后会改变语句的含义，参数只能出现在 PREPARE 里
+    if (c == '$' || c == '?' || (c == '-' && i + 1 < sql.size() && sql[i + 1] == '-') ||
+        (c == '/' && i + 1 < sql.size() && sql[i + 1] == '*')) {
+      return std::nullopt;
+    }
+    if (pending_space && !key.empty()) {
+      key.push_back(' ');
+    }
+    pending_space = false;
+    if (c == '\'' || c == '"') {
+      quote = c;
+      key.push_back(c);
+      continue;
+    }
+    key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+  }
+  if (quote != 0 || key.empty()) {
+    return std::nullopt;
+  }
+  return key;
+}
+
+auto PlanCache::Get(const std::string &key, uint64_t catalog_version) -> std::shared_ptr<const CachedPlan> {
+  std::scoped_lock lock(latch_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  if (it->second->second->catalog_version_ != catalog_version) {
+    // 表、索引或统计信息变了，计划可能不再正确或不再最优
+    entries_.erase(it->second);
+    index_.erase(it);
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  hits_++;
+  return it->second->second;
+}
+
+void PlanCache::Put(const std::string &key, std::shared_ptr<const CachedPlan> plan) {
+  std::scoped_lock lock(latch_);
+  if (capacity_ == 0) {
+    return;
+  }
+  if (auto it = index_.find(key); it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.emplace_front(key, std::move(plan));
+  index_[key] = entries_.begin();
+  if (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+auto PlanCache::Size() const -> size_t {
+  std::scoped_lock lock(latch_);
+  return entries_.size();
+}
+
+auto PlanCache::Hits() const -> size_t {
+  std::scoped_lock lock(latch_);
+  return hits_;
+}
+
+auto InferParameterTypes(const AbstractPlanNodeRef &plan, const std::vector<TypeId> &declared) -> std::vector<TypeId> {
+  auto types = declared;
+  CollectParameterTypes(plan, &types);
+  for (size_t i = 0; i < types.size(); i++) {
+    if (types[i] == TypeId::INVALID) {
+      throw Exception(fmt::format("could not determine the type of parameter ${}", i + 1));
+    }
+  }
+  return types;
+}
+
+auto BindParameters(const AbstractPlanNodeRef &plan, const std::vector<Value> &values) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.push_back(BindParameters(child, values));
+  }
+  auto bound = plan->CloneWithChildren(std::move(children));
+  ForEachExpression(bound.get(),
+                    [&values](AbstractExpressionRef *expr) { *expr = SubstituteParameters(*expr, values); });
+  return bound;
+}
+
+}  // namespace bustub
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "binder/table_ref/bound_join_ref.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/optimizer_internal.h"
+
+namespace bustub {
+
+namespace {
+
+/** Which inputs of a join a conjunct over the join output reads */
+enum class JoinSide { Left, Right, Both };
+
+auto SideOf(const AbstractExpressionRef &expr, uint32_t left_count) -> JoinSide {
+  bool reads_left = false;
+  bool reads_right = false;
+  VisitColumns(expr, [&](const ColumnValueExpression &column) {
+    (column.GetColIdx() < left_count ? reads_left : reads_right) = true;
+  });
+  if (reads_left && reads_right) {
+    return JoinSide::Both;
+  }
+  // 不读任何列的谓词（常量条件）也可以放在左侧
+  return reads_right ? JoinSide::Right : JoinSide::Left;
+}
+
+/** A column compared for equality with another expression */
+using ColumnEquality = std::pair<const ColumnValueExpression *, AbstractExpressionRef>;
+
+/** @return the column and the other side of a `column = <expr>` conjunct, a null column for any other conjunct */
+auto MatchColumnEquality(const AbstractExpressionRef &expr) -> ColumnEquality {
+  const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (cmp_expr == nullptr || cmp_expr->comp_type_ != ComparisonType::Equal) {
+    return {nullptr, nullptr};
+  }
+  const auto &lhs = cmp_expr->GetChildAt(0);
+  const auto &rhs = cmp_expr->GetChildAt(1);
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(lhs.get()); column_expr != nullptr) {
+    return {column_expr, rhs};
+  }
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(rhs.get()); column_expr != nullptr) {
+    return {column_expr, lhs};
+  }
+  return {nullptr, nullptr};
+}
+
+auto IsNonNullConstant(const AbstractExpressionRef &expr) -> bool {
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr.get());
+  return constant_expr != nullptr && !constant_expr->val_.IsNull();
+}
+
+/**
+ * Rewrite the equalities among the conjuncts over the output of an inner join so that as many of them as possible
+ * can be pushed into an input. Columns equal to each other form a class: when the class has a constant every
+ * column is compared with the constant, otherwise the columns of the class from the same input are chained by
+ * equalities evaluated in that input. One equality across the two inputs is kept as the join key.
+ */
+void InferEqualities(std::vector<AbstractExpressionRef> *conjuncts, uint32_t left_count) {
+  std::map<uint32_t, uint32_t> parent;
+  std::map<uint32_t, TypeId> types;
+  std::function<uint32_t(uint32_t)> find = [&](uint32_t col) -> uint32_t {
+    auto it = parent.find(col);
+    if (it == parent.end() || it->second == col) {
+      return col;
+    }
+    return it->second = find(it->second);
+  };
+  auto add = [&](const ColumnValueExpression &column) {
+    parent.emplace(column.GetColIdx(), column.GetColIdx());
+    types.emplace(column.GetColIdx(), column.GetReturnType());
+  };
+
+  std::vector<AbstractExpressionRef> others;
+  std::vector<std::pair<uint32_t, AbstractExpressionRef>> constants;
+  for (const auto &expr : *conjuncts) {
+    auto [column, other] = MatchColumnEquality(expr);
+    if (column == nullptr) {
+      others.push_back(expr);
+      continue;
+    }
+    if (const auto *other_column = dynamic_cast<const ColumnValueExpression *>(other.get()); other_column != nullptr) {
+      add(*column);
+      add(*other_column);
+      parent[find(column->GetColIdx())] = find(other_column->GetColIdx());
+    } else if (IsNonNullConstant(other)) {
+      add(*column);
+      constants.emplace_back(column->GetColIdx(), other);
+    } else {
+      others.push_back(expr);
+    }
+  }
+
+  // 每个等价类的第一个常量作用到类中所有列上，其余的常量条件保持原样
+  std::map<uint32_t, AbstractExpressionRef> class_constant;
+  for (const auto &[col, constant] : constants) {
+    if (!class_constant.emplace(find(col), constant).second) {
+      others.push_back(std::make_shared<ComparisonExpression>(
+          std::make_shared<ColumnValueExpression>(0, col, types.at(col)), constant, ComparisonType::Equal));
+    }
+  }
+  std::map<uint32_t, std::vector<uint32_t>> classes;
+  for (const auto &[col, unused] : parent) {
+    classes[find(col)].push_back(col);
+  }
+
+  auto column_of = [&](uint32_t col) { return std::make_shared<ColumnValueExpression>(0, col, types.at(col)); };
+  auto equal = [&](const AbstractExpressionRef &lhs, const AbstractExpressionRef &rhs) {
+    others.push_back(std::make_shared<ComparisonExpression>(lhs, rhs, ComparisonType::Equal));
+  };
+  for (const auto &[root, members] : classes) {
+    std::vector<uint32_t> left;
+    std::vector<uint32_t> right;
+    for (auto col : members) {
+      (col < left_count ? left : right).push_back(col);
+    }
+    if (auto it = class_constant.find(root); it != class_constant.end()) {
+      for (auto col : members) {
+        equal(column_of(col), it->second);
+      }
+    } else {
+      for (const auto *side : {&left, &right}) {
+        for (size_t i = 1; i < side->size(); i++) {
+          equal(column_of((*side)[i - 1]), column_of((*side)[i]));
+        }
+      }
+    }
+    if (!left.empty() && !right.empty()) {
+      equal(column_of(left[0]), column_of(right[0]));
+    }
+  }
+  *conjuncts = std::move(others);
+}
+
+/**
+ * Put the conjuncts that cannot be pushed any further in a filter on top of the plan. A filter right above a scan
+ * is merged into the scan by OptimizeMergeFilterScan, after the rules that still match the filter above the scan.
+ */
+auto WithFilter(AbstractPlanNodeRef plan, const std::vector<AbstractExpressionRef> &conjuncts) -> AbstractPlanNodeRef {
+  if (conjuncts.empty()) {
+    return plan;
+  }
+  auto output_schema = plan->output_schema_;
+  return std::make_shared<FilterPlanNode>(std::move(output_schema), MakeConjunction(conjuncts), std::move(plan));
+}
+
+auto PushDown(const AbstractPlanNodeRef &plan, std::vector<AbstractExpressionRef> conjuncts) -> AbstractPlanNodeRef;
+
+auto PushThroughJoin(const NestedLoopJoinPlanNode &nlj_plan, std::vector<AbstractExpressionRef> conjuncts)
+    -> AbstractPlanNodeRef {
+  const auto left_count = static_cast<uint32_t>(nlj_plan.GetLeftPlan()->OutputSchema().GetColumnCount());
+  // 连接谓词中右侧的列改写为连接输出中的列号，和上方传下来的谓词统一处理
+  std::vector<AbstractExpressionRef> join_conjuncts;
+  SplitConjuncts(RewriteColumns(nlj_plan.Predicate(),
+                                [left_count](const ColumnValueExpression &column) {
+                                  auto col_idx = column.GetColIdx() + (column.GetTupleIdx() == 0 ? 0 : left_count);
+                                  return std::make_shared<ColumnValueExpression>(0, col_idx, column.GetReturnType());
+                                }),
+                 &join_conjuncts);
+
+  std::vector<AbstractExpressionRef> to_left;
+  std::vector<AbstractExpressionRef> to_right;
+  std::vector<AbstractExpressionRef> in_join;
+  std::vector<AbstractExpressionRef> above;
+  if (nlj_plan.GetJoinType() == JoinType::INNER) {
+    conjuncts.insert(conjuncts.end(), join_conjuncts.begin(), join_conjuncts.end());
+    InferEqualities(&conjuncts, left_count);
+    for (auto &expr : conjuncts) {
+      switch (SideOf(expr, left_count)) {
+        case JoinSide::Left:
+          to_left.push_back(std::move(expr));
+          break;
+        case JoinSide::Right:
+          to_right.push_back(std::move(expr));
+          break;
+        case JoinSide::Both:
+          in_join.push_back(std::move(expr));
+          break;
+      }
+    }
+  } else if (nlj_plan.GetJoinType() == JoinType::LEFT) {
+    // 左连接要保留所有左侧元组：上方的谓词只能下推到左侧，连接条件只能下推到右侧
+    for (auto &expr : conjuncts) {
+      (SideOf(expr, left_count) == JoinSide::Left ? to_left : above).push_back(std::move(expr));
+    }
+    for (auto &expr : join_conjuncts) {
+      (SideOf(expr, left_count) == JoinSide::Right ? to_right : in_join).push_back(std::move(expr));
+    }
+  } else {
+    above = std::move(conjuncts);
+    in_join = std::move(join_conjuncts);
+  }
+
+  for (auto &expr : to_right) {
+    expr = RewriteColumns(expr, [left_count](const ColumnValueExpression &column) {
+      return std::make_shared<ColumnValueExpression>(0, column.GetColIdx() - left_count, column.GetReturnType());
+    });
+  }
+  auto predicate = RewriteColumns(MakeConjunction(in_join), [left_count](const ColumnValueExpression &column) {
+    bool left = column.GetColIdx() < left_count;
+    return std::make_shared<ColumnValueExpression>(left ? 0 : 1, column.GetColIdx() - (left ? 0 : left_count),
+                                                   column.GetReturnType());
+  });
+  auto join = std::make_shared<NestedLoopJoinPlanNode>(
+      nlj_plan.output_schema_, PushDown(nlj_plan.GetLeftPlan(), std::move(to_left)),
+      PushDown(nlj_plan.GetRightPlan(), std::move(to_right)), std::move(predicate), nlj_plan.GetJoinType());
+  return WithFilter(std::move(join), above);
+}
+
+/** @return the plan with the conjuncts, which read the output of the plan, evaluated as deep as possible */
+auto PushDown(const AbstractPlanNodeRef &plan, std::vector<AbstractExpressionRef> conjuncts) -> AbstractPlanNodeRef {
+  switch (plan->GetType()) {
+    case PlanType::Filter: {
+      const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*plan);
+      SplitConjuncts(filter_plan.GetPredicate(), &conjuncts);
+      return PushDown(filter_plan.GetChildPlan(), std::move(conjuncts));
+    }
+    case PlanType::NestedLoopJoin:
+      return PushThroughJoin(dynamic_cast<const NestedLoopJoinPlanNode &>(*plan), std::move(conjuncts));
+    case PlanType::Projection: {
+      // 谓词中的列替换为投影的表达式
+      const auto &projection_plan = dynamic_cast<const ProjectionPlanNode &>(*plan);
+      for (auto &expr : conjuncts) {
+        expr = RewriteColumns(expr, [&](const ColumnValueExpression &column) {
+          return projection_plan.GetExpressions()[column.GetColIdx()];
+        });
+      }
+      return plan->CloneWithChildren({PushDown(projection_plan.GetChildPlan(), std::move(conjuncts))});
+    }
+    case PlanType::Aggregation: {
+      // 只读分组列的谓词在聚合前过滤；没有分组时空输入也要输出一行，不能下推
+      const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*plan);
+      const auto &group_bys = agg_plan.GetGroupBys();
+      std::vector<AbstractExpressionRef> pushed;
+      std::vector<AbstractExpressionRef> kept;
+      for (auto &expr : conjuncts) {
+        bool only_group_bys = !group_bys.empty();
+        VisitColumns(expr, [&](const ColumnValueExpression &column) {
+          only_group_bys = only_group_bys && column.GetColIdx() < group_bys.size();
+        });
+        if (!only_group_bys) {
+          kept.push_back(std::move(expr));
+          continue;
+        }
+        pushed.push_back(RewriteColumns(
+            expr, [&](const ColumnValueExpression &column) { return group_bys[column.GetColIdx()]; }));
+      }
+      return WithFilter(plan->CloneWithChildren({PushDown(agg_plan.GetChildPlan(), std::move(pushed))}), kept);
+    }
+    case PlanType::Sort:
+      return plan->CloneWithChildren({PushDown(plan->GetChildAt(0), std::move(conjuncts))});
+    default: {
+      // limit、top-n 等会改变结果，谓词停在它们上方
+      std::vector<AbstractPlanNodeRef> children;
+      for (const auto &child : plan->GetChildren()) {
+        children.emplace_back(PushDown(child, {}));
+      }
+      return WithFilter(plan->CloneWithChildren(std::move(children)), conjuncts);
+    }
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizePredicatePushdown(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  return PushDown(plan, {});
+}
+
+}  // namespace bustub
@@ -8,6 +8,7 @@
 #include "binder/expressions/bound_column_ref.h"
 #include "binder/expressions/bound_constant.h"
 #include "binder/expressions/bound_func_call.h"
+#include "binder/expressions/bound_parameter.h"
 #include "binder/expressions/bound_unary_op.h"
 #include "binder/statement/select_statement.h"
 #include "common/exception.h"
@@ -15,6 +16,7 @@
 #include "common/util/string_util.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "fmt/format.h"
 #include "planner/planner.h"
@@ -25,6 +27,9 @@ auto Planner::PlanBinaryOp(const BoundBinaryOp &expr, const std::vector<Abstract
     -> AbstractExpressionRef {
   auto [_1, left] = PlanExpression(*expr.larg_, children);
   auto [_2, right] = PlanExpression(*expr.rarg_, children);
+  // `column = $1` 中的参数和另一侧的类型相同
+  left = InferParameterType(std::move(left), right->GetReturnType());
+  right = InferParameterType(std::move(right), left->GetReturnType());
   const auto &op_name = expr.op_name_;
   return GetBinaryExpressionFromFactory(op_name, std::move(left), std::move(right));
 }
@@ -100,6 +105,19 @@ auto Planner::PlanConstant(const BoundConstant &expr, const std::vector<Abstract
   return std::make_shared<ConstantValueExpression>(expr.val_);
 }
 
+auto Planner::PlanParameter(const BoundParameter &expr, const std::vector<AbstractPlanNodeRef> &children)
+    -> AbstractExpressionRef {
+  return std::make_shared<ParameterValueExpression>(expr.index_, expr.type_);
+}
+
+auto Planner::InferParameterType(AbstractExpressionRef expr, TypeId type) -> AbstractExpressionRef {
+  const auto *parameter_expr = dynamic_cast<const ParameterValueExpression *>(expr.get());
+  if (parameter_expr == nullptr || parameter_expr->GetReturnType() != TypeId::INVALID || type == TypeId::INVALID) {
+    return expr;
+  }
+  return std::make_shared<ParameterValueExpression>(parameter_expr->GetIndex(), type);
+}
+
 void Planner::AddAggCallToContext(BoundExpression &expr) {
   switch (expr.type_) {
     case ExpressionType::AGG_CALL: {
@@ -127,7 +145,8 @@ void Planner::AddAggCallToContext(BoundExpression &expr) {
       }
       return;
     }
-    case ExpressionType::CONSTANT: {
+    case ExpressionType::CONSTANT:
+    case ExpressionType::PARAMETER: {
       return;
     }
     case ExpressionType::ALIAS: {
@@ -166,6 +185,10 @@ auto Planner::PlanExpression(const BoundExpression &expr, const std::vector<Abst
       const auto &constant_expr = dynamic_cast<const BoundConstant &>(expr);
       return std::make_tuple(UNNAMED_COLUMN, PlanConstant(constant_expr, children));
     }
+    case ExpressionType::PARAMETER: {
+      const auto &parameter_expr = dynamic_cast<const BoundParameter &>(expr);
+      return std::make_tuple(UNNAMED_COLUMN, PlanParameter(parameter_expr, children));
+    }
     case ExpressionType::ALIAS: {
       const auto &alias_expr = dynamic_cast<const BoundAlias &>(expr);
       auto [_1, expr] = PlanExpression(*alias_expr.child_, children);
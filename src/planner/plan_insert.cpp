@@ -25,9 +25,16 @@
 namespace bustub {
 
 auto Planner::PlanInsert(const InsertStatement &statement) -> AbstractPlanNodeRef {
+  const auto &table_schema = statement.table_->schema_.GetColumns();
+
+  // VALUES 中没有声明类型的参数取对应列的类型
+  insert_types_.clear();
+  for (const auto &col : table_schema) {
+    insert_types_.push_back(col.GetType());
+  }
   auto select = PlanSelect(*statement.select_);
+  insert_types_.clear();
 
-  const auto &table_schema = statement.table_->schema_.GetColumns();
   const auto &child_schema = select->OutputSchema().GetColumns();
   if (!std::equal(table_schema.cbegin(), table_schema.cend(), child_schema.cbegin(), child_schema.cend(),
                   [](auto &&col1, auto &&col2) { return col1.GetType() == col2.GetType(); })) {
@@ -62,7 +69,8 @@ auto Planner::PlanUpdate(const UpdateStatement &statement) -> AbstractPlanNodeRe
   for (const auto &[col, target_expr] : statement.target_expr_) {
     auto [_1, target_abstract_expr] = PlanExpression(*target_expr, scope);
     auto [_2, col_abstract_expr] = PlanColumnRef(*col, scope);
-    target_exprs[col_abstract_expr->GetColIdx()] = std::move(target_abstract_expr);
+    target_exprs[col_abstract_expr->GetColIdx()] =
+        InferParameterType(std::move(target_abstract_expr), col_abstract_expr->GetReturnType());
   }
 
   for (size_t idx = 0; idx < target_exprs.size(); idx++) {
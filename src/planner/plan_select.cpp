@@ -75,6 +75,10 @@ auto Planner::PlanSelect(const SelectStatement &statement) -> AbstractPlanNodeRe
     std::vector<AbstractPlanNodeRef> children = {plan};
     for (const auto &item : statement.select_list_) {
       auto [name, expr] = PlanExpression(*item, {plan});
+      // 单独出现在输出列里的参数推断不出类型，只能由 PREPARE 声明
+      if (expr->GetReturnType() == TypeId::INVALID) {
+        throw Exception(fmt::format("could not determine the type of {}", expr->ToString()));
+      }
       if (name == UNNAMED_COLUMN) {
         name = fmt::format("__unnamed#{}", universal_id_++);
       }
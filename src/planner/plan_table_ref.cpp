@@ -144,6 +144,9 @@ auto Planner::PlanExpressionListRef(const BoundExpressionListRef &table_ref) ->
     std::vector<AbstractExpressionRef> row_exprs;
     for (const auto &col : row) {
       auto [_, expr] = PlanExpression(*col, {});
+      if (row_exprs.size() < insert_types_.size()) {
+        expr = InferParameterType(std::move(expr), insert_types_[row_exprs.size()]);
+      }
       row_exprs.push_back(std::move(expr));
     }
     all_exprs.emplace_back(std::move(row_exprs));
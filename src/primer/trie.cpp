@@ -1,157 +1,458 @@
 #include "primer/trie.h"
+#include <memory>
 #include <string_view>
 #include "common/exception.h"
-#include <iostream>
-#include <stack>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace bustub {
 
-template <class T>
-auto Trie::Get(std::string_view key) const -> const T * {
- //throw NotImplementedException("Trie::Get is not implemented.");
+/*****************************************************************************
+ * CHILDREN
+ *****************************************************************************/
 
-  // You should walk through the trie to find the node corresponding to the key. If the node doesn't exist, return
-  // nullptr. After you find the node, you should use `dynamic_cast` to cast it to `const TrieNodeWithValue<T> *`. If
-  // dynamic_cast returns `nullptr`, it means the type of the value is mismatched, and you should return nullptr.
-  // Otherwise, return the value.
+TrieNodeChildren::TrieNodeChildren(const TrieNodeChildren &other) { *this = other; }
 
- std::cout << "get key: " << key << std::endl;
- auto temp = root_;
- for(size_t i = 0; i<key.size(); i++){
-   if(temp->children_.find(key[i]) == temp->children_.end()){
-      return nullptr;
-   }
+TrieNodeChildren::TrieNodeChildren(TrieNodeChildren &&other) noexcept { *this = std::move(other); }
 
-   temp = temp->children_[key[i]];
- }
+TrieNodeChildren::~TrieNodeChildren() { ReleaseStorage(); }
 
- auto p_value = std::dynamic_pointer_cast<const TrieNodeWithValue<T>>(temp);
+auto TrieNodeChildren::operator=(const TrieNodeChildren &other) -> TrieNodeChildren & {
+  if (this == &other) {
+    return *this;
+  }
+  ReleaseStorage();
+  AllocateStorage(other.kind_);
+  size_ = other.size_;
+  std::copy(other.children_, other.children_ + Capacity(kind_), children_);
+  std::copy(other.keys_, other.keys_ + NumKeyBytes(kind_), keys_);
+  return *this;
+}
 
- if(p_value == nullptr){
-   return nullptr;
- }
+auto TrieNodeChildren::operator=(TrieNodeChildren &&other) noexcept -> TrieNodeChildren & {
+  if (this == &other) {
+    return *this;
+  }
+  ReleaseStorage();
+  kind_ = std::exchange(other.kind_, Kind::Empty);
+  size_ = std::exchange(other.size_, 0);
+  children_ = std::exchange(other.children_, nullptr);
+  keys_ = std::exchange(other.keys_, nullptr);
+  return *this;
+}
 
- return p_value->value_.get();
+auto TrieNodeChildren::NumKeyBytes(Kind kind) -> size_t {
+  switch (kind) {
+    case Kind::Node4:
+    case Kind::Node16:
+      return 16;
+    case Kind::Node48:
+      return 256;
+    case Kind::Empty:
+    case Kind::Node256:
+      return 0;
+  }
+  return 0;
 }
 
-template <class T>
-auto Trie::Put(std::string_view key, T value) const -> Trie {
-  // Note that `T` might be a non-copyable type. Always use `std::move` when creating `shared_ptr` on that value.
-//  throw NotImplementedException("Trie::Put is not implemented.");
-
-  // You should walk through the trie and create new nodes if necessary. If the node corresponding to the key already
-  // exists, you should create a new `TrieNodeWithValue`.
-
-  /**
-   * 创建一个新的根节点，其值为旧根节点的一份拷贝。然后遍历key，若其字符已经在树中，
-   * 则将对应节点的一份拷贝加入到新树中，若发现一个字符不在树中，则说明明树中目前没有
-   * 这个key，则需要将这个key加入到树中，停止遍历。若成功遍历完key，则说明树中已经包含了
-   * 这个key，则需要再创建一个TrieNodeWithValue节点，并插入到树中。
-   *
-   */
-
-  std::cout << "put key: " << key << std::endl;
-  std::shared_ptr<const TrieNode> new_root(std::move(root_->Clone()));
-  //std::shared_ptr<const TrieNode> ne_root(std::move(root_->Clone()));
-  auto new_temp = new_root;
-  //auto pre_new_temp = new_temp;
-  std::shared_ptr<const TrieNode> pre_new_temp = nullptr;
-
-  auto temp = root_;
-  bool is_exist = true;
-
-  size_t i = 0;
-  for(i=0; i<key.size(); i++){
-    if(temp->children_.find(key[i]) == temp->children_.end()){
-        is_exist = false;
-        break;
+void TrieNodeChildren::AllocateStorage(Kind kind) {
+  kind_ = kind;
+  size_ = 0;
+  size_t capacity = Capacity(kind);
+  if (capacity == 0) {
+    return;
+  }
+  // 子节点指针和键字节放在同一块arena内存中，一个节点只需要一次分配
+  size_t children_bytes = capacity * sizeof(std::shared_ptr<const TrieNode>);
+  auto *block = static_cast<char *>(TrieArena::Allocate(children_bytes + NumKeyBytes(kind)));
+  children_ = reinterpret_cast<std::shared_ptr<const TrieNode> *>(block);
+  std::uninitialized_value_construct_n(children_, capacity);
+  keys_ = reinterpret_cast<uint8_t *>(block + children_bytes);
+  std::fill_n(keys_, NumKeyBytes(kind), 0);
+}
+
+void TrieNodeChildren::ReleaseStorage() {
+  if (children_ != nullptr) {
+    size_t capacity = Capacity(kind_);
+    std::destroy_n(children_, capacity);
+    TrieArena::Deallocate(children_, capacity * sizeof(std::shared_ptr<const TrieNode>) + NumKeyBytes(kind_));
+  }
+  kind_ = Kind::Empty;
+  size_ = 0;
+  children_ = nullptr;
+  keys_ = nullptr;
+}
+
+auto TrieNodeChildren::Capacity(Kind kind) -> size_t {
+  switch (kind) {
+    case Kind::Empty:
+      return 0;
+    case Kind::Node4:
+      return 4;
+    case Kind::Node16:
+      return 16;
+    case Kind::Node48:
+      return 48;
+    case Kind::Node256:
+      return 256;
+  }
+  return 0;
+}
+
+auto TrieNodeChildren::SlotOf(uint8_t key) const -> int {
+  switch (kind_) {
+    case Kind::Empty:
+      return -1;
+    case Kind::Node4:
+      for (int i = 0; i < size_; i++) {
+        if (keys_[i] == key) {
+          return i;
+        }
+      }
+      return -1;
+    case Kind::Node16: {
+#if defined(__SSE2__)
+      // 一次比较16个键字节，再屏蔽掉没有使用的槽位
+      auto keys = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys_));
+      auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8(static_cast<char>(key)))));
+      mask &= (1U << size_) - 1;
+      return mask == 0 ? -1 : __builtin_ctz(mask);
+#else
+      for (int i = 0; i < size_; i++) {
+        if (keys_[i] == key) {
+          return i;
+        }
+      }
+      return -1;
+#endif
     }
+    case Kind::Node48:
+      return static_cast<int>(keys_[key]) - 1;
+    case Kind::Node256:
+      return children_[key] == nullptr ? -1 : key;
+  }
+  return -1;
+}
 
-    pre_new_temp = new_temp;
-    auto new_node = std::shared_ptr<const TrieNode>(temp->children_[key[i]]->Clone());
-    new_temp->children_[key[i]] = new_node;
-    new_temp = new_node;
-    temp = temp->children_[key[i]];
+template <typename Visitor>
+void TrieNodeChildren::ForEach(Visitor &&visit) const {
+  switch (kind_) {
+    case Kind::Empty:
+      return;
+    case Kind::Node4:
+    case Kind::Node16:
+      for (size_t i = 0; i < size_; i++) {
+        visit(keys_[i], children_[i]);
+      }
+      return;
+    case Kind::Node48:
+      for (size_t key = 0; key < 256; key++) {
+        if (keys_[key] != 0) {
+          visit(static_cast<uint8_t>(key), children_[keys_[key] - 1]);
+        }
+      }
+      return;
+    case Kind::Node256:
+      for (size_t key = 0; key < 256; key++) {
+        if (children_[key] != nullptr) {
+          visit(static_cast<uint8_t>(key), children_[key]);
+        }
+      }
+      return;
   }
+}
+
+void TrieNodeChildren::Resize(Kind kind) {
+  TrieNodeChildren resized;
+  resized.AllocateStorage(kind);
 
-  if(is_exist){
-    auto new_node = std::make_shared<const TrieNodeWithValue<T>>(new_temp->children_, std::make_shared<T>(std::move(value)));
-    if(key.size() == 0){
-        new_root = new_node;
-    }else{
-        pre_new_temp->children_[key[i-1]] = new_node;
+  ForEach([&](uint8_t key, const std::shared_ptr<const TrieNode> &child) {
+    switch (kind) {
+      case Kind::Empty:
+        break;
+      case Kind::Node4:
+      case Kind::Node16:
+        resized.keys_[resized.size_] = key;
+        resized.children_[resized.size_] = child;
+        break;
+      case Kind::Node48:
+        resized.keys_[key] = resized.size_ + 1;
+        resized.children_[resized.size_] = child;
+        break;
+      case Kind::Node256:
+        resized.children_[key] = child;
+        break;
     }
+    resized.size_++;
+  });
+  *this = std::move(resized);
+}
+
+auto TrieNodeChildren::Find(char key) const -> const std::shared_ptr<const TrieNode> * {
+  int slot = SlotOf(static_cast<uint8_t>(key));
+  return slot < 0 ? nullptr : &children_[slot];
+}
+
+void TrieNodeChildren::Set(char key, std::shared_ptr<const TrieNode> child) {
+  auto byte = static_cast<uint8_t>(key);
+  int slot = SlotOf(byte);
+  if (slot >= 0) {
+    children_[slot] = std::move(child);
+    return;
   }
 
-  if(!is_exist){
-    for(; i<key.size()-1; i++){
-        auto new_node = std::make_shared<const TrieNode>();
-        new_temp->children_[key[i]] = new_node;
-        new_temp = new_node;
+  if (size_ == Capacity(kind_)) {
+    Resize(static_cast<Kind>(static_cast<uint8_t>(kind_) + 1));
+  }
+  switch (kind_) {
+    case Kind::Empty:
+      break;
+    case Kind::Node4:
+    case Kind::Node16:
+      keys_[size_] = byte;
+      children_[size_] = std::move(child);
+      break;
+    case Kind::Node48: {
+      // Node48删除时会留下空洞，找一个空的槽位
+      size_t free_slot = 0;
+      while (children_[free_slot] != nullptr) {
+        free_slot++;
+      }
+      keys_[byte] = free_slot + 1;
+      children_[free_slot] = std::move(child);
+      break;
     }
+    case Kind::Node256:
+      children_[byte] = std::move(child);
+      break;
+  }
+  size_++;
+}
 
-    auto new_node = std::make_shared<const TrieNodeWithValue<T>>(std::make_shared<T>(std::move(value)));
-    new_temp->children_[key[i]] = new_node;
+void TrieNodeChildren::Erase(char key) {
+  auto byte = static_cast<uint8_t>(key);
+  int slot = SlotOf(byte);
+  if (slot < 0) {
+    return;
   }
 
-  return Trie(new_root);
+  switch (kind_) {
+    case Kind::Empty:
+      break;
+    case Kind::Node4:
+    case Kind::Node16:
+      // 用最后一个元素填补空位
+      keys_[slot] = keys_[size_ - 1];
+      children_[slot] = std::move(children_[size_ - 1]);
+      children_[size_ - 1] = nullptr;
+      break;
+    case Kind::Node48:
+      keys_[byte] = 0;
+      children_[slot] = nullptr;
+      break;
+    case Kind::Node256:
+      children_[slot] = nullptr;
+      break;
+  }
+  size_--;
+
+  // 收缩时留一些余量，避免在边界上反复增删导致来回转换
+  if (size_ == 0) {
+    Resize(Kind::Empty);
+  } else if ((kind_ == Kind::Node16 && size_ <= 3) || (kind_ == Kind::Node48 && size_ <= 12) ||
+             (kind_ == Kind::Node256 && size_ <= 40)) {
+    Resize(static_cast<Kind>(static_cast<uint8_t>(kind_) - 1));
+  }
 }
 
-auto Trie::Remove(std::string_view key) const -> Trie {
- // throw NotImplementedException("Trie::Remove is not implemented.");
+auto TrieNodeChildren::Front() const -> std::pair<char, std::shared_ptr<const TrieNode>> {
+  std::pair<char, std::shared_ptr<const TrieNode>> front;
+  ForEach([&](uint8_t key, const std::shared_ptr<const TrieNode> &child) {
+    front = {static_cast<char>(key), child};
+  });
+  return front;
+}
 
-  // You should walk through the trie and remove nodes if necessary. If the node doesn't contain a value any more,
-  // you should convert it to `TrieNode`. If a node doesn't have children any more, you should remove it.
+/*****************************************************************************
+ * TRIE
+ *****************************************************************************/
 
-  std::cout << "remove key: " << key<< std::endl;
-  auto new_root = std::shared_ptr<const TrieNode>(std::move(root_->Clone()));
-  std::shared_ptr<const TrieNode> new_temp = new_root;
-  auto temp = root_;
-  std::stack<std::shared_ptr<const TrieNode>> node_stack;
-  node_stack.push(nullptr);
-  size_t i;
-  for(i=0; i<key.size(); i++){
-    if(temp->children_.find(key[i]) == temp->children_.end()){
-        return Trie(new_root);
+template <class T>
+auto Trie::Get(std::string_view key) const -> const T * {
+  // You should walk through the trie to find the node corresponding to the key. If the node doesn't exist, return
+  // nullptr. After you find the node, you should use `dynamic_cast` to cast it to `const TrieNodeWithValue<T> *`. If
+  // dynamic_cast returns `nullptr`, it means the type of the value is mismatched, and you should return nullptr.
+  // Otherwise, return the value.
+
+  // 只用裸指针沿路径向下走，整棵树在调用期间由root_保持存活，避免每一步都修改共享节点的引用计数
+  const auto *p_value = dynamic_cast<const TrieNodeWithValue<T> *>(FindNode(key));
+  if (p_value == nullptr) {
+    return nullptr;
+  }
+  return p_value->value_.get();
+}
+
+template <class T>
+auto Trie::GetShared(std::string_view key) const -> std::shared_ptr<const T> {
+  const auto *p_value = dynamic_cast<const TrieNodeWithValue<T> *>(FindNode(key));
+  if (p_value == nullptr) {
+    return nullptr;
+  }
+  return p_value->value_;
+}
+
+auto Trie::FindNode(std::string_view key) const -> const TrieNode * {
+  const TrieNode *node = root_.get();
+  size_t pos = 0;
+  while (node != nullptr) {
+    // 先匹配节点上压缩的前缀
+    const std::string &prefix = node->prefix_;
+    if (key.size() - pos < prefix.size() || key.compare(pos, prefix.size(), prefix) != 0) {
+      return nullptr;
+    }
+    pos += prefix.size();
+    if (pos == key.size()) {
+      return node;
     }
 
-    node_stack.push(new_temp);
-    auto new_node = std::shared_ptr<const TrieNode>(std::move(temp->children_[key[i]]->Clone()));
-    new_temp->children_[key[i]] = new_node;
-    new_temp = new_node;
-    temp = temp->children_[key[i]];
-  }
-
-  if(new_temp->is_value_node_){
-    std::cout << key << std::endl;
-    while(i>0){
-        auto pre_new_temp = node_stack.top();
-        node_stack.pop();
-
-        if(new_temp->children_.size() != 0){
-          auto new_node = std::make_shared<const TrieNode>(new_temp->children_);
-          if(pre_new_temp == nullptr){
-            new_root = new_node;
-          }else{
-            pre_new_temp->children_[key[i-1]] = new_node;
-          }
-          break;
-        }
+    const auto *child = node->children_.Find(key[pos]);
+    if (child == nullptr) {
+      return nullptr;
+    }
+    node = child->get();
+    pos++;
+  }
+  return nullptr;
+}
 
-        pre_new_temp->children_.erase(key[i-1]);
+template <class T>
+auto Trie::PutAt(const std::shared_ptr<const TrieNode> &node, std::string_view key, size_t pos,
+                 const std::shared_ptr<T> &value) -> std::shared_ptr<const TrieNode> {
+  if (node == nullptr) {
+    // 剩下的键全部压缩到新的叶子节点里
+    return MakeTrieNode<const TrieNodeWithValue<T>>(TrieNodeChildren(), value, std::string(key.substr(pos)));
+  }
 
+  const std::string &prefix = node->prefix_;
+  size_t matched = 0;
+  while (matched < prefix.size() && pos + matched < key.size() && prefix[matched] == key[pos + matched]) {
+    matched++;
+  }
 
-        if(pre_new_temp->is_value_node_){
-          break;
-        }
-        new_temp = pre_new_temp;
-        i--;
+  if (matched < prefix.size()) {
+    // 键在压缩前缀的中间分叉：拆出一个只带公共前缀的新节点，原节点保留剩下的前缀挂在它下面
+    std::shared_ptr<TrieNode> rest = node->Clone();
+    rest->prefix_ = prefix.substr(matched + 1);
+    TrieNodeChildren children;
+    children.Set(prefix[matched], std::move(rest));
+
+    std::string common = prefix.substr(0, matched);
+    if (pos + matched == key.size()) {
+      return MakeTrieNode<const TrieNodeWithValue<T>>(std::move(children), value, std::move(common));
+    }
+    children.Set(key[pos + matched], PutAt<T>(nullptr, key, pos + matched + 1, value));
+    return MakeTrieNode<const TrieNode>(std::move(children), std::move(common));
+  }
+
+  pos += matched;
+  if (pos == key.size()) {
+    // 键已经存在(或是中间节点)，换成带新值的节点，子节点原样共享
+    return MakeTrieNode<const TrieNodeWithValue<T>>(node->children_, value, prefix);
+  }
+
+  std::shared_ptr<TrieNode> new_node = node->Clone();
+  const auto *child = node->children_.Find(key[pos]);
+  new_node->children_.Set(key[pos], PutAt<T>(child == nullptr ? nullptr : *child, key, pos + 1, value));
+  return new_node;
+}
+
+template <class T>
+auto Trie::Put(std::string_view key, T value) const -> Trie {
+  // Note that `T` might be a non-copyable type. Always use `std::move` when creating `shared_ptr` on that value.
+
+  // 写时复制：只复制从根到键所在位置路径上的节点，其余子树在新旧两棵树之间共享
+  auto shared_value = std::allocate_shared<T>(TrieArenaAllocator<T>(), std::move(value));
+  auto root = root_ == nullptr ? MakeTrieNode<const TrieNode>() : root_;
+  return Trie(PutAt<T>(root, key, 0, shared_value));
+}
+
+auto Trie::Compact(std::shared_ptr<const TrieNode> node) -> std::shared_ptr<const TrieNode> {
+  if (node->is_value_node_ || node->children_.Size() != 1) {
+    return node;
+  }
+  // 没有值且只有一个子节点，把它和子节点合并成一个带更长前缀的节点
+  auto [key, child] = node->children_.Front();
+  std::shared_ptr<TrieNode> merged = child->Clone();
+  merged->prefix_ = node->prefix_ + key + child->prefix_;
+  return merged;
+}
+
+auto Trie::RemoveAt(const std::shared_ptr<const TrieNode> &node, std::string_view key, size_t pos, bool *removed)
+    -> std::shared_ptr<const TrieNode> {
+  const std::string &prefix = node->prefix_;
+  if (key.size() - pos < prefix.size() || key.compare(pos, prefix.size(), prefix) != 0) {
+    return node;
+  }
+  pos += prefix.size();
+
+  if (pos == key.size()) {
+    if (!node->is_value_node_) {
+      return node;
+    }
+    *removed = true;
+    if (node->children_.Empty()) {
+      return nullptr;
     }
+    return Compact(MakeTrieNode<const TrieNode>(node->children_, prefix));
+  }
 
+  const auto *child = node->children_.Find(key[pos]);
+  if (child == nullptr) {
+    return node;
+  }
+  auto new_child = RemoveAt(*child, key, pos + 1, removed);
+  if (!*removed) {
+    return node;
+  }
 
+  std::shared_ptr<TrieNode> new_node = node->Clone();
+  if (new_child == nullptr) {
+    new_node->children_.Erase(key[pos]);
+  } else {
+    new_node->children_.Set(key[pos], std::move(new_child));
+  }
+  if (!new_node->is_value_node_ && new_node->children_.Empty()) {
+    return nullptr;
   }
+  return Compact(std::move(new_node));
+}
 
-  return Trie(new_root);
+auto Trie::Remove(std::string_view key) const -> Trie {
+  // You should walk through the trie and remove nodes if necessary. If the node doesn't contain a value any more,
+  // you should convert it to `TrieNode`. If a node doesn't have children any more, you should remove it.
+  if (root_ == nullptr) {
+    return *this;
+  }
 
+  bool removed = false;
+  auto new_root = RemoveAt(root_, key, 0, &removed);
+  if (!removed) {
+    return *this;
+  }
+  if (new_root == nullptr) {
+    return Trie();
+  }
+  // 根节点不做路径压缩，保证它的前缀始终为空
+  if (!new_root->prefix_.empty()) {
+    TrieNodeChildren children;
+    std::shared_ptr<TrieNode> child = new_root->Clone();
+    child->prefix_ = new_root->prefix_.substr(1);
+    children.Set(new_root->prefix_[0], std::move(child));
+    new_root = MakeTrieNode<const TrieNode>(std::move(children));
+  }
+  return Trie(new_root);
 }
 
 // Below are explicit instantiation of template functions.
@@ -163,12 +464,15 @@ auto Trie::Remove(std::string_view key) const -> Trie {
 
 template auto Trie::Put(std::string_view key, uint32_t value) const -> Trie;
 template auto Trie::Get(std::string_view key) const -> const uint32_t *;
+template auto Trie::GetShared(std::string_view key) const -> std::shared_ptr<const uint32_t>;
 
 template auto Trie::Put(std::string_view key, uint64_t value) const -> Trie;
 template auto Trie::Get(std::string_view key) const -> const uint64_t *;
+template auto Trie::GetShared(std::string_view key) const -> std::shared_ptr<const uint64_t>;
 
 template auto Trie::Put(std::string_view key, std::string value) const -> Trie;
 template auto Trie::Get(std::string_view key) const -> const std::string *;
+template auto Trie::GetShared(std::string_view key) const -> std::shared_ptr<const std::string>;
 
 // If your solution cannot compile for non-copy tests, you can remove the below lines to get partial score.
 
@@ -177,9 +481,11 @@ using Integer = std::unique_ptr<uint32_t>;
 
 template auto Trie::Put(std::string_view key, Integer value) const -> Trie;
 template auto Trie::Get(std::string_view key) const -> const Integer *;
+template auto Trie::GetShared(std::string_view key) const -> std::shared_ptr<const Integer>;
 
 template auto Trie::Put(std::string_view key, MoveBlocked value) const -> Trie;
 template auto Trie::Get(std::string_view key) const -> const MoveBlocked *;
+template auto Trie::GetShared(std::string_view key) const -> std::shared_ptr<const MoveBlocked>;
 
 
 }  // namespace bustub
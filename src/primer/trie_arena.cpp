@@ -0,0 +1,182 @@
+#include "primer/trie_arena.h"
+
+#include <array>
+#include <mutex>  // NOLINT
+#include <new>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+
+struct FreeBlock {
+  FreeBlock *next_;
+};
+
+// 线程退出时留下的空闲链表，以及所有分配过的chunk。chunk永远不会释放，
+// 这里故意不析构，避免进程退出时静态对象里还在用的节点被提前释放
+struct SharedPool {
+  std::mutex mutex_;
+  std::array<FreeBlock *, TrieArena::NUM_CLASSES> free_lists_{};
+  std::vector<char *> chunks_;
+};
+
+auto GetSharedPool() -> SharedPool & {
+  static auto *pool = new SharedPool();
+  return *pool;
+}
+
+// 每个大小类在线程本地最多缓存一个chunk大小的空闲块，超出的部分交还共享池。
+// 否则在生产者/消费者式的负载下，别的线程分配的块会一直堆积在释放它们的线程里
+auto LocalLimit(size_t size_class) -> size_t {
+  return TrieArena::CHUNK_SIZE / ((size_class + 1) * TrieArena::CLASS_SIZE);
+}
+
+struct ThreadPool {
+  std::array<FreeBlock *, TrieArena::NUM_CLASSES> free_lists_{};
+  std::array<size_t, TrieArena::NUM_CLASSES> free_counts_{};
+  char *bump_{nullptr};
+  size_t bump_left_{0};
+
+  void Release() {
+    // 把本线程的空闲块交给共享池，之后由其他线程复用
+    auto &shared = GetSharedPool();
+    std::scoped_lock lock(shared.mutex_);
+    for (size_t i = 0; i < TrieArena::NUM_CLASSES; i++) {
+      FreeBlock *head = free_lists_[i];
+      while (head != nullptr) {
+        FreeBlock *next = head->next_;
+        head->next_ = shared.free_lists_[i];
+        shared.free_lists_[i] = head;
+        head = next;
+      }
+      free_lists_[i] = nullptr;
+      free_counts_[i] = 0;
+    }
+  }
+
+  auto Allocate(size_t size_class) -> void * {
+    if (free_lists_[size_class] == nullptr) {
+      // 本线程没有空闲块了，先从共享池取一批这个大小的块，最多取本地上限的一半
+      auto &shared = GetSharedPool();
+      std::scoped_lock lock(shared.mutex_);
+      FreeBlock *head = shared.free_lists_[size_class];
+      FreeBlock *tail = nullptr;
+      size_t count = 0;
+      for (FreeBlock *block = head; block != nullptr && count < LocalLimit(size_class) / 2; block = block->next_) {
+        tail = block;
+        count++;
+      }
+      if (tail != nullptr) {
+        shared.free_lists_[size_class] = tail->next_;
+        tail->next_ = nullptr;
+        free_lists_[size_class] = head;
+        free_counts_[size_class] = count;
+      }
+    }
+    if (FreeBlock *block = free_lists_[size_class]; block != nullptr) {
+      free_lists_[size_class] = block->next_;
+      free_counts_[size_class]--;
+      return block;
+    }
+
+    size_t block_size = (size_class + 1) * TrieArena::CLASS_SIZE;
+    if (bump_left_ < block_size) {
+      auto &shared = GetSharedPool();
+      bump_ = static_cast<char *>(::operator new(TrieArena::CHUNK_SIZE));
+      bump_left_ = TrieArena::CHUNK_SIZE;
+      std::scoped_lock lock(shared.mutex_);
+      shared.chunks_.push_back(bump_);
+    }
+    void *block = bump_;
+    bump_ += block_size;
+    bump_left_ -= block_size;
+    return block;
+  }
+
+  void Deallocate(void *ptr, size_t size_class) {
+    auto *block = static_cast<FreeBlock *>(ptr);
+    block->next_ = free_lists_[size_class];
+    free_lists_[size_class] = block;
+    if (++free_counts_[size_class] <= LocalLimit(size_class)) {
+      return;
+    }
+    // 留下最近释放的一半(大概率还在缓存里)，其余的交还共享池
+    size_t keep = LocalLimit(size_class) / 2;
+    FreeBlock *last_kept = free_lists_[size_class];
+    for (size_t i = 1; i < keep; i++) {
+      last_kept = last_kept->next_;
+    }
+    FreeBlock *excess = last_kept->next_;
+    last_kept->next_ = nullptr;
+    FreeBlock *excess_tail = excess;
+    while (excess_tail->next_ != nullptr) {
+      excess_tail = excess_tail->next_;
+    }
+    free_counts_[size_class] = keep;
+
+    auto &shared = GetSharedPool();
+    std::scoped_lock lock(shared.mutex_);
+    excess_tail->next_ = shared.free_lists_[size_class];
+    shared.free_lists_[size_class] = excess;
+  }
+};
+
+// 线程池本身用平凡析构的thread_local指针保存，线程退出时由ThreadPoolReleaser交还。
+// 交还之后(例如其他thread_local或静态对象析构时)再释放的块直接进入共享池
+thread_local ThreadPool *thread_pool = nullptr;
+thread_local bool thread_exited = false;
+
+struct ThreadPoolReleaser {
+  ~ThreadPoolReleaser() {
+    if (thread_pool != nullptr) {
+      thread_pool->Release();
+      delete thread_pool;
+      thread_pool = nullptr;
+    }
+    thread_exited = true;
+  }
+};
+
+thread_local ThreadPoolReleaser thread_pool_releaser;
+
+auto GetThreadPool() -> ThreadPool * {
+  if (thread_pool == nullptr && !thread_exited) {
+    // 访问一次releaser，确保它在本线程中被构造，线程退出时会被析构
+    (void)&thread_pool_releaser;
+    thread_pool = new ThreadPool();
+  }
+  return thread_pool;
+}
+
+auto SizeClass(size_t size) -> size_t { return (size + TrieArena::CLASS_SIZE - 1) / TrieArena::CLASS_SIZE - 1; }
+
+}  // namespace
+
+auto TrieArena::Allocate(size_t size) -> void * {
+  if (size == 0 || size > MAX_BLOCK_SIZE) {
+    return ::operator new(size);
+  }
+  if (auto *pool = GetThreadPool(); pool != nullptr) {
+    return pool->Allocate(SizeClass(size));
+  }
+  return ::operator new(SizeClass(size) * CLASS_SIZE + CLASS_SIZE);
+}
+
+void TrieArena::Deallocate(void *ptr, size_t size) {
+  if (size == 0 || size > MAX_BLOCK_SIZE) {
+    ::operator delete(ptr);
+    return;
+  }
+  if (auto *pool = GetThreadPool(); pool != nullptr) {
+    pool->Deallocate(ptr, SizeClass(size));
+    return;
+  }
+  auto &shared = GetSharedPool();
+  std::scoped_lock lock(shared.mutex_);
+  auto *block = static_cast<FreeBlock *>(ptr);
+  block->next_ = shared.free_lists_[SizeClass(size)];
+  shared.free_lists_[SizeClass(size)] = block;
+}
+
+}  // namespace bustub
@@ -1,57 +1,117 @@
 #include "primer/trie_store.h"
+#include <algorithm>
+#include <thread>  // NOLINT
 #include "common/exception.h"
 
 namespace bustub {
 
+namespace {
+
+// 每个线程第一次读的时候分到一个固定的起始槽位，线程数不超过槽位数时各自独占一个槽位
+auto ReaderSlotHint() -> size_t {
+  static std::atomic<size_t> next_hint{0};
+  thread_local size_t hint = next_hint.fetch_add(1);
+  return hint;
+}
+
+}  // namespace
+
+TrieStore::~TrieStore() {
+  delete root_.load();
+  for (auto &[root, epoch] : retired_) {
+    delete root;
+  }
+}
+
+auto TrieStore::EnterEpoch() -> size_t {
+  for (size_t i = ReaderSlotHint();; i++) {
+    size_t slot = i % NUM_READER_SLOTS;
+    uint64_t free_slot = 0;
+    // 在槽位中公布读到的epoch之后才能读root_，写者回收时会看到这个epoch
+    if (reader_slots_[slot].epoch_.compare_exchange_strong(free_slot, epoch_.load())) {
+      return slot;
+    }
+    if (slot == NUM_READER_SLOTS - 1) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void TrieStore::ExitEpoch(size_t slot) { reader_slots_[slot].epoch_.store(0); }
+
+void TrieStore::Publish(const Trie *new_root) {
+  const Trie *old_root = root_.exchange(new_root);
+  // 之后公布的读者读到的epoch都比retire_epoch大，它们只能看到新版本
+  uint64_t retire_epoch = epoch_.fetch_add(1);
+  retired_.emplace_back(old_root, retire_epoch);
+  Reclaim();
+}
+
+void TrieStore::Reclaim() {
+  uint64_t min_epoch = UINT64_MAX;
+  for (const auto &slot : reader_slots_) {
+    uint64_t epoch = slot.epoch_.load();
+    if (epoch != 0) {
+      min_epoch = std::min(min_epoch, epoch);
+    }
+  }
+
+  // 所有正在读的线程公布的epoch都比版本被替换时的epoch新，这个版本就不会再被读到了
+  auto it = std::remove_if(retired_.begin(), retired_.end(), [min_epoch](const auto &retired) {
+    if (retired.second < min_epoch) {
+      delete retired.first;
+      return true;
+    }
+    return false;
+  });
+  retired_.erase(it, retired_.end());
+}
+
 template <class T>
 auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<T>> {
-  // Pseudo-code:
-  // (1) Take the root lock, get the root, and release the root lock. Don't lookup the value in the
-  //     trie while holding the root lock.
-  // (2) Lookup the value in the trie.
-  // (3) If the value is found, return a ValueGuard object that holds a reference to the value and the
-  //     root. Otherwise, return std::nullopt.
- //throw NotImplementedException("TrieStore::Get is not implemented.");
-
-  root_lock_.lock();
-
-  auto root = root_;
- root_lock_.unlock();
-  auto value = root.Get<T>(key);
-  if(value == nullptr){
+  // 读操作不加锁：公布epoch之后读取当前版本，查找结束就退出，返回的ValueGuard自己持有值的所有权
+  size_t slot = EnterEpoch();
+  std::shared_ptr<const T> value = root_.load()->GetShared<T>(key);
+  ExitEpoch(slot);
+
+  if (value == nullptr) {
     return std::nullopt;
   }
-  return ValueGuard(root, *value);
+  return ValueGuard<T>(std::move(value));
 }
 
 template <class T>
 void TrieStore::Put(std::string_view key, T value) {
-  // You will need to ensure there is only one writer at a time. Think of how you can achieve this.
-  // The logic should be somehow similar to `TrieStore::Get`.
- // throw NotImplementedException("TrieStore::Put is not implemented.");
-
+  // 写者之间用write_lock_串行，只有写者会修改root_，所以直接读取当前版本不需要公布epoch
   std::unique_lock<std::mutex> write_lock(write_lock_);
-  std::unique_lock<std::mutex> root_lock(root_lock_);
-  root_ = root_.Put<T>(key, std::move(value));
+  Publish(new Trie(root_.load()->Put<T>(key, std::move(value))));
+}
 
+template <class T>
+void TrieStore::PutBatch(std::vector<std::pair<std::string, T>> entries) {
+  std::unique_lock<std::mutex> write_lock(write_lock_);
+  // 中间版本只在本地存在，批量写入只发布一次
+  Trie root = *root_.load();
+  for (auto &[key, value] : entries) {
+    root = root.Put<T>(key, std::move(value));
+  }
+  Publish(new Trie(std::move(root)));
 }
 
 void TrieStore::Remove(std::string_view key) {
-  // You will need to ensure there is only one writer at a time. Think of how you can achieve this.
-  // The logic should be somehow similar to `TrieStore::Get`.
-  //throw NotImplementedException("TrieStore::Remove is not implemented.");
   std::unique_lock<std::mutex> write_lock(write_lock_);
-  std::unique_lock<std::mutex> root_lock(root_lock_);
-  root_ = root_.Remove(key);
+  Publish(new Trie(root_.load()->Remove(key)));
 }
 
 // Below are explicit instantiation of template functions.
 
 template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<uint32_t>>;
 template void TrieStore::Put(std::string_view key, uint32_t value);
+template void TrieStore::PutBatch(std::vector<std::pair<std::string, uint32_t>> entries);
 
 template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<std::string>>;
 template void TrieStore::Put(std::string_view key, std::string value);
+template void TrieStore::PutBatch(std::vector<std::pair<std::string, std::string>> entries);
 
 // If your solution cannot compile for non-copy tests, you can remove the below lines to get partial score.
 
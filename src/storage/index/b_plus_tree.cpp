@@ -28,7 +28,7 @@ BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPool
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
 
-  auto header_guard = bpm_->FetchPageWrite(header_page_id_);
+  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
   auto header_page = header_guard.As<BPlusTreeHeaderPage>();
 
   return header_page->root_page_id_ == INVALID_PAGE_ID;
@@ -46,7 +46,6 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
 
 
-  std::cout << "get value of key: " << key << std::endl;
   // Declaration of context instance.
   Context ctx;
   (void)ctx;
@@ -94,7 +93,6 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
 
 
-  std::cout << "insert key: " << key << ", value: " << value << std::endl;
   // Declaration of context instance.
   Context ctx;
   //(void)ctx;
@@ -130,7 +128,6 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
       const InternalPage *temp_page = curr_page_guard.As<InternalPage>();
       ctx.write_set_.push_back(std::move(curr_page_guard));
 
-      std::cout << key << " " << ctx.write_set_.size() << std::endl;
       auto index = temp_page->GetIndex(comparator_, key);
       if(index == -1){
           throw Exception("index == -1");
@@ -193,13 +190,6 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
           temp_array[0].second = value;
       }
 
-      for(int k=0; k<leaf_page->GetSize(); k++){
-          std::cout << leaf_page->KeyAt(k) << std::endl;
-      }
-
-      for(int k=0; k< leaf_max_size_+1; k++){
-          std::cout << temp_array[k].first << std::endl;
-      }
       //创建一个新的叶子节点
       page_id_t new_leaf_page_id;
       auto new_leaf_page_guard = bpm_->NewPageGuarded(&new_leaf_page_id);
@@ -223,11 +213,17 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
       leaf_page->SetSize(leaf_max_size_/2+1);
       new_leaf_page->SetSize((leaf_max_size_+1)/2);
 
-      //设置next_page_id;
+      //设置next_page_id和prev_page_id;
+      auto curr_page_id = curr_page_guard.PageId();
       new_leaf_page->SetNextPageId(leaf_page->GetNextPageId());
+      new_leaf_page->SetPrevPageId(curr_page_id);
       leaf_page->SetNextPageId(new_leaf_page_id);
+      if(new_leaf_page->GetNextPageId() != INVALID_PAGE_ID){
+          //叶子节点之间总是从左向右加锁
+          WritePageGuard next_page_guard = bpm_->FetchPageWrite(new_leaf_page->GetNextPageId());
+          next_page_guard.AsMut<LeafPage>()->SetPrevPageId(new_leaf_page_id);
+      }
 
-      auto curr_page_id = curr_page_guard.PageId();
       curr_page_guard.Drop();
       //向父节点中插入new_page_id
       InsertIntoParent(ctx,curr_page_id, new_leaf_page->KeyAt(0), new_leaf_page_id);
@@ -235,9 +231,66 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   return true;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBatch(const std::vector<MappingType> &entries, Transaction *txn) -> size_t {
+  size_t inserted = 0;
+  size_t i = 0;
+  while (i < entries.size()) {
+    // 读锁下降到第i个键所在的叶子，父节点的读锁保证拿到叶子写锁之前它不会分裂
+    ReadPageGuard parent_guard = bpm_->FetchPageRead(header_page_id_);
+    page_id_t child_page_id = parent_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (child_page_id == INVALID_PAGE_ID) {
+      parent_guard.Drop();
+      inserted += Insert(entries[i].first, entries[i].second, txn) ? 1 : 0;
+      i++;
+      continue;
+    }
+    // 叶子的上界是路径上最靠下的右侧分隔键，没有则叶子在最右边
+    std::optional<KeyType> upper;
+    while (true) {
+      auto child_guard = bpm_->FetchPageRead(child_page_id);
+      if (child_guard.As<BPlusTreePage>()->IsLeafPage()) {
+        break;
+      }
+      const auto *internal_page = child_guard.As<InternalPage>();
+      auto index = internal_page->GetIndex(comparator_, entries[i].first);
+      if (index == -1) {
+        throw Exception("index == -1");
+      }
+      if (index + 1 < internal_page->GetSize()) {
+        upper = internal_page->KeyAt(index + 1);
+      }
+      child_page_id = internal_page->ValueAt(index);
+      parent_guard = std::move(child_guard);
+    }
+    auto leaf_guard = bpm_->FetchPageWrite(child_page_id);
+    parent_guard.Drop();
+
+    // 键有序，落在上界之前的键都属于这个叶子，叶子满之前直接插入
+    auto *leaf_page = leaf_guard.AsMut<LeafPage>();
+    while (i < entries.size() && leaf_page->GetSize() < leaf_max_size_) {
+      const auto &[key, value] = entries[i];
+      if (upper.has_value() && comparator_(key, *upper) >= 0) {
+        break;
+      }
+      if (leaf_page->GetIndex(comparator_, key) == -1) {
+        leaf_page->Insert(comparator_, key, value);
+        inserted++;
+      }
+      i++;
+    }
+    if (i < entries.size() && leaf_page->GetSize() >= leaf_max_size_) {
+      // 叶子需要分裂，交给Insert处理
+      leaf_guard.Drop();
+      inserted += Insert(entries[i].first, entries[i].second, txn) ? 1 : 0;
+      i++;
+    }
+  }
+  return inserted;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(Context &context, const bustub::page_id_t &curr_page_id, const KeyType &key, const bustub::page_id_t &value) {
-    std::cout << "insert Into parent: key: " << key << " value: " << value << ", current_page_id: " << curr_page_id << std::endl;
   //如果curr_page_id对应根节点,创建一个新节点作为根节点
 
 
@@ -320,7 +373,6 @@ void BPLUSTREE_TYPE::InsertIntoParent(Context &context, const bustub::page_id_t
 
 
         auto parent_page_id = parent_guard.PageId();
-        std::cout << parent_page_id << std::endl;
         parent_guard.Drop();
         //将new_page_id 插入到父节点中
         InsertIntoParent(context, parent_page_id, new_internal_page->KeyAt(0), new_internal_page_id);
@@ -344,11 +396,9 @@ void BPLUSTREE_TYPE::InsertIntoParent(Context &context, const bustub::page_id_t
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   // Declaration of context instance.
- std::cout << "==remove key: " << key << std::endl;
   Context ctx;
 
   //(void)ctx;
-  std::cout << "remove key: " << key << std::endl;
   ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
   auto header_page = ctx.header_page_->AsMut<BPlusTreeHeaderPage>();
   ctx.root_page_id_ = header_page->root_page_id_;
@@ -476,8 +526,8 @@ void BPLUSTREE_TYPE::RemoveEntry(bustub::Context &context, const bustub::page_id
             right_sibling_index = curr_index + 1;
             left_sibling_page_id = parent_page->ValueAt(left_sibling_index);
             right_sibling_page_id = parent_page->ValueAt(right_sibling_index);
-            right_sibling_page_guard = bpm_->FetchPageWrite(right_sibling_page_id);
             left_sibling_page_guard = bpm_->FetchPageWrite(left_sibling_page_id);
+            right_sibling_page_guard = bpm_->FetchPageWrite(right_sibling_page_id);
             right_sibling_page = right_sibling_page_guard.AsMut<InternalPage>();
             left_sibling_page = left_sibling_page_guard.AsMut<InternalPage>();
         }
@@ -508,8 +558,17 @@ void BPLUSTREE_TYPE::RemoveEntry(bustub::Context &context, const bustub::page_id
                   temp_left_page->Insert(comparator_, temp_curr_page->KeyAt(i), temp_curr_page->ValueAt(i));
                 }
 
-                //设置next_page_id
+                //设置next_page_id，并把被合并节点的后继的prev_page_id指向左节点
+                page_id_t left_page_id = left_sibling_page != nullptr ? left_sibling_page_id : curr_page_id;
                 temp_left_page->SetNextPageId(temp_curr_page->GetNextPageId());
+                if(temp_curr_page->GetNextPageId() != INVALID_PAGE_ID &&
+                   temp_curr_page->GetNextPageId() == right_sibling_page_id){
+                  //后继就是已经加锁的右兄弟
+                  right_sibling_page_guard.AsMut<LeafPage>()->SetPrevPageId(left_page_id);
+                }else if(temp_curr_page->GetNextPageId() != INVALID_PAGE_ID){
+                  WritePageGuard next_page_guard = bpm_->FetchPageWrite(temp_curr_page->GetNextPageId());
+                  next_page_guard.AsMut<LeafPage>()->SetPrevPageId(left_page_id);
+                }
             } else {
                 InternalPage *temp_left_page = nullptr;
                 InternalPage *temp_curr_page = nullptr;
@@ -590,22 +649,7 @@ void BPLUSTREE_TYPE::RemoveEntry(bustub::Context &context, const bustub::page_id
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-
-
-  page_id_t root_page_id = GetRootPageId();
-  auto curr_page_guard = bpm_->FetchPageRead(root_page_id);
-  auto curr_page = curr_page_guard.As<BPlusTreePage>();
-
-  while(!curr_page->IsLeafPage()){
-      const InternalPage *temp_page = curr_page_guard.As<InternalPage>();
-      curr_page_guard = bpm_->FetchPageRead(temp_page->ValueAt(0));
-      curr_page = curr_page_guard.As<BPlusTreePage>();
-  }
-
-
-  return INDEXITERATOR_TYPE(bpm_, curr_page_guard.PageId(), 0);
-}
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return Begin(IndexKeyRange<KeyType>{}); }
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -614,26 +658,65 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
+  IndexKeyRange<KeyType> range;
+  range.low_ = key;
+  return Begin(range);
+}
 
+/*
+ * Find the leaf page that holds the low bound of range (or the leftmost leaf
+ * if there is no low bound), then construct an ascending index iterator
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE {
+  auto leaf_guard = FindLeafRead(range.low_.has_value() ? &*range.low_ : nullptr, false);
+  if (!leaf_guard.has_value()) {
+    return End();
+  }
+  return INDEXITERATOR_TYPE(bpm_, &comparator_, header_page_id_, std::move(*leaf_guard), range, false);
+}
 
-    page_id_t root_page_id = GetRootPageId();
-    auto curr_page_guard = bpm_->FetchPageRead(root_page_id);
-    auto curr_page = curr_page_guard.As<BPlusTreePage>();
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE { return RBegin(IndexKeyRange<KeyType>{}); }
 
-    while(!curr_page->IsLeafPage()){
-        const InternalPage *temp_page = curr_page_guard.As<InternalPage>();
-        curr_page_guard = bpm_->FetchPageRead(temp_page->ValueAt(0));
-        curr_page = curr_page_guard.As<BPlusTreePage>();
-    }
+/*
+ * Find the leaf page that holds the high bound of range (or the rightmost
+ * leaf if there is no high bound), then construct a descending index iterator
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE {
+  auto leaf_guard = FindLeafRead(range.high_.has_value() ? &*range.high_ : nullptr, true);
+  if (!leaf_guard.has_value()) {
+    return End();
+  }
+  return INDEXITERATOR_TYPE(bpm_, &comparator_, header_page_id_, std::move(*leaf_guard), range, true);
+}
 
-    const LeafPage *leaf_page = curr_page_guard.As<LeafPage>();
-    int index = leaf_page->GetIndex(comparator_, key);
-    if(index == -1){
-        throw  Exception("Begin(key): key is not in leaf_page");
-    }
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType *key, bool rightmost) -> std::optional<ReadPageGuard> {
+  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t root_page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (root_page_id == INVALID_PAGE_ID) {
+    return std::nullopt;
+  }
 
-    return INDEXITERATOR_TYPE(bpm_, curr_page_guard.PageId(), index);
+  auto curr_page_guard = bpm_->FetchPageRead(root_page_id);
+  header_guard.Drop();
 
+  while (!curr_page_guard.As<BPlusTreePage>()->IsLeafPage()) {
+    const InternalPage *temp_page = curr_page_guard.As<InternalPage>();
+    int index = rightmost ? temp_page->GetSize() - 1 : 0;
+    if (key != nullptr) {
+      index = temp_page->GetIndex(comparator_, *key);
+      if (index == -1) {
+        throw Exception("index == -1");
+      }
+    }
+    curr_page_guard = bpm_->FetchPageRead(temp_page->ValueAt(index));
+  }
+  return curr_page_guard;
 }
 
 /*
@@ -654,7 +737,7 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
 
-  auto header_guard = bpm_->FetchPageWrite(header_page_id_);
+  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
   auto header_page = header_guard.As<BPlusTreeHeaderPage>();
 
   return header_page->root_page_id_;
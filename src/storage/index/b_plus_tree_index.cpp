@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -33,6 +35,20 @@ auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
   return container_->Insert(index_key, rid, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction)
+    -> size_t {
+  std::vector<MappingType> index_entries(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    index_entries[i].first.SetFromKey(entries[i].first);
+    index_entries[i].second = entries[i].second;
+  }
+  // 按键排序后相邻的键大多落在同一个叶子上
+  std::sort(index_entries.begin(), index_entries.end(),
+            [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+  return container_->InsertBatch(index_entries, transaction);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
@@ -60,6 +76,19 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_->End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetRangeIterator(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE {
+  return container_->Begin(range);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseIterator() -> INDEXITERATOR_TYPE { return container_->RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseIterator(const IndexKeyRange<KeyType> &range) -> INDEXITERATOR_TYPE {
+  return container_->RBegin(range);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -15,52 +16,207 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(bool is_end): is_end_(is_end) {}
+INDEXITERATOR_TYPE::IndexIterator(bool is_end) : is_end_(is_end) {}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, const page_id_t page_id, const int index):bpm_(bpm), page_id_(page_id),index_(index), is_end_(false){
-    guard_ = bpm->FetchPageRead(page_id);
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, KeyComparator *comparator, page_id_t header_page_id,
+                                  ReadPageGuard leaf_guard, IndexKeyRange<KeyType> range, bool reverse)
+    : bpm_(bpm),
+      comparator_(comparator),
+      header_page_id_(header_page_id),
+      range_(std::move(range)),
+      reverse_(reverse),
+      is_end_(false) {
+  page_id_ = leaf_guard.PageId();
+  CopyLeaf(leaf_guard.As<LeafPage>(), page_id_);
+  leaf_guard.Drop();
+
+  if (batch_.empty()) {
+    Advance();
+  }
 }
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return is_end_; }
 
-auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-    //throw std::runtime_error("unimplemented");
-    return is_end_ == true;
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  if (is_end_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "dereference an end index iterator");
+  }
+  return batch_[index_];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
-    //throw std::runtime_error("unimplemented");
-    const BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *page = guard_.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-    value_.first = page->KeyAt(index_);
-    value_.second = page->ValueAt(index_);
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (is_end_) {
+    return *this;
+  }
+
+  last_key_ = batch_[index_].first;
+  index_++;
+  if (index_ >= batch_.size()) {
+    Advance();
+  }
+  return *this;
+}
 
-    return value_;
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::AboveLow(const KeyType &key) const -> bool {
+  if (!range_.low_.has_value()) {
+    return true;
+  }
+  int cmp = (*comparator_)(key, *range_.low_);
+  return range_.low_inclusive_ ? cmp >= 0 : cmp > 0;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-    //throw std::runtime_error("unimplemented");
-    const BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *page = guard_.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
-
-    if(page->GetSize()-1>index_){
-        index_++;
-    }else{
-        int next_page_index = page->GetNextPageId();
-        if(next_page_index == -1){
-            is_end_ = true;
-        }else{
-            guard_ = bpm_->FetchPageRead(next_page_index);
-            index_ = 0;
-        }
+auto INDEXITERATOR_TYPE::BelowHigh(const KeyType &key) const -> bool {
+  if (!range_.high_.has_value()) {
+    return true;
+  }
+  int cmp = (*comparator_)(key, *range_.high_);
+  return range_.high_inclusive_ ? cmp <= 0 : cmp < 0;
+}
+
+/*
+ * 将叶子节点中位于范围内、且排在上一次返回的键之后的元素拷贝到batch_中
+ * 正向扫描时碰到超过上界的键(反向扫描时碰到低于下界的键)，说明扫描已经到达范围的边界
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CopyLeaf(const LeafPage *leaf, page_id_t page_id) {
+  batch_.clear();
+  index_ = 0;
+  page_id_ = page_id;
+
+  if (!reverse_) {
+    int start = 0;
+    if (last_key_.has_value()) {
+      start = leaf->KeyIndex(*comparator_, *last_key_);
+    } else if (range_.low_.has_value()) {
+      start = leaf->KeyIndex(*comparator_, *range_.low_);
     }
 
-    return *this;
+    for (int i = start; i < leaf->GetSize(); i++) {
+      KeyType key = leaf->KeyAt(i);
+      if ((last_key_.has_value() && (*comparator_)(key, *last_key_) <= 0) || !AboveLow(key)) {
+        continue;
+      }
+      if (!BelowHigh(key)) {
+        hit_bound_ = true;
+        break;
+      }
+      batch_.emplace_back(key, leaf->ValueAt(i));
+    }
+    return;
+  }
+
+  int end = leaf->GetSize();
+  if (last_key_.has_value()) {
+    end = leaf->KeyIndex(*comparator_, *last_key_);
+  }
+
+  for (int i = end - 1; i >= 0; i--) {
+    KeyType key = leaf->KeyAt(i);
+    if (!BelowHigh(key)) {
+      continue;
+    }
+    if (!AboveLow(key)) {
+      hit_bound_ = true;
+      break;
+    }
+    batch_.emplace_back(key, leaf->ValueAt(i));
+  }
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Advance() {
+  batch_.clear();
+  index_ = 0;
+  if (hit_bound_) {
+    is_end_ = true;
+    return;
+  }
+
+  // 先重新读取当前叶子节点，拿到迭代器拷贝之后插入的元素
+  ReadPageGuard guard = bpm_->FetchPageRead(page_id_);
+  CopyLeaf(guard.As<LeafPage>(), page_id_);
+
+  while (batch_.empty() && !hit_bound_) {
+    const LeafPage *leaf = guard.As<LeafPage>();
+    if (!reverse_) {
+      page_id_t next_page_id = leaf->GetNextPageId();
+      if (next_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      // 从左向右加锁，和插入/删除时对叶子节点加锁的顺序一致
+      guard = bpm_->FetchPageRead(next_page_id);
+      CopyLeaf(guard.As<LeafPage>(), next_page_id);
+      continue;
+    }
+
+    // 当前叶子中已经没有更小的元素，之后只需要找比它的第一个键更小的元素
+    if (leaf->GetSize() > 0 && (!last_key_.has_value() || (*comparator_)(leaf->KeyAt(0), *last_key_) < 0)) {
+      last_key_ = leaf->KeyAt(0);
+    }
+    page_id_t prev_page_id = leaf->GetPrevPageId();
+    // 反向移动前必须先释放当前节点的锁，否则会和从左向右加锁的写线程死锁
+    guard.Drop();
 
+    auto prev_guard = FetchPrevLeaf(prev_page_id);
+    if (!prev_guard.has_value()) {
+      break;
+    }
+    guard = std::move(*prev_guard);
+    CopyLeaf(guard.As<LeafPage>(), guard.PageId());
+  }
+
+  is_end_ = batch_.empty();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::FetchPrevLeaf(page_id_t prev_page_id) -> std::optional<ReadPageGuard> {
+  if (prev_page_id == INVALID_PAGE_ID) {
+    return std::nullopt;
+  }
+
+  ReadPageGuard guard = bpm_->FetchPageRead(prev_page_id);
+  if (guard.As<LeafPage>()->GetNextPageId() == page_id_ || !last_key_.has_value()) {
+    return guard;
+  }
+  guard.Drop();
+
+  // 前驱指针已经失效(节点在释放锁之后被分裂或合并)，从根节点重新找到包含last_key_的叶子
+  ReadPageGuard header_guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t root_page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (root_page_id == INVALID_PAGE_ID) {
+    return std::nullopt;
+  }
+  guard = bpm_->FetchPageRead(root_page_id);
+  header_guard.Drop();
+
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    const InternalPage *internal = guard.As<InternalPage>();
+    int index = internal->GetIndex(*comparator_, *last_key_);
+    if (index == -1) {
+      throw Exception("index == -1");
+    }
+    guard = bpm_->FetchPageRead(internal->ValueAt(index));
+  }
+
+  if (guard.PageId() == page_id_) {
+    // 重新定位回到了当前叶子，直接使用它的前驱
+    prev_page_id = guard.As<LeafPage>()->GetPrevPageId();
+    guard.Drop();
+    if (prev_page_id == INVALID_PAGE_ID) {
+      return std::nullopt;
+    }
+    return bpm_->FetchPageRead(prev_page_id);
+  }
+  return guard;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
@@ -32,6 +32,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size) {
     SetPageType(IndexPageType::LEAF_PAGE);
     SetSize(0);
     SetNextPageId(-1);
+    SetPrevPageId(-1);
     SetMaxSize(max_size);
 
 }
@@ -53,6 +54,23 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
 
 }
 
+/**
+ * Helper methods to set/get prev page id, used by reverse range scans
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t {
+
+    return prev_page_id_;
+
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+
+    prev_page_id_ = prev_page_id;
+
+}
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -103,6 +121,25 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetIndex(KeyComparator &comparator, const KeyTy
     return -1;
 }
 
+/*
+ * 二分查找第一个键不小于key的下标(lower bound)，若所有键都小于key，返回GetSize()
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(KeyComparator &comparator, const KeyType &key) const -> int {
+    int left = 0;
+    int right = GetSize();
+
+    while(left < right){
+      int middle = left + (right - left)/2;
+      if(comparator(array_[middle].first, key) < 0){
+          left = middle+1;
+      }else{
+          right = middle;
+      }
+    }
+    return left;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(KeyComparator &comparator, const KeyType &key, const ValueType &value) {
     //array_中已经存在键为key的元素
@@ -11,6 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -20,66 +25,168 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::Tag(const KeyType &key) -> uint8_t {
+  // 比较结果相等的键字节也完全相同(int和GenericKey都会先把整个键清零)，所以可以直接对键的字节做哈希；
+  // 再混合一次，让标签用到哈希的所有位
+  uint64_t hash = HashUtil::Hash(&key);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return static_cast<uint8_t>(hash % 255 + 1);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+void HASH_TABLE_BUCKET_TYPE::ForEachTag(uint8_t tag, Visitor &&visit) const {
+#if defined(__SSE2__)
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(tag));
+  for (uint32_t base = 0; base < size_; base += 16) {
+    auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags_ + base));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+    if (size_ - base < 16) {
+      mask &= (1U << (size_ - base)) - 1;
+    }
+    while (mask != 0) {
+      if (visit(base + __builtin_ctz(mask))) {
+        return;
+      }
+      mask &= mask - 1;
+    }
+  }
+#else
+  for (uint32_t i = 0; i < size_; i++) {
+    if (tags_[i] == tag && visit(i)) {
+      return;
+    }
+  }
+#endif
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) const -> bool {
+  bool found = false;
+  ForEachTag(Tag(key), [&](uint32_t slot) {
+    if (cmp(key, array_[slot].first) == 0) {
+      result->push_back(array_[slot].second);
+      found = true;
+    }
+    return false;
+  });
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  if (IsFull()) {
+    return false;
+  }
+
+  bool duplicate = false;
+  ForEachTag(Tag(key), [&](uint32_t slot) {
+    duplicate = cmp(key, array_[slot].first) == 0 && array_[slot].second == value;
+    return duplicate;
+  });
+  if (duplicate) {
+    return false;
+  }
+
+  uint32_t slot = size_;
+  if (num_readable_ < size_) {
+    ForEachTag(TOMBSTONE_TAG, [&](uint32_t tombstone) {
+      slot = tombstone;
+      return true;
+    });
+  }
+
+  array_[slot] = MappingType(key, value);
+  SetOccupied(slot);
+  SetReadable(slot);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
-  return false;
+  int64_t found = -1;
+  ForEachTag(Tag(key), [&](uint32_t slot) {
+    if (cmp(key, array_[slot].first) == 0 && array_[slot].second == value) {
+      found = slot;
+      return true;
+    }
+    return false;
+  });
+  if (found == -1) {
+    return false;
+  }
+  RemoveAt(found);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  if (!IsReadable(bucket_idx)) {
+    return;
+  }
+  tags_[bucket_idx] = TOMBSTONE_TAG;
+  num_readable_--;
+  // 桶空了之后所有墓碑都不再需要，下次插入从头开始
+  if (num_readable_ == 0) {
+    size_ = 0;
+  }
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return bucket_idx < size_;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  // 已经分配出去的槽位总是数组的前缀，跳过的槽位成为墓碑
+  for (; size_ <= bucket_idx; size_++) {
+    tags_[size_] = TOMBSTONE_TAG;
+  }
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return bucket_idx < size_ && tags_[bucket_idx] != TOMBSTONE_TAG;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  if (!IsReadable(bucket_idx)) {
+    num_readable_++;
+  }
+  tags_[bucket_idx] = Tag(array_[bucket_idx].first);
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::IsFull() const -> bool {
+  return num_readable_ == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+auto HASH_TABLE_BUCKET_TYPE::NumReadable() const -> uint32_t {
+  return num_readable_;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::IsEmpty() const -> bool {
+  return num_readable_ == 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::PrintBucket() {
+void HASH_TABLE_BUCKET_TYPE::PrintBucket() const {
   uint32_t size = 0;
   uint32_t taken = 0;
   uint32_t free = 0;
@@ -111,4 +218,8 @@ template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
 
 // template class HashTableBucketPage<hash_t, TmpTuple, HashComparator>;
 
+static_assert(sizeof(HashTableBucketPage<int, int, IntComparator>) <= BUSTUB_PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>) <= BUSTUB_PAGE_SIZE);
+static_assert(sizeof(HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>) <= BUSTUB_PAGE_SIZE);
+
 }  // namespace bustub
@@ -64,7 +64,7 @@ auto ReadPageGuard::operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &
 void ReadPageGuard::Drop() {
     if(guard_.bpm_ != nullptr && guard_.page_ != nullptr){
         guard_.page_->RUnlatch();
-        std::cout << "RUnLatch page " << PageId() << std::endl;
+        guard_.Drop();
     }
 }
 
@@ -89,7 +89,6 @@ auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard
 void WritePageGuard::Drop() {
     if(guard_.bpm_ != nullptr && guard_.page_ != nullptr){
         guard_.page_->WUnlatch();
-        std::cout << "WUnlatch page " <<  PageId() << std::endl;
         guard_.Drop();
 
     }
@@ -0,0 +1,213 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.cpp
+//
+// Identification: src/storage/page/pax_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/pax_page.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/exception.h"
+#include "storage/table/tuple_view.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+auto PaxPage::Layout(const Schema &schema, uint32_t capacity, uint16_t *minipage_offsets) -> size_t {
+  size_t offset = MetaOffset(schema.GetColumnCount()) + TUPLE_META_SIZE * capacity;
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    offset = Align(offset);
+    if (minipage_offsets != nullptr) {
+      minipage_offsets[i] = static_cast<uint16_t>(offset);
+    }
+    offset += Align((capacity + 7) / 8) + ValueWidth(schema.GetColumn(i)) * capacity;
+  }
+  return offset;
+}
+
+auto PaxPage::ComputeCapacity(const Schema &schema) -> uint32_t {
+  size_t tuple_size = TUPLE_META_SIZE;
+  size_t varchar_size = 0;
+  for (const auto &col : schema.GetColumns()) {
+    tuple_size += ValueWidth(col);
+    if (!col.IsInlined()) {
+      varchar_size += std::min(col.GetVariableLength(), VARCHAR_ESTIMATE);
+    }
+  }
+  // 先忽略位图和对齐估一个上界，再逐个减小直到页面放得下
+  auto capacity = static_cast<uint32_t>(
+      std::min<size_t>(BUSTUB_PAGE_SIZE / (tuple_size + varchar_size), std::numeric_limits<uint16_t>::max()));
+  while (capacity > 0 && Layout(schema, capacity, nullptr) + varchar_size * capacity > BUSTUB_PAGE_SIZE) {
+    capacity--;
+  }
+  return capacity;
+}
+
+auto PaxPage::MaxVarcharSize(const Schema &schema) -> size_t {
+  return BUSTUB_PAGE_SIZE - Layout(schema, ComputeCapacity(schema), nullptr);
+}
+
+auto PaxPage::VarcharSize(const Tuple &tuple, const Schema &schema) -> size_t {
+  TupleView view(tuple);
+  size_t varchar_size = 0;
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    if (!schema.GetColumn(i).IsInlined() && !view.IsNull(&schema, i)) {
+      // 连同结尾的'\0'一起存，读出时可以直接构造Value
+      varchar_size += view.GetVarchar(&schema, i).size() + 1;
+    }
+  }
+  return varchar_size;
+}
+
+void PaxPage::Init(const Schema &schema) {
+  auto capacity = ComputeCapacity(schema);
+  if (capacity == 0) {
+    throw bustub::Exception("too many columns for a PAX page");
+  }
+  next_page_id_ = INVALID_PAGE_ID;
+  num_tuples_ = 0;
+  num_deleted_tuples_ = 0;
+  capacity_ = static_cast<uint16_t>(capacity);
+  var_data_offset_ = static_cast<uint16_t>(BUSTUB_PAGE_SIZE);
+  num_columns_ = static_cast<uint16_t>(schema.GetColumnCount());
+  minipages_end_ = static_cast<uint16_t>(Layout(schema, capacity, minipage_offsets_));
+}
+
+void PaxPage::CheckSlot(const RID &rid) const {
+  if (rid.GetSlotNum() >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+}
+
+auto PaxPage::InsertTuple(const TupleMeta &meta, const Tuple &tuple, const Schema &schema) -> std::optional<uint16_t> {
+  if (num_tuples_ >= capacity_) {
+    return std::nullopt;
+  }
+  if (var_data_offset_ < minipages_end_ + VarcharSize(tuple, schema)) {
+    return std::nullopt;
+  }
+
+  TupleView view(tuple);
+
+  auto slot = num_tuples_;
+  Metas()[slot] = meta;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = schema.GetColumn(i);
+    bool is_null = view.IsNull(&schema, i);
+    SetNull(i, slot, is_null);
+    char *dst = Values(i) + ValueWidth(col) * slot;
+    if (col.IsInlined()) {
+      memcpy(dst, tuple.GetData() + col.GetOffset(), ValueWidth(col));
+      continue;
+    }
+    uint16_t offset = 0;
+    uint16_t length = 0;
+    if (!is_null) {
+      auto str = view.GetVarchar(&schema, i);
+      length = static_cast<uint16_t>(str.size() + 1);
+      var_data_offset_ -= length;
+      offset = var_data_offset_;
+      memcpy(page_start_ + offset, str.data(), str.size());
+      page_start_[offset + str.size()] = '\0';
+    }
+    memcpy(dst, &offset, sizeof(offset));
+    memcpy(dst + sizeof(offset), &length, sizeof(length));
+  }
+  num_tuples_++;
+  return slot;
+}
+
+void PaxPage::UpdateTupleMeta(const TupleMeta &meta, const RID &rid) {
+  CheckSlot(rid);
+  auto &old_meta = Metas()[rid.GetSlotNum()];
+  if (!old_meta.is_deleted_ && meta.is_deleted_) {
+    num_deleted_tuples_++;
+  }
+  old_meta = meta;
+}
+
+auto PaxPage::GetTupleMeta(const RID &rid) const -> TupleMeta {
+  CheckSlot(rid);
+  return Metas()[rid.GetSlotNum()];
+}
+
+auto PaxPage::ReadValue(const Column &col, uint32_t column_idx, uint32_t slot) const -> Value {
+  if (IsNull(column_idx, slot)) {
+    return ValueFactory::GetNullValueByType(col.GetType());
+  }
+  const char *src = Values(column_idx) + ValueWidth(col) * slot;
+  if (col.IsInlined()) {
+    return Value::DeserializeFrom(src, col.GetType());
+  }
+  uint16_t offset;
+  uint16_t length;
+  memcpy(&offset, src, sizeof(offset));
+  memcpy(&length, src + sizeof(offset), sizeof(length));
+  return ValueFactory::GetVarcharValue(page_start_ + offset, length, true);
+}
+
+void PaxPage::ReadColumn(const Schema &schema, uint32_t column_idx, const std::vector<uint32_t> &slots,
+                         std::vector<Value> *out) const {
+  const auto &col = schema.GetColumn(column_idx);
+  out->reserve(out->size() + slots.size());
+  for (auto slot : slots) {
+    out->push_back(ReadValue(col, column_idx, slot));
+  }
+}
+
+auto PaxPage::GetTuple(const RID &rid, const Schema &schema) const -> std::pair<TupleMeta, Tuple> {
+  CheckSlot(rid);
+  std::vector<Value> values;
+  values.reserve(num_columns_);
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    values.push_back(ReadValue(schema.GetColumn(i), i, rid.GetSlotNum()));
+  }
+  Tuple tuple(std::move(values), &schema);
+  tuple.SetRid(rid);
+  return std::make_pair(Metas()[rid.GetSlotNum()], std::move(tuple));
+}
+
+void PaxPage::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid, const Schema &schema) {
+  CheckSlot(rid);
+  auto slot = rid.GetSlotNum();
+  TupleView view(tuple);
+  // 变长的值只能写回原来的位置，先检查所有列都放得下再修改，避免只更新了一半
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = schema.GetColumn(i);
+    if (col.IsInlined() || view.IsNull(&schema, i)) {
+      continue;
+    }
+    uint16_t length;
+    memcpy(&length, Values(i) + ValueWidth(col) * slot + sizeof(uint16_t), sizeof(length));
+    if (IsNull(i, slot) || view.GetVarchar(&schema, i).size() + 1 > length) {
+      throw bustub::Exception("Tuple size mismatch");
+    }
+  }
+
+  UpdateTupleMeta(meta, rid);
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = schema.GetColumn(i);
+    bool is_null = view.IsNull(&schema, i);
+    char *dst = Values(i) + ValueWidth(col) * slot;
+    if (col.IsInlined()) {
+      memcpy(dst, tuple.GetData() + col.GetOffset(), ValueWidth(col));
+    } else if (!is_null) {
+      auto str = view.GetVarchar(&schema, i);
+      uint16_t offset;
+      memcpy(&offset, dst, sizeof(offset));
+      auto length = static_cast<uint16_t>(str.size() + 1);
+      memcpy(page_start_ + offset, str.data(), str.size());
+      page_start_[offset + str.size()] = '\0';
+      memcpy(dst + sizeof(offset), &length, sizeof(length));
+    }
+    SetNull(i, slot, is_null);
+  }
+}
+
+}  // namespace bustub
@@ -81,6 +81,15 @@ auto TablePage::GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple> {
   return std::make_pair(meta, std::move(tuple));
 }
 
+auto TablePage::GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView> {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  auto &[offset, size, meta] = tuple_info_[tuple_id];
+  return std::make_pair(meta, TupleView(page_start_ + offset, size, rid));
+}
+
 auto TablePage::GetTupleMeta(const RID &rid) const -> TupleMeta {
   auto tuple_id = rid.GetSlotNum();
   if (tuple_id >= num_tuples_) {
@@ -106,4 +115,29 @@ void TablePage::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tup
   memcpy(page_start_ + offset, tuple.data_.data(), tuple.GetLength());
 }
 
+auto TablePage::GetFreeSpace() const -> size_t {
+  size_t slot_end_offset = num_tuples_ > 0 ? std::get<0>(tuple_info_[num_tuples_ - 1]) : BUSTUB_PAGE_SIZE;
+  auto offset_size = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * (num_tuples_ + 1);
+  return slot_end_offset > offset_size ? slot_end_offset - offset_size : 0;
+}
+
+auto TablePage::Compact(const std::function<bool(const TupleMeta &)> &can_reclaim) -> size_t {
+  size_t reclaimed = 0;
+  size_t end = BUSTUB_PAGE_SIZE;
+  for (uint16_t tuple_id = 0; tuple_id < num_tuples_; tuple_id++) {
+    auto &[offset, size, meta] = tuple_info_[tuple_id];
+    if (size > 0 && meta.is_deleted_ && can_reclaim(meta)) {
+      size = 0;
+      reclaimed++;
+    }
+    // 元组按槽号从页尾向前存放，往后移动一个元组不会覆盖槽号更大、还没移动的元组
+    end -= size;
+    if (offset != end) {
+      memmove(page_start_ + end, page_start_ + offset, size);
+      offset = end;
+    }
+  }
+  return reclaimed;
+}
+
 }  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void FreeSpaceMap::Update(page_id_t page_id, size_t free_bytes) {
+  auto units = static_cast<uint32_t>(free_bytes / FREE_SPACE_UNIT);
+  auto iter = page_index_.find(page_id);
+  if (iter == page_index_.end()) {
+    if (pages_.size() == capacity_) {
+      // 叶子用完时容量翻倍，重建整棵树
+      capacity_ = std::max<size_t>(1, capacity_ * 2);
+      std::vector<uint32_t> tree(capacity_ * 2, 0);
+      for (size_t i = 0; i < pages_.size(); i++) {
+        tree[capacity_ + i] = tree_[capacity_ / 2 + i];
+      }
+      for (size_t node = capacity_ - 1; node > 0; node--) {
+        tree[node] = std::max(tree[node * 2], tree[node * 2 + 1]);
+      }
+      tree_ = std::move(tree);
+    }
+    iter = page_index_.emplace(page_id, pages_.size()).first;
+    pages_.push_back(page_id);
+  }
+  auto leaf = capacity_ + iter->second;
+  tree_[leaf] = units;
+  UpdateParents(leaf);
+}
+
+void FreeSpaceMap::UpdateParents(size_t node) {
+  for (node /= 2; node > 0; node /= 2) {
+    tree_[node] = std::max(tree_[node * 2], tree_[node * 2 + 1]);
+  }
+}
+
+auto FreeSpaceMap::FindPage(size_t needed) const -> std::optional<page_id_t> {
+  // 记录的空闲空间向下取整，所以需要的空间向上取整
+  auto units = (needed + FREE_SPACE_UNIT - 1) / FREE_SPACE_UNIT;
+  if (pages_.empty() || tree_[1] < units) {
+    return std::nullopt;
+  }
+  size_t node = 1;
+  while (node < capacity_) {
+    node = tree_[node * 2] >= units ? node * 2 : node * 2 + 1;
+  }
+  return pages_[node - capacity_];
+}
+
+auto FreeSpaceMap::GetFreeSpace(page_id_t page_id) const -> size_t {
+  auto iter = page_index_.find(page_id);
+  if (iter == page_index_.end()) {
+    return 0;
+  }
+  return tree_[capacity_ + iter->second] * FREE_SPACE_UNIT;
+}
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue.cpp
+//
+// Identification: src/storage/table/morsel_queue.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/morsel_queue.h"
+
+#include <algorithm>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+MorselQueue::MorselQueue(TableHeap *table_heap, size_t pages_per_morsel, const std::vector<ZoneMapRange> &ranges)
+    : bpm_(table_heap->bpm_), pages_per_morsel_(std::max<size_t>(1, pages_per_morsel)) {
+  // 和TableIterator一样记下创建时最后一页和它的元组数，之后插入的元组不会被扫描到
+  std::unique_lock<std::mutex> guard(table_heap->latch_);
+  if (const auto *zone_map = table_heap->GetZoneMap(); zone_map != nullptr) {
+    // zone map在插入时和页面一起在latch_下更新，这里列出的页面和元组数就是此刻堆中的全部元组
+    pages_ = zone_map->GetPages(ranges);
+    return;
+  }
+  last_page_id_ = table_heap->last_page_id_;
+  guard.unlock();
+  auto page_guard = bpm_->FetchPageRead(last_page_id_);
+  last_num_tuples_ = page_guard.As<TablePage>()->GetNumTuples();
+  next_page_id_ = table_heap->GetFirstPageId();
+}
+
+auto MorselQueue::Next(Morsel *morsel) -> bool {
+  morsel->pages_.clear();
+  std::scoped_lock lock(latch_);
+  if (pages_.has_value()) {
+    while (morsel->pages_.size() < pages_per_morsel_ && next_page_ < pages_->size()) {
+      morsel->pages_.push_back((*pages_)[next_page_++]);
+    }
+    return !morsel->pages_.empty();
+  }
+  // 只读页头来沿着页链表前进，元组本身由拿到这个morsel的线程去读
+  while (morsel->pages_.size() < pages_per_morsel_ && next_page_id_ != INVALID_PAGE_ID) {
+    auto page_id = next_page_id_;
+    uint32_t num_slots;
+    if (page_id == last_page_id_) {
+      num_slots = last_num_tuples_;
+      next_page_id_ = INVALID_PAGE_ID;
+    } else {
+      auto guard = bpm_->FetchPageRead(page_id);
+      const auto *page = guard.As<TablePage>();
+      num_slots = page->GetNumTuples();
+      next_page_id_ = page->GetNextPageId();
+    }
+    if (num_slots > 0) {
+      morsel->pages_.emplace_back(page_id, num_slots);
+    }
+  }
+  return !morsel->pages_.empty();
+}
+
+}  // namespace bustub
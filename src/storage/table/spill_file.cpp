@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_file.cpp
+//
+// Identification: src/storage/table/spill_file.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/spill_file.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+SpillFile::~SpillFile() {
+  Finish();
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void SpillFile::Append(const Tuple &tuple) {
+  TmpTuple location{INVALID_PAGE_ID, 0};
+  if (tail_ == nullptr && !page_ids_.empty()) {
+    tail_ = FetchSpillPage(page_ids_.back());
+  }
+  if (tail_ == nullptr || !tail_->Insert(tuple, &location)) {
+    // 当前页已满，换一个新页继续写，写满的页交给缓冲池，需要时会被换出到磁盘
+    Finish();
+    page_id_t page_id;
+    tail_ = NewSpillPage(&page_id);
+    tail_->Init(page_id, BUSTUB_PAGE_SIZE);
+    page_ids_.push_back(page_id);
+    if (!tail_->Insert(tuple, &location)) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "tuple is too large to be spilled");
+    }
+  }
+  num_tuples_++;
+  num_bytes_ += tuple.GetLength();
+}
+
+void SpillFile::Finish() {
+  if (tail_ != nullptr) {
+    bpm_->UnpinPage(page_ids_.back(), true);
+    tail_ = nullptr;
+  }
+}
+
+void SpillFile::ReadPage(size_t page_idx, std::vector<Tuple> *tuples) {
+  Finish();
+  tuples->clear();
+  auto *page = FetchSpillPage(page_ids_[page_idx]);
+  // 页内的元组从页尾向前存放，从空闲空间指针开始往后读得到的是逆序，最后再反转回写入顺序
+  for (size_t offset = page->GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE;) {
+    offset = page->Get(offset, &tuples->emplace_back());
+  }
+  std::reverse(tuples->begin(), tuples->end());
+  bpm_->UnpinPage(page_ids_[page_idx], false);
+}
+
+auto SpillFile::FetchSpillPage(page_id_t page_id) -> TmpTuplePage * {
+  Page *page = nullptr;
+  // 缓冲池约定没有空闲帧时返回 nullptr，但当前的实现会直接抛出异常，两种情况统一报告
+  try {
+    page = bpm_->FetchPage(page_id);
+  } catch (Exception &) {
+    page = nullptr;
+  }
+  if (page == nullptr) {
+    throw ExecutionException("out of buffer pool frames while spilling");
+  }
+  return reinterpret_cast<TmpTuplePage *>(page);
+}
+
+auto SpillFile::NewSpillPage(page_id_t *page_id) -> TmpTuplePage * {
+  Page *page = nullptr;
+  try {
+    page = bpm_->NewPage(page_id);
+  } catch (Exception &) {
+    page = nullptr;
+  }
+  if (page == nullptr) {
+    throw ExecutionException("out of buffer pool frames while spilling");
+  }
+  return reinterpret_cast<TmpTuplePage *>(page);
+}
+
+}  // namespace bustub
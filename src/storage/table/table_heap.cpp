@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <mutex>  // NOLINT
 #include <utility>
@@ -21,6 +22,7 @@
 #include "concurrency/transaction.h"
 #include "fmt/format.h"
 #include "storage/page/page_guard.h"
+#include "storage/page/pax_page.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_heap.h"
 
@@ -36,61 +38,198 @@ TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
   first_page->Init();
 }
 
-auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr, Transaction *txn,
-                            table_oid_t oid) -> std::optional<RID> {
-  std::unique_lock<std::mutex> guard(latch_);
-  auto page_guard = bpm_->FetchPageWrite(last_page_id_);
-  while (true) {
-    auto page = page_guard.AsMut<TablePage>();
-    if (page->GetNextTupleOffset(meta, tuple) != std::nullopt) {
-      break;
-    }
+TableHeap::TableHeap(BufferPoolManager *bpm, TableFormat format, const Schema &schema)
+    : bpm_(bpm),
+      format_(format),
+      schema_(std::make_unique<Schema>(schema)),
+      zone_map_(std::make_unique<ZoneMap>(schema)) {
+  // 建表时就检查一页能否放下至少一个元组，而不是等到第一次插入才失败
+  if (format_ == TableFormat::Pax && PaxPage::ComputeCapacity(*schema_) == 0) {
+    throw bustub::Exception("too many columns for a PAX page");
+  }
+  if (format_ == TableFormat::Pax) {
+    max_varchar_size_ = PaxPage::MaxVarcharSize(*schema_);
+  }
+  if (format_ == TableFormat::Row) {
+    free_space_map_ = std::make_unique<FreeSpaceMap>();
+  }
+  // Initialize the first table page.
+  auto guard = bpm->NewPageGuarded(&first_page_id_);
+  last_page_id_ = first_page_id_;
+  BUSTUB_ASSERT(first_page_id_ != INVALID_PAGE_ID,
+                "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
+  InitPage(guard.GetDataMut());
+}
+
+void TableHeap::InitPage(char *data) {
+  if (format_ == TableFormat::Row) {
+    reinterpret_cast<TablePage *>(data)->Init();
+  } else {
+    reinterpret_cast<PaxPage *>(data)->Init(*schema_);
+  }
+}
+
+auto TableHeap::InsertIntoPage(WritePageGuard *guard, const TupleMeta &meta, const Tuple &tuple)
+    -> std::optional<uint16_t> {
+  if (format_ == TableFormat::Row) {
+    return guard->AsMut<TablePage>()->InsertTuple(meta, tuple);
+  }
+  return guard->AsMut<PaxPage>()->InsertTuple(meta, tuple, *schema_);
+}
+
+void TableHeap::AppendPage(WritePageGuard *page_guard) {
+  // both page formats start with the header of a TablePage
+  auto page = page_guard->AsMut<TablePage>();
+  // if there's no tuple in the page, and we can't insert the tuple, then this tuple is too large.
+  BUSTUB_ENSURE(page->GetNumTuples() != 0, "tuple is too large, cannot insert");
 
-    // if there's no tuple in the page, and we can't insert the tuple, then this tuple is too large.
-    BUSTUB_ENSURE(page->GetNumTuples() != 0, "tuple is too large, cannot insert");
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  auto npg = bpm_->NewPage(&next_page_id);
+  BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
 
-    page_id_t next_page_id = INVALID_PAGE_ID;
-    auto npg = bpm_->NewPage(&next_page_id);
-    BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
+  // Don't do lock crabbing here: TSAN reports, also as last_page_id_ is only updated
+  // later, this page won't be accessed.
+  page->SetNextPageId(next_page_id);
+  page_guard->Drop();
 
-    // Don't do lock crabbing here: TSAN reports, also as last_page_id_ is only updated
-    // later, this page won't be accessed.
-    page->SetNextPageId(next_page_id);
-    page_guard.Drop();
+  npg->WLatch();
+  auto next_page_guard = WritePageGuard{bpm_, npg};
+  InitPage(next_page_guard.GetDataMut());
 
-    npg->WLatch();
-    auto next_page_guard = WritePageGuard{bpm_, npg};
-    auto next_page = next_page_guard.AsMut<TablePage>();
-    next_page->Init();
+  last_page_id_ = next_page_id;
+  *page_guard = std::move(next_page_guard);
+}
 
-    last_page_id_ = next_page_id;
-    page_guard = std::move(next_page_guard);
+auto TableHeap::FitsInPage(const Tuple &tuple) const -> bool {
+  if (format_ == TableFormat::Row) {
+    return tuple.GetLength() <= TablePage::MaxTupleSize();
   }
-  auto last_page_id = last_page_id_;
+  // PAX页面为每列预留了定长的位置，放不放得下只取决于变长列的数据
+  return PaxPage::VarcharSize(tuple, *schema_) <= max_varchar_size_;
+}
 
-  auto page = page_guard.AsMut<TablePage>();
-  auto slot_id = *page->InsertTuple(meta, tuple);
+void TableHeap::CheckFitsInPage(const Tuple &tuple) const {
+  // 放不进空页面的元组会让AppendPage中的BUSTUB_ENSURE终止进程，插入前就报错
+  if (!FitsInPage(tuple)) {
+    throw bustub::Exception(fmt::format("tuple of {} bytes does not fit in a page", tuple.GetLength()));
+  }
+}
+
+auto TableHeap::FindPageForInsert(const Tuple &tuple) const -> page_id_t {
+  if (free_space_map_ != nullptr) {
+    // 空闲空间太少的页面不再使用，只追加写入的表仍然按插入顺序存放元组
+    auto page_id = free_space_map_->FindPage(std::max<size_t>(tuple.GetLength(), MIN_REUSE_SPACE));
+    if (page_id.has_value()) {
+      return *page_id;
+    }
+  }
+  return last_page_id_;
+}
+
+void TableHeap::MoveToNextPage(WritePageGuard *page_guard, page_id_t *page_id, const Tuple &tuple) {
+  // 先记下这一页真实的空闲空间，空闲空间表中的记录过时了也不会再找到它
+  RecordFreeSpace(*page_id, page_guard);
+  auto next_page_id = FindPageForInsert(tuple);
+  if (next_page_id == *page_id) {
+    AppendPage(page_guard);
+    *page_id = last_page_id_;
+    return;
+  }
+  page_guard->Drop();
+  *page_guard = bpm_->FetchPageWrite(next_page_id);
+  *page_id = next_page_id;
+}
+
+void TableHeap::RecordFreeSpace(page_id_t page_id, WritePageGuard *page_guard) {
+  if (free_space_map_ != nullptr) {
+    free_space_map_->Update(page_id, page_guard->As<TablePage>()->GetFreeSpace());
+  }
+}
+
+auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr, Transaction *txn,
+                            table_oid_t oid) -> std::optional<RID> {
+  CheckFitsInPage(tuple);
+  std::unique_lock<std::mutex> guard(latch_);
+  auto page_id = FindPageForInsert(tuple);
+  auto page_guard = bpm_->FetchPageWrite(page_id);
+  auto slot_id = InsertIntoPage(&page_guard, meta, tuple);
+  while (slot_id == std::nullopt) {
+    MoveToNextPage(&page_guard, &page_id, tuple);
+    slot_id = InsertIntoPage(&page_guard, meta, tuple);
+  }
+  RecordFreeSpace(page_id, &page_guard);
+  // 在持有latch_时更新zone map，创建MorselQueue时看到的页面列表和元组数与堆一致
+  if (zone_map_ != nullptr) {
+    zone_map_->AddTuple(page_id, *slot_id, tuple);
+  }
 
   // only allow one insertion at a time, otherwise it will deadlock.
   guard.unlock();
 
   if (lock_mgr != nullptr) {
-    lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{last_page_id, slot_id});
+    lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{page_id, *slot_id});
+  }
+
+  page_guard.Drop();
+
+  return RID(page_id, *slot_id);
+}
+
+auto TableHeap::InsertTuples(const TupleMeta &meta, const std::vector<Tuple> &tuples, LockManager *lock_mgr,
+                             Transaction *txn, table_oid_t oid) -> std::vector<RID> {
+  std::vector<RID> rids;
+  rids.reserve(tuples.size());
+  if (tuples.empty()) {
+    return rids;
+  }
+  // 先检查所有元组，一批中有放不下的就一个也不插入
+  for (const auto &tuple : tuples) {
+    CheckFitsInPage(tuple);
+  }
+  std::unique_lock<std::mutex> guard(latch_);
+  // 一页写满之前一直持有它的写锁，每页只加一次锁，离开一页时才更新它的空闲空间
+  auto page_id = FindPageForInsert(tuples[0]);
+  auto page_guard = bpm_->FetchPageWrite(page_id);
+  for (const auto &tuple : tuples) {
+    auto slot_id = InsertIntoPage(&page_guard, meta, tuple);
+    while (slot_id == std::nullopt) {
+      MoveToNextPage(&page_guard, &page_id, tuple);
+      slot_id = InsertIntoPage(&page_guard, meta, tuple);
+    }
+    if (zone_map_ != nullptr) {
+      zone_map_->AddTuple(page_id, *slot_id, tuple);
+    }
+    rids.emplace_back(page_id, *slot_id);
+  }
+  RecordFreeSpace(page_id, &page_guard);
+  guard.unlock();
+
+  if (lock_mgr != nullptr) {
+    for (const auto &rid : rids) {
+      lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, rid);
+    }
   }
 
   page_guard.Drop();
 
-  return RID(last_page_id, slot_id);
+  return rids;
 }
 
 void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
+  if (format_ == TableFormat::Pax) {
+    page_guard.AsMut<PaxPage>()->UpdateTupleMeta(meta, rid);
+    return;
+  }
   auto page = page_guard.AsMut<TablePage>();
   page->UpdateTupleMeta(meta, rid);
 }
 
 auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
   auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+  if (format_ == TableFormat::Pax) {
+    return page_guard.As<PaxPage>()->GetTuple(rid, *schema_);
+  }
   auto page = page_guard.As<TablePage>();
   auto [meta, tuple] = page->GetTuple(rid);
   tuple.rid_ = rid;
@@ -99,12 +238,49 @@ auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
 
 auto TableHeap::GetTupleMeta(RID rid) -> TupleMeta {
   auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+  if (format_ == TableFormat::Pax) {
+    return page_guard.As<PaxPage>()->GetTupleMeta(rid);
+  }
   auto page = page_guard.As<TablePage>();
   return page->GetTupleMeta(rid);
 }
 
+auto TableHeap::Vacuum(const std::function<bool(const TupleMeta &)> &can_reclaim) -> size_t {
+  if (format_ != TableFormat::Row) {
+    return 0;
+  }
+  size_t reclaimed = 0;
+  std::vector<Tuple> tuples;
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    // 和插入一样先拿latch_再拿页面写锁，整理一页时插入要等待，扫描只在读这一页时等待
+    std::unique_lock<std::mutex> guard(latch_);
+    auto page_guard = bpm_->FetchPageWrite(page_id);
+    auto page = page_guard.AsMut<TablePage>();
+    auto page_reclaimed = page->Compact(can_reclaim);
+    if (page_reclaimed > 0 && zone_map_ != nullptr) {
+      tuples.clear();
+      for (uint32_t slot = 0; slot < page->GetNumTuples(); slot++) {
+        auto [meta, tuple] = page->GetTuple(RID{page_id, slot});
+        if (tuple.GetLength() > 0) {
+          tuples.push_back(std::move(tuple));
+        }
+      }
+      zone_map_->RebuildPage(page_id, tuples);
+    }
+    RecordFreeSpace(page_id, &page_guard);
+    reclaimed += page_reclaimed;
+    page_id = page->GetNextPageId();
+  }
+  return reclaimed;
+}
+
 auto TableHeap::MakeIterator() -> TableIterator {
   std::unique_lock<std::mutex> guard(latch_);
+  if (free_space_map_ != nullptr) {
+    // 插入会放进前面有空位的页面，迭代器按zone map记下的每页元组数扫描，之后插入的元组都不会被扫描到
+    return {this, zone_map_->GetPages({})};
+  }
   auto last_page_id = last_page_id_;
   guard.unlock();
 
@@ -117,8 +293,15 @@ auto TableHeap::MakeEagerIterator() -> TableIterator { return {this, {first_page
 
 void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
-  auto page = page_guard.AsMut<TablePage>();
-  page->UpdateTupleInPlaceUnsafe(meta, tuple, rid);
+  if (format_ == TableFormat::Pax) {
+    page_guard.AsMut<PaxPage>()->UpdateTupleInPlaceUnsafe(meta, tuple, rid, *schema_);
+  } else {
+    auto page = page_guard.AsMut<TablePage>();
+    page->UpdateTupleInPlaceUnsafe(meta, tuple, rid);
+  }
+  if (zone_map_ != nullptr) {
+    zone_map_->AddTuple(rid.GetPageId(), rid.GetSlotNum(), tuple);
+  }
 }
 
 }  // namespace bustub
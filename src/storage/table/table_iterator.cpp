@@ -31,6 +31,17 @@ TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid)
   }
 }
 
+TableIterator::TableIterator(TableHeap *table_heap, std::vector<std::pair<page_id_t, uint32_t>> pages)
+    : table_heap_(table_heap), rid_(INVALID_PAGE_ID, 0), stop_at_rid_(INVALID_PAGE_ID, 0), pages_(std::move(pages)) {
+  // 跳过还没有元组的页面
+  while (page_idx_ < pages_->size() && (*pages_)[page_idx_].second == 0) {
+    page_idx_++;
+  }
+  if (page_idx_ < pages_->size()) {
+    rid_ = RID{(*pages_)[page_idx_].first, 0};
+  }
+}
+
 auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_); }
 
 auto TableIterator::GetRID() -> RID { return rid_; }
@@ -38,6 +49,18 @@ auto TableIterator::GetRID() -> RID { return rid_; }
 auto TableIterator::IsEnd() -> bool { return rid_.GetPageId() == INVALID_PAGE_ID; }
 
 auto TableIterator::operator++() -> TableIterator & {
+  if (pages_.has_value()) {
+    auto next_tuple_id = rid_.GetSlotNum() + 1;
+    if (next_tuple_id < (*pages_)[page_idx_].second) {
+      rid_ = RID{rid_.GetPageId(), next_tuple_id};
+      return *this;
+    }
+    do {
+      page_idx_++;
+    } while (page_idx_ < pages_->size() && (*pages_)[page_idx_].second == 0);
+    rid_ = page_idx_ < pages_->size() ? RID{(*pages_)[page_idx_].first, 0} : RID{INVALID_PAGE_ID, 0};
+    return *this;
+  }
   auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
   auto page = page_guard.As<TablePage>();
   auto next_tuple_id = rid_.GetSlotNum() + 1;
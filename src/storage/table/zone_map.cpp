@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.cpp
+//
+// Identification: src/storage/table/zone_map.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/zone_map.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+#include "storage/table/tuple_view.h"
+
+namespace bustub {
+
+ZoneMap::ZoneMap(const Schema &schema) : schema_(schema) {
+  for (const auto &col : schema_.GetColumns()) {
+    tracked_.push_back(col.IsInlined());
+  }
+}
+
+void ZoneMap::AddTuple(page_id_t page_id, uint32_t slot, const Tuple &tuple) {
+  std::unique_lock lock(latch_);
+  auto iter = page_index_.find(page_id);
+  if (iter == page_index_.end()) {
+    iter = page_index_.emplace(page_id, pages_.size()).first;
+    pages_.push_back(PageZones{page_id, 0, std::vector<ColumnZone>(schema_.GetColumnCount())});
+  }
+  auto &page = pages_[iter->second];
+  page.num_slots_ = std::max(page.num_slots_, slot + 1);
+  Widen(&page.columns_, tuple);
+}
+
+void ZoneMap::RebuildPage(page_id_t page_id, const std::vector<Tuple> &tuples) {
+  // 先在锁外算好新的zone再一次替换，同时创建的MorselQueue不会看到清空了一半的zone
+  std::vector<ColumnZone> columns(schema_.GetColumnCount());
+  for (const auto &tuple : tuples) {
+    Widen(&columns, tuple);
+  }
+  std::unique_lock lock(latch_);
+  auto iter = page_index_.find(page_id);
+  if (iter != page_index_.end()) {
+    pages_[iter->second].columns_ = std::move(columns);
+  }
+}
+
+void ZoneMap::Widen(std::vector<ColumnZone> *columns, const Tuple &tuple) const {
+  TupleView view(tuple);
+  for (uint32_t i = 0; i < schema_.GetColumnCount(); i++) {
+    auto &zone = (*columns)[i];
+    if (!tracked_[i]) {
+      // 变长列不记录最值，只需要知道是不是NULL
+      bool is_null = view.IsNull(&schema_, i);
+      zone.null_count_ += is_null ? 1 : 0;
+      zone.has_value_ = zone.has_value_ || !is_null;
+      continue;
+    }
+    auto value = tuple.GetValue(&schema_, i);
+    if (value.IsNull()) {
+      zone.null_count_++;
+      continue;
+    }
+    zone.has_value_ = true;
+    if (zone.min_.GetTypeId() == TypeId::INVALID || value.CompareLessThan(zone.min_) == CmpBool::CmpTrue) {
+      zone.min_ = value;
+    }
+    if (zone.max_.GetTypeId() == TypeId::INVALID || value.CompareGreaterThan(zone.max_) == CmpBool::CmpTrue) {
+      zone.max_ = value;
+    }
+  }
+}
+
+auto ZoneMap::GetZone(page_id_t page_id, uint32_t column_idx) const -> std::optional<ColumnZone> {
+  std::shared_lock lock(latch_);
+  auto iter = page_index_.find(page_id);
+  if (iter == page_index_.end()) {
+    return std::nullopt;
+  }
+  return pages_[iter->second].columns_[column_idx];
+}
+
+auto ZoneMap::MayMatch(const PageZones &page, const std::vector<ZoneMapRange> &ranges) const -> bool {
+  for (const auto &range : ranges) {
+    const auto &zone = page.columns_[range.column_idx_];
+    // 比较遇到NULL不成立，整列都是NULL的页面一定不匹配
+    if (!zone.has_value_) {
+      return false;
+    }
+    if (!tracked_[range.column_idx_]) {
+      continue;
+    }
+    if (range.lower_.has_value()) {
+      auto cmp = range.lower_inclusive_ ? zone.max_.CompareLessThan(*range.lower_)
+                                        : zone.max_.CompareLessThanEquals(*range.lower_);
+      if (cmp == CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+    if (range.upper_.has_value()) {
+      auto cmp = range.upper_inclusive_ ? zone.min_.CompareGreaterThan(*range.upper_)
+                                        : zone.min_.CompareGreaterThanEquals(*range.upper_);
+      if (cmp == CmpBool::CmpTrue) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+auto ZoneMap::MayMatch(page_id_t page_id, const std::vector<ZoneMapRange> &ranges) const -> bool {
+  std::shared_lock lock(latch_);
+  auto iter = page_index_.find(page_id);
+  return iter == page_index_.end() || MayMatch(pages_[iter->second], ranges);
+}
+
+auto ZoneMap::GetPages(const std::vector<ZoneMapRange> &ranges) const -> std::vector<std::pair<page_id_t, uint32_t>> {
+  std::shared_lock lock(latch_);
+  std::vector<std::pair<page_id_t, uint32_t>> pages;
+  for (const auto &page : pages_) {
+    if (MayMatch(page, ranges)) {
+      pages.emplace_back(page.page_id_, page.num_slots_);
+    }
+  }
+  return pages;
+}
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler_test.cpp
+//
+// Identification: test/common/task_scheduler_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/util/parallel_util.h"
+#include "common/util/task_scheduler.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TaskSchedulerTest, RunsAllTasksTest) {
+  std::atomic<int> count{0};
+  {
+    TaskScheduler scheduler(4);
+    EXPECT_EQ(scheduler.NumWorkers(), 4);
+    for (int i = 0; i < 1000; i++) {
+      scheduler.Submit([&count] { count++; });
+    }
+  }
+  // the destructor runs the tasks still queued before it stops the workers
+  EXPECT_EQ(count, 1000);
+}
+
+TEST(TaskSchedulerTest, WorkStealingTest) {
+  TaskScheduler scheduler(4);
+  std::atomic<int> count{0};
+  std::atomic<bool> done{false};
+  scheduler.Submit([&] {
+    // the subtasks go to this worker's own deque and it waits for them, so the other workers must steal them
+    for (int i = 0; i < 100; i++) {
+      scheduler.Submit([&count] { count++; });
+    }
+    while (count < 100) {
+      std::this_thread::yield();
+    }
+    done = true;
+  });
+  while (!done) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(count, 100);
+  EXPECT_EQ(scheduler.NumSteals(), 100);
+}
+
+TEST(TaskSchedulerTest, ParallelForTest) {
+  // several queries run parallel loops at once and nest them, all on the shared pool
+  std::vector<std::thread> queries;
+  std::vector<std::atomic<int>> sums(4);
+  for (size_t q = 0; q < sums.size(); q++) {
+    queries.emplace_back([&sums, q] {
+      ParallelUtil::For(4, 50, [&](size_t i) {
+        ParallelUtil::For(4, 10, [&](size_t j) { sums[q] += static_cast<int>(i * 10 + j); });
+      });
+    });
+  }
+  for (auto &query : queries) {
+    query.join();
+  }
+  for (auto &sum : sums) {
+    EXPECT_EQ(sum, 499 * 500 / 2);
+  }
+
+  std::atomic<int> ran{0};
+  EXPECT_THROW(ParallelUtil::For(4, 100,
+                                 [&](size_t i) {
+                                   ran++;
+                                   if (i == 10) {
+                                     throw std::runtime_error("task failed");
+                                   }
+                                 }),
+               std::runtime_error);
+  EXPECT_LE(ran, 100);
+}
+
+}  // namespace bustub
@@ -23,7 +23,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -56,7 +56,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -113,4 +113,50 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageTombstoneTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page =
+      reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(bpm->NewPage(&bucket_page_id)->GetData());
+  using KeyType = int;
+  using ValueType = int;
+  const auto capacity = static_cast<int>(BUCKET_ARRAY_SIZE);
+
+  // fill the bucket, every pair is still found through its tag
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_TRUE(bucket_page->Insert(i, i, IntComparator()));
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_FALSE(bucket_page->Insert(capacity, capacity, IntComparator()));
+  for (int i = 0; i < capacity; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(bucket_page->GetValue(i, IntComparator(), &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // a removed slot is reused by the next insert
+  EXPECT_TRUE(bucket_page->Remove(7, 7, IntComparator()));
+  EXPECT_FALSE(bucket_page->IsFull());
+  EXPECT_TRUE(bucket_page->Insert(capacity, capacity, IntComparator()));
+  EXPECT_EQ(capacity, bucket_page->KeyAt(7));
+  EXPECT_TRUE(bucket_page->IsFull());
+
+  // once the bucket is empty its tombstones are dropped
+  for (int i = 0; i <= capacity; i++) {
+    bucket_page->Remove(i, i, IntComparator());
+  }
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  EXPECT_FALSE(bucket_page->IsOccupied(0));
+
+  bpm->UnpinPage(bucket_page_id, true);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/disk/hash/linear_probe_hash_table_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+using KeyType = int;
+using ValueType = int;
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 10, HashFunction<int>());
+
+  // the size is rounded up to whole block pages
+  EXPECT_EQ(BLOCK_ARRAY_SIZE, ht.GetSize());
+
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+
+  // duplicate pairs are rejected, a second value for the same key is not
+  EXPECT_FALSE(ht.Insert(nullptr, 3, 3));
+  EXPECT_TRUE(ht.Insert(nullptr, 3, 30));
+  std::vector<int> res;
+  ht.GetValue(nullptr, 3, &res);
+  std::sort(res.begin(), res.end());
+  EXPECT_EQ((std::vector<int>{3, 30}), res);
+
+  EXPECT_TRUE(ht.Remove(nullptr, 3, 3));
+  EXPECT_FALSE(ht.Remove(nullptr, 3, 3));
+  EXPECT_FALSE(ht.Remove(nullptr, 4, 40));
+  res.clear();
+  ht.GetValue(nullptr, 3, &res);
+  EXPECT_EQ(std::vector<int>{30}, res);
+
+  // the slot freed by the remove can be claimed again
+  EXPECT_TRUE(ht.Insert(nullptr, 3, 3));
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 100, &res));
+  EXPECT_TRUE(res.empty());
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, GrowTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 10, HashFunction<int>());
+
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_GE(ht.GetSize(), static_cast<size_t>(num_keys));
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(std::vector<int>{i}, res);
+  }
+
+  ht.Resize(num_keys * 2);
+  EXPECT_GE(ht.GetSize(), static_cast<size_t>(num_keys * 4));
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(std::vector<int>{i}, res);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, TombstoneTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 10, HashFunction<int>());
+
+  // a long insert/remove churn with few live keys only leaves tombstones behind, the rebuilds
+  // have to clean them up without growing the table
+  for (int i = 0; i < 20000; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    if (i >= 10) {
+      ASSERT_TRUE(ht.Remove(nullptr, i - 10, i - 10));
+    }
+  }
+  EXPECT_EQ(BLOCK_ARRAY_SIZE, ht.GetSize());
+  for (int i = 0; i < 20000; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(i >= 19990 ? 1 : 0, res.size());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentInsertTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), 10, HashFunction<int>());
+
+  const int num_threads = 4;
+  const int keys_per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t * keys_per_thread; i < (t + 1) * keys_per_thread; i++) {
+        ht.Insert(nullptr, i, i);
+        // every thread also retries a pair owned by another thread, only one of them may win
+        ht.Insert(nullptr, i % keys_per_thread, i % keys_per_thread);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(std::vector<int>{i}, res) << "key " << i;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_hash_table_test.cpp
+//
+// Identification: test/execution/aggregation_hash_table_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/config.h"
+#include "execution/aggregation_hash_table.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+const std::vector<AggregationType> AGG_TYPES{AggregationType::CountStarAggregate, AggregationType::CountAggregate,
+                                             AggregationType::SumAggregate, AggregationType::MinAggregate,
+                                             AggregationType::MaxAggregate};
+
+void CombineRow(AggregationHashTable *table, const Value &key, const Value &input) {
+  std::vector<Value> inputs(AGG_TYPES.size(), input);
+  table->Combine(AggregationHashTable::HashKeys(&key, 1), &key, inputs.data());
+}
+
+/** @return the row of the group with the given key, nullptr if there is none */
+auto FindGroup(const AggregationHashTable &table, const Value &key) -> const Value * {
+  for (size_t group = 0; group < table.Size(); group++) {
+    const Value *row = table.GetRow(group);
+    if (row[0].IsNull() ? key.IsNull() : !key.IsNull() && row[0].CompareEquals(key) == CmpBool::CmpTrue) {
+      return row;
+    }
+  }
+  return nullptr;
+}
+
+auto QuerySorted(BustubInstance *bustub, const std::string &sql) -> std::vector<std::string> {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(ss, line);) {
+    lines.push_back(line);
+  }
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+}  // namespace
+
+TEST(AggregationHashTableTest, CombineAndMergeTest) {
+  AggregationHashTable first(AGG_TYPES, 1);
+  AggregationHashTable second(AGG_TYPES, 1);
+  auto null_key = ValueFactory::GetNullValueByType(TypeId::INTEGER);
+  auto null_input = ValueFactory::GetNullValueByType(TypeId::INTEGER);
+
+  // 1000 groups, enough to grow the slot table several times, every key gets the inputs 0..9
+  for (int32_t i = 0; i < 10000; i++) {
+    auto &table = i % 2 == 0 ? first : second;
+    CombineRow(&table, ValueFactory::GetIntegerValue(i % 1000), ValueFactory::GetIntegerValue(i / 1000));
+  }
+  // NULL keys form one group, NULL inputs only count for COUNT(*)
+  CombineRow(&first, null_key, ValueFactory::GetIntegerValue(5));
+  CombineRow(&second, null_key, null_input);
+  CombineRow(&second, null_key, ValueFactory::GetIntegerValue(-3));
+  ASSERT_EQ(first.Size(), 501);
+  ASSERT_EQ(second.Size(), 501);
+
+  AggregationHashTable merged(AGG_TYPES, 1);
+  for (const auto *table : {&first, &second}) {
+    for (size_t group = 0; group < table->Size(); group++) {
+      const Value *row = table->GetRow(group);
+      merged.Merge(table->GetHash(group), row, row + 1);
+    }
+  }
+  ASSERT_EQ(merged.Size(), 1001);
+  EXPECT_GT(merged.MemoryUsage(), 1001 * merged.RowWidth() * sizeof(Value));
+
+  for (int32_t key = 0; key < 1000; key++) {
+    const Value *row = FindGroup(merged, ValueFactory::GetIntegerValue(key));
+    ASSERT_NE(row, nullptr);
+    EXPECT_EQ(row[1].GetAs<int32_t>(), 10);
+    EXPECT_EQ(row[2].GetAs<int32_t>(), 10);
+    EXPECT_EQ(row[3].GetAs<int32_t>(), 45);
+    EXPECT_EQ(row[4].GetAs<int32_t>(), 0);
+    EXPECT_EQ(row[5].GetAs<int32_t>(), 9);
+  }
+  const Value *row = FindGroup(merged, null_key);
+  ASSERT_NE(row, nullptr);
+  EXPECT_EQ(row[1].GetAs<int32_t>(), 3);
+  EXPECT_EQ(row[2].GetAs<int32_t>(), 2);
+  EXPECT_EQ(row[3].GetAs<int32_t>(), 2);
+  EXPECT_EQ(row[4].GetAs<int32_t>(), -3);
+  EXPECT_EQ(row[5].GetAs<int32_t>(), 5);
+
+  merged.Clear();
+  EXPECT_EQ(merged.Size(), 0);
+  EXPECT_EQ(merged.MemoryUsage(), 0);
+}
+
+TEST(AggregationHashTableTest, SpilledAggregationMatchesInMemoryAggregation) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  bustub->ExecuteSql("CREATE TABLE t (a INT, b INT, c VARCHAR(32));", writer);
+  const size_t num_rows = 12000;
+  for (size_t begin = 0; begin < num_rows; begin += 500) {
+    std::string sql = "INSERT INTO t VALUES ";
+    for (size_t i = begin; i < begin + 500; i++) {
+      auto a = i % 101 == 0 ? std::string("NULL") : std::to_string((i * 7) % 5000);
+      sql += fmt::format("{}({}, {}, 'group-{}')", i == begin ? "" : ", ", a, i % 13, i % 3000);
+    }
+    ASSERT_TRUE(bustub->ExecuteSql(sql + ";", writer));
+  }
+
+  const std::vector<std::string> queries{
+      "SELECT a, count(*), count(b), sum(b), min(b), max(b) FROM t GROUP BY a;",
+      "SELECT c, b, count(*), min(a), max(a) FROM t GROUP BY c, b;",
+      "SELECT count(*), sum(a), min(b) FROM t;",
+      "SELECT count(*), sum(a) FROM t WHERE a < 0;",
+  };
+  std::vector<std::vector<std::string>> expected;
+  for (const auto &sql : queries) {
+    expected.push_back(QuerySorted(bustub.get(), sql));
+  }
+  // 5000 keys plus the NULL group
+  ASSERT_EQ(expected[0].size(), 5001);
+  ASSERT_EQ(expected[2].size(), 1);
+  ASSERT_EQ(expected[3].size(), 1);
+
+  // a budget far below the groups makes every query spill partitions to temp pages, the smallest one also makes
+  // the spilled partitions split again when they are reloaded
+  auto budget = aggregation_memory_budget;
+  for (size_t small_budget : {256 << 10, 16 << 10, 2 << 10}) {
+    aggregation_memory_budget = small_budget;
+    for (size_t i = 0; i < queries.size(); i++) {
+      EXPECT_EQ(QuerySorted(bustub.get(), queries[i]), expected[i]) << queries[i] << " budget " << small_budget;
+    }
+  }
+  aggregation_memory_budget = budget;
+}
+
+}  // namespace bustub
@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression_test.cpp
+//
+// Identification: test/execution/compiled_expression_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <fmt/format.h>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/compiled_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/expressions/string_expression.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto Col(uint32_t idx, TypeId type) -> AbstractExpressionRef {
+  return std::make_shared<ColumnValueExpression>(0, idx, type);
+}
+
+auto Int(int32_t val) -> AbstractExpressionRef {
+  return std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(val));
+}
+
+auto Cmp(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ComparisonType type) -> AbstractExpressionRef {
+  return std::make_shared<ComparisonExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+auto Logic(AbstractExpressionRef lhs, AbstractExpressionRef rhs, LogicType type) -> AbstractExpressionRef {
+  return std::make_shared<LogicExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+auto Arith(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ArithmeticType type) -> AbstractExpressionRef {
+  return std::make_shared<ArithmeticExpression>(std::move(lhs), std::move(rhs), type);
+}
+
+// a int, b bigint, c boolean, d varchar, e smallint
+auto MakeSchema() -> Schema {
+  return Schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::BIGINT},
+                                    Column{"c", TypeId::BOOLEAN}, Column{"d", TypeId::VARCHAR, 16},
+                                    Column{"e", TypeId::SMALLINT}}};
+}
+
+auto MakeTuples(const Schema &schema, size_t count) -> std::vector<Tuple> {
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int32_t> dist(-20, 20);
+  auto maybe_null = [&](const Value &val, TypeId type) {
+    return gen() % 8 == 0 ? ValueFactory::GetNullValueByType(type) : val;
+  };
+  std::vector<Tuple> tuples;
+  for (size_t i = 0; i < count; i++) {
+    std::vector<Value> values{
+        maybe_null(ValueFactory::GetIntegerValue(dist(gen)), TypeId::INTEGER),
+        maybe_null(ValueFactory::GetBigIntValue(dist(gen)), TypeId::BIGINT),
+        maybe_null(ValueFactory::GetBooleanValue(dist(gen) > 0), TypeId::BOOLEAN),
+        ValueFactory::GetVarcharValue("bustub"),
+        maybe_null(ValueFactory::GetSmallIntValue(static_cast<int16_t>(dist(gen))), TypeId::SMALLINT),
+    };
+    tuples.emplace_back(values, &schema);
+  }
+  return tuples;
+}
+
+auto SameValue(const Value &lhs, const Value &rhs) -> bool {
+  if (lhs.IsNull() || rhs.IsNull()) {
+    return lhs.IsNull() && rhs.IsNull();
+  }
+  return lhs.CompareEquals(rhs) == CmpBool::CmpTrue;
+}
+
+}  // namespace
+
+TEST(CompiledExpressionTest, MatchesInterpreterTest) {
+  auto schema = MakeSchema();
+  auto tuples = MakeTuples(schema, 2000);
+
+  auto a = Col(0, TypeId::INTEGER);
+  auto b = Col(1, TypeId::BIGINT);
+  auto c = Col(2, TypeId::BOOLEAN);
+  auto e = Col(4, TypeId::SMALLINT);
+  std::vector<AbstractExpressionRef> exprs{
+      a,
+      Cmp(a, Int(5), ComparisonType::GreaterThan),
+      Logic(Cmp(a, Int(5), ComparisonType::GreaterThan), Cmp(b, Int(10), ComparisonType::LessThan), LogicType::And),
+      Logic(Cmp(a, b, ComparisonType::LessThanOrEqual), c, LogicType::Or),
+      Logic(c, Cmp(e, Int(0), ComparisonType::NotEqual), LogicType::And),
+      Cmp(Arith(a, Int(3), ArithmeticType::Plus), Arith(Int(7), a, ArithmeticType::Minus), ComparisonType::Equal),
+      Arith(Arith(a, a, ArithmeticType::Plus), Int(1), ArithmeticType::Minus),
+      Cmp(b, e, ComparisonType::GreaterThanOrEqual),
+      Cmp(a, std::make_shared<ConstantValueExpression>(ValueFactory::GetNullValueByType(TypeId::INTEGER)),
+          ComparisonType::Equal),
+  };
+
+  for (const auto &expr : exprs) {
+    auto compiled = CompiledExpression::Compile(*expr, schema);
+    ASSERT_NE(compiled, nullptr) << expr->ToString();
+    ASSERT_EQ(compiled->GetReturnType(), expr->GetReturnType());
+
+    TupleBatch batch(&schema);
+    std::vector<uint32_t> expected_sel;
+    for (const auto &tuple : tuples) {
+      auto expected = expr->Evaluate(&tuple, schema);
+      ASSERT_TRUE(SameValue(compiled->Evaluate(tuple), expected)) << expr->ToString();
+      if (expr->GetReturnType() != TypeId::BOOLEAN) {
+        continue;
+      }
+      bool holds = !expected.IsNull() && expected.GetAs<bool>();
+      ASSERT_EQ(compiled->EvaluatePredicate(tuple), holds) << expr->ToString();
+
+      if (batch.IsFull()) {
+        compiled->Select(&batch);
+        ASSERT_EQ(batch.GetSelection(), expected_sel) << expr->ToString();
+        batch.Reset(&schema);
+        expected_sel.clear();
+      }
+      if (holds) {
+        expected_sel.push_back(batch.NumRows());
+      }
+      batch.AppendTuple(tuple, RID{});
+    }
+    if (expr->GetReturnType() == TypeId::BOOLEAN) {
+      compiled->Select(&batch);
+      ASSERT_EQ(batch.GetSelection(), expected_sel) << expr->ToString();
+    }
+  }
+}
+
+TEST(CompiledExpressionTest, UnsupportedExpressionTest) {
+  auto schema = MakeSchema();
+  auto d = Col(3, TypeId::VARCHAR);
+  auto varchar = std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue("bustub"));
+
+  // varchar columns and string functions are left to the interpreter
+  EXPECT_EQ(CompiledExpression::Compile(*Cmp(d, varchar, ComparisonType::Equal), schema), nullptr);
+  EXPECT_EQ(CompiledExpression::Compile(*std::make_shared<StringExpression>(d, StringExpressionType::Upper), schema),
+            nullptr);
+  auto partly = Logic(Cmp(Col(0, TypeId::INTEGER), Int(1), ComparisonType::Equal),
+                      Cmp(d, varchar, ComparisonType::Equal), LogicType::And);
+  EXPECT_EQ(CompiledExpression::Compile(*partly, schema), nullptr);
+
+  // a left-deep chain of additions needs one register, a right-deep one needs a register per level
+  AbstractExpressionRef left_deep = Int(0);
+  AbstractExpressionRef right_deep = Int(0);
+  for (int i = 1; i <= 40; i++) {
+    left_deep = Arith(left_deep, Int(i), ArithmeticType::Plus);
+    right_deep = Arith(Int(i), right_deep, ArithmeticType::Plus);
+  }
+  auto compiled = CompiledExpression::Compile(*left_deep, schema);
+  ASSERT_NE(compiled, nullptr);
+  auto tuples = MakeTuples(schema, 1);
+  EXPECT_EQ(compiled->Evaluate(tuples[0]).GetAs<int32_t>(), 820);
+  EXPECT_EQ(CompiledExpression::Compile(*right_deep, schema), nullptr);
+}
+
+// Prints timings, so it only runs on request with --gtest_also_run_disabled_tests
+TEST(CompiledExpressionTest, DISABLED_FilterBenchmark) {
+  auto schema = MakeSchema();
+  auto tuples = MakeTuples(schema, 100000);
+  auto a = Col(0, TypeId::INTEGER);
+  auto b = Col(1, TypeId::BIGINT);
+  auto pred = Logic(Cmp(a, Int(5), ComparisonType::GreaterThan), Cmp(b, Int(10), ComparisonType::LessThan),
+                    LogicType::And);
+  auto compiled = CompiledExpression::Compile(*pred, schema);
+  ASSERT_NE(compiled, nullptr);
+
+  auto start = std::chrono::steady_clock::now();
+  size_t interpreted_hits = 0;
+  for (const auto &tuple : tuples) {
+    auto val = pred->Evaluate(&tuple, schema);
+    interpreted_hits += static_cast<size_t>(!val.IsNull() && val.GetAs<bool>());
+  }
+  auto interpreted = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  size_t compiled_hits = 0;
+  for (const auto &tuple : tuples) {
+    compiled_hits += static_cast<size_t>(compiled->EvaluatePredicate(tuple));
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(interpreted_hits, compiled_hits);
+  std::cout << fmt::format("a > 5 AND b < 10 over {} tuples: interpreted {}us, compiled {}us", tuples.size(),
+                           std::chrono::duration_cast<std::chrono::microseconds>(interpreted).count(),
+                           std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())
+            << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort_test.cpp
+//
+// Identification: test/execution/external_sort_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/bustub_instance.h"
+#include "common/config.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/external_sort.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+// a int, b varchar, c int holding the input position
+auto MakeSchema() -> Schema {
+  return Schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 16},
+                                    Column{"c", TypeId::INTEGER}}};
+}
+
+auto MakeRows(size_t count) -> std::vector<std::vector<Value>> {
+  std::mt19937 gen(15445);
+  std::vector<std::vector<Value>> rows;
+  for (size_t i = 0; i < count; i++) {
+    auto a = gen() % 10 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                             : ValueFactory::GetIntegerValue(static_cast<int32_t>(gen() % 200) - 100);
+    auto b = ValueFactory::GetVarcharValue(fmt::format("key-{}", gen() % 30));
+    rows.push_back({a, b, ValueFactory::GetIntegerValue(static_cast<int32_t>(i))});
+  }
+  return rows;
+}
+
+/** Sorts rows the slow way, NULL smaller than every value, ties kept in input order */
+auto ReferenceSort(std::vector<std::vector<Value>> rows,
+                   const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys)
+    -> std::vector<std::vector<Value>> {
+  auto less = [&](const std::vector<Value> &lhs, const std::vector<Value> &rhs) {
+    for (const auto &[type, expr] : order_bys) {
+      auto idx = dynamic_cast<const ColumnValueExpression &>(*expr).GetColIdx();
+      const auto &l = lhs[idx];
+      const auto &r = rhs[idx];
+      if (l.IsNull() || r.IsNull()) {
+        // NULLs come first under ASC and last under DESC
+        if (l.IsNull() == r.IsNull()) {
+          continue;
+        }
+        return type == OrderByType::DESC ? r.IsNull() : l.IsNull();
+      }
+      if (l.CompareEquals(r) == CmpBool::CmpTrue) {
+        continue;
+      }
+      bool l_first = l.CompareLessThan(r) == CmpBool::CmpTrue;
+      return type == OrderByType::DESC ? !l_first : l_first;
+    }
+    return false;
+  };
+  std::stable_sort(rows.begin(), rows.end(), less);
+  return rows;
+}
+
+void CheckSort(size_t num_rows, size_t memory_budget, size_t num_workers, bool expect_spill) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto schema = MakeSchema();
+  auto rows = MakeRows(num_rows);
+  // the second ordering puts the nullable column first, so its NULLs go through the key prefix under DESC
+  std::vector<std::vector<std::pair<OrderByType, AbstractExpressionRef>>> orderings{
+      {{OrderByType::DESC, std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR)},
+       {OrderByType::ASC, std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER)}},
+      {{OrderByType::DESC, std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER)},
+       {OrderByType::ASC, std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR)}},
+  };
+
+  for (const auto &order_bys : orderings) {
+    ExternalSorter sorter(bpm.get(), &schema, order_bys, memory_budget, num_workers);
+    for (const auto &row : rows) {
+      std::vector<Value> keys;
+      for (const auto &[type, expr] : order_bys) {
+        keys.push_back(row[dynamic_cast<const ColumnValueExpression &>(*expr).GetColIdx()]);
+      }
+      sorter.Add(keys, row);
+    }
+    sorter.Finish();
+    EXPECT_EQ(sorter.NumSpilledRuns() > 0, expect_spill);
+
+    // the input position in column c makes the comparison check stability as well
+    auto expected = ReferenceSort(rows, order_bys);
+    std::vector<Value> row;
+    for (const auto &expected_row : expected) {
+      ASSERT_TRUE(sorter.Next(&row));
+      ASSERT_EQ(row[2].GetAs<int32_t>(), expected_row[2].GetAs<int32_t>());
+    }
+    EXPECT_FALSE(sorter.Next(&row));
+  }
+}
+
+}  // namespace
+
+TEST(ExternalSortTest, InMemorySortTest) {
+  CheckSort(0, 1 << 20, 1, false);
+  CheckSort(1, 1 << 20, 1, false);
+  CheckSort(5000, 16 << 20, 4, false);
+}
+
+TEST(ExternalSortTest, SpilledSortTest) {
+  // a few runs merged in one pass
+  CheckSort(5000, 256 << 10, 1, true);
+  // many small runs from parallel run generation, merged in several passes of fan-in 2
+  CheckSort(5000, 16 << 10, 4, true);
+}
+
+TEST(ExternalSortTest, NullOrderTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto schema = Schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto null = ValueFactory::GetNullValueByType(TypeId::INTEGER);
+  std::vector<Value> input{ValueFactory::GetIntegerValue(2), null, ValueFactory::GetIntegerValue(1), null,
+                           ValueFactory::GetIntegerValue(3)};
+
+  // NULLs come first under ASC and last under DESC, both for the key prefix and for a second key
+  for (size_t key_pos = 0; key_pos < 2; key_pos++) {
+    for (auto type : {OrderByType::ASC, OrderByType::DESC}) {
+      std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys{
+          {OrderByType::ASC, std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(0))}};
+      order_bys.insert(order_bys.begin() + key_pos,
+                       {type, std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER)});
+      ExternalSorter sorter(bpm.get(), &schema, order_bys, 1 << 20, 1);
+      for (const auto &val : input) {
+        std::vector<Value> keys{ValueFactory::GetIntegerValue(0)};
+        keys.insert(keys.begin() + key_pos, val);
+        sorter.Add(keys, {val});
+      }
+      sorter.Finish();
+
+      std::vector<std::string> output;
+      std::vector<Value> row;
+      while (sorter.Next(&row)) {
+        output.push_back(row[0].IsNull() ? "NULL" : row[0].ToString());
+      }
+      auto expected = type == OrderByType::ASC ? std::vector<std::string>{"NULL", "NULL", "1", "2", "3"}
+                                               : std::vector<std::string>{"3", "2", "1", "NULL", "NULL"};
+      EXPECT_EQ(output, expected);
+    }
+  }
+}
+
+TEST(ExternalSortTest, OrderByLargerThanBufferPool) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter noop;
+  bustub->ExecuteSql("CREATE TABLE t (k INT, payload VARCHAR(64));", noop);
+  // about 1MB of tuples, more than the 128 frames of the instance's buffer pool
+  const int num_rows = 12000;
+  for (int begin = 0; begin < num_rows; begin += 500) {
+    std::string sql = "INSERT INTO t VALUES ";
+    for (int i = begin; i < begin + 500; i++) {
+      sql += fmt::format("{}({}, 'payload-{:040}')", i == begin ? "" : ", ", (i * 7919) % num_rows, i);
+    }
+    ASSERT_TRUE(bustub->ExecuteSql(sql + ";", noop));
+  }
+
+  auto budget = sort_memory_budget;
+  sort_memory_budget = 64 << 10;
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql("SELECT k FROM t ORDER BY k DESC;", writer);
+  sort_memory_budget = budget;
+
+  int expected = num_rows - 1;
+  for (std::string line; std::getline(ss, line); expected--) {
+    ASSERT_EQ(std::stoi(line), expected);
+  }
+  EXPECT_EQ(expected, -1);
+}
+
+}  // namespace bustub
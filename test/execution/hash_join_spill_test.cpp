@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_spill_test.cpp
+//
+// Identification: test/execution/hash_join_spill_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/config.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+void InsertRows(BustubInstance *bustub, const std::string &table, size_t count,
+                const std::function<std::string(size_t)> &make_row) {
+  NoopWriter writer;
+  for (size_t begin = 0; begin < count; begin += 500) {
+    std::string sql = fmt::format("INSERT INTO {} VALUES ", table);
+    for (size_t i = begin; i < std::min(count, begin + 500); i++) {
+      sql += (i == begin ? "" : ", ") + make_row(i);
+    }
+    ASSERT_TRUE(bustub->ExecuteSql(sql + ";", writer));
+  }
+}
+
+auto QuerySorted(BustubInstance *bustub, const std::string &sql) -> std::vector<std::string> {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(ss, line);) {
+    lines.push_back(line);
+  }
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+}  // namespace
+
+TEST(HashJoinSpillTest, SpilledJoinMatchesInMemoryJoin) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  bustub->ExecuteSql("CREATE TABLE probe (a INT, b INT);", writer);
+  bustub->ExecuteSql("CREATE TABLE build (a INT, c VARCHAR(32));", writer);
+  bustub->ExecuteSql("CREATE TABLE skew (a INT, d INT);", writer);
+
+  // keys of probe rows are spread over 0..2999 with some NULLs, build rows only cover the even keys
+  InsertRows(bustub.get(), "probe", 3000, [](size_t i) {
+    return i % 97 == 0 ? fmt::format("(NULL, {})", i) : fmt::format("({}, {})", (i * 7) % 3000, i);
+  });
+  InsertRows(bustub.get(), "build", 6000,
+             [](size_t i) { return fmt::format("({}, 'build-row-{}')", (i * 2) % 3000, i); });
+  // every row of skew has the same key, repartitioning cannot split it
+  InsertRows(bustub.get(), "skew", 2000, [](size_t i) { return fmt::format("(14, {})", i); });
+
+  const std::vector<std::string> queries{
+      "SELECT * FROM probe INNER JOIN build ON probe.a = build.a;",
+      "SELECT * FROM probe LEFT OUTER JOIN build ON probe.a = build.a;",
+      "SELECT * FROM probe INNER JOIN skew ON probe.a = skew.a;",
+      "SELECT * FROM probe LEFT OUTER JOIN skew ON probe.a = skew.a;",
+  };
+
+  std::vector<std::vector<std::string>> expected;
+  for (const auto &sql : queries) {
+    expected.push_back(QuerySorted(bustub.get(), sql));
+  }
+  ASSERT_FALSE(expected[0].empty());
+  ASSERT_EQ(expected[3].size(), 3000 + 2000 - 1);
+
+  // a budget far below the build sides makes the joins spill, recurse and fall back to chunks
+  auto budget = hash_join_memory_budget;
+  for (size_t small_budget : {64 << 10, 8 << 10}) {
+    hash_join_memory_budget = small_budget;
+    for (size_t i = 0; i < queries.size(); i++) {
+      EXPECT_EQ(QuerySorted(bustub.get(), queries[i]), expected[i]) << queries[i] << " budget " << small_budget;
+    }
+  }
+  hash_join_memory_budget = budget;
+}
+
+}  // namespace bustub
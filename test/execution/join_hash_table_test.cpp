@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table_test.cpp
+//
+// Identification: test/execution/join_hash_table_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "execution/join_hash_table.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeKey(int32_t key) -> HashJoinKey { return HashJoinKey{{ValueFactory::GetIntegerValue(key)}}; }
+
+auto ProbeAll(const JoinHashTable &jht, int32_t key) -> std::vector<int32_t> {
+  std::vector<int32_t> matches;
+  jht.Probe(MakeKey(key), [&](const std::vector<Value> &row) { matches.push_back(row[0].GetAs<int32_t>()); });
+  return matches;
+}
+
+}  // namespace
+
+TEST(JoinHashTableTest, SmallTableTest) {
+  JoinHashTable jht(4);
+  EXPECT_TRUE(ProbeAll(jht, 1).empty());
+  EXPECT_EQ(jht.Size(), 0);
+
+  std::vector<HashJoinKey> keys{MakeKey(1), MakeKey(2), MakeKey(1),
+                                HashJoinKey{{ValueFactory::GetNullValueByType(TypeId::INTEGER)}}, MakeKey(3)};
+  std::vector<std::vector<Value>> rows;
+  for (int32_t i = 0; i < static_cast<int32_t>(keys.size()); i++) {
+    rows.push_back({ValueFactory::GetIntegerValue(i)});
+  }
+  jht.Build(keys, rows);
+
+  // the NULL key is dropped, duplicate keys come back in build order
+  EXPECT_EQ(jht.Size(), 4);
+  EXPECT_EQ(jht.NumPartitions(), 1);
+  EXPECT_EQ(ProbeAll(jht, 1), (std::vector<int32_t>{0, 2}));
+  EXPECT_EQ(ProbeAll(jht, 2), (std::vector<int32_t>{1}));
+  EXPECT_EQ(ProbeAll(jht, 3), (std::vector<int32_t>{4}));
+  EXPECT_TRUE(ProbeAll(jht, 4).empty());
+}
+
+TEST(JoinHashTableTest, PartitionedBuildTest) {
+  const int32_t num_rows = 100000;
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int32_t> dist(0, num_rows / 4);
+
+  std::vector<HashJoinKey> keys;
+  std::vector<std::vector<Value>> rows;
+  std::map<int32_t, std::vector<int32_t>> expected;
+  for (int32_t i = 0; i < num_rows; i++) {
+    auto key = dist(gen);
+    keys.push_back(MakeKey(key));
+    rows.push_back({ValueFactory::GetIntegerValue(i)});
+    expected[key].push_back(i);
+  }
+
+  JoinHashTable jht(4);
+  jht.Build(keys, rows);
+  EXPECT_EQ(jht.Size(), num_rows);
+  EXPECT_GT(jht.NumPartitions(), 1);
+
+  for (int32_t key = -10; key <= num_rows / 4 + 10; key++) {
+    auto iter = expected.find(key);
+    auto matches = ProbeAll(jht, key);
+    if (iter == expected.end()) {
+      ASSERT_TRUE(matches.empty()) << key;
+    } else {
+      ASSERT_EQ(matches, iter->second) << key;
+    }
+  }
+
+  // rebuilding replaces the previous content
+  jht.Build({MakeKey(7)}, {{ValueFactory::GetIntegerValue(-1)}});
+  EXPECT_EQ(jht.Size(), 1);
+  EXPECT_EQ(ProbeAll(jht, 7), (std::vector<int32_t>{-1}));
+  EXPECT_TRUE(ProbeAll(jht, 8).empty());
+}
+
+}  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// result_streaming_test.cpp
+//
+// Identification: test/execution/result_streaming_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Records the calls it gets, and can stop the query like a client that went away after some rows */
+class RecordingWriter : public NoopWriter {
+ public:
+  explicit RecordingWriter(int stop_after_rows = -1) : stop_after_rows_(stop_after_rows) {}
+  void WriteCell(const std::string &cell) override { cells_.push_back(cell); }
+  void BeginTable(bool simplified_output) override { tables_begun_++; }
+  void EndTable() override { tables_ended_++; }
+  void EndRow() override {
+    if (++rows_ == stop_after_rows_) {
+      throw std::runtime_error("client went away");
+    }
+  }
+
+  int stop_after_rows_;
+  int rows_{0};
+  int tables_begun_{0};
+  int tables_ended_{0};
+  std::vector<std::string> cells_;
+};
+
+}  // namespace
+
+TEST(ResultStreamingTest, StreamsRowsToWriterTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter noop;
+  bustub->ExecuteSql("CREATE TABLE t (a INT, b VARCHAR(16));", noop);
+  // several batches worth of rows
+  const int num_rows = 3000;
+  for (int begin = 0; begin < num_rows; begin += 500) {
+    std::string sql = "INSERT INTO t VALUES ";
+    for (int i = begin; i < begin + 500; i++) {
+      sql += fmt::format("{}({}, 'row-{}')", i == begin ? "" : ", ", i, i);
+    }
+    ASSERT_TRUE(bustub->ExecuteSql(sql + ";", noop));
+  }
+
+  RecordingWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("SELECT a, b FROM t WHERE a >= 100;", writer));
+  ASSERT_EQ(writer.rows_, num_rows - 100);
+  ASSERT_EQ(writer.cells_.size(), 2 * (num_rows - 100));
+  for (int i = 0; i < num_rows - 100; i++) {
+    ASSERT_EQ(writer.cells_[2 * i], std::to_string(i + 100));
+    ASSERT_EQ(writer.cells_[2 * i + 1], fmt::format("row-{}", i + 100));
+  }
+  EXPECT_EQ(writer.tables_begun_, 1);
+  EXPECT_EQ(writer.tables_ended_, 1);
+
+  // a writer that fails stops the query, the table it was given is still closed
+  RecordingWriter failing(10);
+  EXPECT_THROW(bustub->ExecuteSql("SELECT a, b FROM t;", failing), std::runtime_error);
+  EXPECT_EQ(failing.rows_, 10);
+  EXPECT_EQ(failing.tables_begun_, 1);
+  EXPECT_EQ(failing.tables_ended_, 1);
+
+  // the instance keeps working afterwards
+  RecordingWriter count;
+  ASSERT_TRUE(bustub->ExecuteSql("SELECT count(*) FROM t;", count));
+  ASSERT_EQ(count.cells_, std::vector<std::string>{std::to_string(num_rows)});
+}
+
+}  // namespace bustub
@@ -0,0 +1,260 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// cost_model_test.cpp
+//
+// Identification: test/optimizer/cost_model_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/table_statistics.h"
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/cost_model.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+/** @return the result rows of a query in sorted order, joins do not keep any order */
+auto SortedQuery(BustubInstance *bustub, const std::string &sql) -> std::vector<std::string> {
+  auto rows = StringUtil::Split(Query(bustub, sql), '\n');
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+/** @return the optimized plan of a query */
+auto OptimizedPlan(BustubInstance *bustub, const std::string &sql) -> std::string {
+  auto output = Query(bustub, "EXPLAIN " + sql);
+  auto pos = output.find("=== OPTIMIZER ===");
+  EXPECT_NE(pos, std::string::npos);
+  return output.substr(pos);
+}
+
+void InsertRows(BustubInstance *bustub, const std::string &table, int count,
+                const std::function<std::string(int)> &row) {
+  NoopWriter writer;
+  std::string values;
+  for (int i = 0; i < count; i++) {
+    values += fmt::format("{}({})", i == 0 ? "" : ", ", row(i));
+  }
+  ASSERT_TRUE(bustub->ExecuteSql(fmt::format("INSERT INTO {} VALUES {};", table, values), writer));
+}
+
+}  // namespace
+
+TEST(CostModelTest, HyperLogLogTest) {
+  HyperLogLog small;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 20; i++) {
+      auto value = ValueFactory::GetIntegerValue(i);
+      small.AddHash(HyperLogLog::HashOf(value));
+    }
+  }
+  EXPECT_NEAR(small.Estimate(), 20, 1);
+
+  // the standard error with 4096 registers is about 1.6%
+  HyperLogLog large;
+  for (int i = 0; i < 200000; i++) {
+    auto value = ValueFactory::GetIntegerValue(i % 50000);
+    large.AddHash(HyperLogLog::HashOf(value));
+  }
+  EXPECT_NEAR(large.Estimate(), 50000, 2500);
+
+  HyperLogLog strings;
+  for (int i = 0; i < 10000; i++) {
+    auto value = ValueFactory::GetVarcharValue(fmt::format("key {}", i));
+    strings.AddHash(HyperLogLog::HashOf(value));
+  }
+  EXPECT_NEAR(strings.Estimate(), 10000, 500);
+}
+
+TEST(CostModelTest, CollectStatisticsTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER},
+                                    Column{"c", TypeId::VARCHAR, 16}}};
+  TableHeap table(bpm.get());
+  // a is unique and skewed towards small values, b has 10 values, every fourth c is NULL
+  for (int i = 0; i < 40000; i++) {
+    auto a = i < 30000 ? i / 30 : i;
+    auto c = i % 4 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                        : ValueFactory::GetVarcharValue(fmt::format("c{}", i % 100));
+    Tuple tuple{{ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(i % 10), c}, &schema};
+    table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, i % 40 == 39}, tuple);
+  }
+
+  auto stats = TableStatistics::Collect(&table, schema);
+  ASSERT_EQ(stats.row_count_, 39000);
+  ASSERT_EQ(stats.columns_.size(), 3);
+  const auto &a = stats.columns_[0];
+  const auto &b = stats.columns_[1];
+  const auto &c = stats.columns_[2];
+  EXPECT_EQ(a.null_count_, 0);
+  EXPECT_EQ(c.null_count_, 10000);
+  EXPECT_NEAR(a.distinct_count_, 10750, 600);
+  EXPECT_NEAR(b.distinct_count_, 10, 1);
+  EXPECT_NEAR(c.distinct_count_, 75, 2);
+
+  // the equi-depth buckets follow the skew, three quarters of the rows have a < 1000
+  ASSERT_EQ(a.bounds_.size(), TableStatistics::NUM_BUCKETS + 1);
+  EXPECT_EQ(a.bounds_.front().GetAs<int32_t>(), 0);
+  EXPECT_EQ(a.bounds_.back().GetAs<int32_t>(), 39998);
+  EXPECT_NEAR(a.LessFraction(ValueFactory::GetIntegerValue(1000), false), 0.75, 0.03);
+  EXPECT_NEAR(a.LessFraction(ValueFactory::GetIntegerValue(500), false), 0.375, 0.03);
+  EXPECT_NEAR(a.LessFraction(ValueFactory::GetIntegerValue(35000), true), 0.875, 0.03);
+  EXPECT_EQ(a.LessFraction(ValueFactory::GetIntegerValue(-1), true), 0);
+  EXPECT_EQ(a.LessFraction(ValueFactory::GetIntegerValue(40000), false), 1);
+  EXPECT_NEAR(b.EqualFraction(ValueFactory::GetIntegerValue(3)), 0.1, 1e-9);
+  EXPECT_EQ(b.EqualFraction(ValueFactory::GetIntegerValue(10)), 0);
+  EXPECT_NEAR(b.LessFraction(ValueFactory::GetIntegerValue(5), false), 0.5, 0.1);
+}
+
+TEST(CostModelTest, AnalyzeStatementTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (a INT, b VARCHAR(16));", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE u (a INT);", writer));
+  InsertRows(bustub.get(), "t", 300, [](int i) { return fmt::format("{}, 'b{}'", i % 50, i % 7); });
+  InsertRows(bustub.get(), "u", 5, [](int i) { return fmt::format("{}", i); });
+
+  auto *catalog = bustub->catalog_;
+  auto t_oid = catalog->GetTable("t")->oid_;
+  auto u_oid = catalog->GetTable("u")->oid_;
+  EXPECT_EQ(catalog->GetTableStatistics(t_oid), nullptr);
+  EXPECT_EQ(Query(bustub.get(), "ANALYZE t;"), "300 \n");
+  auto stats = catalog->GetTableStatistics(t_oid);
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(stats->row_count_, 300);
+  EXPECT_NEAR(stats->columns_[0].distinct_count_, 50, 1);
+  EXPECT_NEAR(stats->columns_[1].distinct_count_, 7, 1);
+  EXPECT_EQ(catalog->GetTableStatistics(u_oid), nullptr);
+
+  // ANALYZE without a table analyzes every table, VACUUM ANALYZE reports the reclaimed tuples instead
+  EXPECT_EQ(Query(bustub.get(), "ANALYZE;"), "305 \n");
+  ASSERT_NE(catalog->GetTableStatistics(u_oid), nullptr);
+  InsertRows(bustub.get(), "u", 5, [](int i) { return fmt::format("{}", i + 5); });
+  EXPECT_EQ(Query(bustub.get(), "VACUUM ANALYZE u;"), "0 \n");
+  EXPECT_EQ(catalog->GetTableStatistics(u_oid)->row_count_, 10);
+
+  EXPECT_THROW(bustub->ExecuteSql("ANALYZE missing;", writer), Exception);
+  EXPECT_THROW(bustub->ExecuteSql("ANALYZE t (a);", writer), Exception);
+}
+
+TEST(CostModelTest, PlanChoiceTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE small (x INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE big (y INT, z INT);", writer));
+  InsertRows(bustub.get(), "small", 10, [](int i) { return fmt::format("{}", i); });
+  InsertRows(bustub.get(), "big", 1000, [](int i) { return fmt::format("{}, {}", i % 100, i); });
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE INDEX big_z ON big (z);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE INDEX small_x ON small (x);", writer));
+
+  const std::string wide_range = "SELECT z FROM big WHERE z < 900";
+  const std::string narrow_range = "SELECT z FROM big WHERE z < 10";
+  const std::string build_side = "SELECT * FROM small, big WHERE small.x = big.y";
+  const std::string probe_big = "SELECT * FROM big, small WHERE big.y = small.x";
+  std::vector<std::vector<std::string>> expected;
+  for (const auto &sql : {wide_range, narrow_range, build_side, probe_big}) {
+    expected.push_back(SortedQuery(bustub.get(), sql));
+  }
+
+  // without statistics the rules alone decide: every range on an indexed column is an index scan, every join
+  // with an index on the right table is an index join and a hash join builds on the right input
+  EXPECT_NE(OptimizedPlan(bustub.get(), wide_range).find("IndexScan"), std::string::npos);
+  EXPECT_NE(OptimizedPlan(bustub.get(), probe_big).find("NestedIndexJoin"), std::string::npos);
+  auto plan = OptimizedPlan(bustub.get(), build_side);
+  EXPECT_LT(plan.find("table=small"), plan.find("table=big"));
+
+  ASSERT_EQ(Query(bustub.get(), "ANALYZE;"), "1010 \n");
+
+  // most of the table is cheaper to read with a sequential scan, a few rows through the index
+  plan = OptimizedPlan(bustub.get(), wide_range);
+  EXPECT_EQ(plan.find("IndexScan"), std::string::npos) << plan;
+  EXPECT_NE(plan.find("SeqScan"), std::string::npos) << plan;
+  EXPECT_NE(OptimizedPlan(bustub.get(), narrow_range).find("IndexScan"), std::string::npos);
+
+  // the hash table is built on the small table, the projection keeps the column order of the query
+  plan = OptimizedPlan(bustub.get(), build_side);
+  EXPECT_NE(plan.find("HashJoin"), std::string::npos) << plan;
+  EXPECT_LT(plan.find("table=big"), plan.find("table=small")) << plan;
+
+  // probing the small table's index once per row of the big table costs more than hashing the small table
+  plan = OptimizedPlan(bustub.get(), probe_big);
+  EXPECT_EQ(plan.find("NestedIndexJoin"), std::string::npos) << plan;
+  EXPECT_NE(plan.find("HashJoin"), std::string::npos) << plan;
+
+  // the plans chosen with statistics return the same rows
+  size_t i = 0;
+  for (const auto &sql : {wide_range, narrow_range, build_side, probe_big}) {
+    EXPECT_EQ(SortedQuery(bustub.get(), sql), expected[i++]) << sql;
+  }
+
+  // a few probes into the big table's index are cheaper than a hash join
+  const std::string probe_small = "SELECT * FROM small, big WHERE small.x = big.z";
+  plan = OptimizedPlan(bustub.get(), probe_small);
+  EXPECT_NE(plan.find("NestedIndexJoin"), std::string::npos) << plan;
+  EXPECT_EQ(SortedQuery(bustub.get(), probe_small).size(), 10);
+}
+
+TEST(CostModelTest, DeepJoinTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (x INT);", writer));
+  InsertRows(bustub.get(), "t", 100, [](int i) { return fmt::format("{}", i % 10); });
+  ASSERT_EQ(Query(bustub.get(), "ANALYZE;"), "100 \n");
+  const auto *table_info = bustub->catalog_->GetTable("t");
+
+  // a left-deep chain of 40 joins, every level estimates the distinct values of its children again
+  std::vector<Column> columns{Column("t.x", TypeId::INTEGER)};
+  auto scan_schema = std::make_shared<Schema>(columns);
+  AbstractPlanNodeRef plan = std::make_shared<SeqScanPlanNode>(scan_schema, table_info->oid_, "t");
+  for (int i = 0; i < 40; i++) {
+    columns.emplace_back(fmt::format("t{}.x", i), TypeId::INTEGER);
+    auto predicate =
+        std::make_shared<ComparisonExpression>(std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER),
+                                               std::make_shared<ColumnValueExpression>(1, 0, TypeId::INTEGER),
+                                               ComparisonType::Equal);
+    plan = std::make_shared<NestedLoopJoinPlanNode>(
+        std::make_shared<Schema>(columns), plan,
+        std::make_shared<SeqScanPlanNode>(scan_schema, table_info->oid_, "t"), predicate, JoinType::INNER);
+  }
+  CostModel cost_model(*bustub->catalog_);
+  EXPECT_GT(cost_model.EstimateCost(plan), 0);
+  // every join matches a row with the 10 rows sharing its value
+  EXPECT_NEAR(cost_model.EstimateCardinality(plan) / std::pow(10.0, 42), 1.0, 1e-9);
+
+  // a constant predicate that is not a boolean gets the default selectivity
+  auto constant = std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(1));
+  EXPECT_DOUBLE_EQ(cost_model.EstimateSelectivity(constant, {}), CostModel::DEFAULT_SELECTIVITY);
+}
+
+}  // namespace bustub
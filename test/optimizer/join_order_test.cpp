@@ -0,0 +1,174 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_order_test.cpp
+//
+// Identification: test/optimizer/join_order_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binder/binder.h"
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "execution/plans/hash_join_plan.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "planner/planner.h"
+
+namespace bustub {
+
+namespace {
+
+auto SortedQuery(BustubInstance *bustub, const std::string &sql) -> std::vector<std::string> {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  auto rows = StringUtil::Split(ss.str(), '\n');
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+/** @return the plan the instance would execute for a query */
+auto OptimizedPlan(BustubInstance *bustub, const std::string &sql) -> AbstractPlanNodeRef {
+  Binder binder(*bustub->catalog_);
+  binder.ParseAndSave(sql);
+  Planner planner(*bustub->catalog_);
+  planner.PlanQuery(*binder.BindStatement(binder.statement_nodes_.at(0)));
+  Optimizer optimizer(*bustub->catalog_, false);
+  return optimizer.Optimize(planner.plan_);
+}
+
+/** Call fn with every node of a plan */
+void VisitPlan(const AbstractPlanNodeRef &plan, const std::function<void(const AbstractPlanNodeRef &)> &fn) {
+  fn(plan);
+  for (const auto &child : plan->GetChildren()) {
+    VisitPlan(child, fn);
+  }
+}
+
+void InsertRows(BustubInstance *bustub, const std::string &table, int count,
+                const std::function<std::string(int)> &row) {
+  NoopWriter writer;
+  std::string values;
+  for (int i = 0; i < count; i++) {
+    values += fmt::format("{}({})", i == 0 ? "" : ", ", row(i));
+  }
+  ASSERT_TRUE(bustub->ExecuteSql(fmt::format("INSERT INTO {} VALUES {};", table, values), writer));
+}
+
+}  // namespace
+
+TEST(JoinOrderTest, StarSchemaTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE fact (id INT, a INT, b INT, c INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE da (id INT, x INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE db (id INT, y INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE dc (id INT, z INT);", writer));
+  InsertRows(bustub.get(), "fact", 3000,
+             [](int i) { return fmt::format("{}, {}, {}, {}", i, i % 30, i % 20, i % 10); });
+  InsertRows(bustub.get(), "da", 30, [](int i) { return fmt::format("{}, {}", i, i * 10); });
+  InsertRows(bustub.get(), "db", 20, [](int i) { return fmt::format("{}, {}", i, i * 100); });
+  InsertRows(bustub.get(), "dc", 10, [](int i) { return fmt::format("{}, {}", i, i * 1000); });
+
+  // the fact table comes first and every join predicate is on the topmost join, as written
+  const std::string sql =
+      "SELECT fact.id, da.x, db.y, dc.z FROM fact, da, db, dc "
+      "WHERE fact.a = da.id AND fact.b = db.id AND dc.id = fact.c AND da.x < 150";
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3000; i++) {
+    if (i % 30 < 15) {
+      expected.push_back(fmt::format("{} {} {} {} ", i, i % 30 * 10, i % 20 * 100, i % 10 * 1000));
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+
+  // the sizes of the tables are unknown before ANALYZE, the joins are left in the order they are written
+  auto plan = OptimizedPlan(bustub.get(), sql);
+  auto plan_string = plan->ToString();
+  EXPECT_LT(plan_string.find("table=fact"), plan_string.find("table=da")) << plan_string;
+  EXPECT_LT(plan_string.find("table=da"), plan_string.find("table=db")) << plan_string;
+  EXPECT_LT(plan_string.find("table=db"), plan_string.find("table=dc")) << plan_string;
+
+  ASSERT_TRUE(bustub->ExecuteSql("ANALYZE;", writer));
+  plan = OptimizedPlan(bustub.get(), sql);
+  EXPECT_EQ(plan->ToString().find("NestedLoopJoin"), std::string::npos) << plan->ToString();
+  size_t hash_joins = 0;
+  VisitPlan(plan, [&](const AbstractPlanNodeRef &node) {
+    if (node->GetType() == PlanType::HashJoin) {
+      hash_joins++;
+      const auto &hash_join = dynamic_cast<const HashJoinPlanNode &>(*node);
+      EXPECT_EQ(hash_join.GetRightPlan()->ToString().find("table=fact"), std::string::npos) << plan->ToString();
+    }
+  });
+  EXPECT_EQ(hash_joins, 3);
+  EXPECT_EQ(SortedQuery(bustub.get(), sql), expected);
+}
+
+TEST(JoinOrderTest, CyclicGraphTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  // every pair of the five tables is joined, the join graph is a clique
+  std::vector<std::string> from;
+  std::vector<std::string> where;
+  for (int t = 0; t < 5; t++) {
+    ASSERT_TRUE(bustub->ExecuteSql(fmt::format("CREATE TABLE t{} (k INT);", t), writer));
+    InsertRows(bustub.get(), fmt::format("t{}", t), 20 * (5 - t), [](int i) { return fmt::format("{}", i); });
+    from.push_back(fmt::format("t{}", t));
+    for (int u = 0; u < t; u++) {
+      where.push_back(fmt::format("t{}.k = t{}.k", u, t));
+    }
+  }
+  const auto sql = fmt::format("SELECT * FROM {} WHERE {}", StringUtil::Join(from, ", "),
+                               StringUtil::Join(where, " AND "));
+  ASSERT_TRUE(bustub->ExecuteSql("ANALYZE;", writer));
+
+  auto plan = OptimizedPlan(bustub.get(), sql);
+  EXPECT_EQ(plan->ToString().find("NestedLoopJoin"), std::string::npos) << plan->ToString();
+  std::vector<std::string> expected;
+  for (int i = 0; i < 20; i++) {
+    expected.push_back(fmt::format("{0} {0} {0} {0} {0} ", i));
+  }
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(SortedQuery(bustub.get(), sql), expected);
+}
+
+TEST(JoinOrderTest, GreedyChainTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  // 14 relations are more than dynamic programming handles, a chain t0 - t1 - ... - t13 is joined greedily
+  const int tables = 14;
+  std::vector<std::string> from;
+  std::vector<std::string> where;
+  for (int t = 0; t < tables; t++) {
+    ASSERT_TRUE(bustub->ExecuteSql(fmt::format("CREATE TABLE t{} (k INT, v INT);", t), writer));
+    InsertRows(bustub.get(), fmt::format("t{}", t), 10 * (t + 1), [t](int i) { return fmt::format("{}, {}", i, t); });
+    from.push_back(fmt::format("t{}", t));
+    if (t > 0) {
+      where.push_back(fmt::format("t{}.k = t{}.k", t - 1, t));
+    }
+  }
+  const auto sql = fmt::format("SELECT t0.k, t13.v FROM {} WHERE {}", StringUtil::Join(from, ", "),
+                               StringUtil::Join(where, " AND "));
+  ASSERT_TRUE(bustub->ExecuteSql("ANALYZE;", writer));
+
+  auto plan = OptimizedPlan(bustub.get(), sql);
+  EXPECT_EQ(plan->ToString().find("NestedLoopJoin"), std::string::npos) << plan->ToString();
+  std::vector<std::string> expected;
+  for (int i = 0; i < 10; i++) {
+    expected.push_back(fmt::format("{} 13 ", i));
+  }
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(SortedQuery(bustub.get(), sql), expected);
+}
+
+}  // namespace bustub
@@ -0,0 +1,206 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// plan_cache_test.cpp
+//
+// Identification: test/optimizer/plan_cache_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binder/binder.h"
+#include "binder/statement/prepare_statement.h"
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/plan_cache.h"
+#include "planner/planner.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto SortedQuery(BustubInstance *bustub, const std::string &sql) -> std::vector<std::string> {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  auto rows = StringUtil::Split(ss.str(), '\n');
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+/** @return the plan cached for a statement run by the instance, nullptr if there is none */
+auto CachedPlanOf(BustubInstance *bustub, const std::string &sql) -> AbstractPlanNodeRef {
+  auto cached_plan = bustub->plan_cache_->Get(*PlanCache::Normalize(sql), bustub->catalog_->GetVersion());
+  return cached_plan == nullptr ? nullptr : cached_plan->plan_;
+}
+
+auto MakeCachedPlan(uint64_t catalog_version) -> std::shared_ptr<const CachedPlan> {
+  auto cached_plan = std::make_shared<CachedPlan>();
+  cached_plan->catalog_version_ = catalog_version;
+  return cached_plan;
+}
+
+class PlanCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    bustub_ = std::make_unique<BustubInstance>();
+    NoopWriter writer;
+    ASSERT_TRUE(bustub_->ExecuteSql("CREATE TABLE t (x INT, y VARCHAR(16));", writer));
+    std::string rows;
+    for (int i = 0; i < 200; i++) {
+      rows += fmt::format("{}({}, 'row {}')", i == 0 ? "" : ", ", i, i);
+    }
+    ASSERT_TRUE(bustub_->ExecuteSql(fmt::format("INSERT INTO t VALUES {};", rows), writer));
+  }
+
+  std::unique_ptr<BustubInstance> bustub_;
+};
+
+}  // namespace
+
+TEST(PlanCacheNormalizeTest, NormalizeTest) {
+  // letter case and spacing outside quotes do not matter, a trailing semicolon is dropped
+  EXPECT_EQ(PlanCache::Normalize("SELECT  x\n FROM t WHERE y = 'A  b';"), "select x from t where y = 'A  b'");
+  EXPECT_EQ(PlanCache::Normalize("select x from t where y = 'A  b'"), "select x from t where y = 'A  b'");
+  EXPECT_EQ(PlanCache::Normalize("SELECT \"X\" FROM t"), "select \"X\" from t");
+  // several statements, comments, parameters and escapes are not cached
+  EXPECT_EQ(PlanCache::Normalize("SELECT 1; SELECT 2;"), std::nullopt);
+  EXPECT_EQ(PlanCache::Normalize("SELECT 1 -- one\n, 2"), std::nullopt);
+  EXPECT_EQ(PlanCache::Normalize("SELECT $1"), std::nullopt);
+  EXPECT_EQ(PlanCache::Normalize("SELECT 'it\\'s'"), std::nullopt);
+  EXPECT_EQ(PlanCache::Normalize("SELECT 'open"), std::nullopt);
+  EXPECT_EQ(PlanCache::Normalize(" ; "), std::nullopt);
+}
+
+TEST(PlanCacheNormalizeTest, EvictionTest) {
+  PlanCache cache(2);
+  cache.Put("a", MakeCachedPlan(0));
+  cache.Put("b", MakeCachedPlan(0));
+  ASSERT_NE(cache.Get("a", 0), nullptr);
+  // b is the least recently used plan now
+  cache.Put("c", MakeCachedPlan(0));
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_NE(cache.Get("a", 0), nullptr);
+  EXPECT_EQ(cache.Get("b", 0), nullptr);
+  EXPECT_NE(cache.Get("c", 0), nullptr);
+  // a plan built at an older catalog version is dropped
+  EXPECT_EQ(cache.Get("c", 1), nullptr);
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(cache.Hits(), 3);
+}
+
+TEST_F(PlanCacheTest, RepeatedQueryTest) {
+  const std::string sql = "SELECT y FROM t WHERE x = 42";
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"row 42 "}));
+  auto hits = bustub_->plan_cache_->Hits();
+  // the same statement written differently runs with the cached plan
+  EXPECT_EQ(SortedQuery(bustub_.get(), "select y\n  from t where x = 42;"), (std::vector<std::string>{"row 42 "}));
+  EXPECT_EQ(bustub_->plan_cache_->Hits(), hits + 1);
+  // inserts are cached as well, every run inserts again
+  NoopWriter writer;
+  ASSERT_TRUE(bustub_->ExecuteSql("INSERT INTO t VALUES (42, 'again');", writer));
+  ASSERT_TRUE(bustub_->ExecuteSql("INSERT INTO t VALUES (42, 'again');", writer));
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"again ", "again ", "row 42 "}));
+}
+
+TEST_F(PlanCacheTest, InvalidationTest) {
+  const std::string sql = "SELECT y FROM t WHERE x = 7";
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"row 7 "}));
+  auto plan = CachedPlanOf(bustub_.get(), sql);
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->ToString().find("IndexScan"), std::string::npos) << plan->ToString();
+
+  // the new index makes the cached plan stale, the next run plans the statement again and uses the index
+  NoopWriter writer;
+  ASSERT_TRUE(bustub_->ExecuteSql("CREATE INDEX t_x ON t(x);", writer));
+  EXPECT_EQ(CachedPlanOf(bustub_.get(), sql), nullptr);
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"row 7 "}));
+  plan = CachedPlanOf(bustub_.get(), sql);
+  ASSERT_NE(plan, nullptr);
+  EXPECT_NE(plan->ToString().find("IndexScan"), std::string::npos) << plan->ToString();
+}
+
+TEST_F(PlanCacheTest, StarterRuleTest) {
+  const std::string sql = "SELECT y FROM t WHERE x = 11";
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"row 11 "}));
+  auto size = bustub_->plan_cache_->Size();
+  auto hits = bustub_->plan_cache_->Hits();
+
+  // the starter rules build another plan, the plan cached with the custom rules is not used for it
+  NoopWriter writer;
+  ASSERT_TRUE(bustub_->ExecuteSql("set force_optimizer_starter_rule=yes", writer));
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"row 11 "}));
+  EXPECT_EQ(bustub_->plan_cache_->Hits(), hits);
+  EXPECT_EQ(bustub_->plan_cache_->Size(), size + 1);
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"row 11 "}));
+  EXPECT_EQ(bustub_->plan_cache_->Hits(), hits + 1);
+
+  // switching back runs the plan of the custom rules again
+  ASSERT_TRUE(bustub_->ExecuteSql("set force_optimizer_starter_rule=no", writer));
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"row 11 "}));
+  EXPECT_EQ(bustub_->plan_cache_->Hits(), hits + 2);
+  EXPECT_EQ(bustub_->plan_cache_->Size(), size + 1);
+}
+
+TEST_F(PlanCacheTest, PrepareExecuteTest) {
+  NoopWriter writer;
+  ASSERT_TRUE(bustub_->ExecuteSql("PREPARE point AS SELECT y FROM t WHERE x = $1;", writer));
+  EXPECT_EQ(SortedQuery(bustub_.get(), "EXECUTE point(3);"), (std::vector<std::string>{"row 3 "}));
+  EXPECT_EQ(SortedQuery(bustub_.get(), "EXECUTE point(150);"), (std::vector<std::string>{"row 150 "}));
+  EXPECT_TRUE(SortedQuery(bustub_.get(), "EXECUTE point(1000);").empty());
+
+  // the prepared statement is planned again once the index exists and still returns the same rows
+  ASSERT_TRUE(bustub_->ExecuteSql("CREATE INDEX t_x ON t(x);", writer));
+  EXPECT_EQ(SortedQuery(bustub_.get(), "EXECUTE point(3);"), (std::vector<std::string>{"row 3 "}));
+
+  // the type of a parameter comes from the column it is inserted into, or from its declaration
+  ASSERT_TRUE(bustub_->ExecuteSql("PREPARE ins AS INSERT INTO t VALUES ($1, $2);", writer));
+  ASSERT_TRUE(bustub_->ExecuteSql("EXECUTE ins(500, 'five hundred');", writer));
+  EXPECT_EQ(SortedQuery(bustub_.get(), "EXECUTE point(500);"), (std::vector<std::string>{"five hundred "}));
+  ASSERT_TRUE(bustub_->ExecuteSql("PREPARE next (INT) AS SELECT $1 + 1;", writer));
+  EXPECT_EQ(SortedQuery(bustub_.get(), "EXECUTE next('41');"), (std::vector<std::string>{"42 "}));
+
+  EXPECT_THROW(bustub_->ExecuteSql("PREPARE untyped AS SELECT $1;", writer), Exception);
+  EXPECT_THROW(bustub_->ExecuteSql("PREPARE point AS SELECT x FROM t;", writer), Exception);
+  EXPECT_THROW(bustub_->ExecuteSql("EXECUTE point(1, 2);", writer), Exception);
+  EXPECT_THROW(bustub_->ExecuteSql("SELECT y FROM t WHERE x = $1;", writer), Exception);
+  ASSERT_TRUE(bustub_->ExecuteSql("DEALLOCATE point;", writer));
+  EXPECT_THROW(bustub_->ExecuteSql("EXECUTE point(3);", writer), Exception);
+}
+
+TEST_F(PlanCacheTest, ParameterIndexScanTest) {
+  NoopWriter writer;
+  ASSERT_TRUE(bustub_->ExecuteSql("CREATE INDEX t_x ON t(x);", writer));
+
+  // an equality with a parameter on an indexed column is answered by an index lookup in the prepared plan
+  Binder binder(*bustub_->catalog_);
+  binder.ParseAndSave("PREPARE point AS SELECT y FROM t WHERE x = $1");
+  auto statement = binder.BindStatement(binder.statement_nodes_.at(0));
+  const auto &prepare_stmt = dynamic_cast<const PrepareStatement &>(*statement);
+  Planner planner(*bustub_->catalog_);
+  planner.PlanQuery(*prepare_stmt.statement_);
+  Optimizer optimizer(*bustub_->catalog_, false);
+  auto plan = optimizer.Optimize(planner.plan_);
+  auto plan_string = plan->ToString();
+  EXPECT_NE(plan_string.find("IndexScan"), std::string::npos) << plan_string;
+  EXPECT_NE(plan_string.find("range=[$1, $1]"), std::string::npos) << plan_string;
+
+  auto types = InferParameterTypes(planner.plan_, {});
+  EXPECT_EQ(types, std::vector<TypeId>{TypeId::INTEGER});
+  auto bound_plan = BindParameters(plan, {ValueFactory::GetIntegerValue(9)});
+  EXPECT_EQ(bound_plan->ToString().find("$1"), std::string::npos) << bound_plan->ToString();
+  EXPECT_NE(bound_plan->ToString().find("range=[9, 9]"), std::string::npos) << bound_plan->ToString();
+}
+
+}  // namespace bustub
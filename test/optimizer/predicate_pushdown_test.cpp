@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// predicate_pushdown_test.cpp
+//
+// Identification: test/optimizer/predicate_pushdown_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binder/binder.h"
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "planner/planner.h"
+
+namespace bustub {
+
+namespace {
+
+auto SortedQuery(BustubInstance *bustub, const std::string &sql) -> std::vector<std::string> {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  auto rows = StringUtil::Split(ss.str(), '\n');
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+/** @return the plan the instance would execute for a query */
+auto OptimizedPlan(BustubInstance *bustub, const std::string &sql) -> AbstractPlanNodeRef {
+  Binder binder(*bustub->catalog_);
+  binder.ParseAndSave(sql);
+  Planner planner(*bustub->catalog_);
+  planner.PlanQuery(*binder.BindStatement(binder.statement_nodes_.at(0)));
+  Optimizer optimizer(*bustub->catalog_, false);
+  return optimizer.Optimize(planner.plan_);
+}
+
+/** @return the nodes of a plan of the given type, in pre-order */
+auto FindNodes(const AbstractPlanNodeRef &plan, PlanType type) -> std::vector<AbstractPlanNodeRef> {
+  std::vector<AbstractPlanNodeRef> nodes;
+  std::function<void(const AbstractPlanNodeRef &)> visit = [&](const AbstractPlanNodeRef &node) {
+    if (node->GetType() == type) {
+      nodes.push_back(node);
+    }
+    for (const auto &child : node->GetChildren()) {
+      visit(child);
+    }
+  };
+  visit(plan);
+  return nodes;
+}
+
+/** @return the scans of a plan that evaluate a filter predicate themselves, in pre-order */
+auto FilteredScans(const AbstractPlanNodeRef &plan) -> std::vector<const SeqScanPlanNode *> {
+  std::vector<const SeqScanPlanNode *> scans;
+  for (const auto &node : FindNodes(plan, PlanType::SeqScan)) {
+    const auto *scan = dynamic_cast<const SeqScanPlanNode *>(node.get());
+    if (scan->filter_predicate_ != nullptr) {
+      scans.push_back(scan);
+    }
+  }
+  return scans;
+}
+
+class PredicatePushdownTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    bustub_ = std::make_unique<BustubInstance>();
+    NoopWriter writer;
+    ASSERT_TRUE(bustub_->ExecuteSql("CREATE TABLE a (x INT, z INT, pad VARCHAR(32));", writer));
+    ASSERT_TRUE(bustub_->ExecuteSql("CREATE TABLE b (y INT, w INT, pad VARCHAR(32));", writer));
+    std::string a_rows;
+    for (int i = 0; i < 100; i++) {
+      a_rows += fmt::format("{}({}, {}, 'a padding {}')", i == 0 ? "" : ", ", i, i % 10, i);
+    }
+    std::string b_rows;
+    for (int i = 0; i < 50; i++) {
+      b_rows += fmt::format("{}({}, {}, 'b padding {}')", i == 0 ? "" : ", ", i * 2, i % 5, i);
+    }
+    ASSERT_TRUE(bustub_->ExecuteSql(fmt::format("INSERT INTO a VALUES {};", a_rows), writer));
+    ASSERT_TRUE(bustub_->ExecuteSql(fmt::format("INSERT INTO b VALUES {};", b_rows), writer));
+  }
+
+  std::unique_ptr<BustubInstance> bustub_;
+};
+
+}  // namespace
+
+TEST_F(PredicatePushdownTest, JoinTest) {
+  // the WHERE clause is merged into the join, the conjuncts on one table end up in its scan
+  const std::string sql = "SELECT a.x, b.w FROM a, b WHERE a.x = b.y AND a.z > 5 AND b.w < 3";
+  auto plan = OptimizedPlan(bustub_.get(), sql);
+  auto joins = FindNodes(plan, PlanType::HashJoin);
+  ASSERT_EQ(joins.size(), 1) << plan->ToString();
+  EXPECT_EQ(FindNodes(plan, PlanType::Filter).size(), 0) << plan->ToString();
+  for (const auto &child : joins[0]->GetChildren()) {
+    ASSERT_EQ(child->GetType(), PlanType::SeqScan) << plan->ToString();
+    EXPECT_NE(dynamic_cast<const SeqScanPlanNode &>(*child).filter_predicate_, nullptr) << plan->ToString();
+  }
+
+  std::vector<std::string> expected;
+  for (int i = 0; i < 50; i++) {
+    if (i * 2 < 100 && i * 2 % 10 > 5 && i % 5 < 3) {
+      expected.push_back(fmt::format("{} {} ", i * 2, i % 5));
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), expected);
+}
+
+TEST_F(PredicatePushdownTest, ScanPredicateTest) {
+  // conjuncts pushed down to a table reach its scan, no Filter node is left between them
+  const std::string sql = "SELECT pad FROM (SELECT x, pad FROM a WHERE z < 4) WHERE x > 50";
+  auto plan = OptimizedPlan(bustub_.get(), sql);
+  EXPECT_EQ(FindNodes(plan, PlanType::Filter).size(), 0) << plan->ToString();
+  auto scans = FilteredScans(plan);
+  ASSERT_EQ(scans.size(), 1) << plan->ToString();
+  auto predicate = scans[0]->filter_predicate_->ToString();
+  EXPECT_NE(predicate.find("<4"), std::string::npos) << plan->ToString();
+  EXPECT_NE(predicate.find(">50"), std::string::npos) << plan->ToString();
+
+  std::vector<std::string> expected;
+  for (int i = 51; i < 100; i++) {
+    if (i % 10 < 4) {
+      expected.push_back(fmt::format("a padding {} ", i));
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), expected);
+}
+
+TEST_F(PredicatePushdownTest, TransitiveEqualityTest) {
+  // b.y = 40 also holds for a.x through the join key, both scans are filtered
+  const std::string sql = "SELECT a.pad, b.pad FROM a INNER JOIN b ON a.x = b.y WHERE b.y = 40";
+  auto plan = OptimizedPlan(bustub_.get(), sql);
+  auto scans = FilteredScans(plan);
+  ASSERT_EQ(scans.size(), 2) << plan->ToString();
+  for (const auto *scan : scans) {
+    EXPECT_NE(scan->filter_predicate_->ToString().find("=40"), std::string::npos) << plan->ToString();
+  }
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), std::vector<std::string>{"a padding 40 b padding 20 "});
+}
+
+TEST_F(PredicatePushdownTest, AggregationTest) {
+  // a HAVING conjunct on a group-by column filters the input of the aggregation, one on an aggregate stays above
+  const std::string sql = "SELECT z, count(*) FROM a GROUP BY z HAVING z < 3 AND count(*) > 1";
+  auto plan = OptimizedPlan(bustub_.get(), sql);
+  auto aggregations = FindNodes(plan, PlanType::Aggregation);
+  ASSERT_EQ(aggregations.size(), 1) << plan->ToString();
+  auto scans_below = FilteredScans(aggregations[0]);
+  ASSERT_EQ(scans_below.size(), 1) << plan->ToString();
+  EXPECT_NE(scans_below[0]->filter_predicate_->ToString().find("<3"), std::string::npos) << plan->ToString();
+  EXPECT_EQ(FindNodes(plan, PlanType::Filter).size(), 1) << plan->ToString();
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), (std::vector<std::string>{"0 10 ", "1 10 ", "2 10 "}));
+}
+
+TEST_F(PredicatePushdownTest, LeftJoinTest) {
+  // the ON conjunct on the right table filters its scan, the WHERE conjunct on the left table filters the left scan,
+  // left rows without a match are still produced
+  const std::string sql = "SELECT a.x, b.w FROM a LEFT JOIN b ON a.x = b.y AND b.w = 1 WHERE a.x < 20";
+  auto plan = OptimizedPlan(bustub_.get(), sql);
+  EXPECT_EQ(FindNodes(plan, PlanType::Filter).size(), 0) << plan->ToString();
+  EXPECT_EQ(FilteredScans(plan).size(), 2) << plan->ToString();
+
+  std::vector<std::string> expected;
+  for (int x = 0; x < 20; x++) {
+    bool matched = x % 2 == 0 && x / 2 % 5 == 1;
+    expected.push_back(matched ? fmt::format("{} 1 ", x) : fmt::format("{} integer_null ", x));
+  }
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql), expected);
+}
+
+TEST_F(PredicatePushdownTest, ColumnPruningTest) {
+  // only the join keys and the selected columns enter the hash join, the scans do not produce the padding columns
+  const std::string sql = "SELECT a.x, b.w FROM a, b WHERE a.x = b.y";
+  auto plan = OptimizedPlan(bustub_.get(), sql);
+  auto joins = FindNodes(plan, PlanType::HashJoin);
+  ASSERT_EQ(joins.size(), 1) << plan->ToString();
+  EXPECT_EQ(joins[0]->GetChildAt(0)->OutputSchema().GetColumnCount(), 1) << plan->ToString();
+  EXPECT_EQ(joins[0]->GetChildAt(1)->OutputSchema().GetColumnCount(), 2) << plan->ToString();
+  EXPECT_EQ(joins[0]->GetChildAt(0)->GetType(), PlanType::SeqScan) << plan->ToString();
+  EXPECT_EQ(joins[0]->GetChildAt(1)->GetType(), PlanType::SeqScan) << plan->ToString();
+  EXPECT_EQ(plan->OutputSchema().GetColumnCount(), 2);
+  EXPECT_EQ(SortedQuery(bustub_.get(), sql).size(), 50);
+
+  // an unused aggregate is not computed, the input of the aggregation only carries the grouped column
+  const std::string agg_sql = "SELECT z FROM (SELECT z, max(pad) AS m, count(*) AS c FROM a GROUP BY z) WHERE c > 5";
+  plan = OptimizedPlan(bustub_.get(), agg_sql);
+  auto aggregations = FindNodes(plan, PlanType::Aggregation);
+  ASSERT_EQ(aggregations.size(), 1) << plan->ToString();
+  EXPECT_EQ(aggregations[0]->OutputSchema().GetColumnCount(), 2) << plan->ToString();
+  EXPECT_EQ(aggregations[0]->GetChildAt(0)->OutputSchema().GetColumnCount(), 1) << plan->ToString();
+  EXPECT_EQ(SortedQuery(bustub_.get(), agg_sql).size(), 10);
+
+  // a filtered scan produces only the selected column, its predicate still reads the filtered one
+  const std::string filter_sql = "SELECT a.x FROM a WHERE a.z = 3";
+  plan = OptimizedPlan(bustub_.get(), filter_sql);
+  auto scans = FilteredScans(plan);
+  ASSERT_EQ(scans.size(), 1) << plan->ToString();
+  EXPECT_EQ(scans[0]->GetColumnIds(), std::vector<uint32_t>{0}) << plan->ToString();
+  EXPECT_EQ(FindNodes(plan, PlanType::Filter).size(), 0) << plan->ToString();
+  EXPECT_EQ(SortedQuery(bustub_.get(), filter_sql).size(), 10);
+}
+
+}  // namespace bustub
@@ -0,0 +1,99 @@
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "primer/trie_arena.h"
+
+namespace bustub {
+
+TEST(TrieArenaTest, ReuseTest) {
+  // a freed block is handed out again for the next allocation of the same size class
+  void *first = TrieArena::Allocate(40);
+  TrieArena::Deallocate(first, 40);
+  void *second = TrieArena::Allocate(48);
+  EXPECT_EQ(first, second);
+  TrieArena::Deallocate(second, 48);
+
+  // blocks of one size class never overlap
+  std::vector<char *> blocks;
+  std::set<char *> distinct;
+  for (int i = 0; i < 10000; i++) {
+    auto *block = static_cast<char *>(TrieArena::Allocate(64));
+    std::memset(block, i & 0xFF, 64);
+    blocks.push_back(block);
+    distinct.insert(block);
+  }
+  EXPECT_EQ(blocks.size(), distinct.size());
+  for (size_t i = 0; i < blocks.size(); i++) {
+    ASSERT_EQ(static_cast<char>(i & 0xFF), blocks[i][63]);
+    TrieArena::Deallocate(blocks[i], 64);
+  }
+
+  // blocks above the largest size class go through operator new
+  void *large = TrieArena::Allocate(TrieArena::MAX_BLOCK_SIZE + 1);
+  TrieArena::Deallocate(large, TrieArena::MAX_BLOCK_SIZE + 1);
+}
+
+TEST(TrieArenaTest, CrossThreadFreeTest) {
+  // blocks allocated on one thread and freed on another, and the free lists of exited threads, are reused
+  std::vector<void *> blocks(1000);
+  std::thread producer([&] {
+    for (auto &block : blocks) {
+      block = TrieArena::Allocate(100);
+    }
+  });
+  producer.join();
+  std::thread consumer([&] {
+    for (auto *block : blocks) {
+      TrieArena::Deallocate(block, 100);
+    }
+  });
+  consumer.join();
+
+  std::set<void *> freed(blocks.begin(), blocks.end());
+  void *reused = TrieArena::Allocate(100);
+  EXPECT_EQ(1, freed.count(reused));
+  TrieArena::Deallocate(reused, 100);
+}
+
+TEST(TrieArenaTest, ProducerConsumerTest) {
+  // one long-lived thread allocates, another frees; the freed blocks must flow back to the producer
+  // instead of piling up on the consumer while the producer keeps carving new chunks
+  const int num_rounds = 200;
+  std::vector<void *> batch(256);
+  std::set<void *> distinct;
+  std::atomic<int> turn{0};
+  std::thread producer([&] {
+    for (int round = 0; round < num_rounds; round++) {
+      while (turn.load() != 2 * round) {
+        std::this_thread::yield();
+      }
+      for (auto &block : batch) {
+        block = TrieArena::Allocate(200);
+        distinct.insert(block);
+      }
+      turn++;
+    }
+  });
+  std::thread consumer([&] {
+    for (int round = 0; round < num_rounds; round++) {
+      while (turn.load() != 2 * round + 1) {
+        std::this_thread::yield();
+      }
+      for (auto *block : batch) {
+        TrieArena::Deallocate(block, 200);
+      }
+      turn++;
+    }
+  });
+  producer.join();
+  consumer.join();
+
+  // the blocks in flight plus what each thread may cache, far below the 51200 allocations made
+  EXPECT_LT(distinct.size(), 8 * batch.size());
+}
+
+}  // namespace bustub
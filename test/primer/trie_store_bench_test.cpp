@@ -0,0 +1,123 @@
+/**
+ * trie_store_bench_test.cpp
+ */
+
+#include <fmt/format.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "primer/trie_store.h"
+
+namespace bustub {
+
+namespace {
+
+const uint32_t NUM_KEYS = 10000;
+
+auto KeyOf(uint32_t i) -> std::string { return fmt::format("{:#05}", i); }
+
+// Runs num_readers threads doing Get for the given duration while one writer keeps publishing
+// batches, returns the total number of reads per second.
+auto ReadThroughput(TrieStore *store, size_t num_readers, std::chrono::milliseconds duration) -> double {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> total_reads{0};
+  std::atomic<bool> failed{false};
+
+  std::thread writer([&] {
+    uint32_t round = 0;
+    while (!stop) {
+      std::vector<std::pair<std::string, uint32_t>> batch;
+      for (uint32_t i = round % 100; i < NUM_KEYS; i += 100) {
+        batch.emplace_back(KeyOf(i), i);
+      }
+      store->PutBatch<uint32_t>(std::move(batch));
+      round++;
+    }
+  });
+
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < num_readers; t++) {
+    readers.emplace_back([&, t] {
+      uint64_t reads = 0;
+      uint32_t i = t * 7919;
+      while (!stop) {
+        uint32_t key = i++ % NUM_KEYS;
+        auto guard = store->Get<uint32_t>(KeyOf(key));
+        if (!guard.has_value() || **guard != key) {
+          failed = true;
+        }
+        reads++;
+      }
+      total_reads += reads;
+    });
+  }
+
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  writer.join();
+
+  EXPECT_FALSE(failed);
+  return static_cast<double>(total_reads) / std::chrono::duration<double>(duration).count();
+}
+
+}  // namespace
+
+// Reads never take a lock, so their throughput should grow with the number of reader threads
+// even while a writer is publishing new versions. Prints throughput, so it only runs on request with
+// --gtest_also_run_disabled_tests.
+TEST(TrieStoreBenchTest, DISABLED_ReadScalingBenchmark) {  // NOLINT
+  TrieStore store;
+  std::vector<std::pair<std::string, uint32_t>> batch;
+  for (uint32_t i = 0; i < NUM_KEYS; i++) {
+    batch.emplace_back(KeyOf(i), i);
+  }
+  store.PutBatch<uint32_t>(std::move(batch));
+
+  size_t max_threads = std::max<size_t>(1, std::min<size_t>(8, std::thread::hardware_concurrency() - 1));
+  for (size_t num_readers = 1; num_readers <= max_threads; num_readers *= 2) {
+    double throughput = ReadThroughput(&store, num_readers, std::chrono::milliseconds(500));
+    std::cout << fmt::format("readers={:<2} reads/s={:.0f}", num_readers, throughput) << std::endl;
+  }
+}
+
+// A batch is published as one version: a reader sees all of its keys or none of them.
+TEST(TrieStoreBenchTest, PutBatchAtomicityTest) {  // NOLINT
+  TrieStore store;
+  std::atomic<bool> stop{false};
+  std::atomic<bool> torn{false};
+
+  std::thread reader([&] {
+    while (!stop) {
+      auto last = store.Get<uint32_t>(KeyOf(99));
+      auto first = store.Get<uint32_t>(KeyOf(0));
+      // the last key of a batch is read first: the first key must be from that batch or a newer one
+      if (last.has_value() && (!first.has_value() || **first < **last)) {
+        torn = true;
+      }
+    }
+  });
+
+  for (uint32_t round = 1; round <= 200; round++) {
+    std::vector<std::pair<std::string, uint32_t>> batch;
+    for (uint32_t i = 0; i < 100; i++) {
+      batch.emplace_back(KeyOf(i), round);
+    }
+    store.PutBatch<uint32_t>(std::move(batch));
+  }
+  stop = true;
+  reader.join();
+  EXPECT_FALSE(torn);
+
+  auto guard = store.Get<uint32_t>(KeyOf(42));
+  ASSERT_TRUE(guard.has_value());
+  EXPECT_EQ(200, **guard);
+}
+
+}  // namespace bustub
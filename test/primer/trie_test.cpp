@@ -1,6 +1,7 @@
 #include <fmt/format.h>
 #include <bitset>
 #include <functional>
+#include <map>
 #include <numeric>
 #include <optional>
 #include <random>
@@ -252,4 +253,68 @@ TEST(TrieTest, PointerStability) {
   ASSERT_EQ(reinterpret_cast<uint64_t>(ptr_before), reinterpret_cast<uint64_t>(ptr_after));
 }
 
+TEST(TrieTest, WideFanoutTest) {
+  // every byte value below the root and below "x" exercises all child layouts, both growing and shrinking
+  std::map<std::string, uint32_t> expected;
+  auto trie = Trie();
+  for (uint32_t i = 0; i < 256; i++) {
+    std::string key(1, static_cast<char>(i));
+    trie = trie.Put<uint32_t>(key, i);
+    trie = trie.Put<uint32_t>("x" + key, i + 1000);
+    expected[key] = i;
+    expected["x" + key] = i + 1000;
+  }
+  std::mt19937 gen(15445);
+  std::vector<std::string> keys;
+  for (const auto &[key, value] : expected) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), gen);
+
+  for (size_t removed = 0; removed <= keys.size(); removed++) {
+    if (removed % 37 == 0 || removed + 3 >= keys.size()) {
+      for (const auto &[key, value] : expected) {
+        ASSERT_NE(trie.Get<uint32_t>(key), nullptr) << key;
+        ASSERT_EQ(*trie.Get<uint32_t>(key), value);
+      }
+    }
+    if (removed == keys.size()) {
+      break;
+    }
+    trie = trie.Remove(keys[removed]);
+    expected.erase(keys[removed]);
+    ASSERT_EQ(trie.Get<uint32_t>(keys[removed]), nullptr);
+  }
+}
+
+TEST(TrieTest, PathCompressionTest) {
+  auto trie = Trie();
+  trie = trie.Put<uint32_t>("abcdef", 1);
+  // split the compressed path in the middle, at its end and beyond it
+  trie = trie.Put<uint32_t>("abcxyz", 2);
+  trie = trie.Put<uint32_t>("abc", 3);
+  trie = trie.Put<uint32_t>("abcdefgh", 4);
+  ASSERT_EQ(trie.Get<uint32_t>("ab"), nullptr);
+  ASSERT_EQ(trie.Get<uint32_t>("abcd"), nullptr);
+  ASSERT_EQ(trie.Get<uint32_t>("abcdefg"), nullptr);
+  ASSERT_EQ(*trie.Get<uint32_t>("abcdef"), 1);
+  ASSERT_EQ(*trie.Get<uint32_t>("abcxyz"), 2);
+  ASSERT_EQ(*trie.Get<uint32_t>("abc"), 3);
+  ASSERT_EQ(*trie.Get<uint32_t>("abcdefgh"), 4);
+
+  // removing keys merges the remaining single child chains back
+  auto removed = trie.Remove("abc").Remove("abcxyz").Remove("abcdef");
+  ASSERT_EQ(removed.Get<uint32_t>("abc"), nullptr);
+  ASSERT_EQ(removed.Get<uint32_t>("abcdef"), nullptr);
+  ASSERT_EQ(*removed.Get<uint32_t>("abcdefgh"), 4);
+  removed = removed.Put<uint32_t>("abd", 5);
+  ASSERT_EQ(*removed.Get<uint32_t>("abcdefgh"), 4);
+  ASSERT_EQ(*removed.Get<uint32_t>("abd"), 5);
+  ASSERT_EQ(removed.Remove("abcdefgh").Remove("abd").Get<uint32_t>("abd"), nullptr);
+
+  // the old version is untouched
+  ASSERT_EQ(*trie.Get<uint32_t>("abc"), 3);
+  ASSERT_EQ(*trie.Get<uint32_t>("abcxyz"), 2);
+}
+
 }  // namespace bustub
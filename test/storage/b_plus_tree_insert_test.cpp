@@ -187,4 +187,63 @@ TEST(BPlusTreeTests, InsertTest3) {
   delete transaction;
   delete bpm;
 }
+
+TEST(BPlusTreeTests, InsertBatchTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // small pages, so the batch spans many leaves and splits some of them
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator,
+                                                           6, 5);
+
+  auto make_entry = [](int64_t key) {
+    std::pair<GenericKey<8>, RID> entry;
+    entry.first.SetFromInteger(key);
+    entry.second.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF));
+    return entry;
+  };
+
+  // the even keys go in one at a time, then a sorted batch brings the odd keys and repeats some even ones
+  for (int64_t key = 0; key < 200; key += 2) {
+    auto [index_key, rid] = make_entry(key);
+    tree.Insert(index_key, rid);
+  }
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (int64_t key = 1; key < 220; key++) {
+    if (key % 2 == 1 || key % 10 == 0) {
+      entries.push_back(make_entry(key));
+    }
+  }
+  EXPECT_EQ(tree.InsertBatch(entries), 112);
+  EXPECT_EQ(tree.InsertBatch(entries), 0);
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 220; key++) {
+    rids.clear();
+    auto [index_key, rid] = make_entry(key);
+    bool present = key < 200 || key % 2 == 1 || key % 10 == 0;
+    EXPECT_EQ(tree.GetValue(index_key, &rids), present) << key;
+    if (present) {
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0], rid);
+    }
+  }
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    while (current_key >= 200 && current_key % 2 == 0 && current_key % 10 != 0) {
+      current_key++;
+    }
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 220);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
 }  // namespace bustub
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_range_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_range_scan_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+using RangeTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+
+void InsertKeys(RangeTree *tree, const std::vector<int64_t> &keys) {
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, rid);
+  }
+}
+
+auto MakeRange(std::optional<int64_t> low, bool low_inclusive, std::optional<int64_t> high, bool high_inclusive)
+    -> IndexKeyRange<GenericKey<8>> {
+  IndexKeyRange<GenericKey<8>> range;
+  if (low.has_value()) {
+    GenericKey<8> key;
+    key.SetFromInteger(*low);
+    range.low_ = key;
+  }
+  if (high.has_value()) {
+    GenericKey<8> key;
+    key.SetFromInteger(*high);
+    range.high_ = key;
+  }
+  range.low_inclusive_ = low_inclusive;
+  range.high_inclusive_ = high_inclusive;
+  return range;
+}
+
+auto Collect(RangeTree *tree, IndexIterator<GenericKey<8>, RID, GenericComparator<8>> iter) -> std::vector<int64_t> {
+  std::vector<int64_t> result;
+  for (; iter != tree->End(); ++iter) {
+    result.push_back((*iter).second.GetSlotNum());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(BPlusTreeTests, RangeScanTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  RangeTree tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 4);
+
+  // empty tree yields nothing in both directions
+  EXPECT_TRUE(Collect(&tree, tree.Begin(MakeRange(1, true, 10, false))).empty());
+  EXPECT_TRUE(Collect(&tree, tree.RBegin()).empty());
+
+  std::vector<int64_t> keys(200);
+  std::iota(keys.begin(), keys.end(), 1);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  InsertKeys(&tree, keys);
+
+  std::vector<int64_t> expected(50);
+  std::iota(expected.begin(), expected.end(), 50);
+  EXPECT_EQ(Collect(&tree, tree.Begin(MakeRange(50, true, 100, false))), expected);
+
+  std::iota(expected.begin(), expected.end(), 51);
+  EXPECT_EQ(Collect(&tree, tree.Begin(MakeRange(50, false, 100, true))), expected);
+
+  std::reverse(expected.begin(), expected.end());
+  EXPECT_EQ(Collect(&tree, tree.RBegin(MakeRange(50, false, 100, true))), expected);
+
+  std::iota(expected.begin(), expected.end(), 50);
+  std::reverse(expected.begin(), expected.end());
+  EXPECT_EQ(Collect(&tree, tree.RBegin(MakeRange(50, true, 100, false))), expected);
+
+  // open bounds and bounds outside of the stored keys
+  EXPECT_EQ(Collect(&tree, tree.Begin(MakeRange(std::nullopt, true, 3, true))), (std::vector<int64_t>{1, 2, 3}));
+  EXPECT_EQ(Collect(&tree, tree.RBegin(MakeRange(198, false, std::nullopt, true))), (std::vector<int64_t>{200, 199}));
+  EXPECT_TRUE(Collect(&tree, tree.Begin(MakeRange(300, true, 400, true))).empty());
+  EXPECT_TRUE(Collect(&tree, tree.RBegin(MakeRange(-10, true, 0, true))).empty());
+  EXPECT_TRUE(Collect(&tree, tree.Begin(MakeRange(7, false, 7, true))).empty());
+
+  std::vector<int64_t> all(200);
+  std::iota(all.begin(), all.end(), 1);
+  std::reverse(all.begin(), all.end());
+  EXPECT_EQ(Collect(&tree, tree.RBegin()), all);
+
+  // remove the even keys so that leaves are merged, the backward links must follow the merges
+  for (int64_t key = 2; key <= 200; key += 2) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, nullptr);
+  }
+  std::vector<int64_t> odds;
+  for (int64_t key = 199; key >= 1; key -= 2) {
+    odds.push_back(key);
+  }
+  EXPECT_EQ(Collect(&tree, tree.RBegin()), odds);
+  std::reverse(odds.begin(), odds.end());
+  EXPECT_EQ(Collect(&tree, tree.Begin()), odds);
+  EXPECT_EQ(Collect(&tree, tree.RBegin(MakeRange(10, true, 20, true))), (std::vector<int64_t>{19, 17, 15, 13, 11}));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, ReverseScanWithConcurrentInsertTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  RangeTree tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 4);
+
+  std::vector<int64_t> odds;
+  std::vector<int64_t> evens;
+  for (int64_t key = 1; key <= 1000; key++) {
+    (key % 2 == 1 ? odds : evens).push_back(key);
+  }
+  InsertKeys(&tree, odds);
+
+  std::thread writer([&] { InsertKeys(&tree, evens); });
+
+  // every scan sees all keys present before it started, in strictly descending order
+  for (int round = 0; round < 5; round++) {
+    auto seen = Collect(&tree, tree.RBegin());
+    ASSERT_TRUE(std::is_sorted(seen.rbegin(), seen.rend()));
+    ASSERT_EQ(std::adjacent_find(seen.begin(), seen.end()), seen.end());
+    for (auto key : odds) {
+      ASSERT_TRUE(std::binary_search(seen.rbegin(), seen.rend(), key));
+    }
+  }
+  writer.join();
+
+  EXPECT_EQ(Collect(&tree, tree.RBegin()).size(), 1000);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+}  // namespace bustub
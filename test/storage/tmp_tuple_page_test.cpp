@@ -10,16 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/page/tmp_tuple_page.h"
+#include "storage/table/spill_file.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
+TEST(TmpTuplePageTest, BasicTest) {
   // There are many ways to do this assignment, and this is only one of them.
   // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
   // You will get full credit as long as you are correctly using a linear probe hash table.
@@ -48,4 +53,33 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + BUSTUB_PAGE_SIZE - 4), 123);
 }
 
+// NOLINTNEXTLINE
+TEST(TmpTuplePageTest, SpillOutOfFramesTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(2, disk_manager.get());
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema schema(columns);
+  Tuple tuple({ValueFactory::GetIntegerValue(123)}, &schema);
+
+  SpillFile spill_file(bpm.get());
+  spill_file.Append(tuple);
+  spill_file.Finish();
+
+  // every frame is pinned, the spill file can neither read its page back nor start a new one
+  page_id_t page_ids[2];
+  ASSERT_NE(bpm->NewPage(&page_ids[0]), nullptr);
+  ASSERT_NE(bpm->NewPage(&page_ids[1]), nullptr);
+  std::vector<Tuple> tuples;
+  EXPECT_THROW(spill_file.ReadPage(0, &tuples), ExecutionException);
+  EXPECT_THROW(spill_file.Append(tuple), ExecutionException);
+
+  bpm->UnpinPage(page_ids[0], false);
+  spill_file.ReadPage(0, &tuples);
+  ASSERT_EQ(tuples.size(), 1);
+  EXPECT_EQ(tuples[0].GetValue(&schema, 0).GetAs<int32_t>(), 123);
+  bpm->UnpinPage(page_ids[1], false);
+}
+
 }  // namespace bustub
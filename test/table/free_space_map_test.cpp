@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_test.cpp
+//
+// Identification: test/table/free_space_map_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/free_space_map.h"
+#include "storage/table/morsel_queue.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+auto CountLiveTuples(TableIterator iter) -> size_t {
+  size_t count = 0;
+  for (; !iter.IsEnd(); ++iter) {
+    count += iter.GetTuple().first.is_deleted_ ? 0 : 1;
+  }
+  return count;
+}
+
+auto MakeTuple(int a, const Schema &schema) -> Tuple {
+  return Tuple{{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(fmt::format("{:040}", a))}, &schema};
+}
+
+}  // namespace
+
+TEST(FreeSpaceMapTest, FindPageTest) {
+  FreeSpaceMap map;
+  EXPECT_EQ(map.FindPage(1), std::nullopt);
+
+  // enough pages for the tree to grow several times
+  for (page_id_t page_id = 0; page_id < 100; page_id++) {
+    map.Update(page_id, 10);
+  }
+  map.Update(40, 300);
+  map.Update(70, 1000);
+  EXPECT_EQ(map.GetPageCount(), 100);
+  EXPECT_EQ(map.FindPage(200), 40);
+  EXPECT_EQ(map.FindPage(500), 70);
+  EXPECT_EQ(map.FindPage(1001), std::nullopt);
+
+  // free space is rounded down to a unit, so a page is only found when it has room for sure
+  EXPECT_EQ(map.GetFreeSpace(40), 288);
+  EXPECT_EQ(map.FindPage(290), 70);
+  EXPECT_EQ(map.FindPage(288), 40);
+  EXPECT_EQ(map.GetFreeSpace(1000), 0);
+
+  map.Update(70, 0);
+  EXPECT_EQ(map.FindPage(500), std::nullopt);
+  map.Update(5, 4000);
+  EXPECT_EQ(map.FindPage(100), 5);
+}
+
+TEST(FreeSpaceMapTest, VacuumReusesSpaceTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+  auto table = std::make_unique<TableHeap>(bpm.get(), TableFormat::Row, schema);
+  const auto *free_space_map = table->GetFreeSpaceMap();
+  ASSERT_NE(free_space_map, nullptr);
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 3000; i++) {
+    rids.push_back(*table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(i, schema)));
+  }
+  const auto num_pages = free_space_map->GetPageCount();
+  ASSERT_GT(num_pages, 20);
+
+  // leftovers at the end of full pages are too small to be reused, the heap stays in insertion order
+  for (size_t i = 1; i < rids.size(); i++) {
+    ASSERT_TRUE(rids[i - 1].GetPageId() < rids[i].GetPageId() ||
+                (rids[i - 1].GetPageId() == rids[i].GetPageId() && rids[i - 1].GetSlotNum() < rids[i].GetSlotNum()));
+  }
+
+  // delete every tuple with a < 1000 and every other tuple after that
+  std::set<page_id_t> first_pages;
+  for (int i = 0; i < 3000; i++) {
+    if (i < 1000 || i % 2 == 0) {
+      table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[i]);
+    }
+    if (i < 1000) {
+      first_pages.insert(rids[i].GetPageId());
+    }
+  }
+  first_pages.erase(rids[1000].GetPageId());
+  ASSERT_FALSE(first_pages.empty());
+
+  // tuples the predicate rejects are kept
+  EXPECT_EQ(table->Vacuum([](const TupleMeta &meta) { return false; }), 0);
+  EXPECT_EQ(table->Vacuum([](const TupleMeta &meta) { return true; }), 2000);
+  EXPECT_EQ(table->Vacuum([](const TupleMeta &meta) { return true; }), 0);
+
+  // the remaining tuples keep their rids
+  for (int i = 1001; i < 3000; i += 2) {
+    auto [meta, tuple] = table->GetTuple(rids[i]);
+    ASSERT_FALSE(meta.is_deleted_);
+    ASSERT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), i);
+    ASSERT_EQ(tuple.GetValue(&schema, 1).ToString(), fmt::format("{:040}", i));
+  }
+
+  // the pages left without tuples have empty zones, a range scan skips them
+  for (auto page_id : first_pages) {
+    EXPECT_FALSE(table->GetZoneMap()->GetZone(page_id, 0)->has_value_);
+  }
+  MorselQueue morsels(table.get(), 1, {ZoneMapRange{0, ValueFactory::GetIntegerValue(0), true, std::nullopt, true}});
+  size_t scanned_pages = 0;
+  Morsel morsel;
+  while (morsels.Next(&morsel)) {
+    scanned_pages += morsel.pages_.size();
+  }
+  EXPECT_EQ(scanned_pages, num_pages - first_pages.size());
+
+  // new tuples go to the reclaimed space instead of new pages, and a scan started before does not see them
+  auto iter = table->MakeIterator();
+  std::set<page_id_t> pages;
+  for (int i = 0; i < 1000; i++) {
+    auto rid = table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(10000 + i, schema));
+    pages.insert(rid->GetPageId());
+  }
+  EXPECT_EQ(free_space_map->GetPageCount(), num_pages);
+  EXPECT_TRUE(pages.count(rids[0].GetPageId()) == 1);
+  EXPECT_EQ(CountLiveTuples(std::move(iter)), 1000);
+  EXPECT_EQ(CountLiveTuples(table->MakeIterator()), 2000);
+
+  // bulk inserts reuse the space as well
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 100; i++) {
+    tuples.push_back(MakeTuple(20000 + i, schema));
+  }
+  auto bulk_rids = table->InsertTuples(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuples);
+  EXPECT_EQ(free_space_map->GetPageCount(), num_pages);
+  for (size_t i = 0; i < bulk_rids.size(); i++) {
+    ASSERT_EQ(table->GetTuple(bulk_rids[i]).second.GetValue(&schema, 0).GetAs<int32_t>(), 20000 + i);
+  }
+  EXPECT_EQ(CountLiveTuples(table->MakeIterator()), 2100);
+}
+
+TEST(FreeSpaceMapTest, VacuumStatementTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (a INT, b VARCHAR(32));", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE u (a INT);", writer));
+  std::string values;
+  for (int i = 0; i < 100; i++) {
+    values += fmt::format("{}({}, 'row {}')", i == 0 ? "" : ", ", i, i);
+  }
+  ASSERT_TRUE(bustub->ExecuteSql(fmt::format("INSERT INTO t VALUES {};", values), writer));
+  ASSERT_TRUE(bustub->ExecuteSql("INSERT INTO u VALUES (1), (2), (3);", writer));
+
+  // no delete executor yet, so delete through the table heap: a committed delete and one of a running transaction
+  auto *running = bustub->txn_manager_->Begin();
+  auto *table = bustub->catalog_->GetTable("t")->table_.get();
+  int i = 0;
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter, i++) {
+    if (i % 10 == 0) {
+      table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, iter.GetRID());
+    } else if (i % 10 == 1) {
+      table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, running->GetTransactionId(), true}, iter.GetRID());
+    }
+  }
+
+  EXPECT_EQ(Query(bustub.get(), "VACUUM t;"), "10 \n");
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*), sum(a) FROM t;"), "80 4040 \n");
+  bustub->txn_manager_->Commit(running);
+  delete running;
+  EXPECT_EQ(Query(bustub.get(), "VACUUM;"), "10 \n");
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*), sum(a) FROM t;"), "80 4040 \n");
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*) FROM u;"), "3 \n");
+  EXPECT_THROW(bustub->ExecuteSql("VACUUM missing;", writer), Exception);
+}
+
+}  // namespace bustub
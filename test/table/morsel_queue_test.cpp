@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue_test.cpp
+//
+// Identification: test/table/morsel_queue_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/morsel_queue.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(MorselQueueTest, ParallelScanTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+  auto table = std::make_unique<TableHeap>(bpm.get());
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+
+  const int num_rows = 5000;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_rows; i++) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("morsel-queue-test-row")}, &schema};
+    rids.push_back(*table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, i % 10 == 0}, tuple));
+  }
+
+  MorselQueue morsels(table.get(), 2);
+  // tuples inserted after the queue was created are not scanned
+  Tuple late{{ValueFactory::GetIntegerValue(-1), ValueFactory::GetVarcharValue("late")}, &schema};
+  table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, late);
+
+  // every thread takes morsels until none are left, the first page of every morsel orders the results
+  std::mutex latch;
+  std::vector<std::pair<page_id_t, std::vector<RID>>> scanned;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&] {
+      Morsel morsel;
+      while (morsels.Next(&morsel)) {
+        EXPECT_LE(morsel.pages_.size(), 2);
+        std::vector<RID> morsel_rids;
+        morsels.Scan(morsel, [&](const TupleMeta &meta, const TupleView &tuple) {
+          auto a = tuple.GetInt32(&schema, 0);
+          EXPECT_EQ(meta.is_deleted_, a % 10 == 0);
+          morsel_rids.push_back(tuple.GetRid());
+        });
+        std::scoped_lock lock(latch);
+        scanned.emplace_back(morsel.pages_[0].first, std::move(morsel_rids));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::sort(scanned.begin(), scanned.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<RID> all;
+  for (auto &[page_id, morsel_rids] : scanned) {
+    all.insert(all.end(), morsel_rids.begin(), morsel_rids.end());
+  }
+  EXPECT_GT(scanned.size(), 1);
+  EXPECT_EQ(all, rids);
+}
+
+}  // namespace bustub
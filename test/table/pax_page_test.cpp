@@ -0,0 +1,267 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page_test.cpp
+//
+// Identification: test/table/pax_page_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/binder.h"
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/execution_engine.h"
+#include "execution/executor_context.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "planner/planner.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/page/pax_page.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeValues(int i) -> std::vector<Value> {
+  return {i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i),
+          i % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                     : ValueFactory::GetVarcharValue(std::string(i % 40, 'x') + std::to_string(i)),
+          ValueFactory::GetBigIntValue(static_cast<int64_t>(i) * 1000000007),
+          ValueFactory::GetBooleanValue(i % 2 == 0)};
+}
+
+void ExpectValues(const std::vector<Value> &expected, const Tuple &tuple, const Schema &schema) {
+  for (uint32_t col = 0; col < schema.GetColumnCount(); col++) {
+    auto val = tuple.GetValue(&schema, col);
+    ASSERT_EQ(val.IsNull(), expected[col].IsNull()) << col;
+    if (!val.IsNull()) {
+      EXPECT_EQ(val.CompareEquals(expected[col]), CmpBool::CmpTrue) << col;
+    }
+  }
+}
+
+auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+/** @return the plan the instance would execute for a query */
+auto OptimizedPlan(BustubInstance *bustub, const std::string &sql) -> AbstractPlanNodeRef {
+  Binder binder(*bustub->catalog_);
+  binder.ParseAndSave(sql);
+  Planner planner(*bustub->catalog_);
+  planner.PlanQuery(*binder.BindStatement(binder.statement_nodes_.at(0)));
+  Optimizer optimizer(*bustub->catalog_, false);
+  return optimizer.Optimize(planner.plan_);
+}
+
+}  // namespace
+
+TEST(PaxPageTest, InsertAndReadTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(16, disk_manager.get());
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64},
+                                    Column{"c", TypeId::BIGINT}, Column{"d", TypeId::BOOLEAN}}};
+  auto table = std::make_unique<TableHeap>(bpm.get(), TableFormat::Pax, schema);
+  ASSERT_GT(PaxPage::ComputeCapacity(schema), 0);
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 2000; i++) {
+    Tuple tuple{MakeValues(i), &schema};
+    rids.push_back(*table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  }
+  // the tuples spread over several pages and the table iterator walks them like a row table
+  EXPECT_NE(rids.front().GetPageId(), rids.back().GetPageId());
+  int count = 0;
+  for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    EXPECT_EQ(tuple.GetRid(), rids[count]);
+    ExpectValues(MakeValues(count), tuple, schema);
+    count++;
+  }
+  EXPECT_EQ(count, 2000);
+
+  table->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[42]);
+  EXPECT_TRUE(table->GetTupleMeta(rids[42]).is_deleted_);
+  EXPECT_FALSE(table->GetTupleMeta(rids[43]).is_deleted_);
+
+  // an in-place update may shrink a varchar but not grow it
+  auto values = MakeValues(43);
+  values[0] = ValueFactory::GetNullValueByType(TypeId::INTEGER);
+  values[1] = ValueFactory::GetVarcharValue("y");
+  table->UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, Tuple{values, &schema}, rids[43]);
+  ExpectValues(values, table->GetTuple(rids[43]).second, schema);
+  values[1] = ValueFactory::GetVarcharValue(std::string(60, 'z'));
+  EXPECT_THROW(table->UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false},
+                                               Tuple{values, &schema}, rids[43]),
+               Exception);
+
+  // a column is read from its minipage alone
+  auto guard = bpm->FetchPageRead(rids[0].GetPageId());
+  const auto *page = guard.As<PaxPage>();
+  std::vector<uint32_t> slots{0, 1, 5, 7};
+  std::vector<Value> column;
+  page->ReadColumn(schema, 1, slots, &column);
+  ASSERT_EQ(column.size(), slots.size());
+  for (size_t i = 0; i < slots.size(); i++) {
+    EXPECT_EQ(page->IsNull(1, slots[i]), MakeValues(slots[i])[1].IsNull());
+    EXPECT_EQ(column[i].IsNull(), MakeValues(slots[i])[1].IsNull());
+  }
+  EXPECT_EQ(column[1].ToString(), "x1");
+}
+
+TEST(PaxPageTest, PaxTableMatchesRowTable) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE r (a INT, b VARCHAR(32), c INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE p (a INT, b VARCHAR(32), c INT) WITH (format = pax);", writer));
+  EXPECT_THROW(bustub->ExecuteSql("CREATE TABLE q (a INT) WITH (format = columnar);", writer), Exception);
+  for (int begin = 0; begin < 3000; begin += 500) {
+    std::string values;
+    for (int i = begin; i < begin + 500; i++) {
+      values += fmt::format("{}({}, 'name-{}', {})", i == begin ? "" : ", ", i, i % 300, i % 17);
+    }
+    for (const auto *table : {"r", "p"}) {
+      ASSERT_TRUE(bustub->ExecuteSql(fmt::format("INSERT INTO {} VALUES {};", table, values), writer));
+    }
+  }
+  // mark the rows with c = 3 deleted, the scans have to skip them
+  for (const auto *name : {"r", "p"}) {
+    auto *info = bustub->catalog_->GetTable(name);
+    for (auto iter = info->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+      auto [meta, tuple] = iter.GetTuple();
+      if (tuple.GetValue(&info->schema_, 2).GetAs<int32_t>() == 3) {
+        info->table_->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, tuple.GetRid());
+      }
+    }
+  }
+
+  const std::vector<std::string> queries{
+      "SELECT * FROM {};",
+      "SELECT a, b FROM {} WHERE c > 10 AND a < 2000;",
+      "SELECT b, count(*), sum(a) FROM {} WHERE b = 'name-7' GROUP BY b;",
+      "SELECT count(*), count(b), min(c), max(c) FROM {};",
+      "SELECT a, b FROM {} WHERE c = 5 ORDER BY a DESC;",
+  };
+  for (const auto &sql : queries) {
+    auto expected = Query(bustub.get(), fmt::format(sql, "r"));
+    EXPECT_FALSE(expected.empty()) << sql;
+    EXPECT_EQ(Query(bustub.get(), fmt::format(sql, "p")), expected) << sql;
+  }
+
+  // the filters end up in the PAX scan, which decodes the filter columns first and the output columns only for the
+  // rows that pass
+  for (const auto &sql : {queries[1], queries[4]}) {
+    auto plan = OptimizedPlan(bustub.get(), fmt::format(sql, "p"));
+    std::vector<const SeqScanPlanNode *> scans;
+    bool has_filter = false;
+    std::function<void(const AbstractPlanNodeRef &)> visit = [&](const AbstractPlanNodeRef &node) {
+      has_filter = has_filter || node->GetType() == PlanType::Filter;
+      if (node->GetType() == PlanType::SeqScan) {
+        scans.push_back(dynamic_cast<const SeqScanPlanNode *>(node.get()));
+      }
+      for (const auto &child : node->GetChildren()) {
+        visit(child);
+      }
+    };
+    visit(plan);
+    EXPECT_FALSE(has_filter) << plan->ToString();
+    ASSERT_EQ(scans.size(), 1) << plan->ToString();
+    EXPECT_NE(scans[0]->filter_predicate_, nullptr) << plan->ToString();
+    EXPECT_EQ(scans[0]->GetColumnIds(), (std::vector<uint32_t>{0, 1})) << plan->ToString();
+  }
+}
+
+TEST(PaxPageTest, OversizedTupleTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE r (a INT, b VARCHAR(32), c INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE p (a INT, b VARCHAR(32), c INT) WITH (format = pax);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("INSERT INTO p VALUES (1, 'short', 1);", writer));
+
+  // a PAX page keeps most of its room for the minipages, a varchar that fits on a row page can be too long for it;
+  // the insert fails instead of aborting the process, and the table stays usable
+  auto long_row = fmt::format("INSERT INTO {{}} VALUES (2, '{}', 2);", std::string(BUSTUB_PAGE_SIZE / 2, 'x'));
+  ASSERT_TRUE(bustub->ExecuteSql(fmt::format(long_row, "r"), writer));
+  EXPECT_THROW(bustub->ExecuteSql(fmt::format(long_row, "p"), writer), Exception);
+  auto too_long_row = fmt::format("INSERT INTO r VALUES (3, '{}', 3);", std::string(BUSTUB_PAGE_SIZE, 'x'));
+  EXPECT_THROW(bustub->ExecuteSql(too_long_row, writer), Exception);
+  ASSERT_TRUE(bustub->ExecuteSql("INSERT INTO p VALUES (4, 'short', 4);", writer));
+  EXPECT_EQ(Query(bustub.get(), "SELECT a FROM p;"), "1 \n4 \n");
+  EXPECT_EQ(Query(bustub.get(), "SELECT a FROM r;"), "2 \n");
+}
+
+TEST(PaxPageTest, NarrowedScanTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE r (a INT, b VARCHAR(32), c INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE p (a INT, b VARCHAR(32), c INT) WITH (format = pax);", writer));
+  std::string values;
+  for (int i = 0; i < 3000; i++) {
+    values += fmt::format("{}({}, 'name-{}', {})", i == 0 ? "" : ", ", i, i % 300, i % 17);
+  }
+  for (const auto *table : {"r", "p"}) {
+    ASSERT_TRUE(bustub->ExecuteSql(fmt::format("INSERT INTO {} VALUES {};", table, values), writer));
+  }
+
+  // the scan outputs b and a in that order, the filter reads c or b; the integer filter is compiled, the
+  // varchar one is interpreted
+  auto c_is_5 = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 2, TypeId::INTEGER),
+      std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(5)), ComparisonType::Equal);
+  auto b_is_name_7 = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR),
+      std::make_shared<ConstantValueExpression>(ValueFactory::GetVarcharValue("name-7")), ComparisonType::Equal);
+  auto output =
+      std::make_shared<Schema>(std::vector<Column>{Column("b", TypeId::VARCHAR, 32), Column("a", TypeId::INTEGER)});
+  for (const auto *table : {"r", "p"}) {
+    for (const auto &[predicate, matches] : std::vector<std::pair<AbstractExpressionRef, std::function<bool(int)>>>{
+             {c_is_5, [](int i) { return i % 17 == 5; }},
+             {b_is_name_7, [](int i) { return i % 300 == 7; }},
+         }) {
+      auto *table_info = bustub->catalog_->GetTable(table);
+      auto plan = std::make_shared<SeqScanPlanNode>(output, table_info->oid_, table, predicate,
+                                                    std::vector<uint32_t>{1, 0});
+      auto *txn = bustub->txn_manager_->Begin();
+      ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                               bustub->lock_manager_, false);
+      std::vector<Tuple> result;
+      ASSERT_TRUE(bustub->execution_engine_->Execute(plan, &result, txn, &exec_ctx));
+      bustub->txn_manager_->Commit(txn);
+      delete txn;
+
+      size_t row = 0;
+      for (int i = 0; i < 3000; i++) {
+        if (!matches(i)) {
+          continue;
+        }
+        ASSERT_LT(row, result.size()) << table << " " << predicate->ToString();
+        ASSERT_EQ(result[row].GetValue(output.get(), 0).ToString(), fmt::format("name-{}", i % 300));
+        ASSERT_EQ(result[row].GetValue(output.get(), 1).GetAs<int32_t>(), i);
+        row++;
+      }
+      EXPECT_EQ(row, result.size()) << table << " " << predicate->ToString();
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/bustub_instance.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(TableHeapTest, InsertTuplesTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 32}}};
+
+  for (auto format : {TableFormat::Row, TableFormat::Pax}) {
+    auto table = std::make_unique<TableHeap>(bpm.get(), format, schema);
+    auto make_tuple = [&](int i) {
+      return Tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(fmt::format("value-{}", i))},
+                   &schema};
+    };
+    // a single tuple first, then batches that start on a partly filled page and span many pages
+    auto first = table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(0));
+    ASSERT_TRUE(first.has_value());
+    std::vector<RID> rids{*first};
+    for (int begin = 1; begin < 3000; begin += 1000) {
+      std::vector<Tuple> tuples;
+      for (int i = begin; i < begin + 1000 && i < 3000; i++) {
+        tuples.push_back(make_tuple(i));
+      }
+      auto batch_rids = table->InsertTuples(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuples);
+      ASSERT_EQ(batch_rids.size(), tuples.size());
+      rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+    }
+    EXPECT_EQ(table->InsertTuples(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, {}).size(), 0);
+
+    // the tuples are appended in order and read back like tuples inserted one at a time
+    int count = 0;
+    for (auto iter = table->MakeIterator(); !iter.IsEnd(); ++iter) {
+      auto [meta, tuple] = iter.GetTuple();
+      ASSERT_LT(static_cast<size_t>(count), rids.size());
+      EXPECT_EQ(tuple.GetRid(), rids[count]);
+      EXPECT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), count);
+      EXPECT_EQ(tuple.GetValue(&schema, 1).ToString(), fmt::format("value-{}", count));
+      count++;
+    }
+    EXPECT_EQ(count, 3000);
+    EXPECT_NE(rids.front().GetPageId(), rids.back().GetPageId());
+    EXPECT_EQ(table->GetZoneMap()->GetZone(rids.back().GetPageId(), 0)->max_.GetAs<int32_t>(), 2999);
+  }
+}
+
+TEST(TableHeapTest, BulkInsertFillsIndexes) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (a INT, b INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE INDEX t_a ON t (a);", writer));
+  // the keys arrive out of order and span several statements
+  for (int begin = 0; begin < 4000; begin += 1000) {
+    std::string values;
+    for (int i = begin; i < begin + 1000; i++) {
+      int key = (i * 7919) % 4000;
+      values += fmt::format("{}({}, {})", i == begin ? "" : ", ", key, i);
+    }
+    ASSERT_TRUE(bustub->ExecuteSql(fmt::format("INSERT INTO t VALUES {};", values), writer));
+  }
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE INDEX t_b ON t (b);", writer));
+
+  auto *table_info = bustub->catalog_->GetTable("t");
+  for (auto *index_info : bustub->catalog_->GetTableIndexes("t")) {
+    for (int key = 0; key < 4000; key++) {
+      std::vector<RID> rids;
+      Tuple key_tuple{{ValueFactory::GetIntegerValue(key)}, &index_info->key_schema_};
+      index_info->index_->ScanKey(key_tuple, &rids, nullptr);
+      ASSERT_EQ(rids.size(), 1) << index_info->name_ << " " << key;
+      auto [meta, tuple] = table_info->table_->GetTuple(rids[0]);
+      auto column = index_info->name_ == "t_a" ? 0 : 1;
+      EXPECT_EQ(tuple.GetValue(&table_info->schema_, column).GetAs<int32_t>(), key);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_loader_test.cpp
+//
+// Identification: test/table/table_loader_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "catalog/table_loader.h"
+#include "common/bustub_instance.h"
+#include "common/util/parallel_util.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+/** A file in the temporary directory, removed when the test is done with it */
+class TempFile {
+ public:
+  explicit TempFile(const std::string &name)
+      : path_((std::filesystem::temp_directory_path() / fmt::format("bustub_{}_{}", ::getpid(), name)).string()) {}
+  ~TempFile() { std::remove(path_.c_str()); }
+
+  auto Path() const -> const std::string & { return path_; }
+
+  void Write(const std::string &content) const {
+    std::ofstream out(path_, std::ios::binary);
+    out << content;
+  }
+
+ private:
+  std::string path_;
+};
+
+}  // namespace
+
+TEST(TableLoaderTest, CopyCsvTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (a INT, b VARCHAR(32), c INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE INDEX t_a ON t (a);", writer));
+
+  // a header, quoted fields holding the delimiter, quotes and a newline, NULLs and a CRLF line ending
+  TempFile file("copy.csv");
+  file.Write(
+      "a|b|c\n"
+      "3|three|30\n"
+      "1|\"o|n\"\"e\"|10\r\n"
+      "\n"
+      "2|\"tw\no\"|\n"
+      "4||40\n"
+      "5|\"\"|50");
+  EXPECT_EQ(Query(bustub.get(), fmt::format("COPY t FROM '{}' (FORMAT csv, DELIMITER '|', HEADER);", file.Path())),
+            "5 \n");
+  EXPECT_EQ(Query(bustub.get(), "SELECT a, b, c FROM t ORDER BY a;"),
+            "1 o|n\"e 10 \n2 tw\no integer_null \n3 three 30 \n4 varlen_null 40 \n5  50 \n");
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*), count(b), count(c) FROM t;"), "5 4 4 \n");
+
+  // the index is filled once the rows are loaded
+  auto *index_info = bustub->catalog_->GetTableIndexes("t")[0];
+  for (int key = 1; key <= 5; key++) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple{{ValueFactory::GetIntegerValue(key)}, &index_info->key_schema_}, &rids,
+                                nullptr);
+    EXPECT_EQ(rids.size(), 1) << key;
+  }
+
+  // rows with the wrong number of fields, bad values and missing files are errors
+  file.Write("6|six\n");
+  EXPECT_THROW(bustub->ExecuteSql(fmt::format("COPY t FROM '{}' (DELIMITER '|');", file.Path()), writer), Exception);
+  file.Write("x,seven,70\n");
+  EXPECT_THROW(bustub->ExecuteSql(fmt::format("COPY t FROM '{}';", file.Path()), writer), Exception);
+  EXPECT_THROW(bustub->ExecuteSql("COPY t FROM '/nonexistent/bustub.csv';", writer), Exception);
+  EXPECT_THROW(bustub->ExecuteSql(fmt::format("COPY t FROM '{}' (FORMAT json);", file.Path()), writer), Exception);
+}
+
+TEST(TableLoaderTest, CopyManyChunksTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (a INT, b INT, c VARCHAR(64));", writer));
+
+  // several chunks, so rows are cut at chunk boundaries and parsed by several workers
+  const int num_rows = 60000;
+  std::string content;
+  int64_t sum = 0;
+  for (int i = 0; i < num_rows; i++) {
+    content += fmt::format("{},{},\"row {} with a, comma and some padding\"\n", i, i % 97, i);
+    sum += i % 97;
+  }
+  ASSERT_GT(content.size(), 2 * TableLoader::CHUNK_SIZE);
+  TempFile file("many.csv");
+  file.Write(content);
+  EXPECT_EQ(Query(bustub.get(), fmt::format("COPY t FROM '{}';", file.Path())), fmt::format("{} \n", num_rows));
+
+  // the rows are appended in file order
+  int expected = 0;
+  auto *table_info = bustub->catalog_->GetTable("t");
+  for (auto iter = table_info->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    ASSERT_EQ(tuple.GetValue(&table_info->schema_, 0).GetAs<int32_t>(), expected);
+    expected++;
+  }
+  EXPECT_EQ(expected, num_rows);
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*), sum(b) FROM t;"), fmt::format("{} {} \n", num_rows, sum));
+  EXPECT_EQ(Query(bustub.get(), "SELECT c FROM t WHERE a = 12345;"), "row 12345 with a, comma and some padding \n");
+}
+
+TEST(TableLoaderTest, CopyBadRowLateTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (a INT, b VARCHAR(32));", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE INDEX t_a ON t (a);", writer));
+
+  // the bad row is past the first round of chunks, so the rows before it are already in the table heap when
+  // it is parsed
+  const size_t good_size = (2 * ParallelUtil::WorkerCount() + 1) * TableLoader::CHUNK_SIZE;
+  std::string content;
+  int num_rows = 0;
+  while (content.size() < good_size) {
+    content += fmt::format("{},padding for row {}\n", num_rows, num_rows);
+    num_rows++;
+  }
+  content += "x,not a number\n";
+  TempFile file("bad.csv");
+  file.Write(content);
+  EXPECT_THROW(bustub->ExecuteSql(fmt::format("COPY t FROM '{}';", file.Path()), writer), Exception);
+
+  // no row of the failed load is visible
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*) FROM t;"), "0 \n");
+  auto *table_info = bustub->catalog_->GetTable("t");
+  for (auto iter = table_info->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
+    ASSERT_TRUE(iter.GetTuple().first.is_deleted_);
+  }
+
+  // the same rows without the bad one load normally, and the index holds only the keys of this load
+  content.resize(content.size() - std::string("x,not a number\n").size());
+  file.Write(content);
+  EXPECT_EQ(Query(bustub.get(), fmt::format("COPY t FROM '{}';", file.Path())), fmt::format("{} \n", num_rows));
+  auto *index_info = bustub->catalog_->GetTableIndexes("t")[0];
+  for (int key : {0, num_rows / 2, num_rows - 1}) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple{{ValueFactory::GetIntegerValue(key)}, &index_info->key_schema_}, &rids,
+                                nullptr);
+    ASSERT_EQ(rids.size(), 1) << key;
+    auto [meta, tuple] = table_info->table_->GetTuple(rids[0]);
+    EXPECT_FALSE(meta.is_deleted_) << key;
+    EXPECT_EQ(tuple.GetValue(&table_info->schema_, 0).GetAs<int32_t>(), key);
+  }
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*) FROM t;"), fmt::format("{} \n", num_rows));
+}
+
+TEST(TableLoaderTest, CopyOversizedRowTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE r (a INT, b VARCHAR(32));", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE p (a INT, b VARCHAR(32)) WITH (format = pax);", writer));
+
+  // a row longer than a page fails the load instead of the insert, the rows before it are rolled back
+  std::string content;
+  for (int i = 0; i < 100; i++) {
+    content += fmt::format("{},row {}\n", i, i);
+  }
+  content += fmt::format("100,{}\n", std::string(BUSTUB_PAGE_SIZE, 'x'));
+  TempFile file("oversized.csv");
+  file.Write(content);
+  TempFile binary_file("oversized.bin");
+  {
+    std::ofstream out(binary_file.Path(), std::ios::binary);
+    BinaryRowWriter rows(out, bustub->catalog_->GetTable("r")->schema_);
+    rows.WriteRow({ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue("row 0")});
+    rows.WriteRow(
+        {ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue(std::string(BUSTUB_PAGE_SIZE, 'x'))});
+  }
+  for (const auto *table : {"r", "p"}) {
+    EXPECT_THROW(bustub->ExecuteSql(fmt::format("COPY {} FROM '{}';", table, file.Path()), writer), Exception);
+    EXPECT_THROW(
+        bustub->ExecuteSql(fmt::format("COPY {} FROM '{}' (FORMAT 'binary');", table, binary_file.Path()), writer),
+        Exception);
+    EXPECT_EQ(Query(bustub.get(), fmt::format("SELECT count(*) FROM {};", table)), "0 \n") << table;
+  }
+}
+
+TEST(TableLoaderTest, CopyBinaryTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE t (a INT, b VARCHAR(32), c INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE csv (a INT, b VARCHAR(32), c INT);", writer));
+
+  TempFile file("copy.bin");
+  TempFile csv_file("copy.csv");
+  {
+    std::ofstream out(file.Path(), std::ios::binary);
+    BinaryRowWriter rows(out, bustub->catalog_->GetTable("t")->schema_);
+    std::string csv;
+    for (int i = 0; i < 5000; i++) {
+      auto b = i % 10 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                           : ValueFactory::GetVarcharValue(std::string(i % 20, 'x'));
+      rows.WriteRow({ValueFactory::GetIntegerValue(i), b, ValueFactory::GetIntegerValue(i * 7919)});
+      csv += fmt::format("{},{},{}\n", i, b.IsNull() ? "" : fmt::format("\"{}\"", b.ToString()), i * 7919);
+    }
+    csv_file.Write(csv);
+  }
+  EXPECT_EQ(Query(bustub.get(), fmt::format("COPY t FROM '{}' (FORMAT 'binary');", file.Path())), "5000 \n");
+  EXPECT_EQ(Query(bustub.get(), fmt::format("COPY csv FROM '{}';", csv_file.Path())), "5000 \n");
+  auto expected = Query(bustub.get(), "SELECT * FROM csv;");
+  EXPECT_EQ(Query(bustub.get(), "SELECT * FROM t;"), expected);
+
+  // a binary file only loads into a table with the same column types
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE u (a INT, b INT, c INT);", writer));
+  EXPECT_THROW(bustub->ExecuteSql(fmt::format("COPY u FROM '{}' (FORMAT 'binary');", file.Path()), writer),
+               Exception);
+  EXPECT_THROW(bustub->ExecuteSql(fmt::format("COPY u FROM '{}' (FORMAT 'binary');", csv_file.Path()), writer),
+               Exception);
+}
+
+}  // namespace bustub
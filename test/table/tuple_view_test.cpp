@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view_test.cpp
+//
+// Identification: test/table/tuple_view_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple_view.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+TEST(TupleViewTest, TypedAccessTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 32},
+                                    Column{"c", TypeId::BIGINT}, Column{"d", TypeId::BOOLEAN},
+                                    Column{"e", TypeId::VARCHAR, 32}, Column{"f", TypeId::DECIMAL},
+                                    Column{"g", TypeId::SMALLINT}}};
+  std::vector<Value> values{ValueFactory::GetIntegerValue(-42),
+                            ValueFactory::GetVarcharValue("hello"),
+                            ValueFactory::GetNullValueByType(TypeId::BIGINT),
+                            ValueFactory::GetBooleanValue(true),
+                            ValueFactory::GetNullValueByType(TypeId::VARCHAR),
+                            ValueFactory::GetDecimalValue(2.5),
+                            ValueFactory::GetSmallIntValue(7)};
+  Tuple tuple{values, &schema};
+  TupleView view(tuple);
+
+  for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+    EXPECT_EQ(view.IsNull(&schema, i), values[i].IsNull()) << i;
+    auto val = view.GetValue(&schema, i);
+    EXPECT_EQ(val.IsNull(), values[i].IsNull()) << i;
+    if (!val.IsNull()) {
+      EXPECT_EQ(val.CompareEquals(values[i]), CmpBool::CmpTrue) << i;
+    }
+  }
+  EXPECT_EQ(view.GetInt32(&schema, 0), -42);
+  EXPECT_EQ(view.GetVarchar(&schema, 1), "hello");
+  EXPECT_EQ(view.GetBool(&schema, 3), 1);
+  EXPECT_EQ(view.GetDecimal(&schema, 5), 2.5);
+  EXPECT_EQ(view.GetInt16(&schema, 6), 7);
+
+  auto copy = view.Materialize();
+  ASSERT_EQ(copy.GetLength(), tuple.GetLength());
+  EXPECT_EQ(copy.GetValue(&schema, 1).ToString(), "hello");
+}
+
+TEST(TupleViewTest, PageViewTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(16, disk_manager.get());
+  auto table = std::make_unique<TableHeap>(bpm.get());
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 32}}};
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("row-" + std::to_string(i))},
+                &schema};
+    rids.push_back(*table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, i == 3}, tuple));
+  }
+
+  for (int i = 0; i < 100; i++) {
+    // the view points into the page frame, so it is read while the guard is held
+    auto guard = bpm->FetchPageRead(rids[i].GetPageId());
+    auto [meta, view] = guard.As<TablePage>()->GetTupleView(rids[i]);
+    EXPECT_EQ(meta.is_deleted_, i == 3);
+    EXPECT_EQ(view.GetRid(), rids[i]);
+    EXPECT_EQ(view.GetInt32(&schema, 0), i);
+    EXPECT_EQ(view.GetVarchar(&schema, 1), "row-" + std::to_string(i));
+    EXPECT_GE(view.GetData(), guard.GetData());
+    EXPECT_LT(view.GetData(), guard.GetData() + BUSTUB_PAGE_SIZE);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map_test.cpp
+//
+// Identification: test/table/zone_map_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "binder/binder.h"
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_context.h"
+#include "execution/executor_factory.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
+#include "planner/planner.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/morsel_queue.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/zone_map.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto CountPages(TableHeap *table, const std::vector<ZoneMapRange> &ranges) -> size_t {
+  MorselQueue morsels(table, MorselQueue::DEFAULT_PAGES_PER_MORSEL, ranges);
+  size_t num_pages = 0;
+  Morsel morsel;
+  while (morsels.Next(&morsel)) {
+    num_pages += morsel.pages_.size();
+  }
+  return num_pages;
+}
+
+auto Query(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  SimpleStreamWriter writer(ss, true, " ");
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+/**
+ * Plan a query like the instance does and run its scan on its own.
+ * @return the number of pages the scan read, or nullopt if the filter of the query did not end up in the scan
+ */
+auto ScannedPages(BustubInstance *bustub, const std::string &sql) -> std::optional<size_t> {
+  Binder binder(*bustub->catalog_);
+  binder.ParseAndSave(sql);
+  Planner planner(*bustub->catalog_);
+  planner.PlanQuery(*binder.BindStatement(binder.statement_nodes_.at(0)));
+  Optimizer optimizer(*bustub->catalog_, false);
+  AbstractPlanNodeRef scan_plan = nullptr;
+  bool has_filter = false;
+  std::function<void(const AbstractPlanNodeRef &)> visit = [&](const AbstractPlanNodeRef &node) {
+    has_filter = has_filter || node->GetType() == PlanType::Filter;
+    if (node->GetType() == PlanType::SeqScan) {
+      scan_plan = node;
+    }
+    for (const auto &child : node->GetChildren()) {
+      visit(child);
+    }
+  };
+  visit(optimizer.Optimize(planner.plan_));
+  if (scan_plan == nullptr || has_filter ||
+      dynamic_cast<const SeqScanPlanNode &>(*scan_plan).filter_predicate_ == nullptr) {
+    return std::nullopt;
+  }
+
+  auto *txn = bustub->txn_manager_->Begin();
+  ExecutorContext exec_ctx(txn, bustub->catalog_, bustub->buffer_pool_manager_, bustub->txn_manager_,
+                           bustub->lock_manager_, false);
+  auto executor = ExecutorFactory::CreateExecutor(&exec_ctx, scan_plan);
+  executor->Init();
+  TupleBatch batch;
+  while (executor->NextBatch(&batch)) {
+  }
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+  return dynamic_cast<SeqScanExecutor &>(*executor).GetNumPagesScanned();
+}
+
+}  // namespace
+
+TEST(ZoneMapTest, PrunePagesTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER},
+                                    Column{"c", TypeId::VARCHAR, 16}}};
+  auto table = std::make_unique<TableHeap>(bpm.get(), TableFormat::Row, schema);
+  const auto *zone_map = table->GetZoneMap();
+  ASSERT_NE(zone_map, nullptr);
+
+  // a is ascending, b is spread over every page, c is always NULL
+  std::vector<RID> rids;
+  for (int i = 0; i < 5000; i++) {
+    Tuple tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10),
+                 ValueFactory::GetNullValueByType(TypeId::VARCHAR)},
+                &schema};
+    rids.push_back(*table->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  }
+  const size_t num_pages = CountPages(table.get(), {});
+  ASSERT_GT(num_pages, 20);
+
+  auto zone = zone_map->GetZone(rids[0].GetPageId(), 0);
+  ASSERT_TRUE(zone.has_value());
+  EXPECT_EQ(zone->min_.GetAs<int32_t>(), 0);
+  EXPECT_TRUE(zone->has_value_);
+  auto last = zone_map->GetZone(rids.back().GetPageId(), 0);
+  EXPECT_EQ(last->max_.GetAs<int32_t>(), 4999);
+  auto first_page_tuples = std::count_if(rids.begin(), rids.end(),
+                                         [&](const RID &rid) { return rid.GetPageId() == rids[0].GetPageId(); });
+  EXPECT_EQ(zone_map->GetZone(rids[0].GetPageId(), 2)->null_count_, first_page_tuples);
+  EXPECT_FALSE(zone_map->GetZone(rids[0].GetPageId(), 2)->has_value_);
+
+  // 3000 <= a < 3100 lies on one or two pages
+  ZoneMapRange range{0, ValueFactory::GetIntegerValue(3000), true, ValueFactory::GetIntegerValue(3100), false};
+  EXPECT_LE(CountPages(table.get(), {range}), 2);
+  EXPECT_TRUE(zone_map->MayMatch(rids[3050].GetPageId(), {range}));
+  EXPECT_FALSE(zone_map->MayMatch(rids[0].GetPageId(), {range}));
+  // a > 4999 matches nothing, b = 5 matches every page holding a 5, c = ... never matches a NULL column
+  std::set<page_id_t> pages_with_five;
+  for (size_t i = 5; i < rids.size(); i += 10) {
+    pages_with_five.insert(rids[i].GetPageId());
+  }
+  EXPECT_EQ(CountPages(table.get(), {ZoneMapRange{0, ValueFactory::GetIntegerValue(4999), false, {}, true}}), 0);
+  EXPECT_EQ(CountPages(table.get(), {ZoneMapRange{1, ValueFactory::GetIntegerValue(5), true,
+                                                  ValueFactory::GetIntegerValue(5), true}}),
+            pages_with_five.size());
+  EXPECT_EQ(CountPages(table.get(), {ZoneMapRange{2, ValueFactory::GetVarcharValue("x"), true, {}, true}}), 0);
+
+  // an in-place update widens the zone of its page
+  Tuple updated{{ValueFactory::GetIntegerValue(-7), ValueFactory::GetIntegerValue(1),
+                 ValueFactory::GetNullValueByType(TypeId::VARCHAR)},
+                &schema};
+  table->UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, updated, rids[4000]);
+  EXPECT_EQ(zone_map->GetZone(rids[4000].GetPageId(), 0)->min_.GetAs<int32_t>(), -7);
+  EXPECT_EQ(CountPages(table.get(), {ZoneMapRange{0, {}, true, ValueFactory::GetIntegerValue(0), false}}), 1);
+}
+
+TEST(ZoneMapTest, PrunedScanMatchesFullScan) {
+  auto bustub = std::make_unique<BustubInstance>();
+  NoopWriter writer;
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE r (a INT, b INT);", writer));
+  ASSERT_TRUE(bustub->ExecuteSql("CREATE TABLE p (a INT, b INT) WITH (format = pax);", writer));
+  for (int begin = 0; begin < 6000; begin += 500) {
+    std::string values;
+    for (int i = begin; i < begin + 500; i++) {
+      values += fmt::format("{}({}, {})", i == begin ? "" : ", ", i, i % 13);
+    }
+    for (const auto *table : {"r", "p"}) {
+      ASSERT_TRUE(bustub->ExecuteSql(fmt::format("INSERT INTO {} VALUES {};", table, values), writer));
+    }
+  }
+
+  const std::vector<std::string> queries{
+      "SELECT * FROM {} WHERE a >= 2500 AND a < 2600;",
+      "SELECT count(*), sum(b) FROM {} WHERE 4000 < a AND b = 3;",
+      "SELECT count(*) FROM {} WHERE a = 5999;",
+      "SELECT count(*) FROM {} WHERE a > 6000;",
+      "SELECT count(*) FROM {} WHERE a < 10 OR a > 5990;",
+  };
+  for (const auto &sql : queries) {
+    auto expected = Query(bustub.get(), fmt::format(sql, "r"));
+    EXPECT_FALSE(expected.empty()) << sql;
+    EXPECT_EQ(Query(bustub.get(), fmt::format(sql, "p")), expected) << sql;
+  }
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*) FROM r WHERE a >= 2500 AND a < 2600;"), "100 \n");
+  EXPECT_EQ(Query(bustub.get(), "SELECT count(*) FROM r WHERE a > 6000;"), "0 \n");
+
+  // the WHERE clause is merged into the scan, which skips the pages outside the range of a
+  for (const auto *table : {"r", "p"}) {
+    const size_t num_pages = CountPages(bustub->catalog_->GetTable(table)->table_.get(), {});
+    ASSERT_GT(num_pages, 4) << table;
+    auto range_pages = ScannedPages(bustub.get(), fmt::format(queries[0], table));
+    ASSERT_TRUE(range_pages.has_value()) << table;
+    EXPECT_LE(*range_pages, 2) << table;
+    EXPECT_EQ(ScannedPages(bustub.get(), fmt::format(queries[3], table)), 0) << table;
+    // a disjunction gives no range, every page is read
+    EXPECT_EQ(ScannedPages(bustub.get(), fmt::format(queries[4], table)), num_pages) << table;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "container/disk/hash/disk_extendible_hash_table.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"
+
+static const size_t LRU_K_SIZE = 4;
+static const size_t BUSTUB_BPM_SIZE = 4096;
+static const size_t TOTAL_KEYS = 100000;
+
+using bustub::BufferPoolManager;
+using bustub::DiskManagerUnlimitedMemory;
+using bustub::GenericComparator;
+using bustub::GenericKey;
+using bustub::page_id_t;
+using bustub::RID;
+
+/** One index under test, built in its own buffer pool so that the page counts do not mix. */
+struct IndexUnderTest {
+  std::unique_ptr<DiskManagerUnlimitedMemory> disk_manager_{std::make_unique<DiskManagerUnlimitedMemory>()};
+  std::unique_ptr<BufferPoolManager> bpm_{
+      std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager_.get(), LRU_K_SIZE)};
+
+  /** Page ids are handed out in order, the next one tells how many pages the index has allocated so far. */
+  auto PagesAllocated() -> page_id_t {
+    page_id_t page_id;
+    bpm_->NewPageGuarded(&page_id);
+    bpm_->DeletePage(page_id);
+    return page_id;
+  }
+};
+
+auto MakeKey(int64_t key) -> GenericKey<8> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+auto MakeRid(int64_t key) -> RID { return {static_cast<page_id_t>(key), static_cast<uint32_t>(key)}; }
+
+/** Runs lookup(key) for every probe key and prints the average latency next to the pages used. */
+template <typename Lookup>
+void Report(const std::string &name, IndexUnderTest *index, const std::vector<int64_t> &probes, Lookup &&lookup) {
+  auto pages = index->PagesAllocated();
+  size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto key : probes) {
+    found += lookup(key) ? 1 : 0;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  fmt::print("{:<16} probe={:>10.1f} ns/op  pages={:>8}  space={:>10} KiB  found={}\n", name,
+             static_cast<double>(elapsed.count()) / probes.size(), pages, pages * bustub::BUSTUB_PAGE_SIZE / 1024,
+             found);
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-index-bench");
+  program.add_argument("--keys").help("number of keys loaded into each index");
+  program.add_argument("--probes").help("number of point lookups run against each index");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t total_keys = TOTAL_KEYS;
+  if (program.present("--keys")) {
+    total_keys = std::stoul(program.get("--keys"));
+  }
+  size_t total_probes = total_keys;
+  if (program.present("--probes")) {
+    total_probes = std::stoul(program.get("--probes"));
+  }
+
+  fmt::print(stderr, "[info] total_keys={}, total_probes={}, lru_k_size={}, bpm_size={}\n", total_keys, total_probes,
+             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  bustub::HashFunction<GenericKey<8>> hash_fn;
+
+  std::vector<int64_t> keys(total_keys);
+  for (size_t i = 0; i < total_keys; i++) {
+    keys[i] = static_cast<int64_t>(i);
+  }
+  std::mt19937 gen(15445);
+  std::shuffle(keys.begin(), keys.end(), gen);
+
+  // half of the probes hit a stored key, the other half miss
+  std::vector<int64_t> probes(total_probes);
+  std::uniform_int_distribution<int64_t> dis(0, static_cast<int64_t>(total_keys) * 2 - 1);
+  for (auto &probe : probes) {
+    probe = dis(gen);
+  }
+
+  {
+    IndexUnderTest index;
+    page_id_t header_page_id;
+    index.bpm_->NewPageGuarded(&header_page_id);
+    bustub::BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("bench", header_page_id, index.bpm_.get(),
+                                                                     comparator);
+    for (auto key : keys) {
+      tree.Insert(MakeKey(key), MakeRid(key));
+    }
+    std::vector<RID> result;
+    Report("b+ tree", &index, probes, [&](int64_t key) {
+      result.clear();
+      return tree.GetValue(MakeKey(key), &result);
+    });
+  }
+
+  {
+    IndexUnderTest index;
+    bustub::DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>> table("bench", index.bpm_.get(),
+                                                                                    comparator, hash_fn);
+    for (auto key : keys) {
+      table.Insert(nullptr, MakeKey(key), MakeRid(key));
+    }
+    std::vector<RID> result;
+    Report("extendible hash", &index, probes, [&](int64_t key) {
+      result.clear();
+      return table.GetValue(nullptr, MakeKey(key), &result);
+    });
+  }
+
+  {
+    // sized up front for a load factor of 1/2, so no rebuild runs and every allocated page is still in use
+    IndexUnderTest index;
+    bustub::LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>> table("bench", index.bpm_.get(),
+                                                                                 comparator, total_keys * 2, hash_fn);
+    for (auto key : keys) {
+      table.Insert(nullptr, MakeKey(key), MakeRid(key));
+    }
+    std::vector<RID> result;
+    Report("linear probe", &index, probes, [&](int64_t key) {
+      result.clear();
+      return table.GetValue(nullptr, MakeKey(key), &result);
+    });
+  }
+
+  return 0;
+}